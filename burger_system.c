@@ -62,6 +62,7 @@
  * - -n, --bandas <N>: Número de bandas (1-10, default: 3)
  * - -t, --tiempo-ingrediente <S>: Segundos por ingrediente (1-60, default: 2)
  * - -o, --tiempo-orden <S>: Segundos entre órdenes (1-300, default: 7)
+ * - -s, --nombre <NOMBRE>: Nombre de la cocina (segmento /burger_system_<NOMBRE>)
  * - -m, --menu: Mostrar menú de hamburguesas disponibles
  * - -h, --help: Mostrar ayuda completa
  *
@@ -96,6 +97,7 @@
  */
 
 #include <stdio.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -103,8 +105,17 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <time.h>
+#include <math.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <signal.h>
+#include <limits.h>
 #include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <sys/file.h>
 
 /**
  * @defgroup constantes Constantes del Sistema
@@ -135,6 +146,18 @@
 /** @brief Umbral para considerar inventario bajo (menos de 3 unidades) */
 #define UMBRAL_INVENTARIO_BAJO 2
 
+/** @brief Sin reabastecimiento automático por umbral (--umbral-reabasto) */
+#define SIN_UMBRAL_REABASTO -1
+
+/** @brief Tiempo máximo de parada por dispensador rellenado (--tiempo-reabasto, segundos simulados) */
+#define MAX_TIEMPO_REABASTO 60
+
+/** @brief Factor de velocidad mínimo de una banda o estación (--velocidad): 4 veces más lenta */
+#define VELOCIDAD_MINIMA 0.25f
+
+/** @brief Factor de velocidad máximo de una banda o estación (--velocidad): 4 veces más rápida */
+#define VELOCIDAD_MAXIMA 4.0f
+
 /**
  * @brief Valores por defecto para tiempos de operación
  * @{
@@ -144,6 +167,417 @@
 
 /** @brief Tiempo por defecto entre generación de nuevas órdenes (segundos) */
 #define TIEMPO_DEFAULT_NUEVA_ORDEN 7
+
+/** @brief Tiempo medio por defecto que un cliente piensa antes de volver a ordenar (segundos simulados) */
+#define TIEMPO_DEFAULT_PENSAR 30
+/** @} */
+
+/**
+ * @brief Población cerrada de clientes (--clientes)
+ * @{
+ */
+/** @brief Clientes máximos de la población cerrada */
+#define MAX_CLIENTES 1000
+
+/** @brief Orden generada sin cliente: llegadas abiertas a intervalo fijo */
+#define SIN_CLIENTE -1
+
+/** @brief Regreso de un cliente con una orden en curso */
+#define CLIENTE_ESPERANDO -1
+
+/** @brief Regreso de un cliente cuya orden terminó y aún no sorteó su reflexión */
+#define CLIENTE_LIBERADO 0
+
+/** @brief Espera máxima del generador entre revisiones de la población (ms reales) */
+#define ESPERA_MAXIMA_CLIENTES_MS 200
+/** @} */
+
+/**
+ * @brief Parámetros de publicación de métricas para el panel de control
+ * @{
+ */
+/** @brief Prefijo común de los segmentos de memoria compartida (registro de instancias) */
+#define PREFIJO_MEMORIA "/burger_system"
+
+/** @brief Longitud máxima del nombre de una instancia (cocina) */
+#define MAX_NOMBRE_INSTANCIA 32
+
+/** @brief Ventana deslizante para calcular el throughput (segundos) */
+#define VENTANA_THROUGHPUT 60
+
+/** @brief Ancho de cada cubeta del histograma de latencias (milisegundos) */
+#define ANCHO_CUBETA_LATENCIA_MS 250
+
+/** @brief Número de cubetas del histograma de latencias (cubre 10 minutos) */
+#define NUM_CUBETAS_LATENCIA 2400
+
+/** @brief Segundos simulados que agrupa cada lote de MSER-5 */
+#define SEGUNDOS_LOTE_MSER 5
+
+/** @brief Lotes de MSER que se conservan; al llenarse se funden de a pares y duran el doble */
+#define MAX_LOTES_MSER 1024
+
+/** @brief Lotes del estado estacionario con los que se arma el intervalo de confianza */
+#define LOTES_MEDIAS 10
+
+/** @brief Transiciones de estado que conserva cada banda para la línea de tiempo */
+#define MAX_TRANSICIONES_BANDA 256
+
+/** @brief Tiempo durante el cual un rechazo por inventario marca la banda como desabastecida (ms) */
+#define VENTANA_DESABASTECIDA_MS 4000
+
+/** @brief Paciencia media por defecto de un cliente antes de abandonar (ms simulados desde su creación, --edad-maxima) */
+#define EDAD_MAXIMA_DEFAULT_MS 60000
+
+/** @brief Entradas del índice de órdenes vivas (potencia de 2, holgada sobre la cola y los lotes en bandas) */
+#define CAPACIDAD_INDICE 512
+
+/** @brief Espera del asignador antes de reintentar cuando ninguna banda puede tomar la orden (ms simulados) */
+#define ESPERA_REINTENTO_MS 3000
+
+/** @brief Órdenes del mismo tipo que una banda puede preparar juntas como máximo (--lote) */
+#define MAX_LOTE 4
+
+/** @brief Exponente por defecto del costo de lote: un paso de n órdenes dura n^exponente pasos sueltos */
+#define EXPONENTE_LOTE_DEFAULT 0.6
+
+/**
+ * @brief Lugares de la cola reservados para reencolar (asignador y vigilante)
+ *
+ * Las órdenes nuevas se rechazan antes de llenar la cola: si el generador
+ * ocupara el último lugar, el asignador, único consumidor, quedaría bloqueado
+ * al reencolar una orden que ninguna banda pudo tomar.
+ */
+#define RESERVA_REENCOLADO (MAX_BANDAS * MAX_LOTE + 1)
+/** @} */
+
+/**
+ * @brief Políticas de asignación de órdenes (--politica)
+ * @{
+ */
+/** @brief La cabeza de la cola primero (comportamiento original) */
+#define POLITICA_FIFO 0
+/** @brief Dentro de la ventana de equidad, primero la orden con más ingreso por segundo de preparación */
+#define POLITICA_VALOR 1
+
+/** @brief Órdenes del frente de la cola entre las que elige la política por valor */
+#define VENTANA_EQUIDAD 8
+/** @} */
+
+/**
+ * @brief Paciencia de los clientes en la cola (--paciencia)
+ * @{
+ */
+/** @brief Todas las órdenes abandonan a la edad máxima exacta (comportamiento original) */
+#define PACIENCIA_FIJA 0
+/** @brief Paciencia exponencial con media en la edad máxima */
+#define PACIENCIA_EXPONENCIAL 1
+/** @brief Paciencia uniforme entre la mitad y una vez y media la edad máxima */
+#define PACIENCIA_UNIFORME 2
+
+/** @brief Casillas de la rueda de temporizadores de paciencia */
+#define CASILLAS_RUEDA_PACIENCIA 256
+
+/** @brief Ancho de cada casilla de la rueda (ms reales) */
+#define MS_CASILLA_PACIENCIA 50
+
+/** @brief Tramos de cola al llegar para la curva de abandonos contra carga */
+#define TRAMOS_CARGA_ABANDONO 6
+
+/** @brief Veces que una orden puede ser adelantada antes de pasar obligatoriamente primero */
+#define MAX_ADELANTOS 4
+/** @} */
+
+/**
+ * @brief Estaciones de una banda para las recetas en DAG (--dag)
+ * @{
+ */
+/** @brief Tostador de panes */
+#define ESTACION_TOSTADOR 0
+/** @brief Plancha: carne, vegetal, bacon y queso fundido */
+#define ESTACION_PLANCHA 1
+/** @brief Mesa de fríos: verduras cortadas */
+#define ESTACION_FRIOS 2
+/** @brief Mesa de armado: salsas y cierre con el pan superior */
+#define ESTACION_ARMADO 3
+/** @brief Estaciones de cada banda; cada una atiende un paso a la vez */
+#define NUM_ESTACIONES 4
+
+/** @brief Pasos máximos de una receta (uno por ingrediente de TipoHamburguesa) */
+#define MAX_PASOS_RECETA 10
+/** @} */
+
+/**
+ * @brief Vigilante de bandas atascadas
+ * @{
+ */
+/** @brief Veces la duración esperada de un paso tras las cuales la banda se declara atascada */
+#define FACTOR_ATASCO 3
+
+/** @brief Holgura fija (ms reales) sumada al plazo de cada paso para absorber la planificación del SO */
+#define MARGEN_ATASCO_MS 500
+
+/** @brief Periodo entre revisiones del vigilante (ms reales) */
+#define PERIODO_VIGILANTE_MS 250
+
+/** @brief Tiempo que tarda una banda en tomar una orden recién asignada (ms simulados) */
+#define PASO_RECOGIDA_MS 100
+
+/** @brief Duración del atasco que provoca la acción "bloquear" de un escenario (ms simulados) */
+#define DURACION_BLOQUEO_MS 60000
+/** @} */
+
+/**
+ * @brief Recursos de cocina compartidos entre bandas (--parrillas, --tolvas)
+ * @{
+ */
+/** @brief Recursos como máximo: la parrilla y una tolva por cada par de bandas */
+#define MAX_RECURSOS (1 + (MAX_BANDAS + 1) / 2)
+
+/** @brief Índice de la parrilla en DatosCompartidos.recursos */
+#define RECURSO_PARRILLA 0
+
+/** @brief Largo máximo del nombre de un recurso */
+#define MAX_NOMBRE_RECURSO 32
+
+/** @brief Cada cuánto una banda en espera de un recurso publica su latido (ms reales) */
+#define PERIODO_ESPERA_RECURSO_MS 100
+/** @} */
+
+/**
+ * @brief Contabilidad de CPU de cada hilo interno
+ * @{
+ */
+/** @brief Hilo principal, que imprime el estado en la terminal */
+#define COMPONENTE_PANTALLA 0
+#define COMPONENTE_GENERADOR 1
+#define COMPONENTE_ASIGNADOR 2
+#define COMPONENTE_MONITOR 3
+#define COMPONENTE_PUBLICADOR 4
+#define COMPONENTE_COMANDOS 5
+#define COMPONENTE_VIGILANTE 6
+#define COMPONENTE_DIARIO 7
+#define COMPONENTE_ESCENARIO 8
+#define COMPONENTE_ARCHIVO 9
+/** @brief La banda i usa la cuenta COMPONENTE_PRIMERA_BANDA + i */
+#define COMPONENTE_PRIMERA_BANDA 10
+
+/** @brief Cuentas de CPU como máximo: los hilos fijos y uno por banda */
+#define MAX_COMPONENTES (COMPONENTE_PRIMERA_BANDA + MAX_BANDAS)
+
+/** @brief Largo máximo del nombre de un componente */
+#define MAX_NOMBRE_COMPONENTE 20
+
+/** @brief Tiempo mínimo entre dos lecturas de los relojes de un hilo (ms reales) */
+#define INTERVALO_CUENTA_CPU_MS 100
+/** @} */
+
+/**
+ * @brief Microbenchmarks del despacho y de la cola (--microbench)
+ * @{
+ */
+/** @brief Operaciones por repetición de cada microbenchmark */
+#define ITERACIONES_MICROBENCH 50000
+
+/** @brief Repeticiones de cada microbenchmark; se reporta la más rápida */
+#define REPETICIONES_MICROBENCH 5
+
+/** @brief Órdenes de muestra que se reparten entre las operaciones */
+#define MUESTRAS_MICROBENCH 64
+/** @} */
+
+/**
+ * @brief Prueba de estrés con verificación de invariantes (--estres)
+ * @{
+ */
+/** @brief Duración máxima de la prueba (s) */
+#define MAX_DURACION_ESTRES 3600
+
+/** @brief Números de orden que sigue la prueba; al llegar aquí el generador deja de crear órdenes */
+#define CAPACIDAD_DESENLACES_ESTRES (1 << 26)
+
+/** @brief Hilos que mandan comandos por el buzón como lo haría el panel */
+#define INYECTORES_ESTRES 2
+
+/** @brief Solo se cancelan los números múltiplos de este valor; el resto de las órdenes puede entregarse */
+#define CANCELABLES_CADA_ESTRES 8
+
+/** @brief Cada cuánto se verifican los invariantes con el sistema en marcha (ms reales) */
+#define INTERVALO_VERIFICACION_ESTRES_MS 50
+
+/** @brief Cada cuánto se imprime el avance de la prueba (ms reales) */
+#define INTERVALO_AVANCE_ESTRES_MS 5000
+
+/** @brief Tiempo máximo para vaciar la cola y las bandas al terminar la carga (ms reales) */
+#define DRENADO_ESTRES_MS 10000
+/** @} */
+
+/**
+ * @brief Estados de una banda registrados en su línea de tiempo
+ * @{
+ */
+/** @brief Sin orden asignada */
+#define ESTADO_LINEA_OCIOSA 0
+/** @brief Preparando una orden (el tipo de hamburguesa se guarda aparte) */
+#define ESTADO_LINEA_OCUPADA 1
+/** @brief Pausada por el operador o por señal */
+#define ESTADO_LINEA_PAUSADA 2
+/** @brief Ociosa porque el asignador la descartó por falta de ingredientes */
+#define ESTADO_LINEA_SIN_INVENTARIO 3
+/** @brief Parada rellenando dispensadores (--tiempo-reabasto) */
+#define ESTADO_LINEA_REABASTECIENDO 4
+/** @} */
+
+/**
+ * @brief Formato del diario de estado que reproduce el panel (--replay)
+ * @{
+ */
+/** @brief Identificador al inicio de todo archivo de diario */
+#define MAGIA_DIARIO "BURGDIA1"
+
+/** @brief Intervalo entre cuadros del diario (milisegundos) */
+#define INTERVALO_DIARIO_MS 250
+
+/** @brief Cada cuántos cuadros se escribe un cuadro clave con el estado completo */
+#define CUADROS_POR_CLAVE 20
+
+/** @brief Granularidad con que se comparan dos estados para construir un delta (bytes) */
+#define BLOQUE_DIARIO 64
+
+/** @brief Cuadro con una copia completa de DatosCompartidos */
+#define CUADRO_CLAVE 1
+/** @brief Cuadro con los bloques que cambiaron respecto al cuadro anterior */
+#define CUADRO_DELTA 2
+/** @} */
+
+/**
+ * @brief Archivo persistente de métricas a varias resoluciones (--archivo)
+ * @{
+ */
+/** @brief Identificador al inicio de todo archivo de métricas */
+#define MAGIA_ARCHIVO "BURGRRD2"
+
+/** @brief Resoluciones del archivo: segundos, minutos y horas */
+#define NUM_RESOLUCIONES_ARCHIVO 3
+
+/** @brief Filas por segundo: la última hora */
+#define FILAS_ARCHIVO_SEGUNDOS 3600
+
+/** @brief Filas por minuto: dos semanas, para comparar cada minuto con el de la semana anterior */
+#define FILAS_ARCHIVO_MINUTOS 20160
+
+/** @brief Filas por hora: un año */
+#define FILAS_ARCHIVO_HORAS 8760
+
+/** @brief Intervalo entre muestras del archivador (milisegundos reales) */
+#define PERIODO_ARCHIVO_MS 1000
+/** @} */
+
+/**
+ * @brief Exportación de resultados en formato Arrow IPC (--arrow)
+ * @{
+ */
+/** @brief Filas que guarda cada anillo de exportación; al llenarse se descartan las más antiguas */
+#define CAPACIDAD_EXPORTACION 65536
+
+/** @brief Columnas máximas de una tabla exportada */
+#define MAX_COLUMNAS_ARROW 12
+
+/** @brief Bytes para los metadatos flatbuffer de un mensaje (alcanza para MAX_COLUMNAS_ARROW columnas) */
+#define TAM_FLATBUFFER 8192
+
+/** @brief MetadataVersion V5 del formato Arrow */
+#define VERSION_ARROW 4
+
+/** @brief Tipo de mensaje Arrow con el esquema */
+#define MENSAJE_ARROW_ESQUEMA 1
+/** @brief Tipo de mensaje Arrow con un lote de filas */
+#define MENSAJE_ARROW_LOTE 3
+
+#define ARROW_INT32 1
+#define ARROW_INT64 2
+#define ARROW_FLOAT32 3
+#define ARROW_FLOAT64 4
+#define ARROW_UTF8 5
+/** @} */
+
+/**
+ * @brief Escenarios de eventos programados (--escenario)
+ * @{
+ */
+/** @brief Eventos máximos en un archivo de escenario */
+#define MAX_EVENTOS_ESCENARIO 256
+
+/** @brief Aceleración máxima del reloj simulado */
+#define MAX_ACELERACION 1000
+
+/** @brief Argumento de banda que aplica la acción a todas las bandas */
+#define TODAS_LAS_BANDAS -1
+
+#define ACCION_PAUSAR 1
+#define ACCION_REANUDAR 2
+#define ACCION_TASA 3
+#define ACCION_REABASTECER 4
+#define ACCION_FALLAR 5
+#define ACCION_REPARAR 6
+#define ACCION_TERMINAR 7
+#define ACCION_BLOQUEAR 8
+#define ACCION_CANCELAR 9
+#define ACCION_EXPORTAR 10
+/** @} */
+
+/**
+ * @brief Contadores de eventos para las esperas entre hilos y procesos
+ * @{
+ */
+/** @brief Espera sin límite de tiempo */
+#define SIN_LIMITE -1
+/** @brief Despertar a uno de los hilos en espera */
+#define DESPERTAR_UNO 1
+/** @brief Despertar a todos los hilos en espera */
+#define DESPERTAR_TODOS INT_MAX
+/** @} */
+
+/**
+ * @brief Buzón de comandos entre el panel y el sistema principal
+ * @{
+ */
+/** @brief Buzón disponible */
+#define BUZON_LIBRE 0
+/** @brief Un panel está escribiendo un comando */
+#define BUZON_OCUPADO 1
+/** @brief Comando listo para que burger_system lo aplique */
+#define BUZON_PENDIENTE 2
+/** @brief burger_system tomó el comando y lo está aplicando */
+#define BUZON_APLICANDO 3
+/** @brief Comando aplicado; el resultado espera a que el panel lo lea */
+#define BUZON_RESUELTO 4
+
+/** @brief Reabastecimiento masivo de dispensadores */
+#define COMANDO_REABASTECER 1
+/** @brief Aplicar un plan de recargas calculado por el panel */
+#define COMANDO_APLICAR_PLAN 2
+/** @brief Cancelar una orden por su número */
+#define COMANDO_CANCELAR 3
+
+/** @brief Resultado de una cancelación: la orden no existe o ya salió del sistema */
+#define CANCELACION_NO_ENCONTRADA 0
+/** @brief Resultado de una cancelación: se quitó de la cola */
+#define CANCELACION_EN_COLA 1
+/** @brief Resultado de una cancelación: la banda la deja en su próximo paso y devuelve lo no usado */
+#define CANCELACION_EN_BANDA 2
+/** @brief Resultado de una cancelación: el asignador la tenía en mano; se descarta al soltarla */
+#define CANCELACION_EN_ASIGNACION 3
+
+/** @brief Recargas máximas de un plan (una por dispensador) */
+#define MAX_RECARGAS_PLAN (MAX_BANDAS * MAX_INGREDIENTES)
+
+/** @brief Rellenar todos los dispensadores seleccionados */
+#define REABASTECER_TODO 0
+/** @brief Rellenar solo los dispensadores con UMBRAL_INVENTARIO_BAJO o menos */
+#define REABASTECER_CRITICOS 1
+/** @brief Rellenar solo los dispensadores vacíos */
+#define REABASTECER_AGOTADOS 2
 /** @} */
 /** @} */
 
@@ -152,6 +586,24 @@
  * @{
  */
 
+/**
+ * @brief Contador de eventos para esperar cambios en la memoria compartida
+ *
+ * Reemplaza a las variables de condición y sirve entre procesos (el panel
+ * despierta a una banda) porque la secuencia es la palabra de un futex
+ * compartido. Quien espera lee la clave antes de revisar su condición y duerme
+ * solo si la secuencia sigue igual; quien notifica cambia la condición, avanza
+ * la secuencia y hace la llamada al sistema solo si hay alguien esperando.
+ */
+typedef struct
+{
+    /** @brief Avanza con cada notificación; también es la palabra del futex */
+    unsigned int secuencia;
+
+    /** @brief Hilos de cualquier proceso dentro de esperar_eventos */
+    unsigned int esperando;
+} ContadorEventos;
+
 /**
  * @brief Estructura que representa un ingrediente en el inventario de una banda
  *
@@ -166,6 +618,12 @@ typedef struct
     /** @brief Cantidad disponible en el dispensador (0 a CAPACIDAD_DISPENSADOR) */
     int cantidad;
 
+    /** @brief Nivel al que la banda debe rellenarlo en su próximo hueco (0 si no hay relleno programado) */
+    int objetivo_reabasto;
+
+    /** @brief Factor de velocidad de la estación de este ingrediente, sobre el de la banda (1 = normal) */
+    float velocidad;
+
     /** @brief Mutex para acceso exclusivo al inventario del ingrediente */
     pthread_mutex_t mutex;
 } Ingrediente;
@@ -191,6 +649,52 @@ typedef struct
     float precio;
 } TipoHamburguesa;
 
+/**
+ * @brief Paso de una receta en DAG: dónde se hace, cuánto dura y qué necesita antes
+ *
+ * El paso i corresponde al ingrediente i de la receta en menu_hamburguesas.
+ * Los pasos previos siempre tienen un índice menor, así que el orden de la
+ * receta ya es un orden topológico.
+ */
+typedef struct
+{
+    /** @brief Estación de la banda que ocupa (ESTACION_*) */
+    int estacion;
+
+    /** @brief Duración en unidades de tiempo_por_ingrediente */
+    int duracion;
+
+    /** @brief Máscara de bits de los pasos que deben terminar antes de empezar este */
+    int previos;
+} PasoReceta;
+
+/**
+ * @brief Calendario de una receta: en qué orden y en qué momento empieza cada paso
+ *
+ * Las unidades son pasos de tiempo_por_ingrediente. Sin --dag es la receta
+ * paso a paso (un paso por unidad); con --dag lo arma planificar_receta.
+ */
+typedef struct
+{
+    /** @brief Pasos de la receta (índices en menu_hamburguesas) en el orden en que empiezan */
+    int orden[MAX_PASOS_RECETA];
+
+    /** @brief Inicio del k-ésimo paso en empezar */
+    int inicio[MAX_PASOS_RECETA];
+
+    /** @brief Fin del k-ésimo paso en empezar */
+    int fin[MAX_PASOS_RECETA];
+
+    /** @brief Fin del último paso: duración de la receta sin el tiempo final */
+    int duracion_total;
+
+    /** @brief Camino más largo del DAG, cota inferior de duracion_total */
+    int ruta_critica;
+
+    /** @brief Suma de las duraciones de los pasos: la receta hecha de a un paso */
+    int suma_secuencial;
+} PlanReceta;
+
 /**
  * @brief Estructura para registrar eventos y actividades de cada banda
  *
@@ -247,8 +751,60 @@ typedef struct
 
     /** @brief Contador de intentos de asignación a bandas */
     int intentos_asignacion;
+
+    /** @brief Marca de creación en milisegundos de reloj monotónico (para latencias) */
+    long long creacion_ms;
+
+    /** @brief Hora estimada de entrega en ms de reloj monotónico, actualizada con el estado (0 si no hay banda que pueda prepararla) */
+    long long eta_ms;
+
+    /** @brief Primera estimación de entrega, hecha al encolar la orden (para medir el error) */
+    long long eta_prometida_ms;
+
+    /** @brief Veces que la política por valor asignó antes otra orden que estaba detrás de esta */
+    int veces_adelantada;
+
+    /** @brief Cliente de la población cerrada que la pidió (SIN_CLIENTE con llegadas abiertas) */
+    int cliente;
+
+    /** @brief Tiempo que el cliente está dispuesto a esperar sin que una banda la tome (ms simulados) */
+    long long paciencia_ms;
+
+    /** @brief Órdenes en la cola cuando llegó (para la curva de abandonos contra carga) */
+    int cola_al_llegar;
+
+    /** @brief Temporizador de paciencia que la vigila mientras está en la cola (-1 si ninguno) */
+    int temporizador;
+
+    /**
+     * @brief Estado de cancelación (o expiración)
+     *
+     * En la cola, 1 marca una lápida: el lugar sigue ocupado hasta que el
+     * asignador lo salta. En una banda, 1 es una cancelación pendiente que la
+     * banda atiende en su próximo paso devolviendo los ingredientes no usados,
+     * y 2 indica que ya la atendió.
+     */
+    int cancelada;
 } Orden;
 
+/**
+ * @brief Cambio de estado de una banda para la línea de tiempo del panel
+ *
+ * Cada banda guarda sus últimas transiciones en un anillo de tamaño fijo.
+ * El estado vigente es el de la última transición hasta que llegue otra.
+ */
+typedef struct
+{
+    /** @brief Momento del cambio en milisegundos de reloj monotónico */
+    long long marca_ms;
+
+    /** @brief Nuevo estado (ESTADO_LINEA_*) */
+    int estado;
+
+    /** @brief Tipo de hamburguesa en preparación (-1 si no aplica) */
+    int tipo_hamburguesa;
+} TransicionBanda;
+
 /**
  * @brief Estructura que representa una banda de preparación de hamburguesas
  *
@@ -291,8 +847,8 @@ typedef struct
     /** @brief Mutex para acceso exclusivo a los datos de la banda */
     pthread_mutex_t mutex;
 
-    /** @brief Variable de condición para sincronización de pausa/reanudación */
-    pthread_cond_t condicion;
+    /** @brief Se notifica al pausar, reanudar, averiar, reparar o asignarle una orden */
+    ContadorEventos eventos;
 
     /** @brief Descripción del estado actual de la banda */
     char estado_actual[100];
@@ -305,6 +861,88 @@ typedef struct
 
     /** @brief Timestamp de la última alerta de inventario para evitar spam */
     time_t ultima_alerta_inventario;
+
+    /** @brief Último momento (ms) en que el asignador la descartó por falta de ingredientes */
+    long long ultimo_rechazo_inventario_ms;
+
+    /**
+     * @brief Anillo de transiciones de estado (línea de tiempo)
+     *
+     * Solo el hilo de la banda escribe en él: guarda la entrada y después
+     * publica total_transiciones con semántica release, de modo que el panel
+     * puede leerlo sin tomar el mutex de la banda.
+     */
+    TransicionBanda transiciones[MAX_TRANSICIONES_BANDA];
+
+    /** @brief Número total de transiciones registradas (la posición es total % MAX) */
+    unsigned int total_transiciones;
+
+    /** @brief Unidades consumidas de cada dispensador desde el inicio (para tiempo hasta agotarse) */
+    int consumido[MAX_INGREDIENTES];
+
+    /**
+     * @brief Versión del inventario de la banda
+     *
+     * Funciona como seqlock: un escritor la deja impar antes de tocar
+     * cantidades o consumos y par al terminar. Los lectores copian todas las
+     * cantidades de la banda de una vez y repiten la copia si la versión era
+     * impar o cambió mientras copiaban, en lugar de bloquear cada dispensador.
+     */
+    unsigned int version_inventario;
+
+    /** @brief Último latido de progreso en ms de reloj monotónico (se publica en cada paso) */
+    long long latido_ms;
+
+    /** @brief Duración esperada del paso en curso en ms reales (0 si no hay nada que vigilar) */
+    long long paso_esperado_ms;
+
+    /**
+     * @brief Generación de la orden en curso
+     *
+     * Quien se queda con la orden (la banda al completarla o el vigilante al
+     * rescatarla) la incrementa con un CAS desde generacion_asignada; el otro
+     * ve que cambió y la abandona, así la orden nunca se cuenta dos veces.
+     */
+    unsigned int generacion_orden;
+
+    /** @brief Valor de generacion_orden cuando el asignador entregó la orden en curso */
+    unsigned int generacion_asignada;
+
+    /** @brief Flag que indica que el vigilante la declaró atascada y le quitó la orden */
+    int atascada;
+
+    /** @brief Órdenes rescatadas de esta banda por el vigilante */
+    int ordenes_rescatadas;
+
+    /** @brief Ingresos (precio de menú) de las hamburguesas completadas por esta banda */
+    float ingresos;
+
+    /** @brief Órdenes del lote en curso contando orden_actual (1 si se prepara sola) */
+    int tamano_lote;
+
+    /** @brief Resto del lote en curso: órdenes del mismo tipo que orden_actual */
+    Orden lote[MAX_LOTE - 1];
+
+    /** @brief Lotes de más de una orden completados por esta banda */
+    int lotes_completados;
+
+    /** @brief Flag que indica que está rellenando dispensadores; el asignador la salta */
+    int reabasteciendo;
+
+    /** @brief Tiempo simulado total parada rellenando dispensadores (ms) */
+    long long reabasto_ms;
+
+    /** @brief Parte de reabasto_ms con órdenes esperando: capacidad perdida (ms simulados) */
+    long long reabasto_perdido_ms;
+
+    /** @brief Dispensadores rellenados por la propia banda */
+    int dispensadores_reabastecidos;
+
+    /** @brief De ellos, los urgentes que pasaron antes que las órdenes en espera */
+    int reabastos_urgentes;
+
+    /** @brief Factor de velocidad de la banda: sus pasos duran tiempo_por_ingrediente / velocidad */
+    float velocidad;
 } Banda;
 
 /**
@@ -328,1633 +966,8148 @@ typedef struct
     /** @brief Número actual de órdenes en la cola */
     int tamano;
 
+    /** @brief Lugares de tamano ocupados por órdenes canceladas o expiradas que aún no se saltaron */
+    int lapidas;
+
     /** @brief Mutex para acceso exclusivo a la cola */
     pthread_mutex_t mutex;
 
-    /** @brief Variable de condición para despertar hilos cuando la cola no está vacía */
-    pthread_cond_t no_vacia;
+    /** @brief Se notifica al entrar una orden a la cola */
+    ContadorEventos no_vacia;
 
-    /** @brief Variable de condición para despertar hilos cuando la cola no está llena */
-    pthread_cond_t no_llena;
+    /** @brief Se notifica al salir una orden de la cola */
+    ContadorEventos no_llena;
 } ColaFIFO;
 
 /**
- * @brief Estructura principal que contiene todos los datos compartidos del sistema
+ * @brief Instantánea de métricas publicada sin bloqueos para lectores externos
  *
- * Esta estructura se almacena en memoria compartida POSIX para permitir la
- * comunicación entre el sistema principal y el panel de control. Contiene
- * el estado global del sistema, todas las bandas, la cola de órdenes y
- * parámetros de configuración.
+ * El hilo publicador es el único escritor. Usa un seqlock: incrementa la
+ * secuencia (queda impar) antes de escribir y la vuelve a incrementar al
+ * terminar. Los lectores (panel de control) copian la estructura y reintentan
+ * si la secuencia era impar o cambió durante la copia, sin tomar ningún mutex
+ * del sistema y por lo tanto sin competir con las bandas.
  */
 typedef struct
 {
-    /** @brief Array de todas las bandas de preparación del sistema */
-    Banda bandas[MAX_BANDAS];
+    /** @brief Contador del seqlock (impar mientras se escribe) */
+    unsigned int secuencia;
 
-    /** @brief Cola FIFO que gestiona las órdenes pendientes de asignación */
-    ColaFIFO cola_espera;
+    /** @brief Momento de publicación en milisegundos de reloj monotónico */
+    long long marca_ms;
 
-    /** @brief Número actual de bandas activas en el sistema */
-    int num_bandas;
+    /** @brief Copia de total_ordenes_generadas al momento de publicar */
+    int ordenes_generadas;
 
-    /** @brief Flag que indica si el sistema está operativo (1) o en proceso de cierre (0) */
-    int sistema_activo;
+    /** @brief Copia de total_ordenes_procesadas al momento de publicar */
+    int ordenes_procesadas;
 
-    /** @brief Contador total de órdenes procesadas exitosamente por todas las bandas */
-    int total_ordenes_procesadas;
+    /** @brief Órdenes esperando en la cola FIFO */
+    int ordenes_en_cola;
 
-    /** @brief Contador total de órdenes generadas por el sistema */
-    int total_ordenes_generadas;
+    /** @brief Bandas operativas y no pausadas */
+    int bandas_operativas;
 
-    /** @brief Mutex global para operaciones que afectan a todo el sistema */
-    pthread_mutex_t mutex_global;
+    /** @brief Dispensadores vacíos sumando todas las bandas */
+    int dispensadores_agotados;
 
-    /** @brief Variable de condición para notificar cuando hay nuevas órdenes disponibles */
-    pthread_cond_t nueva_orden;
+    /** @brief Bandas marcadas con necesita_reabastecimiento */
+    int bandas_sin_inventario;
 
-    /** @brief Tiempo configurado para procesar cada ingrediente (segundos) */
-    int tiempo_por_ingrediente;
+    /** @brief Hamburguesas completadas por minuto en la última ventana */
+    float throughput_por_minuto;
 
-    /** @brief Tiempo configurado entre la generación de nuevas órdenes (segundos) */
-    int tiempo_nueva_orden;
-} DatosCompartidos;
+    /** @brief Latencia (creación a entrega) mediana en milisegundos */
+    int latencia_p50_ms;
 
-/**
- * @defgroup variables_globales Variables Globales del Sistema
- * @{
- */
+    /** @brief Latencia (creación a entrega) percentil 99 en milisegundos */
+    int latencia_p99_ms;
 
-/** @brief Puntero a la estructura de datos compartidos en memoria compartida */
-DatosCompartidos *datos_compartidos;
+    /** @brief Órdenes que llegan por minuto (ventana deslizante) */
+    float llegadas_por_minuto;
 
-/** @brief Hilo que genera órdenes de hamburguesas automáticamente */
-pthread_t hilo_generador_ordenes;
+    /** @brief Bandas que el vigilante tiene marcadas como atascadas */
+    int bandas_atascadas;
 
-/** @brief Hilo que asigna órdenes a las bandas disponibles */
-pthread_t hilo_asignador_ordenes;
+    /** @brief Órdenes reencoladas por el vigilante desde el arranque */
+    int ordenes_rescatadas;
 
-/** @brief Hilo que monitorea el inventario de todas las bandas */
-pthread_t hilo_monitor_inventario;
+    /** @brief Error absoluto medio de la hora prometida frente a la entrega real (ms simulados) */
+    int error_eta_medio_ms;
 
-/** @} */
+    /** @brief Error medio con signo de la hora prometida (positivo: se entregó tarde) en ms simulados */
+    int sesgo_eta_ms;
 
-/**
- * @brief Menú completo de hamburguesas disponibles en el sistema
- *
- * Define todos los tipos de hamburguesas que se pueden preparar, incluyendo
- * sus ingredientes específicos, cantidad de ingredientes y precios de venta.
- * Cada hamburguesa tiene una receta única que determina el orden de
- * preparación de los ingredientes.
- */
-TipoHamburguesa menu_hamburguesas[NUM_TIPOS_HAMBURGUESA] = {
-    /** @brief Hamburguesa Clásica: Pan, carne, lechuga, tomate */
-    {"Clasica", {"pan_inferior", "carne", "lechuga", "tomate", "pan_superior"}, 5, 8.50},
+    /** @brief Ingresos por minuto simulado en la última ventana */
+    float ingresos_por_minuto;
 
-    /** @brief Cheeseburger: Clásica + queso */
-    {"Cheeseburger", {"pan_inferior", "carne", "queso", "lechuga", "tomate", "pan_superior"}, 6, 9.25},
+    /** @brief Ingresos acumulados de las órdenes completadas */
+    float ingresos_totales;
 
-    /** @brief BBQ Bacon: Con bacon, queso, cebolla y salsa BBQ */
-    {"BBQ Bacon", {"pan_inferior", "carne", "bacon", "queso", "cebolla", "salsa_bbq", "pan_superior"}, 7, 11.75},
+    /** @brief Ingresos perdidos por órdenes expiradas o rechazadas por cola llena */
+    float ingresos_perdidos;
 
-    /** @brief Vegetariana: Sin carne, con vegetal y aguacate */
-    {"Vegetariana", {"pan_inferior", "vegetal", "lechuga", "tomate", "aguacate", "mayonesa", "pan_superior"}, 7, 10.25},
+    /** @brief Ingresos por hora simulada de cada banda configurada */
+    float ingresos_por_banda_hora;
 
-    /** @brief Deluxe: Hamburguesa premium con todos los ingredientes */
-    {"Deluxe", {"pan_inferior", "carne", "queso", "bacon", "lechuga", "tomate", "cebolla", "mayonesa", "pan_superior"}, 9, 13.50},
+    /** @brief Órdenes completadas por lote preparado, en promedio desde el arranque */
+    float tamano_lote_medio;
 
-    /** @brief Spicy Mexican: Con jalapeños y salsa picante */
-    {"Spicy Mexican", {"pan_inferior", "carne", "queso", "jalapenos", "tomate", "cebolla", "salsa_picante", "pan_superior"}, 8, 12.00}};
+    /** @brief Calentamiento descartado por MSER-5 (s simulados; -1 si aún no hay estado estacionario) */
+    int calentamiento_s;
 
-/**
- * @brief Lista completa de ingredientes base disponibles en el sistema
- *
- * Define todos los ingredientes que pueden estar presentes en cualquier
- * hamburguesa. Cada banda tiene dispensadores para todos estos ingredientes,
- * permitiendo preparar cualquier tipo de hamburguesa del menú.
- */
-char ingredientes_base[MAX_INGREDIENTES][MAX_NOMBRE_INGREDIENTE] = {
-    "pan_inferior", "pan_superior", "carne", "queso", "tomate",
-    "lechuga", "cebolla", "bacon", "mayonesa", "jalapenos",
-    "aguacate", "vegetal", "salsa_bbq", "salsa_picante", "pepinillos"};
+    /** @brief Órdenes por minuto del estado estacionario */
+    float throughput_estacionario;
 
-/**
- * @defgroup funciones_formato Funciones Auxiliares para Formato de Pantalla
- * @{
- *
- * Este grupo de funciones proporciona utilidades para formatear y mostrar
- * información en la consola de manera estructurada y legible. Incluye
- * funciones para centrar texto, crear tablas y manejar buffers de formato.
- */
+    /** @brief Semiancho del intervalo de confianza del 95 % del throughput estacionario */
+    float ic_throughput_estacionario;
 
-/** @brief Buffers circulares para formateo de texto (evita desbordamientos) */
-static char format_buffers[8][50];
+    /** @brief Latencia media del estado estacionario (ms simulados) */
+    float latencia_estacionaria_ms;
 
-/** @brief Índice del buffer actual en uso (implementa rotación circular) */
-static int current_buffer = 0;
+    /** @brief Semiancho del intervalo de confianza del 95 % de la latencia estacionaria */
+    float ic_latencia_estacionaria_ms;
+} InstantaneaMetricas;
 
 /**
- * @brief Formatea un texto para que tenga un ancho fijo específico
- *
- * Esta función toma un texto de entrada y lo ajusta al ancho especificado.
- * Si el texto es más largo que el ancho, se trunca y se añaden puntos suspensivos.
- * Si es más corto, se rellena con espacios en blanco.
- *
- * @param texto Puntero al texto de entrada (puede ser NULL)
- * @param ancho Ancho deseado para el texto formateado
- * @return Puntero al buffer formateado (no liberar, es buffer interno)
- *
- * @note Utiliza un sistema de buffers circulares para evitar desbordamientos
- * @note Si ancho < 3, se rellena completamente con puntos
+ * @brief Recarga de un dispensador dentro de un plan de reabastecimiento
  */
-char *formatear_texto_fijo(const char *texto, int ancho)
+typedef struct
 {
-    // Rotar al siguiente buffer disponible
-    current_buffer = (current_buffer + 1) % 8;
-    char *buffer = format_buffers[current_buffer];
+    /** @brief Banda del dispensador */
+    int banda;
 
-    // Inicializar buffer con espacios en blanco
-    memset(buffer, ' ', ancho);
-    buffer[ancho] = '\0';
-
-    // Manejar casos especiales
-    if (texto == NULL || strlen(texto) == 0)
-    {
-        return buffer;
-    }
+    /** @brief Índice del ingrediente en ingredientes_base */
+    int ingrediente;
 
-    int len = strlen(texto);
-    if (len <= ancho)
-    {
-        // Texto cabe completamente
-        memcpy(buffer, texto, len);
-    }
-    else
-    {
-        // Texto es muy largo, truncar con "..."
-        if (ancho >= 3)
-        {
-            memcpy(buffer, texto, ancho - 3);
-            memcpy(buffer + ancho - 3, "...", 3);
-        }
-        else
-        {
-            // Ancho muy pequeño, rellenar con puntos
-            memset(buffer, '.', ancho);
-        }
-    }
-    return buffer;
-}
+    /** @brief Unidades a añadir */
+    int unidades;
+} RecargaPlan;
 
 /**
- * @brief Centra un texto dentro de un ancho específico
- *
- * Esta función toma un texto y lo centra horizontalmente dentro del ancho
- * especificado, rellenando con espacios en blanco a ambos lados.
- * Si el texto es más largo que el ancho, se delega a formatear_texto_fijo().
- *
- * @param texto Puntero al texto a centrar (puede ser NULL)
- * @param ancho Ancho total disponible para centrar el texto
- * @return Puntero al buffer con el texto centrado (no liberar, es buffer interno)
+ * @brief Buzón de comandos que el panel envía al sistema principal
  *
- * @note Utiliza el mismo sistema de buffers circulares que formatear_texto_fijo()
- * @note Si el texto es NULL, retorna un buffer lleno de espacios
+ * Un solo comando en vuelo. El panel reserva el buzón con un CAS
+ * LIBRE -> OCUPADO, escribe el comando, lo publica como PENDIENTE y despierta
+ * al procesador con un futex. burger_system lo toma con un CAS
+ * PENDIENTE -> APLICANDO, escribe el resultado y lo marca RESUELTO. El panel
+ * lee el resultado y libera el buzón. Si el sistema no responde, el panel
+ * retira el comando con un CAS PENDIENTE -> LIBRE; solo uno de los dos CAS
+ * puede ganar, así que un comando nunca se aplica después de retirarse.
  */
-char *centrar_texto(const char *texto, int ancho)
+typedef struct
 {
-    // Rotar al siguiente buffer disponible
-    current_buffer = (current_buffer + 1) % 8;
-    char *buffer = format_buffers[current_buffer];
+    /** @brief Estado del buzón (BUZON_*); también es la palabra del futex */
+    unsigned int estado;
 
-    // Inicializar buffer con espacios en blanco
-    memset(buffer, ' ', ancho);
-    buffer[ancho] = '\0';
+    /** @brief Número de comando, para asociar el resultado con su envío */
+    unsigned int secuencia;
 
-    // Manejar texto NULL
-    if (texto == NULL)
-        return buffer;
+    /** @brief PID del panel que reservó el buzón (para recuperarlo si muere) */
+    pid_t pid_emisor;
 
-    int len = strlen(texto);
-    if (len >= ancho)
-    {
-        // Texto es muy largo, usar formateo fijo
-        return formatear_texto_fijo(texto, ancho);
-    }
+    /** @brief Reloj monotónico al reservar el buzón (ms) */
+    long long reservado_ms;
 
-    // Calcular posición de inicio para centrar
-    int inicio = (ancho - len) / 2;
-    memcpy(buffer + inicio, texto, len);
-    return buffer;
-}
+    /** @brief Comando solicitado (COMANDO_*) */
+    int comando;
+
+    /** @brief Criterio de reabastecimiento (REABASTECER_*) */
+    int modo;
+
+    /** @brief Banda destino o TODAS_LAS_BANDAS */
+    int banda;
+
+    /** @brief Ingrediente destino o -1 para todos */
+    int ingrediente;
+
+    /** @brief Resultado: dispensadores rellenados */
+    int dispensadores;
+
+    /** @brief Resultado: unidades añadidas en total */
+    int unidades;
+
+    /** @brief Resultado: bandas con algún dispensador rellenado */
+    int bandas;
+
+    /** @brief Resultado: 1 si los rellenos quedaron programados para las bandas (--tiempo-reabasto) */
+    int programado;
+
+    /** @brief Resultado: tiempo que tomó aplicar el comando (ns) */
+    long long duracion_ns;
+
+    /** @brief Recargas del plan (solo COMANDO_APLICAR_PLAN) */
+    int num_recargas;
+
+    /** @brief Plan de recargas (solo COMANDO_APLICAR_PLAN) */
+    RecargaPlan recargas[MAX_RECARGAS_PLAN];
+
+    /** @brief Orden a cancelar (solo COMANDO_CANCELAR) */
+    int id_orden;
+
+    /** @brief Resultado de la cancelación (CANCELACION_*) */
+    int resultado_cancelacion;
+} BuzonComandos;
 
 /**
- * @brief Imprime una línea de separación para tablas con formato personalizable
- *
- * Esta función crea líneas de separación para tablas, permitiendo especificar
- * los caracteres de borde izquierdo, centro, derecho y el relleno interno.
- * Es útil para crear tablas con diferentes estilos de bordes.
- *
- * @param num_columnas Número de columnas en la tabla
- * @param ancho_columna Ancho de cada columna (incluyendo bordes)
- * @param izq Carácter o cadena para el borde izquierdo de la tabla
- * @param centro Carácter o cadena para separar columnas internas
- * @param der Carácter o cadena para el borde derecho de la tabla
- * @param relleno Carácter o cadena para rellenar el espacio interno de las columnas
+ * @brief Recurso de cocina con lugares contados compartido entre bandas
  *
- * @note Ejemplo de uso: imprimir_linea_separacion(3, 20, "╔", "╦", "╗", "═")
- * @note Produce: ╔══════════════════╦══════════════════╦══════════════════╗
+ * Una banda toma un lugar al empezar un paso que lo necesita y lo suelta al
+ * terminarlo. Si no hay lugar espera en orden de llegada (turnos). Ninguna
+ * receta pide la parrilla después de una tolva (la carne empieza antes que las
+ * salsas), así que no hay esperas circulares.
  */
-void imprimir_linea_separacion(int num_columnas, int ancho_columna, const char *izq, const char *centro, const char *der, const char *relleno)
+typedef struct
 {
-    for (int col = 0; col < num_columnas; col++)
-    {
-        if (col == 0)
-        {
-            // Primera columna: borde izquierdo
-            printf("%s", izq);
-        }
+    /** @brief Nombre para las estadísticas y el panel */
+    char nombre[MAX_NOMBRE_RECURSO];
 
-        // Rellenar el contenido de la columna
-        for (int i = 0; i < ancho_columna - 2; i++)
-        {
-            printf("%s", relleno);
-        }
+    /** @brief Lugares del recurso */
+    int capacidad;
 
-        if (col == num_columnas - 1)
-        {
-            // Última columna: borde derecho
-            printf("%s", der);
-        }
-        else
-        {
-            // Columnas intermedias: separador
-            printf("%s", centro);
-        }
-    }
-    printf("\n");
-}
+    /** @brief Primera y última banda que lo usan (índices desde 0) */
+    int banda_desde;
+    int banda_hasta;
+
+    /** @brief Lugares ocupados ahora */
+    int en_uso;
+
+    /** @brief Bandas esperando un lugar ahora */
+    int esperando;
+
+    /** @brief Próximo turno a entregar a una banda que llega */
+    unsigned int siguiente_turno;
+
+    /** @brief Turno al que le toca tomar el próximo lugar libre */
+    unsigned int turno_actual;
+
+    /** @brief Lugares tomados en total */
+    int usos;
+
+    /** @brief Usos que tuvieron que esperar */
+    int esperas;
+
+    /** @brief Máximo de bandas esperando a la vez */
+    int max_esperando;
+
+    /** @brief Espera acumulada en ms simulados */
+    long long espera_total_ms;
+
+    /** @brief Integral de lugares ocupados en el tiempo (lugar-ms simulados) */
+    long long ocupado_ms;
+
+    /** @brief Reloj monotónico del último cambio de en_uso (ms) */
+    long long ultimo_cambio_ms;
+
+    /** @brief Fracción de la capacidad usada desde el arranque (la actualiza el publicador) */
+    float utilizacion;
+
+    /** @brief Mutex del recurso */
+    pthread_mutex_t mutex;
+
+    /** @brief Se notifica al soltar o tomar un lugar */
+    ContadorEventos liberado;
+} RecursoCompartido;
 
 /**
- * @brief Imprime una fila de contenido de tabla con formato uniforme
- *
- * Esta función toma un array de contenidos y los imprime en formato de tabla,
- * aplicando formateo consistente a cada columna y separando las columnas
- * con espacios para mejor legibilidad.
- *
- * @param contenidos Array bidimensional con el contenido de cada columna
- * @param num_columnas Número de columnas a imprimir
- * @param ancho_columna Ancho total de cada columna (incluyendo bordes)
+ * @brief Consumo de CPU de un hilo interno
  *
- * @note Cada contenido se formatea automáticamente al ancho de la columna
- * @note Las columnas se separan con dos espacios para mejor legibilidad
- * @note Utiliza caracteres Unicode para bordes de tabla (║)
+ * Cada hilo escribe solo su propia cuenta con sus relojes de hilo
+ * (CLOCK_THREAD_CPUTIME_ID y getrusage(RUSAGE_THREAD)); el publicador de
+ * métricas calcula las tasas del último segundo.
  */
-void imprimir_fila_contenido(char contenidos[][50], int num_columnas, int ancho_columna)
+typedef struct
 {
-    for (int col = 0; col < num_columnas; col++)
-    {
-        // Imprimir contenido de la columna con bordes y formateo
-        printf("║%s║", formatear_texto_fijo(contenidos[col], ancho_columna - 2));
+    /** @brief Nombre del componente ("asignador", "banda 2", ...); vacío si el hilo no existe */
+    char nombre[MAX_NOMBRE_COMPONENTE];
 
-        // Separar columnas con espacios (excepto la última)
-        if (col < num_columnas - 1)
-        {
-            printf("  ");
-        }
-    }
-    printf("\n");
-}
+    /** @brief 1 mientras el hilo está en ejecución */
+    int activo;
 
-/**
- * @defgroup prototipos Prototipos de Funciones del Sistema
- * @{
- *
- * Declaraciones de todas las funciones principales del sistema, organizadas
- * por categorías funcionales para facilitar la comprensión del código.
- */
+    /** @brief CPU consumida por el hilo desde que arrancó (ns) */
+    long long cpu_ns;
 
-// ============================================================================
-// FUNCIONES DE INICIALIZACIÓN Y CONFIGURACIÓN
-// ============================================================================
+    /** @brief Vueltas del bucle del hilo (cada una sigue a una espera) */
+    long long despertares;
 
-/**
- * @brief Inicializa el sistema completo con la configuración especificada
- * @param num_bandas Número de bandas de preparación a crear
- * @param tiempo_ingrediente Tiempo en segundos para procesar cada ingrediente
- * @param tiempo_orden Tiempo en segundos entre generación de nuevas órdenes
- */
-void inicializar_sistema(int num_bandas, int tiempo_ingrediente, int tiempo_orden);
+    /** @brief Cambios de contexto voluntarios (el hilo se bloqueó) */
+    long long cambios_voluntarios;
 
-/**
- * @brief Muestra el menú completo de hamburguesas disponibles
- * @note Se ejecuta automáticamente al inicializar el sistema
- */
-void mostrar_menu_hamburguesas();
+    /** @brief Cambios de contexto involuntarios (el planificador lo desalojó) */
+    long long cambios_involuntarios;
 
-// ============================================================================
-// FUNCIONES DE HILOS DE TRABAJO (WORKER THREADS)
-// ============================================================================
+    /** @brief Reloj monotónico de la última lectura de los relojes del hilo (ms) */
+    long long ultima_lectura_ms;
 
-/**
- * @brief Función principal del hilo de cada banda de preparación
- * @param arg Puntero al ID de la banda (int*)
- * @return NULL al terminar
- */
-void *banda_worker(void *arg);
+    /** @brief Fracción de un núcleo usada en el último segundo */
+    float uso_cpu;
 
-/**
- * @brief Hilo que genera órdenes de hamburguesas automáticamente
- * @param arg Parámetro no utilizado (NULL)
- * @return NULL al terminar
- */
-void *generador_ordenes(void *arg);
+    /** @brief Despertares por segundo en el último segundo */
+    float despertares_por_segundo;
+
+    /** @brief cpu_ns y despertares cuando se calcularon las tasas anteriores */
+    long long cpu_anterior_ns;
+    long long despertares_anteriores;
+} CuentaCpu;
 
 /**
- * @brief Hilo que asigna órdenes a las bandas disponibles
- * @param arg Parámetro no utilizado (NULL)
- * @return NULL al terminar
- */
-void *asignador_ordenes(void *arg);
+ * @brief Estructura principal que contiene todos los datos compartidos del sistema
+ *
+ * Esta estructura se almacena en memoria compartida POSIX para permitir la
+ * comunicación entre el sistema principal y el panel de control. Contiene
+ * el estado global del sistema, todas las bandas, la cola de órdenes y
+ * parámetros de configuración.
+ */
+typedef struct
+{
+    /** @brief Array de todas las bandas de preparación del sistema */
+    Banda bandas[MAX_BANDAS];
+
+    /** @brief Cola FIFO que gestiona las órdenes pendientes de asignación */
+    ColaFIFO cola_espera;
+
+    /** @brief Número actual de bandas activas en el sistema */
+    int num_bandas;
+
+    /** @brief Flag que indica si el sistema está operativo (1) o en proceso de cierre (0) */
+    int sistema_activo;
+
+    /** @brief Contador total de órdenes procesadas exitosamente por todas las bandas */
+    int total_ordenes_procesadas;
+
+    /** @brief Contador total de órdenes generadas por el sistema */
+    int total_ordenes_generadas;
+
+    /** @brief Mutex global para operaciones que afectan a todo el sistema */
+    pthread_mutex_t mutex_global;
+
+    /** @brief Se notifica cuando hay nuevas órdenes disponibles */
+    ContadorEventos nueva_orden;
+
+    /** @brief Tiempo configurado para procesar cada ingrediente (segundos) */
+    int tiempo_por_ingrediente;
+
+    /** @brief Tiempo configurado entre la generación de nuevas órdenes (segundos) */
+    int tiempo_nueva_orden;
+
+    /** @brief Nombre de esta instancia (cocina) para paneles que supervisan varias */
+    char nombre_instancia[MAX_NOMBRE_INSTANCIA];
+
+    /** @brief PID del proceso burger_system dueño del segmento */
+    pid_t pid;
+
+    /** @brief Métricas agregadas legibles sin bloqueos (ver InstantaneaMetricas) */
+    InstantaneaMetricas instantanea;
+
+    /** @brief Buzón de comandos del panel (ver BuzonComandos) */
+    BuzonComandos buzon;
+
+    /** @brief Ingresos acumulados de las órdenes completadas (protegido por mutex_global) */
+    double ingresos_totales;
+
+    /** @brief Ingresos de las órdenes expiradas o rechazadas (protegido por mutex_global) */
+    double ingresos_perdidos;
+
+    /** @brief Órdenes expiradas por superar la edad máxima sin prepararse (protegido por mutex_global) */
+    int ordenes_descartadas;
+
+    /** @brief Órdenes nuevas rechazadas por cola llena (protegido por mutex_global) */
+    int ordenes_rechazadas;
+
+    /** @brief Política de asignación en uso (POLITICA_*) */
+    int politica_asignacion;
+
+    /** @brief Órdenes que una banda puede tomar juntas (--lote, 1 = sin lotes) */
+    int tamano_lote_maximo;
+
+    /** @brief Exponente del modelo de costo de lote (--costo-lote) */
+    float exponente_lote;
+
+    /** @brief Lotes completados, contando como lote de 1 cada orden suelta (protegido por mutex_global) */
+    int lotes_procesados;
+
+    /** @brief Órdenes canceladas desde el panel o un escenario (protegido por mutex_global) */
+    int ordenes_canceladas;
+
+    /** @brief Edad máxima de una orden sin preparar en ms simulados (--edad-maxima) */
+    int edad_maxima_ms;
+
+    /** @brief Recursos compartidos entre bandas (parrilla y tolvas) */
+    RecursoCompartido recursos[MAX_RECURSOS];
+
+    /** @brief Recursos configurados (0 si cada banda tiene todo propio) */
+    int num_recursos;
+
+    /** @brief CPU de cada hilo interno (COMPONENTE_*) */
+    CuentaCpu cuentas_cpu[MAX_COMPONENTES];
+
+    /** @brief Cuentas en uso: los hilos fijos más una por banda */
+    int num_componentes;
+
+    /** @brief CPU de todo el proceso desde el arranque (ns), incluidos hilos sin cuenta */
+    long long cpu_proceso_ns;
+
+    /** @brief Fracción de un núcleo usada por todo el proceso en el último segundo */
+    float uso_cpu_proceso;
+
+    /** @brief Archivo de métricas que escribe la cocina (--archivo), o "" si no archiva */
+    char ruta_archivo_metricas[256];
+
+    /** @brief Clientes de la población cerrada (--clientes); 0 con llegadas abiertas */
+    int num_clientes;
+
+    /** @brief Clientes con una orden en curso; el resto está pensando */
+    int clientes_esperando;
+
+    /** @brief Distribución de la paciencia de los clientes (PACIENCIA_*) */
+    int distribucion_paciencia;
+} DatosCompartidos;
 
 /**
- * @brief Hilo que monitorea el inventario de todas las bandas
- * @param arg Parámetro no utilizado (NULL)
- * @return NULL al terminar
+ * @brief Evento programado de un escenario
+ *
+ * Cada línea del archivo de escenario tiene la forma
+ * "<segundo> <acción> [argumento]", con el segundo medido en tiempo simulado
+ * desde el arranque del sistema.
  */
-void *monitor_inventario(void *arg);
+typedef struct
+{
+    /** @brief Instante simulado en que se ejecuta (ms desde el arranque) */
+    long long instante_ms;
 
-// ============================================================================
-// FUNCIONES DE PROCESAMIENTO DE ÓRDENES
-// ============================================================================
+    /** @brief Acción a ejecutar (ACCION_*) */
+    int accion;
+
+    /** @brief Banda afectada (0-based) o TODAS_LAS_BANDAS */
+    int banda;
+
+    /** @brief Órdenes por segundo para ACCION_TASA */
+    double tasa;
+
+    /** @brief Línea del archivo donde se definió (para los mensajes) */
+    int linea;
+
+    /** @brief Orden a cancelar (acción cancelar) */
+    int id_orden;
+} EventoEscenario;
 
 /**
- * @brief Procesa una orden completa en la banda especificada
- * @param banda_id ID de la banda que procesará la orden
- * @param orden Puntero a la orden a procesar
+ * @brief Entrada del índice de órdenes vivas
+ *
+ * Tabla hash de direccionamiento abierto (sondeo lineal, borrado con
+ * desplazamiento hacia atrás) en memoria del proceso, protegida por el mutex
+ * de la cola. Una orden está en el índice desde que entra a la cola hasta
+ * que sale del sistema, así una cancelación la encuentra sin recorrer la
+ * cola ni las bandas.
  */
-void procesar_orden(int banda_id, Orden *orden);
+typedef struct
+{
+    /** @brief Número de la orden (0 = entrada libre) */
+    int id_orden;
+
+    /** @brief Banda que la prepara, o -1 si está en la cola o en manos del asignador */
+    int banda;
+
+    /** @brief Lugar en el arreglo de la cola cuando banda es -1 */
+    int posicion;
+
+    /** @brief Cancelación pedida mientras el asignador la tenía fuera de la cola */
+    int cancelar;
+} EntradaIndice;
 
 /**
- * @brief Verifica si una banda tiene suficientes ingredientes para una orden
- * @param banda_id ID de la banda a verificar
- * @param orden Puntero a la orden a verificar
- * @return 1 si hay suficientes ingredientes, 0 en caso contrario
+ * @brief Temporizador de paciencia de una orden en la cola
+ *
+ * Nodo de una rueda de temporizadores: cada casilla es una lista doblemente
+ * enlazada de los que vencen en ella (módulo la vuelta), así armar y desarmar
+ * cuestan O(1) y cada avance de la rueda solo revisa las casillas que pasaron.
+ * Los nodos viven en un arreglo del tamaño de la cola protegido por su mutex.
  */
-int verificar_ingredientes_banda(int banda_id, Orden *orden);
+typedef struct
+{
+    /** @brief Orden vigilada (0 = nodo libre) */
+    int id_orden;
+
+    /** @brief Momento (reloj_ms) en que el cliente abandona */
+    long long vence_ms;
+
+    /** @brief Casilla de la rueda en la que está enlazado */
+    int casilla;
+
+    /** @brief Siguiente nodo de la casilla, o de la lista de libres (-1 al final) */
+    int siguiente;
+
+    /** @brief Nodo anterior de la casilla (-1 si es el primero) */
+    int anterior;
+} TemporizadorPaciencia;
 
 /**
- * @brief Consume los ingredientes necesarios para una orden
- * @param banda_id ID de la banda donde se consumirán los ingredientes
- * @param orden Puntero a la orden que consume los ingredientes
+ * @brief Estimación del régimen estacionario tras descartar el calentamiento
+ *
+ * MSER-5 elige el truncamiento que minimiza el error estándar de la media de lo
+ * que queda; lo que sigue se parte en LOTES_MEDIAS lotes cuyas medias dan el
+ * intervalo de confianza del 95 % con la t de Student.
  */
-void consumir_ingredientes_banda(int banda_id, Orden *orden);
+typedef struct
+{
+    /** @brief Calentamiento descartado (s simulados; -1 mientras no se detecta estado estacionario) */
+    int calentamiento_s;
+
+    /** @brief Lotes de MSER descartados al frente */
+    int lotes_descartados;
+
+    /** @brief Lotes de MSER cerrados al estimar */
+    int lotes;
+
+    /** @brief Segundos simulados que dura cada lote */
+    int segundos_lote;
+
+    /** @brief Órdenes entregadas por minuto simulado en el estado estacionario */
+    double throughput;
+
+    /** @brief Semiancho del intervalo de confianza del throughput */
+    double ic_throughput;
+
+    /** @brief Latencia media (creación a entrega) en el estado estacionario (ms simulados) */
+    double latencia_ms;
+
+    /** @brief Semiancho del intervalo de confianza de la latencia media */
+    double ic_latencia_ms;
+
+    /** @brief Throughput desde el arranque, calentamiento incluido (órdenes por minuto simulado) */
+    double throughput_total;
+
+    /** @brief Latencia media desde el arranque, calentamiento incluido (ms simulados) */
+    double latencia_total_ms;
+} EstimacionEstacionaria;
 
 /**
- * @brief Encuentra una banda disponible para procesar una orden
- * @param orden Puntero a la orden que necesita asignación
- * @return ID de la banda disponible o -1 si no hay ninguna
+ * @brief Cabecera del archivo de diario de estado
+ *
+ * El diario es una secuencia de cuadros (CabeceraCuadro + carga). Cada
+ * CUADROS_POR_CLAVE cuadros hay uno clave con el estado completo; los demás
+ * son deltas de pares (desplazamiento, longitud) seguidos de los bytes
+ * nuevos. Así el panel puede saltar a cualquier instante cargando el cuadro
+ * clave previo y aplicando como mucho CUADROS_POR_CLAVE - 1 deltas.
  */
-int encontrar_banda_disponible(Orden *orden);
+typedef struct
+{
+    /** @brief Debe valer MAGIA_DIARIO */
+    char magia[8];
 
-// ============================================================================
-// FUNCIONES DE GESTIÓN DE LOGS E INVENTARIO
-// ============================================================================
+    /** @brief Tamaño de DatosCompartidos al grabar; debe coincidir al reproducir */
+    unsigned int tamano_estado;
+
+    /** @brief Intervalo nominal entre cuadros (ms) */
+    int intervalo_ms;
+
+    /** @brief Reloj monotónico al iniciar la grabación (ms) */
+    long long inicio_ms;
+
+    /** @brief Nombre de la cocina grabada */
+    char nombre_instancia[MAX_NOMBRE_INSTANCIA];
+} CabeceraDiario;
 
 /**
- * @brief Añade una entrada de log a una banda específica
- * @param banda_id ID de la banda donde se registrará el log
- * @param mensaje Texto del mensaje a registrar
- * @param es_alerta 1 si es una alerta crítica, 0 si es información normal
+ * @brief Cabecera de cada cuadro del diario
  */
-void agregar_log_banda(int banda_id, const char *mensaje, int es_alerta);
+typedef struct
+{
+    /** @brief CUADRO_CLAVE o CUADRO_DELTA */
+    int tipo;
+
+    /** @brief Bytes de carga que siguen a esta cabecera */
+    unsigned int longitud;
+
+    /** @brief Reloj monotónico en que se tomó el cuadro (ms) */
+    long long marca_ms;
+} CabeceraCuadro;
 
 /**
- * @brief Verifica el estado del inventario de una banda y genera alertas
- * @param banda_id ID de la banda a verificar
+ * @brief Fila del archivo de métricas: lo ocurrido en un intervalo de reloj real
+ *
+ * Cada resolución es un anillo indexado por tiempo: el intervalo que empieza
+ * en t ocupa la fila (t / paso_s) % filas. Una fila solo vale si su inicio_s
+ * es el del intervalo buscado; las de una vuelta anterior o de cuando la
+ * cocina no corría se leen como huecos.
  */
-void verificar_inventario_banda(int banda_id);
+typedef struct
+{
+    /** @brief Inicio del intervalo en segundos desde la época (0: nunca escrita) */
+    long long inicio_s;
 
-// ============================================================================
-// FUNCIONES DE GESTIÓN DE COLA FIFO
-// ============================================================================
+    /** @brief Suma de la cola en cada muestra; la media es cola_suma / muestras */
+    long long cola_suma;
+
+    /** @brief Muestras del archivador consolidadas en la fila */
+    int muestras;
+
+    /** @brief Órdenes entregadas en el intervalo */
+    int completadas;
+
+    /** @brief Órdenes generadas en el intervalo */
+    int llegadas;
+
+    /** @brief Dispensadores que se vaciaron en el intervalo */
+    int agotamientos;
+
+    /** @brief Cola más larga observada en el intervalo */
+    int cola_maxima;
+
+    /** @brief Entregas del intervalo con latencia medida */
+    int latencias;
+
+    /** @brief Latencia mediana de las entregas del intervalo (ms simulados) */
+    int latencia_p50_ms;
+
+    /** @brief Latencia percentil 99 de las entregas del intervalo (ms simulados) */
+    int latencia_p99_ms;
+
+    /** @brief Entregas que cubren los percentiles; menos que latencias si el intervalo viene de varias corridas */
+    int latencias_percentil;
+} FilaArchivo;
 
 /**
- * @brief Añade una orden al final de la cola de espera
- * @param orden Puntero a la orden a encolar
+ * @brief Anillo de una resolución dentro del archivo de métricas
  */
-void encolar_orden(Orden *orden);
+typedef struct
+{
+    /** @brief Segundos que cubre cada fila */
+    int paso_s;
+
+    /** @brief Filas del anillo */
+    int filas;
+
+    /** @brief Posición de la primera fila desde el inicio del archivo (bytes) */
+    long long desplazamiento;
+} ResolucionArchivo;
 
 /**
- * @brief Extrae la primera orden de la cola de espera
- * @return Puntero a la orden extraída o NULL si la cola está vacía
+ * @brief Cabecera del archivo de métricas (--archivo)
+ *
+ * Le siguen los anillos de cada resolución, uno detrás de otro. El archivo
+ * tiene tamaño fijo y se proyecta con mmap; el archivador es su único escritor
+ * y usa un seqlock como la instantánea de métricas, así el panel lo lee sin
+ * frenarlo. Sobrevive a la cocina: la siguiente corrida sigue escribiendo en
+ * los mismos anillos.
  */
-Orden *desencolar_orden();
+typedef struct
+{
+    /** @brief Debe valer MAGIA_ARCHIVO */
+    char magia[8];
 
-// ============================================================================
-// FUNCIONES DE VISUALIZACIÓN Y MONITOREO
-// ============================================================================
+    /** @brief Contador del seqlock (impar mientras se escribe) */
+    unsigned int secuencia;
+
+    /** @brief Resoluciones guardadas (NUM_RESOLUCIONES_ARCHIVO) */
+    int num_resoluciones;
+
+    /** @brief Geometría de cada anillo, de la más fina a la más gruesa */
+    ResolucionArchivo resoluciones[NUM_RESOLUCIONES_ARCHIVO];
+
+    /** @brief Última muestra escrita, en segundos desde la época */
+    long long actualizado_s;
+
+    /** @brief Tamaño total del archivo (bytes) */
+    long long tamano;
+
+    /** @brief Cocina que escribió la última muestra */
+    char nombre_instancia[MAX_NOMBRE_INSTANCIA];
+} CabeceraArchivo;
 
 /**
- * @brief Muestra el estado del sistema en formato de tabla columnar
- * @note Formato detallado con múltiples columnas por banda
+ * @brief Columna de una tabla a escribir en Arrow
+ *
+ * Las columnas numéricas se escriben tal cual desde su anillo, en hasta dos
+ * tramos: desde la fila más antigua hasta el final del arreglo y desde el
+ * principio hasta la más nueva. Las de texto usan el par de buffers de Arrow
+ * (desplazamientos int32 y caracteres).
  */
-void mostrar_estado_columnar();
+typedef struct
+{
+    /** @brief Nombre de la columna en el esquema */
+    const char *nombre;
+
+    /** @brief Tipo de los valores (ARROW_*) */
+    int tipo;
+
+    /** @brief Tramos de valores contiguos de las columnas numéricas */
+    const void *tramos[2];
+
+    /** @brief Filas de cada tramo */
+    long long filas_tramo[2];
+
+    /** @brief Desplazamientos (filas + 1) de las columnas ARROW_UTF8 */
+    const int *desplazamientos;
+
+    /** @brief Caracteres concatenados de las columnas ARROW_UTF8 */
+    const char *caracteres;
+} ColumnaArrow;
 
 /**
- * @brief Muestra el estado del sistema en formato compacto
- * @note Formato resumido para pantallas pequeñas
+ * @brief Constructor de metadatos flatbuffer de adelante hacia atrás
+ *
+ * Cada tabla se escribe antes que lo que referencia, así todos los
+ * desplazamientos apuntan hacia adelante y se enlazan al escribir el destino.
  */
-void mostrar_estado_compacto();
+typedef struct
+{
+    /** @brief Bytes escritos */
+    unsigned char datos[TAM_FLATBUFFER];
+
+    /** @brief Bytes usados de datos */
+    int largo;
+} Flatbuffer;
 
 /**
- * @brief Muestra el estado del sistema adaptándose al tamaño de pantalla
- * @note Selecciona automáticamente entre columnar y compacto
+ * @brief Campo escalar o referencia de una tabla flatbuffer
  */
-void mostrar_estado_adaptativo();
+typedef struct
+{
+    /** @brief Bytes del campo (1, 2, 4 u 8); 0 si está ausente y toma su valor por defecto */
+    int tamano;
 
-// ============================================================================
-// FUNCIONES DE UTILIDAD Y CONTROL
-// ============================================================================
+    /** @brief Valor escalar; las referencias se escriben en 0 y se enlazan después */
+    long long valor;
+} CampoFlatbuffer;
 
 /**
- * @brief Genera una orden específica con el ID proporcionado
- * @param orden Puntero a la estructura de orden a llenar
- * @param id ID único para la nueva orden
+ * @brief Ubicación de un lote dentro del archivo Arrow (struct Block del pie)
  */
-void generar_orden_especifica(Orden *orden, int id);
+typedef struct
+{
+    /** @brief Byte del archivo donde empieza el mensaje */
+    long long desplazamiento;
+
+    /** @brief Bytes del prefijo más los metadatos */
+    int largo_metadatos;
+
+    /** @brief Relleno para alinear el siguiente campo a 8 */
+    int relleno;
+
+    /** @brief Bytes del cuerpo con los buffers */
+    long long largo_cuerpo;
+} BloqueArrow;
 
 /**
- * @brief Reabastece completamente el inventario de una banda
- * @param banda_id ID de la banda a reabastecer
+ * @brief Órdenes entregadas en columnas, para exportarlas sin reordenar (--arrow)
  */
-void reabastecer_banda(int banda_id);
+typedef struct
+{
+    int id_orden[CAPACIDAD_EXPORTACION];
+    int tipo[CAPACIDAD_EXPORTACION];
+    int banda[CAPACIDAD_EXPORTACION];
+    int lote[CAPACIDAD_EXPORTACION];
+    long long creacion_ms[CAPACIDAD_EXPORTACION];
+    long long inicio_ms[CAPACIDAD_EXPORTACION];
+    long long entrega_ms[CAPACIDAD_EXPORTACION];
+    long long latencia_ms[CAPACIDAD_EXPORTACION];
+    long long prometida_ms[CAPACIDAD_EXPORTACION];
+    double precio[CAPACIDAD_EXPORTACION];
+
+    /** @brief Filas agregadas desde el arranque; la siguiente va en total % CAPACIDAD_EXPORTACION */
+    long long total;
+} AnilloOrdenesExportadas;
 
 /**
- * @brief Limpia todos los recursos del sistema y termina los hilos
- * @note Se ejecuta automáticamente al recibir señales de terminación
+ * @brief Transiciones de estado de todas las bandas en columnas (--arrow)
  */
-void limpiar_sistema();
+typedef struct
+{
+    long long marca_ms[CAPACIDAD_EXPORTACION];
+    int banda[CAPACIDAD_EXPORTACION];
+    int estado[CAPACIDAD_EXPORTACION];
+    int tipo[CAPACIDAD_EXPORTACION];
+
+    /** @brief Filas agregadas desde el arranque */
+    long long total;
+} AnilloTransicionesExportadas;
 
 /**
- * @brief Manejador de señales del sistema operativo
- * @param sig Número de la señal recibida
+ * @brief Serie de métricas por segundo en columnas (--arrow)
  */
-void manejar_senal(int sig);
+typedef struct
+{
+    long long marca_ms[CAPACIDAD_EXPORTACION];
+    int generadas[CAPACIDAD_EXPORTACION];
+    int completadas[CAPACIDAD_EXPORTACION];
+    int en_cola[CAPACIDAD_EXPORTACION];
+    int bandas_ocupadas[CAPACIDAD_EXPORTACION];
+    float throughput[CAPACIDAD_EXPORTACION];
+    float llegadas[CAPACIDAD_EXPORTACION];
+    float ingresos_por_minuto[CAPACIDAD_EXPORTACION];
+
+    /** @brief Filas agregadas desde el arranque */
+    long long total;
+} AnilloMetricasExportadas;
 
 /**
- * @brief Valida y procesa los parámetros de línea de comandos
- * @param argc Número de argumentos
- * @param argv Array de argumentos
- * @param num_bandas Puntero donde se almacenará el número de bandas
- * @param tiempo_ingrediente Puntero donde se almacenará el tiempo por ingrediente
- * @param tiempo_orden Puntero donde se almacenará el tiempo entre órdenes
- * @return 1 si los parámetros son válidos, 0 en caso contrario
+ * @brief Movimientos de un dispensador desde el arranque (protegidos por el mutex del dispensador)
+ *
+ * Toda escritura de la cantidad pasa por aquí, así que en cualquier momento
+ * cantidad = CAPACIDAD_DISPENSADOR + repuesto - retirado + devuelto.
  */
-int validar_parametros(int argc, char *argv[], int *num_bandas, int *tiempo_ingrediente, int *tiempo_orden);
+typedef struct
+{
+    /** @brief Unidades agregadas por reabastecimientos */
+    long long repuesto;
+
+    /** @brief Unidades reservadas para preparar órdenes */
+    long long retirado;
+
+    /** @brief Unidades que volvieron al dispensador por cancelaciones */
+    long long devuelto;
+} LibroDispensador;
 
 /**
- * @brief Muestra la ayuda completa del sistema con ejemplos de uso
+ * @brief Contadores que solo pueden crecer, leídos en cada verificación de --estres
  */
-void mostrar_ayuda();
+typedef struct
+{
+    long long generadas;
+    long long procesadas;
+    long long canceladas;
+    long long descartadas;
+    long long rechazadas;
+    long long lotes;
+    double ingresos;
+    long long hamburguesas[MAX_BANDAS];
+    long long rescatadas[MAX_BANDAS];
+} ContadoresEstres;
 
-/** @} */
+/**
+ * @brief Actividad inyectada y violaciones encontradas por la prueba de estrés
+ */
+typedef struct
+{
+    /** @brief 1 cuando termina la carga: sin órdenes nuevas ni comandos (atómico) */
+    int drenando;
 
-// ═══════════════════════════════════════════════════════════════
-// FUNCIONES DE INICIALIZACIÓN
-// ═══════════════════════════════════════════════════════════════
+    /** @brief Comandos aplicados por el buzón (atómicos) */
+    long long comandos_reabastecer;
+    long long comandos_cancelar;
+
+    /** @brief Pausas, reanudaciones, averías y reparaciones de bandas (atómico) */
+    long long cambios_banda;
+
+    /** @brief Reabastecimientos directos de una banda (atómico) */
+    long long reabastecimientos;
+
+    /** @brief Pasadas de verificación con el sistema en marcha */
+    long long verificaciones;
+
+    /** @brief Violaciones por invariante (protegidas por mutex_estres) */
+    long long violaciones_inventario;
+    long long violaciones_conservacion;
+    long long violaciones_monotonia;
+    long long duplicadas;
+    long long perdidas;
+
+    /** @brief Descripción de la primera violación (protegida por mutex_estres) */
+    char primera_violacion[160];
+
+    /** @brief Contadores de la verificación anterior */
+    ContadoresEstres anteriores;
+} EstadoEstres;
 
 /**
- * @brief Inicializa completamente el sistema de hamburguesas
- *
- * Esta función es el punto de entrada principal para la configuración del sistema.
- * Realiza las siguientes operaciones críticas:
- *
- * 1. Configura la memoria compartida POSIX para comunicación entre procesos
- * 2. Inicializa todas las estructuras de datos del sistema
- * 3. Configura los mutexes y variables de condición para sincronización
- * 4. Inicializa todas las bandas de preparación con inventario completo
- * 5. Configura la cola FIFO para gestión de órdenes pendientes
- * 6. Establece los parámetros de tiempo configurables
- *
- * @param num_bandas Número de bandas de preparación a crear (1-10)
- * @param tiempo_ingrediente Tiempo en segundos para procesar cada ingrediente
- * @param tiempo_orden Tiempo en segundos entre generación de nuevas órdenes
- *
- * @note Esta función debe ser llamada antes de crear cualquier hilo del sistema
- * @note La memoria compartida se crea con permisos 0666 para acceso del panel de control
- * @note Todas las bandas se inicializan con inventario completo (CAPACIDAD_DISPENSADOR)
- *
- * @warning Si la función falla, el programa termina con exit(1)
- * @warning La memoria compartida previa se elimina automáticamente
+ * @defgroup variables_globales Variables Globales del Sistema
+ * @{
  */
-void inicializar_sistema(int num_bandas, int tiempo_ingrediente, int tiempo_orden)
-{
-    // Limpiar memoria compartida previa para evitar conflictos
-    shm_unlink("/burger_system");
 
-    // Crear nueva memoria compartida POSIX
-    int shm_fd = shm_open("/burger_system", O_CREAT | O_RDWR, 0666);
-    if (shm_fd == -1)
-    {
-        perror("Error creando memoria compartida");
-        exit(1);
-    }
+/** @brief Puntero a la estructura de datos compartidos en memoria compartida */
+DatosCompartidos *datos_compartidos;
 
-    // Configurar tamaño y mapear la memoria
-    ftruncate(shm_fd, sizeof(DatosCompartidos));
-    datos_compartidos = mmap(0, sizeof(DatosCompartidos), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+/** @brief Hilo que genera órdenes de hamburguesas automáticamente */
+pthread_t hilo_generador_ordenes;
 
-    if (datos_compartidos == MAP_FAILED)
-    {
-        perror("Error mapeando memoria compartida");
-        exit(1);
-    }
+/** @brief Hilo que asigna órdenes a las bandas disponibles */
+pthread_t hilo_asignador_ordenes;
 
-    // Inicializar estructura de datos compartidos
-    memset(datos_compartidos, 0, sizeof(DatosCompartidos));
-    datos_compartidos->num_bandas = num_bandas;
-    datos_compartidos->sistema_activo = 1;
-    datos_compartidos->total_ordenes_procesadas = 0;
-    datos_compartidos->total_ordenes_generadas = 0;
+/** @brief Hilo que monitorea el inventario de todas las bandas */
+pthread_t hilo_monitor_inventario;
 
-    // Configurar parámetros de tiempo configurables
-    datos_compartidos->tiempo_por_ingrediente = tiempo_ingrediente;
-    datos_compartidos->tiempo_nueva_orden = tiempo_orden;
+/** @brief Hilo que publica la instantánea de métricas para el panel */
+pthread_t hilo_publicador_metricas;
 
-    // Inicializar mecanismos de sincronización globales
-    pthread_mutex_init(&datos_compartidos->mutex_global, NULL);
-    pthread_cond_init(&datos_compartidos->nueva_orden, NULL);
+/** @brief Hilo que graba el diario de estado (solo con --diario) */
+pthread_t hilo_escritor_diario;
 
-    // Inicializar todas las bandas de preparación
-    for (int i = 0; i < num_bandas; i++)
-    {
-        // Configuración básica de la banda
-        datos_compartidos->bandas[i].id = i;
-        datos_compartidos->bandas[i].activa = 1;
-        datos_compartidos->bandas[i].pausada = 0;
-        datos_compartidos->bandas[i].hamburguesas_procesadas = 0;
-        datos_compartidos->bandas[i].procesando_orden = 0;
-        datos_compartidos->bandas[i].num_logs = 0;
-        datos_compartidos->bandas[i].necesita_reabastecimiento = 0;
-        datos_compartidos->bandas[i].ultima_alerta_inventario = 0;
+/** @brief Archivo del diario de estado; NULL si no se graba */
+FILE *archivo_diario = NULL;
 
-        // Estado inicial de la banda
-        strcpy(datos_compartidos->bandas[i].estado_actual, "ESPERANDO");
-        strcpy(datos_compartidos->bandas[i].ingrediente_actual, "");
+/** @brief Hilo que consolida las métricas en el archivo persistente (solo con --archivo) */
+pthread_t hilo_archivador;
 
-        // Inicializar mecanismos de sincronización de la banda
-        pthread_mutex_init(&datos_compartidos->bandas[i].mutex, NULL);
-        pthread_cond_init(&datos_compartidos->bandas[i].condicion, NULL);
+/** @brief Ruta del archivo de métricas (--archivo); "" si no se archiva */
+char ruta_archivo_metricas[256] = "";
 
-        // Inicializar dispensadores de ingredientes con inventario completo
-        for (int j = 0; j < MAX_INGREDIENTES; j++)
-        {
-            strcpy(datos_compartidos->bandas[i].dispensadores[j].nombre, ingredientes_base[j]);
-            datos_compartidos->bandas[i].dispensadores[j].cantidad = CAPACIDAD_DISPENSADOR;
-            pthread_mutex_init(&datos_compartidos->bandas[i].dispensadores[j].mutex, NULL);
-        }
+/** @brief Archivo de métricas proyectado en memoria; NULL si no se archiva */
+static CabeceraArchivo *archivo_metricas = NULL;
 
-        // Registrar inicio de la banda en el sistema de logs
-        agregar_log_banda(i, "BANDA INICIADA", 0);
-    }
+/** @brief Descriptor del archivo de métricas; abierto mientras dure el bloqueo de escritor */
+static int descriptor_archivo = -1;
 
-    // Inicializar cola FIFO para gestión de órdenes pendientes
-    datos_compartidos->cola_espera.frente = 0;
-    datos_compartidos->cola_espera.atras = 0;
-    datos_compartidos->cola_espera.tamano = 0;
-    pthread_mutex_init(&datos_compartidos->cola_espera.mutex, NULL);
-    pthread_cond_init(&datos_compartidos->cola_espera.no_vacia, NULL);
-    pthread_cond_init(&datos_compartidos->cola_espera.no_llena, NULL);
+/** @brief Dispensadores que se vaciaron desde el arranque */
+static unsigned int agotamientos_dispensador = 0;
 
-    // Mostrar información de configuración del sistema
-    printf("Sistema inicializado con %d bandas de preparación\n", num_bandas);
-    printf("Configuración de tiempos:\n");
-    printf("  • Tiempo por ingrediente: %d segundos\n", tiempo_ingrediente);
-    printf("  • Tiempo entre órdenes: %d segundos\n", tiempo_orden);
+/** @brief Hilo que aplica los comandos que el panel deja en el buzón */
+pthread_t hilo_procesador_comandos;
 
-    // Mostrar menú de hamburguesas disponibles
-    mostrar_menu_hamburguesas();
-}
+/** @brief Reabastecimientos; el asignador deja de esperar entre reintentos cuando avanza */
+static ContadorEventos eventos_reabastecimiento;
 
-void mostrar_menu_hamburguesas()
-{
-    printf("\n╔══════════════════════════════════════════════════════════════════╗\n");
-    printf("║                         MENU DE HAMBURGUESAS                     ║\n");
-    printf("╠══════════════════════════════════════════════════════════════════╣\n");
+/** @brief Hilo que ejecuta los eventos del escenario (solo con --escenario) */
+pthread_t hilo_escenario;
 
-    for (int i = 0; i < NUM_TIPOS_HAMBURGUESA; i++)
-    {
-        printf("║ %d. %-20s - $%6.2f                                ║\n",
-               i + 1, menu_hamburguesas[i].nombre, menu_hamburguesas[i].precio);
-    }
-    printf("╚══════════════════════════════════════════════════════════════════╝\n");
-}
+/** @brief Hilo vigilante que rescata las órdenes de bandas atascadas */
+pthread_t hilo_vigilante;
 
-// ═══════════════════════════════════════════════════════════════
-// FUNCIONES DE MANEJO DE LOGS
-// ═══════════════════════════════════════════════════════════════
+/** @brief Atasco pendiente por banda (acción "bloquear"): el siguiente paso no publica latido */
+static int bloqueo_solicitado[MAX_BANDAS];
 
-void agregar_log_banda(int banda_id, const char *mensaje, int es_alerta)
-{
-    if (banda_id < 0 || banda_id >= datos_compartidos->num_bandas)
-        return;
+/** @brief Eventos del escenario ordenados por instante */
+EventoEscenario eventos_escenario[MAX_EVENTOS_ESCENARIO];
 
-    Banda *banda = &datos_compartidos->bandas[banda_id];
+/** @brief Número de eventos cargados del escenario */
+int num_eventos_escenario = 0;
 
-    pthread_mutex_lock(&banda->mutex);
+/** @brief Factor de aceleración del reloj simulado (1 = tiempo real) */
+double aceleracion = 1.0;
 
-    if (banda->num_logs >= MAX_LOGS_POR_BANDA)
-    {
-        for (int i = 1; i < MAX_LOGS_POR_BANDA; i++)
-        {
-            banda->logs[i - 1] = banda->logs[i];
-        }
-        banda->num_logs = MAX_LOGS_POR_BANDA - 1;
-    }
+/** @brief Reloj monotónico al arrancar la simulación (ms) */
+long long inicio_simulacion_ms = 0;
 
-    strcpy(banda->logs[banda->num_logs].mensaje, mensaje);
-    banda->logs[banda->num_logs].timestamp = time(NULL);
-    banda->logs[banda->num_logs].es_alerta = es_alerta;
-    banda->num_logs++;
+/** @brief Intervalo simulado entre órdenes nuevas (ms); lo cambia la acción "tasa" */
+volatile int intervalo_orden_ms = TIEMPO_DEFAULT_NUEVA_ORDEN * 1000;
 
-    pthread_mutex_unlock(&banda->mutex);
-}
+/** @brief Solicitud de terminación hecha por un escenario */
+volatile int terminar_solicitado = 0;
 
-// ═══════════════════════════════════════════════════════════════
-// FUNCIONES DE VERIFICACIÓN DE INVENTARIO
-// ═══════════════════════════════════════════════════════════════
+/** @brief Política de asignación elegida con --politica (POLITICA_*) */
+int politica_asignacion = POLITICA_FIFO;
 
-void verificar_inventario_banda(int banda_id)
-{
-    if (banda_id < 0 || banda_id >= datos_compartidos->num_bandas)
-        return;
+/** @brief Órdenes del mismo tipo que el asignador junta en una banda (--lote) */
+int tamano_lote_maximo = 1;
 
-    Banda *banda = &datos_compartidos->bandas[banda_id];
-    time_t ahora = time(NULL);
+/** @brief Exponente del costo de un paso de lote (--costo-lote): 1 = sin ahorro, 0 = gratis */
+double exponente_lote = EXPONENTE_LOTE_DEFAULT;
 
-    // Evitar spam de alertas (máximo una cada 30 segundos)
-    if (ahora - banda->ultima_alerta_inventario < 30)
-        return;
+/** @brief Parada simulada de la banda por dispensador que rellena (--tiempo-reabasto, ms); 0 = al instante */
+long long tiempo_reabasto_ms = 0;
 
-    int ingredientes_bajos = 0;
-    int ingredientes_agotados = 0;
-    char ingredientes_criticos[200] = "";
+/** @brief Nivel al que una banda programa sus propios rellenos tras cada orden (--umbral-reabasto) */
+int umbral_reabasto = SIN_UMBRAL_REABASTO;
 
-    for (int i = 0; i < MAX_INGREDIENTES; i++)
-    {
-        pthread_mutex_lock(&banda->dispensadores[i].mutex);
-        int cantidad = banda->dispensadores[i].cantidad;
+/** @brief Factor de velocidad de cada banda (--velocidad B:F); 0 = sin configurar, equivale a 1 */
+float velocidad_banda[MAX_BANDAS];
 
-        if (cantidad == 0)
-        {
-            ingredientes_agotados++;
-            if (strlen(ingredientes_criticos) > 0)
-                strcat(ingredientes_criticos, ", ");
-            strcat(ingredientes_criticos, banda->dispensadores[i].nombre);
-        }
-        else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
-        {
-            ingredientes_bajos++;
-        }
+/** @brief Factor de cada estación de ingrediente por banda (--velocidad B:F:ING); 0 = sin configurar */
+float velocidad_estacion[MAX_BANDAS][MAX_INGREDIENTES];
 
-        pthread_mutex_unlock(&banda->dispensadores[i].mutex);
-    }
+/** @brief Asignar a la primera banda libre aunque las velocidades difieran (--primera-libre) */
+int asignacion_primera_libre = 0;
 
-    if (ingredientes_agotados > 0)
-    {
-        char mensaje_alerta[250];
-        snprintf(mensaje_alerta, sizeof(mensaje_alerta),
-                 "ALERTA! BANDA %d SIN: %s", banda_id + 1, ingredientes_criticos);
-        agregar_log_banda(banda_id, mensaje_alerta, 1);
-        banda->necesita_reabastecimiento = 1;
-        banda->ultima_alerta_inventario = ahora;
-    }
-    else if (ingredientes_bajos >= 3)
-    {
-        char mensaje_alerta[100];
-        snprintf(mensaje_alerta, sizeof(mensaje_alerta),
-                 "AVISO: Banda %d necesita reabastecimiento", banda_id + 1);
-        agregar_log_banda(banda_id, mensaje_alerta, 1);
-        banda->necesita_reabastecimiento = 1;
-        banda->ultima_alerta_inventario = ahora;
-    }
-    else
-    {
-        banda->necesita_reabastecimiento = 0;
-    }
-}
+/** @brief Alguna banda o estación tiene un factor de velocidad distinto de 1 */
+int bandas_heterogeneas = 0;
 
-void *monitor_inventario(void *arg)
-{
-    (void)arg;
+/** @brief Hamburguesas de recetas largas entregadas por cada banda (protegido por el mutex de la banda) */
+static int largas_por_banda[MAX_BANDAS];
 
-    while (datos_compartidos->sistema_activo)
-    {
-        for (int i = 0; i < datos_compartidos->num_bandas; i++)
-        {
-            verificar_inventario_banda(i);
-        }
-        sleep(15); // Chequear cada 15 segundos
-    }
-    return NULL;
-}
+/** @brief Clientes de la población cerrada (--clientes); 0 = llegadas abiertas a intervalo fijo */
+int num_clientes = 0;
 
-// ═══════════════════════════════════════════════════════════════
-// FUNCIONES DE HILOS DE TRABAJO
-// ═══════════════════════════════════════════════════════════════
+/** @brief Tiempo medio que un cliente piensa entre el desenlace de su orden y la siguiente (--pensar, ms simulados) */
+long long tiempo_pensar_ms = TIEMPO_DEFAULT_PENSAR * 1000LL;
 
-void *banda_worker(void *arg)
-{
-    int banda_id = *(int *)arg;
-    Banda *banda = &datos_compartidos->bandas[banda_id];
+/**
+ * @brief Momento (reloj_ms) en que cada cliente vuelve a ordenar
+ *
+ * CLIENTE_ESPERANDO mientras su orden sigue en el sistema y CLIENTE_LIBERADO
+ * cuando acaba de salir; el generador sortea entonces su reflexión.
+ */
+static long long regreso_cliente[MAX_CLIENTES];
 
-    while (datos_compartidos->sistema_activo)
-    {
-        pthread_mutex_lock(&banda->mutex);
+/** @brief Mutex que protege regreso_cliente y los acumulados de los ciclos de cliente */
+static pthread_mutex_t mutex_clientes = PTHREAD_MUTEX_INITIALIZER;
 
-        // Esperar mientras esté pausada
-        while (banda->pausada && datos_compartidos->sistema_activo)
-        {
-            strcpy(banda->estado_actual, "PAUSADA");
-            pthread_cond_wait(&banda->condicion, &banda->mutex);
-        }
+/** @brief Se notifica cada vez que una orden de un cliente sale del sistema */
+static ContadorEventos eventos_clientes;
 
-        if (!datos_compartidos->sistema_activo)
-        {
-            pthread_mutex_unlock(&banda->mutex);
-            break;
-        }
+/** @brief Suma del tiempo de respuesta de cada ciclo de cliente (ms simulados, protegida por mutex_clientes) */
+static long long suma_respuesta_clientes_ms = 0;
 
-        // Si no está procesando, esperar
-        if (!banda->procesando_orden)
-        {
-            strcpy(banda->estado_actual, "ESPERANDO");
-            pthread_mutex_unlock(&banda->mutex);
-            usleep(100000);
-            continue;
-        }
+/** @brief Órdenes de clientes que ya salieron del sistema, con cualquier desenlace */
+static long long ciclos_clientes = 0;
 
-        pthread_mutex_unlock(&banda->mutex);
+/** @brief Paciencia media de un cliente en ms simulados (--edad-maxima) */
+long long edad_maxima_ms = EDAD_MAXIMA_DEFAULT_MS;
 
-        // Procesar la orden asignada
-        procesar_orden(banda_id, &banda->orden_actual);
+/** @brief Distribución de la paciencia alrededor de edad_maxima_ms (--paciencia, PACIENCIA_*) */
+int distribucion_paciencia = PACIENCIA_FIJA;
 
-        pthread_mutex_lock(&banda->mutex);
-        banda->hamburguesas_procesadas++;
-        banda->procesando_orden = 0;
-        strcpy(banda->estado_actual, "ESPERANDO");
-        strcpy(banda->ingrediente_actual, "");
-        pthread_mutex_unlock(&banda->mutex);
+/** @brief Preparar las recetas como DAG de pasos en estaciones paralelas (--dag) */
+int recetas_en_dag = 0;
 
-        pthread_mutex_lock(&datos_compartidos->mutex_global);
-        datos_compartidos->total_ordenes_procesadas++;
-        pthread_mutex_unlock(&datos_compartidos->mutex_global);
+/** @brief Medir el despacho y la cola en vez de simular (--microbench) */
+int modo_microbench = 0;
 
-        char log_msg[100];
-        sprintf(log_msg, "COMPLETADA %s #%d", banda->orden_actual.nombre_hamburguesa, banda->orden_actual.id_orden);
-        agregar_log_banda(banda_id, log_msg, 0);
+/** @brief Segundos de prueba de estrés (--estres), o 0 para simular normalmente */
+int segundos_estres = 0;
 
-        verificar_inventario_banda(banda_id);
-    }
-    return NULL;
-}
+/** @brief Lugares de la parrilla compartida para los pasos de carne (--parrillas, 0 = parrilla propia por banda) */
+int lugares_parrilla = 0;
 
-void *generador_ordenes(void *arg)
-{
-    (void)arg;
-    int contador_ordenes = 1;
+/** @brief Cada par de bandas vecinas comparte una tolva para los pasos de salsa (--tolvas) */
+int tolvas_compartidas = 0;
 
-    while (datos_compartidos->sistema_activo)
-    {
-        Orden nueva_orden;
-        generar_orden_especifica(&nueva_orden, contador_ordenes++);
-        nueva_orden.intentos_asignacion = 0;
-        encolar_orden(&nueva_orden);
+/** @brief Directorio donde se exportan los resultados en Arrow (--arrow), o "" si no se exportan */
+char directorio_arrow[256] = "";
 
-        pthread_mutex_lock(&datos_compartidos->mutex_global);
-        datos_compartidos->total_ordenes_generadas++;
-        pthread_mutex_unlock(&datos_compartidos->mutex_global);
+/** @brief Órdenes entregadas pendientes de exportar (protegido por mutex_exportacion) */
+static AnilloOrdenesExportadas anillo_ordenes;
 
-        printf("\n[NUEVA ORDEN] %s #%d generada - En cola\n",
-               nueva_orden.nombre_hamburguesa, nueva_orden.id_orden);
+/** @brief Transiciones de las bandas pendientes de exportar (protegido por mutex_exportacion) */
+static AnilloTransicionesExportadas anillo_transiciones;
 
-        pthread_cond_broadcast(&datos_compartidos->nueva_orden);
+/** @brief Métricas por segundo pendientes de exportar (protegido por mutex_exportacion) */
+static AnilloMetricasExportadas anillo_metricas;
 
-        // MODIFICADO: Usar tiempo configurado en lugar de valor fijo
-        sleep(datos_compartidos->tiempo_nueva_orden);
-    }
-    return NULL;
-}
+/** @brief Movimientos de cada dispensador (protegidos por el mutex del dispensador) */
+static LibroDispensador libro_inventario[MAX_BANDAS][MAX_INGREDIENTES];
 
-void *asignador_ordenes(void *arg)
-{
-    (void)arg;
+/** @brief Estado de la prueba de estrés (--estres) */
+static EstadoEstres estres;
 
-    while (datos_compartidos->sistema_activo)
-    {
-        Orden *orden = desencolar_orden();
-        if (orden != NULL)
-        {
-            orden->intentos_asignacion++;
-            int banda_asignada = encontrar_banda_disponible(orden);
+/** @brief Desenlaces de cada número de orden en --estres (entregada, cancelada, expirada o rechazada) */
+static unsigned char *desenlaces_estres = NULL;
 
-            if (banda_asignada >= 0)
-            {
-                // Asignar orden a la banda encontrada
-                Banda *banda = &datos_compartidos->bandas[banda_asignada];
+/** @brief Mutex de las violaciones de la prueba de estrés; no se pide otro con él */
+static pthread_mutex_t mutex_estres = PTHREAD_MUTEX_INITIALIZER;
 
-                pthread_mutex_lock(&banda->mutex);
-                banda->procesando_orden = 1;
-                banda->orden_actual = *orden;
-                banda->orden_actual.asignada_a_banda = banda_asignada;
-                sprintf(banda->estado_actual, "PREPARANDO %s", orden->nombre_hamburguesa);
-                pthread_mutex_unlock(&banda->mutex);
+/** @brief Salida estándar original, donde va el informe de --estres */
+static FILE *salida_estres = NULL;
 
-                char log_msg[100];
-                sprintf(log_msg, "ASIGNADA %s #%d", orden->nombre_hamburguesa, orden->id_orden);
-                agregar_log_banda(banda_asignada, log_msg, 0);
-            }
-            else
-            {
-                // Re-encolar para intentar más tarde
-                if (orden->intentos_asignacion < 20)
-                { // Máximo 20 intentos
-                    encolar_orden(orden);
-                    sleep(3); // Esperar antes del siguiente intento
-                }
-                else
-                {
-                    // Después de muchos intentos, la orden se pierde (timeout)
-                    printf("\n⚠️  [TIMEOUT] Orden %s #%d descartada por timeout\n",
-                           orden->nombre_hamburguesa, orden->id_orden);
-                }
-            }
-        }
-        else
-        {
-            usleep(200000); // No hay órdenes, esperar 200ms
-        }
-    }
-    return NULL;
-}
+/** @brief Cuenta de CPU del hilo en curso, o -1 si el hilo no se registró */
+static __thread int componente_hilo = -1;
 
-int encontrar_banda_disponible(Orden *orden)
-{
-    // Buscar banda libre con recursos suficientes
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
-    {
-        Banda *banda = &datos_compartidos->bandas[i];
+/** @brief Mutex de los anillos de exportación; es la última en tomarse, nunca se pide otra con ella */
+static pthread_mutex_t mutex_exportacion = PTHREAD_MUTEX_INITIALIZER;
 
-        pthread_mutex_lock(&banda->mutex);
-        int banda_libre = banda->activa && !banda->pausada && !banda->procesando_orden;
-        pthread_mutex_unlock(&banda->mutex);
+/** @brief Calendario de cada tipo de hamburguesa (lo arma planificar_recetas al arrancar) */
+static PlanReceta planes_receta[NUM_TIPOS_HAMBURGUESA];
 
-        if (banda_libre && verificar_ingredientes_banda(i, orden))
-        {
-            return i;
-        }
-    }
-    return -1;
-}
+/** @brief Índice de órdenes vivas por número (protegido por el mutex de la cola) */
+static EntradaIndice indice_ordenes[CAPACIDAD_INDICE];
 
-// ═══════════════════════════════════════════════════════════════
-// FUNCIONES DE PROCESAMIENTO DE ÓRDENES
-// ═══════════════════════════════════════════════════════════════
+/** @brief Nodos de la rueda de paciencia: a lo sumo uno por lugar de la cola (protegidos por su mutex) */
+static TemporizadorPaciencia temporizadores_paciencia[MAX_ORDENES];
 
-void procesar_orden(int banda_id, Orden *orden)
-{
-    Banda *banda = &datos_compartidos->bandas[banda_id];
+/** @brief Primer nodo de cada casilla de la rueda (-1 si está vacía) */
+static int rueda_paciencia[CASILLAS_RUEDA_PACIENCIA];
 
-    char log_msg[100];
-    sprintf(log_msg, "INICIANDO %s #%d", orden->nombre_hamburguesa, orden->id_orden);
-    agregar_log_banda(banda_id, log_msg, 0);
+/** @brief Primer nodo libre (-1 si no queda ninguno) */
+static int temporizadores_libres = -1;
 
-    // Consumir ingredientes
-    consumir_ingredientes_banda(banda_id, orden);
+/** @brief Última casilla absoluta (reloj_ms / MS_CASILLA_PACIENCIA) que revisó la rueda */
+static long long casilla_revisada = 0;
 
-    // Simular preparación paso a paso
-    for (int i = 0; i < orden->num_ingredientes; i++)
-    {
-        pthread_mutex_lock(&banda->mutex);
-        orden->paso_actual = i + 1;
-        strcpy(banda->ingrediente_actual, orden->ingredientes_solicitados[i]);
-        sprintf(banda->estado_actual, "AGREGANDO %s", orden->ingredientes_solicitados[i]);
-        pthread_mutex_unlock(&banda->mutex);
+/** @brief Órdenes admitidas por tramo de cola al llegar (protegido por el mutex de la cola) */
+static long long llegadas_por_tramo[TRAMOS_CARGA_ABANDONO];
 
-        sprintf(log_msg, "Agregando %s...", orden->ingredientes_solicitados[i]);
-        agregar_log_banda(banda_id, log_msg, 0);
+/** @brief Órdenes abandonadas por tramo de cola al llegar (protegido por el mutex de la cola) */
+static long long abandonos_por_tramo[TRAMOS_CARGA_ABANDONO];
 
-        // MODIFICADO: Usar tiempo configurado en lugar de valor fijo
-        sleep(datos_compartidos->tiempo_por_ingrediente);
-    }
+/** @brief Ingresos de menú de las órdenes abandonadas (protegido por el mutex de la cola) */
+static double ingresos_abandonados = 0;
 
-    pthread_mutex_lock(&banda->mutex);
-    sprintf(banda->estado_actual, "FINALIZANDO %s", orden->nombre_hamburguesa);
-    pthread_mutex_unlock(&banda->mutex);
+/** @brief Límite inferior de cada tramo de cola al llegar */
+static const int inicio_tramo_carga[TRAMOS_CARGA_ABANDONO] = {0, 2, 5, 10, 20, 40};
 
-    agregar_log_banda(banda_id, "HAMBURGUESA LISTA!", 0);
-    sleep(1); // Tiempo final
-}
+/** @brief Nombre del segmento de memoria compartida de esta instancia */
+char nombre_memoria[64] = PREFIJO_MEMORIA;
 
-int verificar_ingredientes_banda(int banda_id, Orden *orden)
-{
-    Banda *banda = &datos_compartidos->bandas[banda_id];
+/** @brief Nombre legible de esta instancia (cocina) */
+char nombre_cocina[MAX_NOMBRE_INSTANCIA] = "principal";
 
-    for (int i = 0; i < orden->num_ingredientes; i++)
-    {
-        int encontrado = 0;
-        for (int j = 0; j < MAX_INGREDIENTES; j++)
-        {
-            if (strcmp(orden->ingredientes_solicitados[i],
-                       banda->dispensadores[j].nombre) == 0)
-            {
-                pthread_mutex_lock(&banda->dispensadores[j].mutex);
-                if (banda->dispensadores[j].cantidad <= 0)
-                {
-                    pthread_mutex_unlock(&banda->dispensadores[j].mutex);
-                    return 0;
-                }
-                pthread_mutex_unlock(&banda->dispensadores[j].mutex);
-                encontrado = 1;
-                break;
-            }
-        }
-        if (!encontrado)
-            return 0;
-    }
-    return 1;
-}
+/** @brief Histograma de latencias de órdenes completadas (memoria local del proceso) */
+static int histograma_latencias[NUM_CUBETAS_LATENCIA];
 
-void consumir_ingredientes_banda(int banda_id, Orden *orden)
-{
-    Banda *banda = &datos_compartidos->bandas[banda_id];
+/** @brief Total de muestras registradas en el histograma de latencias */
+static int total_muestras_latencia = 0;
 
-    for (int i = 0; i < orden->num_ingredientes; i++)
-    {
-        for (int j = 0; j < MAX_INGREDIENTES; j++)
-        {
-            if (strcmp(orden->ingredientes_solicitados[i],
-                       banda->dispensadores[j].nombre) == 0)
-            {
-                pthread_mutex_lock(&banda->dispensadores[j].mutex);
-                if (banda->dispensadores[j].cantidad > 0)
-                {
-                    banda->dispensadores[j].cantidad--;
-                }
-                pthread_mutex_unlock(&banda->dispensadores[j].mutex);
-                break;
-            }
-        }
-    }
-}
+/** @brief Latencias registradas desde la última muestra del archivador (protegido por mutex_latencias) */
+static int histograma_archivo[NUM_CUBETAS_LATENCIA];
 
-// ═══════════════════════════════════════════════════════════════
-// FUNCIONES DE COLA FIFO
-// ═══════════════════════════════════════════════════════════════
+/** @brief Muestras en histograma_archivo */
+static int muestras_archivo = 0;
 
-void encolar_orden(Orden *orden)
-{
-    pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+/** @brief Mutex que protege el histograma de latencias y los acumulados del error de ETA */
+static pthread_mutex_t mutex_latencias = PTHREAD_MUTEX_INITIALIZER;
 
-    while (datos_compartidos->cola_espera.tamano >= MAX_ORDENES)
-    {
-        pthread_cond_wait(&datos_compartidos->cola_espera.no_llena,
-                          &datos_compartidos->cola_espera.mutex);
-    }
+/** @brief Suma del error con signo de la hora prometida (ms simulados) */
+static long long suma_error_eta_ms = 0;
 
-    datos_compartidos->cola_espera.ordenes[datos_compartidos->cola_espera.atras] = *orden;
-    datos_compartidos->cola_espera.atras = (datos_compartidos->cola_espera.atras + 1) % MAX_ORDENES;
-    datos_compartidos->cola_espera.tamano++;
+/** @brief Suma del error absoluto de la hora prometida (ms simulados) */
+static long long suma_error_abs_eta_ms = 0;
 
-    pthread_cond_signal(&datos_compartidos->cola_espera.no_vacia);
-    pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
-}
+/** @brief Órdenes entregadas que tenían hora prometida */
+static int muestras_error_eta = 0;
 
-Orden *desencolar_orden()
-{
-    static Orden orden_temp;
+/** @brief Hora en que cada banda queda libre tras atender la cola, según la última estimación (mutex de la cola) */
+static long long libre_tras_cola_ms[MAX_BANDAS];
 
-    pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+/** @brief Bandas que podían preparar cada receta en el último recálculo de ETAs (mutex de la cola) */
+static int servibles_tras_cola[MAX_BANDAS][NUM_TIPOS_HAMBURGUESA];
 
-    if (datos_compartidos->cola_espera.tamano == 0)
-    {
-        pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
-        return NULL;
-    }
+/** @brief 1 cuando ya hubo un recálculo completo de ETAs del que partir */
+static int etas_calculadas = 0;
 
-    orden_temp = datos_compartidos->cola_espera.ordenes[datos_compartidos->cola_espera.frente];
-    datos_compartidos->cola_espera.frente = (datos_compartidos->cola_espera.frente + 1) % MAX_ORDENES;
-    datos_compartidos->cola_espera.tamano--;
+/** @brief Suma de la duración real de las preparaciones entregadas (ms simulados, protegida por mutex_latencias) */
+static long long suma_preparacion_ms = 0;
 
-    pthread_cond_signal(&datos_compartidos->cola_espera.no_llena);
-    pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+/** @brief Suma de la ruta crítica de esas preparaciones (ms simulados, protegida por mutex_latencias) */
+static long long suma_ruta_critica_ms = 0;
 
-    return &orden_temp;
-}
+/** @brief Suma de lo que habrían durado paso a paso (ms simulados, protegida por mutex_latencias) */
+static long long suma_secuencial_ms = 0;
 
-// ═══════════════════════════════════════════════════════════════
-// FUNCIONES DE DISPLAY
-// ═══════════════════════════════════════════════════════════════
+/** @brief Preparaciones registradas (una por lote entregado) */
+static int muestras_preparacion = 0;
 
-void mostrar_estado_columnar()
-{
-    printf("\033[2J\033[H"); // Limpiar pantalla
+/** @brief Entregas de cada lote de MSER según su instante simulado (protegido por mutex_latencias) */
+static long long entregas_lote_mser[MAX_LOTES_MSER];
 
-    // Encabezado del sistema
-    printf("╔═══════════════════════════════════════════════════════════════════════════════════════════════════════════════╗\n");
-    printf("║                                      SISTEMA DE HAMBURGUESAS - ESTADO                                         ║\n");
-    printf("║ Generadas: %-6d  │  Procesadas: %-6d  │  En cola: %-6d  │  Bandas: %-6d                              ║\n",
-           datos_compartidos->total_ordenes_generadas,
-           datos_compartidos->total_ordenes_procesadas,
-           datos_compartidos->cola_espera.tamano,
-           datos_compartidos->num_bandas);
-    printf("║ Nueva orden cada %ds │ Ingrediente cada %ds │ Asignacion inteligente FIFO                                  ║\n",
-           datos_compartidos->tiempo_nueva_orden,
-           datos_compartidos->tiempo_por_ingrediente);
-    printf("╚═══════════════════════════════════════════════════════════════════════════════════════════════════════════════╝\n");
+/** @brief Suma de las latencias de cada lote de MSER en ms simulados (protegido por mutex_latencias) */
+static long long latencia_lote_mser_ms[MAX_LOTES_MSER];
 
-    // Mostrar alertas de inventario
-    int bandas_con_alertas = 0;
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
-    {
-        if (datos_compartidos->bandas[i].necesita_reabastecimiento)
-        {
-            bandas_con_alertas++;
-        }
-    }
+/** @brief Lotes de MSER cerrados en la última revisión del publicador */
+static int lotes_mser = 0;
 
-    if (bandas_con_alertas > 0)
-    {
-        printf("\n🚨 ALERTAS DE INVENTARIO: %d bandas necesitan reabastecimiento 🚨\n", bandas_con_alertas);
-        for (int i = 0; i < datos_compartidos->num_bandas; i++)
-        {
-            if (datos_compartidos->bandas[i].necesita_reabastecimiento)
-            {
-                printf("   ⚠️  BANDA %d requiere reabastecimiento urgente\n", i + 1);
-            }
-        }
-        printf("\n");
-    }
+/** @brief Segundos simulados que dura cada lote; se duplica al fundirlos (protegido por mutex_latencias) */
+static int segundos_por_lote_mser = SEGUNDOS_LOTE_MSER;
 
-    // Layout columnar
-    const int ANCHO_COLUMNA = 40;
-    const int MAX_COLUMNAS = 3;
+/** @brief Última estimación del estado estacionario (la escribe el publicador) */
+static EstimacionEstacionaria estacionario = {-1, 0, 0, SEGUNDOS_LOTE_MSER, 0, 0, 0, 0, 0, 0};
 
-    int filas_bandas = (datos_compartidos->num_bandas + MAX_COLUMNAS - 1) / MAX_COLUMNAS;
+/** @brief t de Student al 95 % (dos colas) por grados de libertad, hasta LOTES_MEDIAS - 1 */
+static const double t_student_95[LOTES_MEDIAS] = {0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262};
 
-    for (int fila = 0; fila < filas_bandas; fila++)
-    {
-        int banda_inicio = fila * MAX_COLUMNAS;
-        int banda_fin = (banda_inicio + MAX_COLUMNAS > datos_compartidos->num_bandas) ? datos_compartidos->num_bandas : banda_inicio + MAX_COLUMNAS;
-        int num_columnas_fila = banda_fin - banda_inicio;
+/** @} */
 
-        // Bordes superiores
-        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╔", "╗  ╔", "╗", "═");
+/**
+ * @brief Menú completo de hamburguesas disponibles en el sistema
+ *
+ * Define todos los tipos de hamburguesas que se pueden preparar, incluyendo
+ * sus ingredientes específicos, cantidad de ingredientes y precios de venta.
+ * Cada hamburguesa tiene una receta única que determina el orden de
+ * preparación de los ingredientes.
+ */
+TipoHamburguesa menu_hamburguesas[NUM_TIPOS_HAMBURGUESA] = {
+    /** @brief Hamburguesa Clásica: Pan, carne, lechuga, tomate */
+    {"Clasica", {"pan_inferior", "carne", "lechuga", "tomate", "pan_superior"}, 5, 8.50},
 
-        // Encabezados de bandas
-        char titulos[MAX_COLUMNAS][50];
-        for (int col = 0; col < num_columnas_fila; col++)
-        {
-            int banda_actual = banda_inicio + col;
-            sprintf(titulos[col], "BANDA %d", banda_actual + 1);
-            strcpy(titulos[col], centrar_texto(titulos[col], ANCHO_COLUMNA - 2));
-        }
-        imprimir_fila_contenido(titulos, num_columnas_fila, ANCHO_COLUMNA);
+    /** @brief Cheeseburger: Clásica + queso */
+    {"Cheeseburger", {"pan_inferior", "carne", "queso", "lechuga", "tomate", "pan_superior"}, 6, 9.25},
 
-        // Separador
-        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "═");
+    /** @brief BBQ Bacon: Con bacon, queso, cebolla y salsa BBQ */
+    {"BBQ Bacon", {"pan_inferior", "carne", "bacon", "queso", "cebolla", "salsa_bbq", "pan_superior"}, 7, 11.75},
 
-        // Sección inventario
-        char subtitulo_inv[MAX_COLUMNAS][50];
-        for (int col = 0; col < num_columnas_fila; col++)
-        {
-            strcpy(subtitulo_inv[col], centrar_texto("INVENTARIO", ANCHO_COLUMNA - 2));
-        }
-        imprimir_fila_contenido(subtitulo_inv, num_columnas_fila, ANCHO_COLUMNA);
+    /** @brief Vegetariana: Sin carne, con vegetal y aguacate */
+    {"Vegetariana", {"pan_inferior", "vegetal", "lechuga", "tomate", "aguacate", "mayonesa", "pan_superior"}, 7, 10.25},
 
-        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "─");
+    /** @brief Deluxe: Hamburguesa premium con todos los ingredientes */
+    {"Deluxe", {"pan_inferior", "carne", "queso", "bacon", "lechuga", "tomate", "cebolla", "mayonesa", "pan_superior"}, 9, 13.50},
 
-        // Mostrar inventario (8 líneas)
-        for (int ing = 0; ing < 8; ing++)
-        {
-            char lineas_inventario[MAX_COLUMNAS][50];
+    /** @brief Spicy Mexican: Con jalapeños y salsa picante */
+    {"Spicy Mexican", {"pan_inferior", "carne", "queso", "jalapenos", "tomate", "cebolla", "salsa_picante", "pan_superior"}, 8, 12.00}};
 
-            for (int col = 0; col < num_columnas_fila; col++)
-            {
-                int banda = banda_inicio + col;
-                if (banda < datos_compartidos->num_bandas && ing < MAX_INGREDIENTES)
-                {
-                    Banda *b = &datos_compartidos->bandas[banda];
-                    pthread_mutex_lock(&b->dispensadores[ing].mutex);
+/**
+ * @brief Recetas del menú como DAG de pasos (--dag)
+ *
+ * Fila por tipo, columna por ingrediente de menu_hamburguesas: {estación,
+ * duración, pasos previos}. La carne y el vegetal tardan dos unidades en la
+ * plancha y el queso se funde sobre ellos; las salsas van sobre el pan
+ * inferior tostado y el pan superior cierra cuando todo lo demás terminó.
+ */
+PasoReceta pasos_receta[NUM_TIPOS_HAMBURGUESA][MAX_PASOS_RECETA] = {
+    /** @brief Clasica: pan_inferior, carne, lechuga, tomate, pan_superior */
+    {{ESTACION_TOSTADOR, 1, 0}, {ESTACION_PLANCHA, 2, 0}, {ESTACION_FRIOS, 1, 0}, {ESTACION_FRIOS, 1, 0},
+     {ESTACION_ARMADO, 1, 0x0F}},
 
-                    char nombre_corto[15];
-                    strncpy(nombre_corto, b->dispensadores[ing].nombre, 14);
-                    nombre_corto[14] = '\0';
+    /** @brief Cheeseburger: pan_inferior, carne, queso, lechuga, tomate, pan_superior */
+    {{ESTACION_TOSTADOR, 1, 0}, {ESTACION_PLANCHA, 2, 0}, {ESTACION_PLANCHA, 1, 1 << 1}, {ESTACION_FRIOS, 1, 0},
+     {ESTACION_FRIOS, 1, 0}, {ESTACION_ARMADO, 1, 0x1F}},
 
-                    int cantidad = b->dispensadores[ing].cantidad;
+    /** @brief BBQ Bacon: pan_inferior, carne, bacon, queso, cebolla, salsa_bbq, pan_superior */
+    {{ESTACION_TOSTADOR, 1, 0}, {ESTACION_PLANCHA, 2, 0}, {ESTACION_PLANCHA, 1, 0}, {ESTACION_PLANCHA, 1, 1 << 1},
+     {ESTACION_FRIOS, 1, 0}, {ESTACION_ARMADO, 1, 1 << 0}, {ESTACION_ARMADO, 1, 0x3F}},
 
-                    if (cantidad == 0)
-                    {
-                        sprintf(lineas_inventario[col], "%-14s: %2d [AGOTADO]", nombre_corto, cantidad);
-                    }
-                    else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
-                    {
-                        sprintf(lineas_inventario[col], "%-14s: %2d [CRITICO]", nombre_corto, cantidad);
-                    }
-                    else
-                    {
-                        sprintf(lineas_inventario[col], "%-14s: %2d", nombre_corto, cantidad);
-                    }
+    /** @brief Vegetariana: pan_inferior, vegetal, lechuga, tomate, aguacate, mayonesa, pan_superior */
+    {{ESTACION_TOSTADOR, 1, 0}, {ESTACION_PLANCHA, 2, 0}, {ESTACION_FRIOS, 1, 0}, {ESTACION_FRIOS, 1, 0},
+     {ESTACION_FRIOS, 1, 0}, {ESTACION_ARMADO, 1, 1 << 0}, {ESTACION_ARMADO, 1, 0x3F}},
 
-                    pthread_mutex_unlock(&b->dispensadores[ing].mutex);
-                }
-                else
-                {
-                    strcpy(lineas_inventario[col], "");
-                }
-            }
+    /** @brief Deluxe: pan_inferior, carne, queso, bacon, lechuga, tomate, cebolla, mayonesa, pan_superior */
+    {{ESTACION_TOSTADOR, 1, 0}, {ESTACION_PLANCHA, 2, 0}, {ESTACION_PLANCHA, 1, 1 << 1}, {ESTACION_PLANCHA, 1, 0},
+     {ESTACION_FRIOS, 1, 0}, {ESTACION_FRIOS, 1, 0}, {ESTACION_FRIOS, 1, 0}, {ESTACION_ARMADO, 1, 1 << 0},
+     {ESTACION_ARMADO, 1, 0xFF}},
+
+    /** @brief Spicy Mexican: pan_inferior, carne, queso, jalapenos, tomate, cebolla, salsa_picante, pan_superior */
+    {{ESTACION_TOSTADOR, 1, 0}, {ESTACION_PLANCHA, 2, 0}, {ESTACION_PLANCHA, 1, 1 << 1}, {ESTACION_FRIOS, 1, 0},
+     {ESTACION_FRIOS, 1, 0}, {ESTACION_FRIOS, 1, 0}, {ESTACION_ARMADO, 1, 1 << 0}, {ESTACION_ARMADO, 1, 0x7F}}};
+
+/**
+ * @brief Lista completa de ingredientes base disponibles en el sistema
+ *
+ * Define todos los ingredientes que pueden estar presentes en cualquier
+ * hamburguesa. Cada banda tiene dispensadores para todos estos ingredientes,
+ * permitiendo preparar cualquier tipo de hamburguesa del menú.
+ */
+char ingredientes_base[MAX_INGREDIENTES][MAX_NOMBRE_INGREDIENTE] = {
+    "pan_inferior", "pan_superior", "carne", "queso", "tomate",
+    "lechuga", "cebolla", "bacon", "mayonesa", "jalapenos",
+    "aguacate", "vegetal", "salsa_bbq", "salsa_picante", "pepinillos"};
+
+/**
+ * @defgroup funciones_formato Funciones Auxiliares para Formato de Pantalla
+ * @{
+ *
+ * Este grupo de funciones proporciona utilidades para formatear y mostrar
+ * información en la consola de manera estructurada y legible. Incluye
+ * funciones para centrar texto, crear tablas y manejar buffers de formato.
+ */
+
+/** @brief Buffers circulares para formateo de texto (evita desbordamientos) */
+static char format_buffers[8][50];
+
+/** @brief Índice del buffer actual en uso (implementa rotación circular) */
+static int current_buffer = 0;
+
+/**
+ * @brief Formatea un texto para que tenga un ancho fijo específico
+ *
+ * Esta función toma un texto de entrada y lo ajusta al ancho especificado.
+ * Si el texto es más largo que el ancho, se trunca y se añaden puntos suspensivos.
+ * Si es más corto, se rellena con espacios en blanco.
+ *
+ * @param texto Puntero al texto de entrada (puede ser NULL)
+ * @param ancho Ancho deseado para el texto formateado
+ * @return Puntero al buffer formateado (no liberar, es buffer interno)
+ *
+ * @note Utiliza un sistema de buffers circulares para evitar desbordamientos
+ * @note Si ancho < 3, se rellena completamente con puntos
+ */
+char *formatear_texto_fijo(const char *texto, int ancho)
+{
+    // Rotar al siguiente buffer disponible
+    current_buffer = (current_buffer + 1) % 8;
+    char *buffer = format_buffers[current_buffer];
+
+    // Inicializar buffer con espacios en blanco
+    memset(buffer, ' ', ancho);
+    buffer[ancho] = '\0';
+
+    // Manejar casos especiales
+    if (texto == NULL || strlen(texto) == 0)
+    {
+        return buffer;
+    }
+
+    int len = strlen(texto);
+    if (len <= ancho)
+    {
+        // Texto cabe completamente
+        memcpy(buffer, texto, len);
+    }
+    else
+    {
+        // Texto es muy largo, truncar con "..."
+        if (ancho >= 3)
+        {
+            memcpy(buffer, texto, ancho - 3);
+            memcpy(buffer + ancho - 3, "...", 3);
+        }
+        else
+        {
+            // Ancho muy pequeño, rellenar con puntos
+            memset(buffer, '.', ancho);
+        }
+    }
+    return buffer;
+}
+
+/**
+ * @brief Centra un texto dentro de un ancho específico
+ *
+ * Esta función toma un texto y lo centra horizontalmente dentro del ancho
+ * especificado, rellenando con espacios en blanco a ambos lados.
+ * Si el texto es más largo que el ancho, se delega a formatear_texto_fijo().
+ *
+ * @param texto Puntero al texto a centrar (puede ser NULL)
+ * @param ancho Ancho total disponible para centrar el texto
+ * @return Puntero al buffer con el texto centrado (no liberar, es buffer interno)
+ *
+ * @note Utiliza el mismo sistema de buffers circulares que formatear_texto_fijo()
+ * @note Si el texto es NULL, retorna un buffer lleno de espacios
+ */
+char *centrar_texto(const char *texto, int ancho)
+{
+    // Rotar al siguiente buffer disponible
+    current_buffer = (current_buffer + 1) % 8;
+    char *buffer = format_buffers[current_buffer];
+
+    // Inicializar buffer con espacios en blanco
+    memset(buffer, ' ', ancho);
+    buffer[ancho] = '\0';
+
+    // Manejar texto NULL
+    if (texto == NULL)
+        return buffer;
+
+    int len = strlen(texto);
+    if (len >= ancho)
+    {
+        // Texto es muy largo, usar formateo fijo
+        return formatear_texto_fijo(texto, ancho);
+    }
+
+    // Calcular posición de inicio para centrar
+    int inicio = (ancho - len) / 2;
+    memcpy(buffer + inicio, texto, len);
+    return buffer;
+}
+
+/**
+ * @brief Imprime una línea de separación para tablas con formato personalizable
+ *
+ * Esta función crea líneas de separación para tablas, permitiendo especificar
+ * los caracteres de borde izquierdo, centro, derecho y el relleno interno.
+ * Es útil para crear tablas con diferentes estilos de bordes.
+ *
+ * @param num_columnas Número de columnas en la tabla
+ * @param ancho_columna Ancho de cada columna (incluyendo bordes)
+ * @param izq Carácter o cadena para el borde izquierdo de la tabla
+ * @param centro Carácter o cadena para separar columnas internas
+ * @param der Carácter o cadena para el borde derecho de la tabla
+ * @param relleno Carácter o cadena para rellenar el espacio interno de las columnas
+ *
+ * @note Ejemplo de uso: imprimir_linea_separacion(3, 20, "╔", "╦", "╗", "═")
+ * @note Produce: ╔══════════════════╦══════════════════╦══════════════════╗
+ */
+void imprimir_linea_separacion(int num_columnas, int ancho_columna, const char *izq, const char *centro, const char *der, const char *relleno)
+{
+    for (int col = 0; col < num_columnas; col++)
+    {
+        if (col == 0)
+        {
+            // Primera columna: borde izquierdo
+            printf("%s", izq);
+        }
+
+        // Rellenar el contenido de la columna
+        for (int i = 0; i < ancho_columna - 2; i++)
+        {
+            printf("%s", relleno);
+        }
+
+        if (col == num_columnas - 1)
+        {
+            // Última columna: borde derecho
+            printf("%s", der);
+        }
+        else
+        {
+            // Columnas intermedias: separador
+            printf("%s", centro);
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Imprime una fila de contenido de tabla con formato uniforme
+ *
+ * Esta función toma un array de contenidos y los imprime en formato de tabla,
+ * aplicando formateo consistente a cada columna y separando las columnas
+ * con espacios para mejor legibilidad.
+ *
+ * @param contenidos Array bidimensional con el contenido de cada columna
+ * @param num_columnas Número de columnas a imprimir
+ * @param ancho_columna Ancho total de cada columna (incluyendo bordes)
+ *
+ * @note Cada contenido se formatea automáticamente al ancho de la columna
+ * @note Las columnas se separan con dos espacios para mejor legibilidad
+ * @note Utiliza caracteres Unicode para bordes de tabla (║)
+ */
+void imprimir_fila_contenido(char contenidos[][50], int num_columnas, int ancho_columna)
+{
+    for (int col = 0; col < num_columnas; col++)
+    {
+        // Imprimir contenido de la columna con bordes y formateo
+        printf("║%s║", formatear_texto_fijo(contenidos[col], ancho_columna - 2));
+
+        // Separar columnas con espacios (excepto la última)
+        if (col < num_columnas - 1)
+        {
+            printf("  ");
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @defgroup prototipos Prototipos de Funciones del Sistema
+ * @{
+ *
+ * Declaraciones de todas las funciones principales del sistema, organizadas
+ * por categorías funcionales para facilitar la comprensión del código.
+ */
+
+// ============================================================================
+// FUNCIONES DE INICIALIZACIÓN Y CONFIGURACIÓN
+// ============================================================================
+
+/**
+ * @brief Inicializa el sistema completo con la configuración especificada
+ * @param num_bandas Número de bandas de preparación a crear
+ * @param tiempo_ingrediente Tiempo en segundos para procesar cada ingrediente
+ * @param tiempo_orden Tiempo en segundos entre generación de nuevas órdenes
+ */
+void inicializar_sistema(int num_bandas, int tiempo_ingrediente, int tiempo_orden);
+
+/**
+ * @brief Muestra el menú completo de hamburguesas disponibles
+ * @note Se ejecuta automáticamente al inicializar el sistema
+ */
+void mostrar_menu_hamburguesas();
+
+// ============================================================================
+// FUNCIONES DE HILOS DE TRABAJO (WORKER THREADS)
+// ============================================================================
+
+/**
+ * @brief Función principal del hilo de cada banda de preparación
+ * @param arg Puntero al ID de la banda (int*)
+ * @return NULL al terminar
+ */
+void *banda_worker(void *arg);
+
+/**
+ * @brief Hilo que genera órdenes de hamburguesas automáticamente
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ */
+void *generador_ordenes(void *arg);
+
+/**
+ * @brief Crea una orden, la admite en la cola y la anuncia
+ * @param id_orden Número de la orden
+ * @param cliente Cliente de la población cerrada que la pide o SIN_CLIENTE
+ * @return 1 si entró a la cola, 0 si se rechazó por cola llena
+ */
+int emitir_orden(int id_orden, int cliente);
+
+/**
+ * @brief Emite las órdenes de los clientes que terminaron de pensar
+ * @param contador_ordenes Siguiente número de orden (se avanza por cada orden emitida)
+ * @param semilla Semilla del sorteo de reflexiones (solo la usa el generador)
+ * @return Milisegundos reales hasta el próximo regreso (0 si conviene revisar de nuevo enseguida)
+ */
+long long atender_clientes(int *contador_ordenes, unsigned int *semilla);
+
+/**
+ * @brief Avisa al cliente de una orden que esta salió del sistema
+ *
+ * Se llama en cada desenlace (entregada, cancelada, expirada o rechazada). El
+ * cliente pasa a pensar y el generador vuelve a ordenar por él al terminar.
+ * @param orden Orden que sale; no hace nada si no tiene cliente
+ */
+void liberar_cliente(const Orden *orden);
+
+/**
+ * @brief Hilo que asigna órdenes a las bandas disponibles
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ */
+void *asignador_ordenes(void *arg);
+
+/**
+ * @brief Hilo que monitorea el inventario de todas las bandas
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ */
+void *monitor_inventario(void *arg);
+
+/**
+ * @brief Hilo que publica cada segundo la instantánea de métricas
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ */
+void *publicador_metricas(void *arg);
+
+/**
+ * @brief Hilo que graba cada INTERVALO_DIARIO_MS un cuadro del diario de estado
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ */
+void *escritor_diario(void *arg);
+
+/**
+ * @brief Hilo que cada PERIODO_ARCHIVO_MS consolida las métricas en el archivo persistente
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ * @note Escribe una última muestra con el sistema ya detenido
+ */
+void *archivador_metricas(void *arg);
+
+// ============================================================================
+// FUNCIONES DE MÉTRICAS
+// ============================================================================
+
+/**
+ * @brief Obtiene el reloj monotónico del sistema en milisegundos
+ * @return Milisegundos desde un origen arbitrario pero común a todos los procesos
+ */
+long long reloj_ms();
+
+/**
+ * @brief Registra la latencia de una orden completada en el histograma
+ * @param latencia_ms Tiempo transcurrido desde la creación hasta la entrega
+ */
+void registrar_latencia_orden(long long latencia_ms);
+
+/**
+ * @brief Calcula un percentil a partir del histograma de latencias
+ * @param percentil Percentil deseado (0-100)
+ * @return Latencia en milisegundos (límite superior de la cubeta) o 0 sin muestras
+ */
+int calcular_percentil_latencia(float percentil);
+
+/**
+ * @brief Calcula un percentil de cualquier histograma con las cubetas del de latencias
+ * @param histograma Array de NUM_CUBETAS_LATENCIA cubetas
+ * @param muestras Suma de las cubetas
+ * @param percentil Percentil deseado (0-100)
+ * @return Latencia en milisegundos (límite superior de la cubeta) o 0 sin muestras
+ */
+int percentil_histograma(const int *histograma, int muestras, float percentil);
+
+/**
+ * @brief Registra la diferencia entre la entrega real y la hora prometida de una orden
+ * @param error_ms Entrega real menos hora prometida, en ms simulados
+ */
+void registrar_error_eta(long long error_ms);
+
+/**
+ * @brief Lote de MSER que corresponde al instante simulado actual
+ *
+ * Si cae fuera de los MAX_LOTES_MSER guardados, funde los lotes de a pares
+ * (duran el doble) hasta que entre. Los lotes anteriores ya están cerrados.
+ * @return Índice del lote abierto
+ * @note El llamador debe tener tomado mutex_latencias
+ */
+int lote_mser_actual();
+
+/**
+ * @brief Suma una entrega al lote de MSER de su instante simulado
+ * @param latencia_ms Latencia de la orden (ms simulados)
+ * @note El llamador debe tener tomado mutex_latencias
+ */
+void anotar_entrega_mser(long long latencia_ms);
+
+/**
+ * @brief Da por cerrados los lotes de MSER cuyo intervalo simulado ya terminó
+ * @return 1 si se cerró algún lote desde la llamada anterior, 0 si no
+ * @note Solo la llaman el publicador de métricas y, ya sin publicador, el hilo principal
+ */
+int cerrar_lotes_mser();
+
+/**
+ * @brief Truncamiento de MSER: los lotes del frente cuyo descarte minimiza el error estándar del resto
+ * @param serie Medias por lote
+ * @param n Lotes de la serie
+ * @return Lotes a descartar, o -1 si el mínimo cae en la segunda mitad (calentamiento aún en curso)
+ */
+int truncamiento_mser(const double *serie, int n);
+
+/**
+ * @brief Detecta el calentamiento con MSER-5 y estima throughput y latencia del estado estacionario
+ * @param estimacion Destino; calentamiento_s queda en -1 si aún no hay estado estacionario
+ * @note Usa los lotes cerrados; la llama el publicador o el hilo principal ya sin publicador
+ */
+void estimar_estacionario(EstimacionEstacionaria *estimacion);
+
+/**
+ * @brief Imprime el estado estacionario estimado al terminar junto a los valores desde el arranque
+ */
+void mostrar_estacionario();
+
+/**
+ * @brief Factor de duración de un paso preparado para un lote
+ * @param tamano Órdenes del lote
+ * @return tamano^exponente_lote (1 para una orden suelta)
+ */
+double factor_lote(int tamano);
+
+/**
+ * @brief Duración real estimada de la preparación completa de un lote de hamburguesas iguales
+ * @param banda_id Banda que lo prepara (sus velocidades cambian la duración)
+ * @param tipo Índice en menu_hamburguesas
+ * @param tamano Órdenes del lote (1 para una orden suelta)
+ * @return Milisegundos de reloj real (ingredientes más el tiempo final, escalados con factor_lote)
+ */
+long long duracion_preparacion_ms(int banda_id, int tipo, int tamano);
+
+/**
+ * @brief Factor de velocidad de un paso en una banda: el de la banda por el de la estación del ingrediente
+ * @param banda Banda que hace el paso
+ * @param ingrediente Nombre del ingrediente del paso
+ * @return Factor (1 = tiempo_por_ingrediente sin cambios, 2 = el paso dura la mitad)
+ */
+float factor_paso(const Banda *banda, const char *ingrediente);
+
+/**
+ * @brief Tiempo que le falta a una banda para terminar una receta desde un paso
+ * @param banda Banda que la prepara
+ * @param tipo Índice en menu_hamburguesas
+ * @param desde Primer paso que falta (0 para la receta completa)
+ * @param tamano Órdenes del lote
+ * @return Milisegundos simulados, con el tiempo final, escalados por el lote y las velocidades de la banda
+ */
+long long duracion_restante_ms(const Banda *banda, int tipo, int desde, int tamano);
+
+/**
+ * @brief Arma el calendario de un tipo de hamburguesa con su DAG de pasos
+ *
+ * Planificación por lista con prioridad de ruta crítica: en cada unidad de
+ * tiempo, cada estación libre empieza, de entre los pasos cuyos previos ya
+ * terminaron, el de mayor nivel (su duración más el camino más largo que le
+ * sigue hasta el cierre de la receta).
+ *
+ * @param tipo Índice en menu_hamburguesas y pasos_receta
+ * @param plan Recibe el calendario, la ruta crítica y la suma secuencial
+ */
+void planificar_receta(int tipo, PlanReceta *plan);
+
+/**
+ * @brief Arma planes_receta: con --dag por ruta crítica, si no paso a paso
+ * @note Debe llamarse antes de generar órdenes: los ingredientes de cada orden se copian en el orden del calendario
+ */
+void planificar_recetas();
+
+/**
+ * @brief Registra la duración real de una preparación entregada junto a su ruta crítica
+ * @param tipo Tipo de hamburguesa preparado
+ * @param tamano Órdenes con que empezó el lote
+ * @param duracion_ms Duración real en ms simulados, desde que la banda la tomó hasta la entrega
+ */
+void registrar_preparacion(int tipo, int tamano, long long duracion_ms);
+
+/**
+ * @brief Configura la parrilla y las tolvas compartidas según --parrillas y --tolvas
+ * @param num_bandas Bandas de la cocina
+ */
+void inicializar_recursos(int num_bandas);
+
+/**
+ * @brief Recurso compartido que necesita un paso de una banda
+ * @param banda_id Banda que hace el paso
+ * @param ingrediente Ingrediente del paso
+ * @return Índice en DatosCompartidos.recursos, o -1 si el paso solo usa equipo propio de la banda
+ */
+int recurso_de_paso(int banda_id, const char *ingrediente);
+
+/**
+ * @brief Toma un lugar del recurso, esperando turno si está lleno
+ * @param indice Índice del recurso
+ * @param banda Banda que lo pide (publica latidos mientras espera para que el vigilante no la rescate)
+ * @note No debe llamarse con el mutex de la banda tomado
+ */
+void adquirir_recurso(int indice, Banda *banda);
+
+/**
+ * @brief Suelta un lugar del recurso y despierta a quien espera turno
+ * @param indice Índice del recurso
+ */
+void liberar_recurso(int indice);
+
+/**
+ * @brief Suelta los recursos de los pasos que terminaron
+ * @param recursos Recursos tomados por la banda; se compacta
+ * @param fines Unidad del calendario en que termina cada paso que los tomó
+ * @param num Número de recursos tomados; se actualiza
+ * @param hasta Unidad actual del calendario (INT_MAX suelta todos)
+ */
+void soltar_recursos(int recursos[], int fines[], int *num, int hasta);
+
+/**
+ * @brief Suma a la integral de ocupación los lugares usados desde el último cambio
+ * @param recurso Recurso con su mutex tomado
+ */
+void acumular_ocupacion(RecursoCompartido *recurso);
+
+/**
+ * @brief Marca qué tipos de hamburguesa puede preparar cada banda operativa con su inventario
+ * @param puede_servir Recibe 1 en [banda][tipo] si la banda está operativa y tiene todos los ingredientes
+ * @note Lee las bandas sin mutex, como la instantánea: el asignador verifica después con bloqueo
+ */
+void calcular_bandas_servibles(int puede_servir[MAX_BANDAS][NUM_TIPOS_HAMBURGUESA]);
+
+/**
+ * @brief Ingreso por segundo simulado de preparación de un tipo de hamburguesa
+ * @param tipo Índice en menu_hamburguesas
+ * @return Precio dividido entre la duración de la preparación
+ */
+float valor_por_segundo(int tipo);
+
+/**
+ * @brief Elige la orden que toma la política por valor entre las primeras de la cola
+ * @param tipos Tipo de hamburguesa de cada orden, en orden de cola
+ * @param adelantos Veces que cada orden ya fue adelantada
+ * @param n Número de órdenes (solo se miran las VENTANA_EQUIDAD primeras)
+ * @param servible Por tipo, 1 si alguna banda libre puede prepararlo ahora
+ * @return Índice elegido, o -1 si ninguna orden de la ventana puede asignarse ahora
+ * @note Una orden adelantada MAX_ADELANTOS veces pasa primero en cuanto pueda asignarse
+ */
+int elegir_orden_por_valor(const int tipos[], const int adelantos[], int n, const int servible[]);
+
+/**
+ * @brief Recalcula la hora estimada de entrega de todas las órdenes en cola
+ *
+ * Simula el asignador sobre el estado actual: cada banda operativa queda libre
+ * cuando termine su orden en curso; la cabeza de la cola va a la primera banda
+ * libre con ingredientes y, si no hay, pasa al final tras la espera de
+ * reintento, como en asignador_ordenes. Las órdenes que agotarían sus intentos
+ * o que ninguna banda puede preparar quedan sin ETA. La primera estimación de
+ * cada orden queda como su hora prometida.
+ *
+ * @note El llamador debe tener tomado el mutex de la cola de espera
+ */
+void actualizar_etas_cola();
+
+/**
+ * @brief Estima la ETA de una orden recién puesta al final de la cola
+ *
+ * Con órdenes delante parte de la hora en que cada banda queda libre tras la
+ * cola según el último recálculo completo (o la última estimación incremental),
+ * nunca antes de que termine su orden en curso, y asigna la orden a la primera
+ * banda que pueda prepararla sin volver a simular la cola. El recálculo
+ * completo de cada segundo corrige lo que esto no ve (lotes, política por
+ * valor, cambios de inventario). Sola en la cola se usa la simulación completa.
+ *
+ * @param orden Orden encolada; recibe su ETA y, si es la primera, su hora prometida
+ * @note El llamador debe tener tomado el mutex de la cola de espera
+ */
+void estimar_eta_al_final(Orden *orden);
+
+/**
+ * @brief Escribe una nueva instantánea de métricas protegida por seqlock
+ * @param throughput Hamburguesas por minuto calculadas por el publicador
+ * @param llegadas Órdenes nuevas por minuto calculadas por el publicador
+ * @param ingresos Ingresos por minuto calculados por el publicador
+ */
+void publicar_instantanea(float throughput, float llegadas, float ingresos);
+
+// ============================================================================
+// FUNCIONES DE TIEMPO SIMULADO Y ESCENARIOS
+// ============================================================================
+
+/**
+ * @brief Tiempo simulado transcurrido desde el arranque
+ * @return Milisegundos simulados (reales multiplicados por la aceleración)
+ */
+long long tiempo_simulado_ms();
+
+/**
+ * @brief Duerme un intervalo de tiempo simulado
+ * @param ms Milisegundos simulados; en tiempo real duran ms / aceleracion
+ */
+void dormir_simulado(long long ms);
+
+/**
+ * @brief Carga y valida un archivo de escenario
+ * @param ruta Ruta del archivo
+ * @param num_bandas Número de bandas configuradas (para validar los argumentos)
+ * @return 1 si el escenario es válido, 0 en caso contrario
+ */
+int cargar_escenario(const char *ruta, int num_bandas);
+
+/**
+ * @brief Ejecuta la acción de un evento de escenario
+ * @param evento Evento a ejecutar
+ */
+void aplicar_evento_escenario(const EventoEscenario *evento);
+
+/**
+ * @brief Hilo que ejecuta los eventos del escenario en su instante simulado
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ */
+void *ejecutor_escenario(void *arg);
+
+// ============================================================================
+// FUNCIONES DEL VIGILANTE DE BANDAS
+// ============================================================================
+
+/**
+ * @brief Publica el latido de progreso de una banda al empezar un paso
+ * @param banda Banda que avanza
+ * @param duracion_simulada_ms Duración simulada esperada del paso (0 deja de vigilarla)
+ */
+void publicar_latido(Banda *banda, long long duracion_simulada_ms);
+
+/**
+ * @brief Quita la orden a una banda atascada y la devuelve a la cola
+ * @param banda_id ID de la banda atascada
+ * @param generacion Generación con la que se asignó la orden
+ * @return 1 si el vigilante se quedó con la orden, 0 si la banda ya la había cerrado
+ */
+int rescatar_orden(int banda_id, unsigned int generacion);
+
+/**
+ * @brief Hilo que revisa los latidos y rescata órdenes de bandas atascadas
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ */
+void *vigilante_bandas(void *arg);
+
+// ============================================================================
+// FUNCIONES DE CONTADORES DE EVENTOS
+// ============================================================================
+
+/**
+ * @brief Inicializa un mutex de la memoria compartida para usarlo desde varios procesos
+ * @param mutex Mutex a inicializar
+ */
+void iniciar_mutex_compartido(pthread_mutex_t *mutex);
+
+/**
+ * @brief Espera o despierta sobre una palabra de memoria compartida (futex)
+ *
+ * Única entrada a la llamada al sistema: la usan los contadores de eventos y
+ * el buzón de comandos.
+ * @param palabra Palabra del futex (en memoria compartida entre procesos)
+ * @param operacion FUTEX_WAIT o FUTEX_WAKE
+ * @param valor Con FUTEX_WAIT, valor esperado; con FUTEX_WAKE, hilos a despertar
+ * @param espera_us Con FUTEX_WAIT, espera máxima en microsegundos (reloj monotónico) o SIN_LIMITE
+ * @return Resultado de la llamada al sistema
+ */
+long llamada_futex(unsigned int *palabra, int operacion, unsigned int valor, long long espera_us);
+
+/**
+ * @brief Lee la clave de un contador de eventos
+ * @param eventos Contador de eventos
+ * @return Clave para esperar_eventos
+ * @note Se lee antes de revisar la condición: una notificación posterior corta la espera
+ */
+unsigned int leer_eventos(ContadorEventos *eventos);
+
+/**
+ * @brief Espera a que el contador avance desde la clave, o a que se acabe el tiempo
+ * @param eventos Contador de eventos
+ * @param clave Clave leída antes de revisar la condición
+ * @param espera_us Espera máxima en microsegundos reales, o SIN_LIMITE
+ * @note Sin mutex tomado; si el contador ya avanzó vuelve sin llamar al sistema
+ */
+void esperar_eventos(ContadorEventos *eventos, unsigned int clave, long long espera_us);
+
+/**
+ * @brief Avanza el contador y despierta a los hilos que esperan, de este u otro proceso
+ * @param eventos Contador de eventos
+ * @param despertar DESPERTAR_UNO o DESPERTAR_TODOS
+ * @note Se llama después de cambiar la condición; sin nadie esperando no llama al sistema.
+ *       Es segura dentro de un manejador de señales
+ */
+void notificar_eventos(ContadorEventos *eventos, int despertar);
+
+// ============================================================================
+// FUNCIONES DEL BUZÓN DE COMANDOS
+// ============================================================================
+
+
+/**
+ * @brief Reabastece en una sola pasada por banda los dispensadores que pide el comando
+ * @param comando COMANDO_REABASTECER (modo, banda e ingrediente) o COMANDO_APLICAR_PLAN
+ *        (recargas); recibe el resultado agregado
+ * @note Toma los mutex de los dispensadores de cada banda en orden de índice y
+ *       publica una sola versión de inventario por banda
+ */
+void aplicar_reabastecimiento_masivo(BuzonComandos *comando);
+
+/**
+ * @brief Despierta al asignador para que reintente las órdenes en espera
+ */
+void despertar_asignador();
+
+/**
+ * @brief Espera un intervalo simulado o hasta el próximo reabastecimiento
+ * @param generacion Generación de reabastecimiento leída antes del intento fallido
+ * @param ms Espera máxima en milisegundos simulados
+ */
+void esperar_reabastecimiento(unsigned int generacion, long long ms);
+
+/**
+ * @brief Hilo que aplica los comandos publicados en el buzón
+ * @param arg Parámetro no utilizado (NULL)
+ * @return NULL al terminar
+ */
+void *procesador_comandos(void *arg);
+
+// ============================================================================
+// FUNCIONES DE PROCESAMIENTO DE ÓRDENES
+// ============================================================================
+
+/**
+ * @brief Procesa una orden completa (o el lote que encabeza) en la banda especificada
+ * @param banda_id ID de la banda que procesará la orden
+ * @param orden Puntero a la orden a procesar
+ * @param generacion Generación con la que se asignó la orden
+ * @return 1 si la banda completó la orden, 0 si el vigilante la rescató antes,
+ *         -1 si se cancelaron todas las órdenes del lote
+ * @note Cada paso dura factor_lote(tamano_lote) veces el tiempo por ingrediente
+ */
+int procesar_orden(int banda_id, Orden *orden, unsigned int generacion);
+
+/**
+ * @brief Verifica si una banda tiene suficientes ingredientes para una orden
+ * @param banda_id ID de la banda a verificar
+ * @param orden Puntero a la orden a verificar
+ * @return 1 si hay suficientes ingredientes, 0 en caso contrario
+ */
+int verificar_ingredientes_banda(int banda_id, Orden *orden);
+
+/**
+ * @brief Forma el lote de una orden y reserva sus ingredientes en la banda
+ *
+ * Con la cola bloqueada toma hasta tamano_lote_maximo - 1 órdenes del mismo
+ * tipo entre las primeras VENTANA_EQUIDAD, bloquea los dispensadores de la
+ * receta en orden de índice y descuenta de una vez las unidades del lote más
+ * grande que alcanzan a cubrir. Las órdenes que no entran se quedan en la cola.
+ *
+ * @param banda_id ID de la banda libre elegida para la orden
+ * @param orden Orden ya extraída de la cola que encabeza el lote
+ * @param extras Recibe las demás órdenes del lote, en orden de cola
+ * @return Órdenes en extras, o -1 si la banda ya no tiene ingredientes ni para la orden
+ */
+int reservar_lote(int banda_id, Orden *orden, Orden extras[MAX_LOTE - 1]);
+
+/**
+ * @brief Devuelve a los dispensadores de una banda los ingredientes reservados que una orden no usó
+ * @param banda Banda que tenía la orden
+ * @param orden Orden cancelada
+ * @param desde_paso Primer paso de la receta que la banda no llegó a hacer
+ */
+void devolver_ingredientes(Banda *banda, const Orden *orden, int desde_paso);
+
+/**
+ * @brief Atiende las cancelaciones pendientes del lote en curso de una banda
+ * @param banda Banda que prepara el lote
+ * @param paso Paso de la receta que está por hacer (lo anterior ya se usó)
+ * @return Órdenes del lote que siguen vigentes
+ * @note El llamador debe tener tomado el mutex de la banda
+ */
+int atender_cancelaciones_lote(Banda *banda, int paso);
+
+/**
+ * @brief Encuentra una banda disponible para procesar una orden
+ * @param orden Puntero a la orden que necesita asignación
+ * @return ID de la banda disponible o -1 si no hay ninguna
+ */
+int encontrar_banda_disponible(Orden *orden);
+
+/**
+ * @brief Indica si una receta es de las largas del menú (al menos el promedio de pasos)
+ * @param tipo Índice en menu_hamburguesas
+ * @return 1 si es larga, 0 si es corta
+ */
+int receta_larga(int tipo);
+
+/**
+ * @brief Compara dos bandas libres para una receta según sus velocidades
+ *
+ * Cada receta va a la banda que la termina antes, salvo una corta con órdenes
+ * esperando detrás: esa va a la banda más lenta en general y deja las rápidas
+ * para las largas. Con bandas iguales o --primera-libre se queda con la
+ * primera, como siempre.
+ *
+ * @param tipo Índice en menu_hamburguesas
+ * @param candidata Banda que se evalúa
+ * @param actual Banda elegida hasta ahora (-1 si ninguna)
+ * @return 1 si candidata reemplaza a actual
+ */
+int preferir_banda(int tipo, int candidata, int actual);
+
+// ============================================================================
+// FUNCIONES DE GESTIÓN DE LOGS E INVENTARIO
+// ============================================================================
+
+/**
+ * @brief Añade una entrada de log a una banda específica
+ * @param banda_id ID de la banda donde se registrará el log
+ * @param mensaje Texto del mensaje a registrar
+ * @param es_alerta 1 si es una alerta crítica, 0 si es información normal
+ */
+void agregar_log_banda(int banda_id, const char *mensaje, int es_alerta);
+
+/**
+ * @brief Verifica el estado del inventario de una banda y genera alertas
+ * @param banda_id ID de la banda a verificar
+ */
+void verificar_inventario_banda(int banda_id);
+
+/**
+ * @brief Abre una escritura del inventario de una banda (deja su versión impar)
+ *
+ * Espera a que termine otro escritor. Se llama con los mutex de los
+ * dispensadores ya tomados y no se toma ningún mutex hasta cerrarla.
+ * @param banda Banda cuyo inventario se va a modificar
+ */
+void abrir_escritura_inventario(Banda *banda);
+
+/**
+ * @brief Cierra la escritura del inventario de una banda (deja su versión par)
+ * @param banda Banda cuyo inventario se modificó
+ */
+void cerrar_escritura_inventario(Banda *banda);
+
+/**
+ * @brief Registra un cambio de estado en la línea de tiempo de una banda
+ * @param banda Banda que cambia de estado
+ * @param estado Nuevo estado (ESTADO_LINEA_*)
+ * @param tipo_hamburguesa Tipo en preparación o -1
+ * @note Solo debe llamarse desde el hilo de la propia banda (único escritor)
+ * @note No registra nada si el estado y el tipo no cambiaron
+ */
+void registrar_transicion_banda(Banda *banda, int estado, int tipo_hamburguesa);
+
+// ============================================================================
+// FUNCIONES DE GESTIÓN DE COLA FIFO
+// ============================================================================
+
+/**
+ * @brief Añade una orden al final de la cola de espera
+ * @param orden Puntero a la orden a encolar; recibe la hora estimada de entrega que se le asignó
+ * @note Si la cola está llena espera a que haya lugar
+ */
+void encolar_orden(Orden *orden);
+
+/**
+ * @brief Encola una orden nueva si la cola no llegó a su límite de admisión
+ * @param orden Puntero a la orden a encolar; recibe la hora estimada de entrega que se le asignó
+ * @return 1 si se encoló, 0 si se rechazó (quedan solo los lugares de RESERVA_REENCOLADO)
+ */
+int admitir_orden(Orden *orden);
+
+/**
+ * @brief Copia una orden al final de la cola, la indexa y estampa su hora estimada de entrega
+ * @param orden Puntero a la orden a encolar; recibe la hora estimada de entrega
+ * @return 1 si se encoló, 0 si estaba cancelada y se dio de baja en su lugar
+ * @note El llamador debe tener tomado el mutex de la cola y garantizar que hay lugar
+ */
+int insertar_en_cola(Orden *orden);
+
+/**
+ * @brief Da de baja una orden cancelada que estaba fuera de la cola
+ * @param orden Orden cancelada
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+void dar_de_baja_cancelada(const Orden *orden);
+
+/**
+ * @brief Busca una orden viva en el índice
+ * @param id_orden Número de la orden
+ * @return Su entrada, o NULL si no está en el sistema
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+EntradaIndice *buscar_en_indice(int id_orden);
+
+/**
+ * @brief Devuelve la entrada de una orden en el índice, creándola si no existe
+ * @param id_orden Número de la orden
+ * @return Su entrada; CAPACIDAD_INDICE deja lugar para todas las órdenes vivas
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+EntradaIndice *indexar_orden(int id_orden);
+
+/**
+ * @brief Quita una orden del índice al salir del sistema
+ * @param id_orden Número de la orden (se ignora si no está)
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+void desindexar_orden(int id_orden);
+
+/**
+ * @brief Cancela una orden esté donde esté
+ *
+ * En la cola deja una lápida en su lugar; en una banda la marca para que la
+ * banda la suelte en su próximo paso; si el asignador la tiene en mano, se
+ * descarta cuando la entregue a una banda o la reencole.
+ *
+ * @param id_orden Número de la orden
+ * @return Dónde estaba (CANCELACION_*)
+ */
+int cancelar_orden(int id_orden);
+
+/**
+ * @brief Indica si el cliente de una orden ya se cansó de esperar
+ * @param orden Orden a revisar
+ * @param ahora Reloj monotónico actual (ms)
+ * @return 1 si pasó más de su paciencia_ms simulada desde su creación
+ */
+int orden_expirada(const Orden *orden, long long ahora);
+
+/**
+ * @brief Sortea la paciencia de un cliente con la distribución elegida
+ * @return Milisegundos simulados que espera antes de abandonar
+ */
+long long sortear_paciencia();
+
+/**
+ * @brief Prepara la rueda de paciencia vacía con todos sus nodos libres
+ */
+void iniciar_rueda_paciencia();
+
+/**
+ * @brief Arma el temporizador de una orden que acaba de entrar a la cola
+ * @param orden Orden ya copiada en la cola; guarda en ella el nodo asignado
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+void armar_paciencia(Orden *orden);
+
+/**
+ * @brief Desarma el temporizador de una orden que sale de la cola
+ * @param orden Orden con su campo temporizador (queda en -1)
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+void desarmar_paciencia(Orden *orden);
+
+/**
+ * @brief Retira de la cola las órdenes cuyos clientes abandonaron
+ *
+ * Revisa solo las casillas de la rueda que pasaron desde la última vez; un
+ * nodo de una vuelta posterior queda en su casilla.
+ * @param ahora Reloj monotónico actual (ms)
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+void avanzar_rueda_paciencia(long long ahora);
+
+/**
+ * @brief Tramo de cola al llegar (0 a TRAMOS_CARGA_ABANDONO-1) de un largo de cola
+ * @param en_cola Órdenes en la cola
+ * @return Índice del tramo
+ */
+int tramo_carga(int en_cola);
+
+/**
+ * @brief Imprime los abandonos por tramo de cola al llegar y los ingresos que se llevaron
+ */
+void mostrar_curva_abandonos();
+
+/**
+ * @brief Da de baja una orden expirada: la cuenta como perdida y la quita del índice
+ * @param orden Orden expirada
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+void registrar_orden_expirada(const Orden *orden);
+
+/**
+ * @brief Libera los lugares de las lápidas que quedaron al frente de la cola
+ * @note El llamador debe tener tomado el mutex de la cola
+ */
+void saltar_lapidas_frente();
+
+/**
+ * @brief Extrae la primera orden de la cola de espera
+ * @return Puntero a la orden extraída o NULL si la cola está vacía
+ */
+Orden *desencolar_orden();
+
+/**
+ * @brief Extrae la orden que elige la política por valor (ver elegir_orden_por_valor)
+ *
+ * Si ninguna orden de la ventana puede asignarse ahora extrae la cabeza, como
+ * desencolar_orden. Las órdenes que quedan por delante de la elegida anotan un
+ * adelanto más.
+ *
+ * @return Puntero a la orden extraída o NULL si la cola está vacía
+ */
+Orden *desencolar_orden_por_valor();
+
+// ============================================================================
+// FUNCIONES DE VISUALIZACIÓN Y MONITOREO
+// ============================================================================
+
+/**
+ * @brief Muestra el estado del sistema en formato de tabla columnar
+ * @note Formato detallado con múltiples columnas por banda
+ */
+void mostrar_estado_columnar();
+
+/**
+ * @brief Muestra el estado del sistema en formato compacto
+ * @note Formato resumido para pantallas pequeñas
+ */
+void mostrar_estado_compacto();
+
+/**
+ * @brief Muestra el estado del sistema adaptándose al tamaño de pantalla
+ * @note Selecciona automáticamente entre columnar y compacto
+ */
+void mostrar_estado_adaptativo();
+
+// ============================================================================
+// FUNCIONES DE UTILIDAD Y CONTROL
+// ============================================================================
+
+/**
+ * @brief Genera una orden específica con el ID proporcionado
+ * @param orden Puntero a la estructura de orden a llenar
+ * @param id ID único para la nueva orden
+ */
+void generar_orden_especifica(Orden *orden, int id);
+
+/**
+ * @brief Reabastece completamente el inventario de una banda
+ * @param banda_id ID de la banda a reabastecer
+ */
+void reabastecer_banda(int banda_id);
+
+/**
+ * @brief Lleva un dispensador a un nivel, al instante o programado para su banda
+ *
+ * Con --tiempo-reabasto el relleno queda pendiente y lo hace el hilo de la banda
+ * entre órdenes; sin él se aplica de inmediato. Requiere el mutex del dispensador
+ * y una escritura de inventario abierta por el llamador, que la abre una vez
+ * para todos los dispensadores de la banda que rellena.
+ * @param banda_id Banda del dispensador
+ * @param ingrediente Índice del dispensador
+ * @param objetivo Nivel deseado (hasta CAPACIDAD_DISPENSADOR)
+ * @return Unidades repuestas o programadas (0 si ya tenía ese nivel)
+ */
+int reponer_dispensador(int banda_id, int ingrediente, int objetivo);
+
+/**
+ * @brief Programa el relleno de los dispensadores que quedaron en umbral_reabasto o menos
+ * @param banda_id Banda que acaba de entregar una orden
+ */
+void programar_reabasto_por_umbral(int banda_id);
+
+/**
+ * @brief Órdenes en la cola sin contar lápidas, leídas sin tomar su mutex
+ * @return Órdenes que esperan banda
+ */
+int ordenes_en_espera();
+
+/**
+ * @brief Indica si la banda debe detenerse a rellenar antes de tomar otra orden
+ * @param banda Banda a revisar
+ * @param hay_espera 1 si hay órdenes esperando: entonces solo cuentan los rellenos urgentes
+ * @return 1 si tiene algún relleno programado que corresponde hacer ahora
+ */
+int reabasto_pendiente(Banda *banda, int hay_espera);
+
+/**
+ * @brief Rellena los dispensadores programados de la banda, uno a la vez
+ *
+ * Cada dispensador detiene la banda tiempo_reabasto_ms simulados. Los urgentes
+ * (UMBRAL_INVENTARIO_BAJO o menos) pasan antes que las órdenes en espera; los
+ * demás solo aprovechan los huecos y ceden en cuanto llega trabajo.
+ * @param banda_id Banda que rellena (solo desde su propio hilo)
+ */
+void ejecutar_reabastecimientos(int banda_id);
+
+/**
+ * @brief Crea el archivo de diario y escribe su cabecera
+ * @param ruta Ruta del archivo a crear (se sobrescribe si existe)
+ * @return 1 si se pudo crear, 0 en caso contrario
+ */
+int abrir_diario(const char *ruta);
+
+/**
+ * @brief Abre o crea el archivo de métricas y lo proyecta en memoria
+ * @param ruta Ruta del archivo; si existe debe tener el formato actual y se sigue escribiendo
+ * @return 1 si quedó listo, 0 si no se pudo abrir, es de otro formato u otra cocina lo escribe
+ */
+int abrir_archivo_metricas(const char *ruta);
+
+/**
+ * @brief Fila de una resolución del archivo de métricas que corresponde a un intervalo
+ * @param cabecera Archivo proyectado en memoria
+ * @param resolucion Índice de la resolución
+ * @param inicio_s Inicio del intervalo (múltiplo del paso) en segundos desde la época
+ * @return Fila del anillo; vale para ese intervalo solo si su inicio_s coincide
+ */
+FilaArchivo *fila_archivo(CabeceraArchivo *cabecera, int resolucion, long long inicio_s);
+
+/**
+ * @brief Escribe un cuadro del diario comparando el estado actual con el anterior
+ * @param actual Copia del estado en este instante
+ * @param anterior Copia del estado en el cuadro previo (ignorada si es_clave)
+ * @param es_clave 1 para escribir el estado completo, 0 para escribir solo el delta
+ * @param carga Buffer de trabajo para el delta (ver escritor_diario)
+ */
+void escribir_cuadro_diario(const DatosCompartidos *actual, const DatosCompartidos *anterior, int es_clave,
+                            unsigned char *carga);
+
+/**
+ * @brief Agrega una orden entregada al anillo de exportación
+ * @param orden Orden entregada
+ * @param banda_id Banda que la preparó
+ * @param tamano_lote Órdenes del lote en que se preparó
+ * @param inicio_ms Reloj monotónico al empezar el lote (ms)
+ * @param entrega_ms Reloj monotónico al entregarla (ms)
+ * @note Los instantes se guardan en ms simulados desde el arranque
+ */
+void exportar_orden_entregada(const Orden *orden, int banda_id, int tamano_lote, long long inicio_ms,
+                              long long entrega_ms);
+
+/**
+ * @brief Agrega una transición de banda al anillo de exportación
+ * @param banda_id Banda que cambió de estado
+ * @param estado Nuevo estado (ESTADO_LINEA_*)
+ * @param tipo_hamburguesa Hamburguesa en preparación, o -1
+ * @param marca_ms Reloj monotónico de la transición (ms)
+ */
+void exportar_transicion_banda(int banda_id, int estado, int tipo_hamburguesa, long long marca_ms);
+
+/**
+ * @brief Agrega la muestra de métricas de este segundo al anillo de exportación
+ * @param throughput Órdenes completadas por minuto en la ventana
+ * @param llegadas Órdenes generadas por minuto en la ventana
+ * @param ingresos Ingresos por minuto en la ventana
+ */
+void exportar_metricas(float throughput, float llegadas, float ingresos);
+
+/**
+ * @brief Escribe una tabla en un archivo Arrow IPC con un único lote
+ * @param ruta Archivo a crear (se sobrescribe si existe)
+ * @param columnas Columnas de la tabla
+ * @param num_columnas Número de columnas (máximo MAX_COLUMNAS_ARROW)
+ * @param filas Filas de cada columna
+ * @return 1 si se escribió completo, 0 en caso contrario
+ * @note Los buffers se escriben directamente desde la memoria de cada columna,
+ *       alineados a 8 bytes y en el orden de bytes de la máquina (little-endian),
+ *       para que los lectores puedan mapear el archivo sin copiarlo
+ */
+int escribir_arrow(const char *ruta, const ColumnaArrow *columnas, int num_columnas, long long filas);
+
+/**
+ * @brief Escribe ordenes.arrow, transiciones.arrow, metricas.arrow y menu.arrow en directorio_arrow
+ * @note Se llama al terminar y con la acción "exportar" de un escenario; los anillos
+ *       quedan bloqueados mientras se escriben
+ */
+void exportar_resultados_arrow();
+
+/**
+ * @brief Asocia el hilo en curso a su cuenta de CPU y toma la primera lectura
+ * @param componente Cuenta a usar (COMPONENTE_*)
+ * @param nombre Nombre que muestran el panel y las estadísticas
+ */
+void registrar_componente(int componente, const char *nombre);
+
+/**
+ * @brief Cuenta un despertar del hilo en curso y relee sus relojes si pasó INTERVALO_CUENTA_CPU_MS
+ * @note Solo hace llamadas al sistema; puede usarse con cualquier mutex tomado
+ */
+void contabilizar_despertar();
+
+/**
+ * @brief Toma la última lectura de CPU del hilo en curso y marca su cuenta como inactiva
+ */
+void cerrar_componente();
+
+/**
+ * @brief Calcula el uso de CPU y los despertares por segundo de cada cuenta y del proceso
+ * @note Lo llama el publicador de métricas una vez por segundo
+ */
+void actualizar_uso_cpu();
+
+/**
+ * @brief Mide el costo por operación del despacho y de la cola sin levantar los hilos
+ *
+ * - Despacho: encontrar_banda_disponible con todas las bandas menos la última
+ *   ocupadas, así recorre la flota y compara la receta con los dispensadores.
+ * - Cola: admitir_orden más desencolar_orden y su salida del índice, con la
+ *   cola a un cuarto de su capacidad para que el recálculo de ETA tenga trabajo.
+ *
+ * @return 0 al terminar
+ * @note Requiere el sistema inicializado y ningún hilo en ejecución
+ */
+int ejecutar_microbenchmarks();
+
+/**
+ * @brief Anota el desenlace de una orden para la prueba de estrés
+ *
+ * Lo llaman todos los caminos por los que una orden sale de la simulación:
+ * entrega, cancelación, expiración y rechazo por cola llena. Un segundo
+ * desenlace del mismo número es una orden duplicada.
+ *
+ * @param id_orden Número de la orden
+ * @note Sin --estres no hace nada
+ */
+void anotar_desenlace_estres(int id_orden);
+
+/**
+ * @brief Reserva el registro de desenlaces y desvía la salida de la simulación a /dev/null
+ * @return 1 si la prueba puede correr, 0 si no
+ * @note El informe de la prueba sale por la salida estándar original
+ */
+int preparar_estres();
+
+/**
+ * @brief Hilo que manda cancelaciones y reabastecimientos por el buzón, y pausa y avería bandas
+ * @param arg Número del inyector (semilla de su generador aleatorio)
+ * @return NULL
+ */
+void *inyector_comandos_estres(void *arg);
+
+/**
+ * @brief Hilo que reabastece bandas al azar sin pausa
+ * @param arg No usado
+ * @return NULL
+ */
+void *reabastecedor_estres(void *arg);
+
+/**
+ * @brief Verifica los invariantes con el sistema en marcha
+ *
+ * - Inventario: cada dispensador cuadra con su libro y está entre 0 y su capacidad.
+ * - Conservación: generadas = desenlaces + vivas (en cola o en bandas), salvo las
+ *   que están en tránsito entre dos estructuras, acotadas por los lotes en vuelo.
+ * - Monotonía: ningún contador acumulado retrocede.
+ */
+void verificar_invariantes_estres();
+
+/**
+ * @brief Corre la prueba de estrés con los hilos ya levantados y la termina
+ *
+ * Carga durante --estres segundos con pasos y esperas sin duración, luego deja
+ * de generar y de inyectar, vacía la cola y las bandas, detiene el sistema y
+ * comprueba que cada orden generada tuvo exactamente un desenlace.
+ *
+ * @return 0 si no hubo violaciones, 1 si las hubo
+ */
+int ejecutar_estres();
+
+/**
+ * @brief Limpia todos los recursos del sistema y termina los hilos
+ * @note Se ejecuta automáticamente al recibir señales de terminación
+ */
+void limpiar_sistema();
+
+/**
+ * @brief Manejador de señales del sistema operativo
+ * @param sig Número de la señal recibida
+ */
+void manejar_senal(int sig);
+
+/**
+ * @brief Valida y procesa los parámetros de línea de comandos
+ * @param argc Número de argumentos
+ * @param argv Array de argumentos
+ * @param num_bandas Puntero donde se almacenará el número de bandas
+ * @param tiempo_ingrediente Puntero donde se almacenará el tiempo por ingrediente
+ * @param tiempo_orden Puntero donde se almacenará el tiempo entre órdenes
+ * @param nombre_instancia Buffer (MAX_NOMBRE_INSTANCIA) donde se almacenará el nombre de la cocina
+ * @param ruta_diario Buffer (256) donde se almacenará la ruta del diario de estado, o "" si no se graba
+ * @param ruta_escenario Buffer (256) donde se almacenará la ruta del escenario, o "" si no hay
+ * @return 1 si los parámetros son válidos, 0 en caso contrario
+ * @note La aceleración (-x), la política (-P), los lotes (-b, -c), la edad máxima (-a), las recetas
+ *       en DAG (-d), los recursos compartidos (-g, -k), la exportación Arrow (-A), los microbenchmarks
+ *       (-u) y la prueba de estrés (-z) se guardan directamente en las variables globales aceleracion,
+ *       politica_asignacion, tamano_lote_maximo, exponente_lote, edad_maxima_ms, recetas_en_dag,
+ *       lugares_parrilla, tolvas_compartidas, directorio_arrow, modo_microbench y segundos_estres
+ */
+int validar_parametros(int argc, char *argv[], int *num_bandas, int *tiempo_ingrediente, int *tiempo_orden,
+                       char *nombre_instancia, char *ruta_diario, char *ruta_escenario);
+
+/**
+ * @brief Muestra la ayuda completa del sistema con ejemplos de uso
+ */
+void mostrar_ayuda();
+
+/** @} */
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE INICIALIZACIÓN
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * @brief Inicializa completamente el sistema de hamburguesas
+ *
+ * Esta función es el punto de entrada principal para la configuración del sistema.
+ * Realiza las siguientes operaciones críticas:
+ *
+ * 1. Configura la memoria compartida POSIX para comunicación entre procesos
+ * 2. Inicializa todas las estructuras de datos del sistema
+ * 3. Configura los mutexes y variables de condición para sincronización
+ * 4. Inicializa todas las bandas de preparación con inventario completo
+ * 5. Configura la cola FIFO para gestión de órdenes pendientes
+ * 6. Establece los parámetros de tiempo configurables
+ *
+ * @param num_bandas Número de bandas de preparación a crear (1-10)
+ * @param tiempo_ingrediente Tiempo en segundos para procesar cada ingrediente
+ * @param tiempo_orden Tiempo en segundos entre generación de nuevas órdenes
+ *
+ * @note Esta función debe ser llamada antes de crear cualquier hilo del sistema
+ * @note La memoria compartida se crea con permisos 0666 para acceso del panel de control
+ * @note Todas las bandas se inicializan con inventario completo (CAPACIDAD_DISPENSADOR)
+ *
+ * @warning Si la función falla, el programa termina con exit(1)
+ * @warning La memoria compartida previa se elimina automáticamente
+ */
+void inicializar_sistema(int num_bandas, int tiempo_ingrediente, int tiempo_orden)
+{
+    // Limpiar memoria compartida previa para evitar conflictos
+    shm_unlink(nombre_memoria);
+
+    // Crear nueva memoria compartida POSIX
+    int shm_fd = shm_open(nombre_memoria, O_CREAT | O_RDWR, 0666);
+    if (shm_fd == -1)
+    {
+        perror("Error creando memoria compartida");
+        exit(1);
+    }
+
+    // Configurar tamaño y mapear la memoria
+    ftruncate(shm_fd, sizeof(DatosCompartidos));
+    datos_compartidos = mmap(0, sizeof(DatosCompartidos), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+
+    if (datos_compartidos == MAP_FAILED)
+    {
+        perror("Error mapeando memoria compartida");
+        exit(1);
+    }
+
+    // Inicializar estructura de datos compartidos
+    memset(datos_compartidos, 0, sizeof(DatosCompartidos));
+    datos_compartidos->num_bandas = num_bandas;
+    datos_compartidos->sistema_activo = 1;
+    datos_compartidos->total_ordenes_procesadas = 0;
+    datos_compartidos->total_ordenes_generadas = 0;
+    datos_compartidos->pid = getpid();
+    snprintf(datos_compartidos->nombre_instancia, MAX_NOMBRE_INSTANCIA, "%s", nombre_cocina);
+    snprintf(datos_compartidos->ruta_archivo_metricas, sizeof(datos_compartidos->ruta_archivo_metricas), "%s",
+             ruta_archivo_metricas);
+
+    // Configurar parámetros de tiempo configurables
+    datos_compartidos->tiempo_por_ingrediente = tiempo_ingrediente;
+    datos_compartidos->tiempo_nueva_orden = tiempo_orden;
+    datos_compartidos->politica_asignacion = politica_asignacion;
+    datos_compartidos->tamano_lote_maximo = tamano_lote_maximo;
+    datos_compartidos->edad_maxima_ms = edad_maxima_ms;
+    datos_compartidos->exponente_lote = exponente_lote;
+    datos_compartidos->num_clientes = num_clientes;
+    datos_compartidos->distribucion_paciencia = distribucion_paciencia;
+
+    // Inicializar mecanismos de sincronización globales (el panel también toma estos mutex;
+    // los contadores de eventos quedan en cero con el memset)
+    iniciar_mutex_compartido(&datos_compartidos->mutex_global);
+
+    // Inicializar todas las bandas de preparación
+    for (int i = 0; i < num_bandas; i++)
+    {
+        // Configuración básica de la banda
+        datos_compartidos->bandas[i].id = i;
+        datos_compartidos->bandas[i].activa = 1;
+        datos_compartidos->bandas[i].pausada = 0;
+        datos_compartidos->bandas[i].hamburguesas_procesadas = 0;
+        datos_compartidos->bandas[i].procesando_orden = 0;
+        datos_compartidos->bandas[i].num_logs = 0;
+        datos_compartidos->bandas[i].necesita_reabastecimiento = 0;
+        datos_compartidos->bandas[i].ultima_alerta_inventario = 0;
+
+        // Estado inicial de la banda
+        strcpy(datos_compartidos->bandas[i].estado_actual, "ESPERANDO");
+        strcpy(datos_compartidos->bandas[i].ingrediente_actual, "");
+
+        // Inicializar mecanismos de sincronización de la banda
+        iniciar_mutex_compartido(&datos_compartidos->bandas[i].mutex);
+
+        // Inicializar dispensadores de ingredientes con inventario completo
+        datos_compartidos->bandas[i].velocidad = velocidad_banda[i] > 0 ? velocidad_banda[i] : 1;
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            strcpy(datos_compartidos->bandas[i].dispensadores[j].nombre, ingredientes_base[j]);
+            datos_compartidos->bandas[i].dispensadores[j].cantidad = CAPACIDAD_DISPENSADOR;
+            datos_compartidos->bandas[i].dispensadores[j].velocidad =
+                velocidad_estacion[i][j] > 0 ? velocidad_estacion[i][j] : 1;
+            if (velocidad_estacion[i][j] > 0 && velocidad_estacion[i][j] != 1)
+                bandas_heterogeneas = 1;
+            iniciar_mutex_compartido(&datos_compartidos->bandas[i].dispensadores[j].mutex);
+        }
+        if (datos_compartidos->bandas[i].velocidad != 1)
+            bandas_heterogeneas = 1;
+
+        // Registrar inicio de la banda en el sistema de logs
+        agregar_log_banda(i, "BANDA INICIADA", 0);
+    }
+
+    // Inicializar cola FIFO para gestión de órdenes pendientes
+    datos_compartidos->cola_espera.frente = 0;
+    datos_compartidos->cola_espera.atras = 0;
+    datos_compartidos->cola_espera.tamano = 0;
+    iniciar_mutex_compartido(&datos_compartidos->cola_espera.mutex);
+    iniciar_rueda_paciencia();
+
+    // Parrilla y tolvas compartidas entre bandas, si se pidieron
+    inicializar_recursos(num_bandas);
+    datos_compartidos->num_componentes = COMPONENTE_PRIMERA_BANDA + num_bandas;
+
+    // Mostrar información de configuración del sistema
+    printf("Sistema inicializado con %d bandas de preparación\n", num_bandas);
+    printf("Memoria compartida: %s\n", nombre_memoria);
+    printf("Configuración de tiempos:\n");
+    printf("  • Tiempo por ingrediente: %d segundos\n", tiempo_ingrediente);
+    printf("  • Tiempo entre órdenes: %d segundos\n", tiempo_orden);
+
+    // Mostrar menú de hamburguesas disponibles
+    mostrar_menu_hamburguesas();
+}
+
+void mostrar_menu_hamburguesas()
+{
+    printf("\n╔══════════════════════════════════════════════════════════════════╗\n");
+    printf("║                         MENU DE HAMBURGUESAS                     ║\n");
+    printf("╠══════════════════════════════════════════════════════════════════╣\n");
+
+    for (int i = 0; i < NUM_TIPOS_HAMBURGUESA; i++)
+    {
+        printf("║ %d. %-20s - $%6.2f                                ║\n",
+               i + 1, menu_hamburguesas[i].nombre, menu_hamburguesas[i].precio);
+    }
+    printf("╚══════════════════════════════════════════════════════════════════╝\n");
+
+    if (!recetas_en_dag)
+        return;
+
+    // Calendario de cada receta: unidad de inicio de cada paso
+    printf("\nRecetas en DAG (en unidades de tiempo por ingrediente):\n");
+    for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+    {
+        PlanReceta *plan = &planes_receta[r];
+        printf("  %-14s %d unidades (ruta crítica %d, paso a paso %d):", menu_hamburguesas[r].nombre,
+               plan->duracion_total, plan->ruta_critica, plan->suma_secuencial);
+        for (int k = 0; k < menu_hamburguesas[r].num_ingredientes; k++)
+        {
+            if (k == 0 || plan->inicio[k] != plan->inicio[k - 1])
+                printf("  t%d", plan->inicio[k]);
+            printf(" %s", menu_hamburguesas[r].ingredientes[plan->orden[k]]);
+        }
+        printf("\n");
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE MANEJO DE LOGS
+// ═══════════════════════════════════════════════════════════════
+
+void agregar_log_banda(int banda_id, const char *mensaje, int es_alerta)
+{
+    if (banda_id < 0 || banda_id >= datos_compartidos->num_bandas)
+        return;
+
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+
+    pthread_mutex_lock(&banda->mutex);
+
+    if (banda->num_logs >= MAX_LOGS_POR_BANDA)
+    {
+        for (int i = 1; i < MAX_LOGS_POR_BANDA; i++)
+        {
+            banda->logs[i - 1] = banda->logs[i];
+        }
+        banda->num_logs = MAX_LOGS_POR_BANDA - 1;
+    }
+
+    strcpy(banda->logs[banda->num_logs].mensaje, mensaje);
+    banda->logs[banda->num_logs].timestamp = time(NULL);
+    banda->logs[banda->num_logs].es_alerta = es_alerta;
+    banda->num_logs++;
+
+    pthread_mutex_unlock(&banda->mutex);
+}
+
+void abrir_escritura_inventario(Banda *banda)
+{
+    unsigned int version = __atomic_load_n(&banda->version_inventario, __ATOMIC_RELAXED);
+    while ((version & 1) ||
+           !__atomic_compare_exchange_n(&banda->version_inventario, &version, version + 1, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        // Otro escritor tiene la versión impar; su escritura es de unas pocas instrucciones
+        if (version & 1)
+        {
+            sched_yield();
+            version = __atomic_load_n(&banda->version_inventario, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+void cerrar_escritura_inventario(Banda *banda)
+{
+    __atomic_add_fetch(&banda->version_inventario, 1, __ATOMIC_RELEASE);
+}
+
+void registrar_transicion_banda(Banda *banda, int estado, int tipo_hamburguesa)
+{
+    unsigned int total = banda->total_transiciones;
+
+    if (total > 0)
+    {
+        TransicionBanda *ultima = &banda->transiciones[(total - 1) % MAX_TRANSICIONES_BANDA];
+        if (ultima->estado == estado && ultima->tipo_hamburguesa == tipo_hamburguesa)
+            return;
+    }
+
+    TransicionBanda *entrada = &banda->transiciones[total % MAX_TRANSICIONES_BANDA];
+    entrada->marca_ms = reloj_ms();
+    entrada->estado = estado;
+    entrada->tipo_hamburguesa = tipo_hamburguesa;
+
+    // Publicar la entrada antes que el nuevo total para los lectores sin bloqueo
+    __atomic_store_n(&banda->total_transiciones, total + 1, __ATOMIC_RELEASE);
+
+    if (directorio_arrow[0] != '\0')
+        exportar_transicion_banda(banda->id, estado, tipo_hamburguesa, entrada->marca_ms);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE VERIFICACIÓN DE INVENTARIO
+// ═══════════════════════════════════════════════════════════════
+
+void verificar_inventario_banda(int banda_id)
+{
+    if (banda_id < 0 || banda_id >= datos_compartidos->num_bandas)
+        return;
+
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+    time_t ahora = time(NULL);
+
+    // Evitar spam de alertas (máximo una cada 30 segundos)
+    if (ahora - banda->ultima_alerta_inventario < 30)
+        return;
+
+    int ingredientes_bajos = 0;
+    int ingredientes_agotados = 0;
+    char ingredientes_criticos[200] = "";
+
+    for (int i = 0; i < MAX_INGREDIENTES; i++)
+    {
+        pthread_mutex_lock(&banda->dispensadores[i].mutex);
+        int cantidad = banda->dispensadores[i].cantidad;
+
+        if (cantidad == 0)
+        {
+            ingredientes_agotados++;
+            if (strlen(ingredientes_criticos) > 0)
+                strcat(ingredientes_criticos, ", ");
+            strcat(ingredientes_criticos, banda->dispensadores[i].nombre);
+        }
+        else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
+        {
+            ingredientes_bajos++;
+        }
+
+        pthread_mutex_unlock(&banda->dispensadores[i].mutex);
+    }
+
+    if (ingredientes_agotados > 0)
+    {
+        char mensaje_alerta[250];
+        snprintf(mensaje_alerta, sizeof(mensaje_alerta),
+                 "ALERTA! BANDA %d SIN: %s", banda_id + 1, ingredientes_criticos);
+        agregar_log_banda(banda_id, mensaje_alerta, 1);
+        banda->necesita_reabastecimiento = 1;
+        banda->ultima_alerta_inventario = ahora;
+    }
+    else if (ingredientes_bajos >= 3)
+    {
+        char mensaje_alerta[100];
+        snprintf(mensaje_alerta, sizeof(mensaje_alerta),
+                 "AVISO: Banda %d necesita reabastecimiento", banda_id + 1);
+        agregar_log_banda(banda_id, mensaje_alerta, 1);
+        banda->necesita_reabastecimiento = 1;
+        banda->ultima_alerta_inventario = ahora;
+    }
+    else
+    {
+        banda->necesita_reabastecimiento = 0;
+    }
+}
+
+void *monitor_inventario(void *arg)
+{
+    (void)arg;
+    registrar_componente(COMPONENTE_MONITOR, "monitor");
+
+    while (datos_compartidos->sistema_activo)
+    {
+        contabilizar_despertar();
+        for (int i = 0; i < datos_compartidos->num_bandas; i++)
+        {
+            verificar_inventario_banda(i);
+        }
+        dormir_simulado(15000); // Chequear cada 15 segundos
+    }
+    cerrar_componente();
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE MÉTRICAS
+// ═══════════════════════════════════════════════════════════════
+
+long long reloj_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void registrar_latencia_orden(long long latencia_ms)
+{
+    int cubeta = latencia_ms / ANCHO_CUBETA_LATENCIA_MS;
+    if (cubeta < 0)
+        cubeta = 0;
+    if (cubeta >= NUM_CUBETAS_LATENCIA)
+        cubeta = NUM_CUBETAS_LATENCIA - 1;
+
+    pthread_mutex_lock(&mutex_latencias);
+    histograma_latencias[cubeta]++;
+    total_muestras_latencia++;
+    anotar_entrega_mser(latencia_ms);
+    if (archivo_metricas != NULL)
+    {
+        histograma_archivo[cubeta]++;
+        muestras_archivo++;
+    }
+    pthread_mutex_unlock(&mutex_latencias);
+}
+
+int percentil_histograma(const int *histograma, int muestras, float percentil)
+{
+    if (muestras <= 0)
+        return 0;
+
+    // Posición (1..N) de la muestra que corresponde al percentil
+    int objetivo = (int)(muestras * percentil / 100.0f + 0.999f);
+    if (objetivo < 1)
+        objetivo = 1;
+
+    int acumulado = 0;
+    for (int i = 0; i < NUM_CUBETAS_LATENCIA; i++)
+    {
+        acumulado += histograma[i];
+        if (acumulado >= objetivo)
+            return (i + 1) * ANCHO_CUBETA_LATENCIA_MS;
+    }
+    return NUM_CUBETAS_LATENCIA * ANCHO_CUBETA_LATENCIA_MS;
+}
+
+int calcular_percentil_latencia(float percentil)
+{
+    pthread_mutex_lock(&mutex_latencias);
+    int resultado = percentil_histograma(histograma_latencias, total_muestras_latencia, percentil);
+    pthread_mutex_unlock(&mutex_latencias);
+
+    return resultado;
+}
+
+void registrar_error_eta(long long error_ms)
+{
+    pthread_mutex_lock(&mutex_latencias);
+    suma_error_eta_ms += error_ms;
+    suma_error_abs_eta_ms += error_ms < 0 ? -error_ms : error_ms;
+    muestras_error_eta++;
+    pthread_mutex_unlock(&mutex_latencias);
+}
+
+int lote_mser_actual()
+{
+    // El lote sale del reloj simulado: no depende de cuándo despierte el publicador ni de la aceleración
+    long long lote = tiempo_simulado_ms() / (segundos_por_lote_mser * 1000LL);
+    while (lote >= MAX_LOTES_MSER)
+    {
+        // Sin lugar: fundir de a pares conserva toda la corrida con lotes del doble
+        for (int i = 0; i < MAX_LOTES_MSER / 2; i++)
+        {
+            entregas_lote_mser[i] = entregas_lote_mser[2 * i] + entregas_lote_mser[2 * i + 1];
+            latencia_lote_mser_ms[i] = latencia_lote_mser_ms[2 * i] + latencia_lote_mser_ms[2 * i + 1];
+        }
+        memset(&entregas_lote_mser[MAX_LOTES_MSER / 2], 0, sizeof(entregas_lote_mser) / 2);
+        memset(&latencia_lote_mser_ms[MAX_LOTES_MSER / 2], 0, sizeof(latencia_lote_mser_ms) / 2);
+        segundos_por_lote_mser *= 2;
+        lote /= 2;
+    }
+    return (int)lote;
+}
+
+void anotar_entrega_mser(long long latencia_ms)
+{
+    int lote = lote_mser_actual();
+    entregas_lote_mser[lote]++;
+    latencia_lote_mser_ms[lote] += latencia_ms;
+}
+
+int cerrar_lotes_mser()
+{
+    pthread_mutex_lock(&mutex_latencias);
+    int cerrados = lote_mser_actual();
+    pthread_mutex_unlock(&mutex_latencias);
+
+    // Tras fundir lotes la cuenta puede bajar; solo importa si cambió
+    int anteriores = lotes_mser;
+    lotes_mser = cerrados;
+    return lotes_mser != anteriores;
+}
+
+int truncamiento_mser(const double *serie, int n)
+{
+    double suma = 0, suma_cuadrados = 0;
+    for (int i = 0; i < n; i++)
+    {
+        suma += serie[i];
+        suma_cuadrados += serie[i] * serie[i];
+    }
+
+    // MSER(d) = varianza de lo que queda / (n - d), buscando d en la primera mitad
+    int mejor = 0;
+    double mejor_mser = -1;
+    for (int d = 0; d <= n / 2; d++)
+    {
+        int m = n - d;
+        double mser = (suma_cuadrados - suma * suma / m) / ((double)m * m);
+        if (mejor_mser < 0 || mser < mejor_mser)
+        {
+            mejor_mser = mser;
+            mejor = d;
+        }
+        suma -= serie[d];
+        suma_cuadrados -= serie[d] * serie[d];
+    }
+    return mejor < n / 2 ? mejor : -1;
+}
+
+void estimar_estacionario(EstimacionEstacionaria *estimacion)
+{
+    static double tasas[MAX_LOTES_MSER];
+    static double latencias[MAX_LOTES_MSER];
+    static long long entregas_lote[MAX_LOTES_MSER];
+    static long long latencia_lote_ms[MAX_LOTES_MSER];
+
+    // Copia de los lotes cerrados; las bandas siguen llenando el abierto
+    pthread_mutex_lock(&mutex_latencias);
+    int n = lote_mser_actual();
+    int segundos_lote = segundos_por_lote_mser;
+    memcpy(entregas_lote, entregas_lote_mser, n * sizeof(long long));
+    memcpy(latencia_lote_ms, latencia_lote_mser_ms, n * sizeof(long long));
+    pthread_mutex_unlock(&mutex_latencias);
+    double minutos_lote = segundos_lote / 60.0;
+
+    memset(estimacion, 0, sizeof(*estimacion));
+    estimacion->calentamiento_s = -1;
+    estimacion->lotes = n;
+    estimacion->segundos_lote = segundos_lote;
+
+    long long entregas = 0, latencia_ms = 0;
+    double ultima_latencia = 0;
+    for (int i = 0; i < n; i++)
+    {
+        entregas += entregas_lote[i];
+        latencia_ms += latencia_lote_ms[i];
+        tasas[i] = entregas_lote[i];
+        // Un lote sin entregas repite la latencia anterior en vez de hundir la media
+        if (entregas_lote[i] > 0)
+            ultima_latencia = (double)latencia_lote_ms[i] / entregas_lote[i];
+        latencias[i] = ultima_latencia;
+    }
+    if (n > 0)
+        estimacion->throughput_total = entregas / (n * minutos_lote);
+    if (entregas > 0)
+        estimacion->latencia_total_ms = (double)latencia_ms / entregas;
+    if (n < 2 * LOTES_MEDIAS)
+        return;
+
+    // El calentamiento termina cuando ambas series se estabilizaron
+    int d_throughput = truncamiento_mser(tasas, n);
+    int d_latencia = truncamiento_mser(latencias, n);
+    if (d_throughput < 0 || d_latencia < 0)
+        return;
+    int d = d_throughput > d_latencia ? d_throughput : d_latencia;
+    estimacion->lotes_descartados = d;
+    estimacion->calentamiento_s = d * segundos_lote;
+
+    // Medias por lote sobre lo que queda; el sobrante se descarta junto al calentamiento
+    int tamano = (n - d) / LOTES_MEDIAS;
+    int inicio = n - tamano * LOTES_MEDIAS;
+    double medias_throughput[LOTES_MEDIAS], medias_latencia[LOTES_MEDIAS];
+    int con_entregas = 0;
+    for (int g = 0; g < LOTES_MEDIAS; g++)
+    {
+        long long entregas_grupo = 0, latencia_grupo = 0;
+        for (int i = inicio + g * tamano; i < inicio + (g + 1) * tamano; i++)
+        {
+            entregas_grupo += entregas_lote[i];
+            latencia_grupo += latencia_lote_ms[i];
+        }
+        medias_throughput[g] = entregas_grupo / (tamano * minutos_lote);
+        if (entregas_grupo > 0)
+            medias_latencia[con_entregas++] = (double)latencia_grupo / entregas_grupo;
+    }
+
+    double media = 0, varianza = 0;
+    for (int g = 0; g < LOTES_MEDIAS; g++)
+        media += medias_throughput[g] / LOTES_MEDIAS;
+    for (int g = 0; g < LOTES_MEDIAS; g++)
+        varianza += (medias_throughput[g] - media) * (medias_throughput[g] - media) / (LOTES_MEDIAS - 1);
+    estimacion->throughput = media;
+    estimacion->ic_throughput = t_student_95[LOTES_MEDIAS - 1] * sqrt(varianza / LOTES_MEDIAS);
+
+    if (con_entregas < 2)
+        return;
+    media = varianza = 0;
+    for (int g = 0; g < con_entregas; g++)
+        media += medias_latencia[g] / con_entregas;
+    for (int g = 0; g < con_entregas; g++)
+        varianza += (medias_latencia[g] - media) * (medias_latencia[g] - media) / (con_entregas - 1);
+    estimacion->latencia_ms = media;
+    estimacion->ic_latencia_ms = t_student_95[con_entregas - 1] * sqrt(varianza / con_entregas);
+}
+
+void mostrar_estacionario()
+{
+    // El publicador ya terminó: se estima con todos los lotes cerrados
+    estimar_estacionario(&estacionario);
+    if (estacionario.lotes < 2 * LOTES_MEDIAS)
+    {
+        printf("- Estado estacionario (MSER-5): corrida demasiado corta, %d de %d lotes de %d s simulados\n",
+               estacionario.lotes, 2 * LOTES_MEDIAS, estacionario.segundos_lote);
+        return;
+    }
+    if (estacionario.calentamiento_s < 0)
+    {
+        printf("- Estado estacionario (MSER-5): no detectado en %d lotes de %d s simulados (el calentamiento no\n"
+               "  termina en la primera mitad); desde el arranque %.2f órdenes/min, latencia media %.1f s\n",
+               estacionario.lotes, estacionario.segundos_lote, estacionario.throughput_total,
+               estacionario.latencia_total_ms / 1000.0);
+        return;
+    }
+    printf("- Estado estacionario (MSER-5): %d s simulados de calentamiento descartados (%d de %d lotes de %d s)\n",
+           estacionario.calentamiento_s, estacionario.lotes_descartados, estacionario.lotes,
+           estacionario.segundos_lote);
+    printf("  Throughput %.2f ± %.2f órdenes/min, latencia media %.1f ± %.1f s (IC 95%%, medias de %d lotes)\n",
+           estacionario.throughput, estacionario.ic_throughput, estacionario.latencia_ms / 1000.0,
+           estacionario.ic_latencia_ms / 1000.0, LOTES_MEDIAS);
+    printf("  Desde el arranque: %.2f órdenes/min, latencia media %.1f s\n", estacionario.throughput_total,
+           estacionario.latencia_total_ms / 1000.0);
+}
+
+double factor_lote(int tamano)
+{
+    return tamano > 1 ? pow(tamano, exponente_lote) : 1.0;
+}
+
+long long duracion_preparacion_ms(int banda_id, int tipo, int tamano)
+{
+    return (long long)(duracion_restante_ms(&datos_compartidos->bandas[banda_id], tipo, 0, tamano) / aceleracion);
+}
+
+float factor_paso(const Banda *banda, const char *ingrediente)
+{
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
+    {
+        if (strcmp(banda->dispensadores[j].nombre, ingrediente) == 0)
+            return banda->velocidad * banda->dispensadores[j].velocidad;
+    }
+    return banda->velocidad;
+}
+
+long long duracion_restante_ms(const Banda *banda, int tipo, int desde, int tamano)
+{
+    // Cada paso dura hasta que empieza el siguiente, como en procesar_orden
+    const PlanReceta *plan = &planes_receta[tipo];
+    double unidad_ms = datos_compartidos->tiempo_por_ingrediente * 1000.0 * factor_lote(tamano);
+    double total = 1000 * factor_lote(tamano) / banda->velocidad;
+    for (int i = desde; i < menu_hamburguesas[tipo].num_ingredientes; i++)
+    {
+        int siguiente = i + 1 < menu_hamburguesas[tipo].num_ingredientes ? plan->inicio[i + 1] : plan->duracion_total;
+        total += (siguiente - plan->inicio[i]) * unidad_ms / factor_paso(banda, menu_hamburguesas[tipo].ingredientes[i]);
+    }
+    return (long long)total;
+}
+
+void planificar_receta(int tipo, PlanReceta *plan)
+{
+    const PasoReceta *pasos = pasos_receta[tipo];
+    int n = menu_hamburguesas[tipo].num_ingredientes;
+
+    // Nivel de cada paso: los sucesores tienen índice mayor, así que basta recorrer hacia atrás
+    int nivel[MAX_PASOS_RECETA];
+    plan->ruta_critica = 0;
+    plan->suma_secuencial = 0;
+    for (int i = n - 1; i >= 0; i--)
+    {
+        int siguiente = 0;
+        for (int j = i + 1; j < n; j++)
+        {
+            if ((pasos[j].previos & (1 << i)) && nivel[j] > siguiente)
+                siguiente = nivel[j];
+        }
+        nivel[i] = pasos[i].duracion + siguiente;
+        if (nivel[i] > plan->ruta_critica)
+            plan->ruta_critica = nivel[i];
+        plan->suma_secuencial += pasos[i].duracion;
+    }
+
+    // Simulación por unidades de tiempo: cada estación libre toma el paso listo de mayor nivel
+    int libre_desde[NUM_ESTACIONES] = {0};
+    int empezados = 0;
+    int mascara_empezados = 0;
+    plan->duracion_total = 0;
+    for (int t = 0; empezados < n; t++)
+    {
+        int terminados = 0;
+        for (int k = 0; k < empezados; k++)
+        {
+            if (plan->fin[k] <= t)
+                terminados |= 1 << plan->orden[k];
+        }
+
+        for (int e = 0; e < NUM_ESTACIONES; e++)
+        {
+            if (libre_desde[e] > t)
+                continue;
+
+            int elegido = -1;
+            for (int i = 0; i < n; i++)
+            {
+                if ((mascara_empezados & (1 << i)) || pasos[i].estacion != e || (pasos[i].previos & ~terminados))
+                    continue;
+                if (elegido < 0 || nivel[i] > nivel[elegido])
+                    elegido = i;
+            }
+            if (elegido < 0)
+                continue;
+
+            plan->orden[empezados] = elegido;
+            plan->inicio[empezados] = t;
+            plan->fin[empezados] = t + pasos[elegido].duracion;
+            libre_desde[e] = plan->fin[empezados];
+            if (plan->fin[empezados] > plan->duracion_total)
+                plan->duracion_total = plan->fin[empezados];
+            mascara_empezados |= 1 << elegido;
+            empezados++;
+        }
+    }
+}
+
+void planificar_recetas()
+{
+    for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+    {
+        PlanReceta *plan = &planes_receta[r];
+        if (recetas_en_dag)
+        {
+            planificar_receta(r, plan);
+            continue;
+        }
+
+        // Paso a paso: un ingrediente por unidad, en el orden de la receta
+        int n = menu_hamburguesas[r].num_ingredientes;
+        for (int i = 0; i < n; i++)
+        {
+            plan->orden[i] = i;
+            plan->inicio[i] = i;
+            plan->fin[i] = i + 1;
+        }
+        plan->duracion_total = n;
+        plan->ruta_critica = n;
+        plan->suma_secuencial = n;
+    }
+}
+
+void registrar_preparacion(int tipo, int tamano, long long duracion_ms)
+{
+    // Las mismas unidades que la preparación real: pasos escalados por el lote más el tiempo final
+    double escala = factor_lote(tamano);
+    long long unidad_ms = datos_compartidos->tiempo_por_ingrediente * 1000LL;
+
+    pthread_mutex_lock(&mutex_latencias);
+    suma_preparacion_ms += duracion_ms;
+    suma_ruta_critica_ms += (long long)((planes_receta[tipo].ruta_critica * unidad_ms + 1000) * escala);
+    suma_secuencial_ms += (long long)((planes_receta[tipo].suma_secuencial * unidad_ms + 1000) * escala);
+    muestras_preparacion++;
+    pthread_mutex_unlock(&mutex_latencias);
+}
+
+void inicializar_recursos(int num_bandas)
+{
+    datos_compartidos->num_recursos = 0;
+    if (lugares_parrilla == 0 && !tolvas_compartidas)
+        return;
+
+    // La parrilla siempre ocupa RECURSO_PARRILLA; sin --parrillas queda sin lugares y nadie la pide
+    int total = tolvas_compartidas ? 1 + (num_bandas + 1) / 2 : 1;
+    for (int r = 0; r < total; r++)
+    {
+        RecursoCompartido *recurso = &datos_compartidos->recursos[r];
+        if (r == RECURSO_PARRILLA)
+        {
+            strcpy(recurso->nombre, "Parrilla");
+            recurso->capacidad = lugares_parrilla;
+            recurso->banda_desde = 0;
+            recurso->banda_hasta = num_bandas - 1;
+        }
+        else
+        {
+            recurso->banda_desde = (r - 1) * 2;
+            recurso->banda_hasta = recurso->banda_desde + 1 < num_bandas ? recurso->banda_desde + 1 : recurso->banda_desde;
+            snprintf(recurso->nombre, MAX_NOMBRE_RECURSO, "Tolva %d-%d", recurso->banda_desde + 1,
+                     recurso->banda_hasta + 1);
+            recurso->capacidad = 1;
+        }
+        recurso->ultimo_cambio_ms = reloj_ms();
+        iniciar_mutex_compartido(&recurso->mutex);
+    }
+    datos_compartidos->num_recursos = total;
+}
+
+int recurso_de_paso(int banda_id, const char *ingrediente)
+{
+    if (lugares_parrilla > 0 && strcmp(ingrediente, "carne") == 0)
+        return RECURSO_PARRILLA;
+    if (tolvas_compartidas && (strcmp(ingrediente, "mayonesa") == 0 || strcmp(ingrediente, "salsa_bbq") == 0 ||
+                               strcmp(ingrediente, "salsa_picante") == 0))
+        return 1 + banda_id / 2;
+    return -1;
+}
+
+void acumular_ocupacion(RecursoCompartido *recurso)
+{
+    long long ahora = reloj_ms();
+    recurso->ocupado_ms += (long long)(recurso->en_uso * (ahora - recurso->ultimo_cambio_ms) * aceleracion);
+    recurso->ultimo_cambio_ms = ahora;
+}
+
+void adquirir_recurso(int indice, Banda *banda)
+{
+    RecursoCompartido *recurso = &datos_compartidos->recursos[indice];
+    long long inicio = reloj_ms();
+    int espero = 0;
+
+    pthread_mutex_lock(&recurso->mutex);
+    unsigned int turno = recurso->siguiente_turno++;
+    unsigned int clave = leer_eventos(&recurso->liberado);
+    while ((turno != recurso->turno_actual || recurso->en_uso >= recurso->capacidad) &&
+           datos_compartidos->sistema_activo)
+    {
+        if (!espero)
+        {
+            espero = 1;
+            recurso->esperando++;
+            if (recurso->esperando > recurso->max_esperando)
+                recurso->max_esperando = recurso->esperando;
+
+            // Nadie toma un recurso con el mutex de una banda tomado: este orden es seguro
+            pthread_mutex_lock(&banda->mutex);
+            sprintf(banda->estado_actual, "ESPERANDO %s", recurso->nombre);
+            pthread_mutex_unlock(&banda->mutex);
+        }
+
+        // Esperar un lugar no es un atasco: la banda sigue dando señales de vida
+        publicar_latido(banda, (long long)(PERIODO_ESPERA_RECURSO_MS * aceleracion));
+        pthread_mutex_unlock(&recurso->mutex);
+        esperar_eventos(&recurso->liberado, clave, PERIODO_ESPERA_RECURSO_MS * 1000LL);
+        pthread_mutex_lock(&recurso->mutex);
+        clave = leer_eventos(&recurso->liberado);
+    }
+
+    acumular_ocupacion(recurso);
+    recurso->en_uso++;
+    recurso->turno_actual++;
+    recurso->usos++;
+    if (espero)
+    {
+        recurso->esperando--;
+        recurso->esperas++;
+        recurso->espera_total_ms += (long long)((reloj_ms() - inicio) * aceleracion);
+    }
+
+    // El turno siguiente puede caber también si quedan lugares
+    notificar_eventos(&recurso->liberado, DESPERTAR_TODOS);
+    pthread_mutex_unlock(&recurso->mutex);
+}
+
+void liberar_recurso(int indice)
+{
+    RecursoCompartido *recurso = &datos_compartidos->recursos[indice];
+
+    pthread_mutex_lock(&recurso->mutex);
+    acumular_ocupacion(recurso);
+    recurso->en_uso--;
+    notificar_eventos(&recurso->liberado, DESPERTAR_TODOS);
+    pthread_mutex_unlock(&recurso->mutex);
+}
+
+void soltar_recursos(int recursos[], int fines[], int *num, int hasta)
+{
+    int quedan = 0;
+    for (int k = 0; k < *num; k++)
+    {
+        if (fines[k] <= hasta)
+        {
+            liberar_recurso(recursos[k]);
+            continue;
+        }
+        recursos[quedan] = recursos[k];
+        fines[quedan] = fines[k];
+        quedan++;
+    }
+    *num = quedan;
+}
+
+void calcular_bandas_servibles(int puede_servir[MAX_BANDAS][NUM_TIPOS_HAMBURGUESA])
+{
+    for (int b = 0; b < datos_compartidos->num_bandas; b++)
+    {
+        Banda *banda = &datos_compartidos->bandas[b];
+        int operativa = banda->activa && !banda->pausada && !banda->atascada;
+
+        for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+        {
+            puede_servir[b][r] = operativa;
+            for (int i = 0; i < menu_hamburguesas[r].num_ingredientes && puede_servir[b][r]; i++)
+            {
+                for (int j = 0; j < MAX_INGREDIENTES; j++)
+                {
+                    if (strcmp(menu_hamburguesas[r].ingredientes[i], banda->dispensadores[j].nombre) == 0)
+                    {
+                        if (banda->dispensadores[j].cantidad <= 0)
+                            puede_servir[b][r] = 0;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+float valor_por_segundo(int tipo)
+{
+    float segundos = planes_receta[tipo].duracion_total * datos_compartidos->tiempo_por_ingrediente + 1;
+    return menu_hamburguesas[tipo].precio / segundos;
+}
+
+int elegir_orden_por_valor(const int tipos[], const int adelantos[], int n, const int servible[])
+{
+    int elegida = -1;
+    float mejor = 0;
+
+    for (int k = 0; k < n && k < VENTANA_EQUIDAD; k++)
+    {
+        if (tipos[k] < 0 || !servible[tipos[k]])
+            continue;
+
+        // Equidad: la orden adelantada demasiadas veces va primero
+        if (adelantos[k] >= MAX_ADELANTOS)
+            return k;
+
+        // Con igual valor gana la más antigua
+        float valor = valor_por_segundo(tipos[k]);
+        if (elegida < 0 || valor > mejor)
+        {
+            elegida = k;
+            mejor = valor;
+        }
+    }
+    return elegida;
+}
+
+void actualizar_etas_cola()
+{
+    long long ahora = reloj_ms();
+    int num_bandas = datos_compartidos->num_bandas;
+    long long libre_ms[MAX_BANDAS];
+    int puede_servir[MAX_BANDAS][NUM_TIPOS_HAMBURGUESA];
+
+    // Lectura sin mutex de las bandas, como la instantánea: la estimación es indicativa
+    calcular_bandas_servibles(puede_servir);
+    for (int b = 0; b < num_bandas; b++)
+    {
+        Banda *banda = &datos_compartidos->bandas[b];
+        libre_ms[b] = ahora;
+        if (banda->procesando_orden && banda->orden_actual.eta_ms > ahora)
+            libre_ms[b] = banda->orden_actual.eta_ms;
+    }
+
+    // Copia de la cola en el orden en que la verá el asignador, con adelantos y sin lápidas
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    int pendientes[MAX_ORDENES];
+    int tipos[MAX_ORDENES];
+    int adelantos[MAX_ORDENES];
+    int restantes = 0;
+    for (int k = 0; k < cola->tamano; k++)
+    {
+        int posicion = (cola->frente + k) % MAX_ORDENES;
+        if (cola->ordenes[posicion].cancelada)
+            continue;
+        pendientes[restantes] = posicion;
+        tipos[restantes] = cola->ordenes[posicion].tipo_hamburguesa;
+        adelantos[restantes] = cola->ordenes[posicion].veces_adelantada;
+        restantes++;
+    }
+
+    // Simular el asignador: toma la cabeza (o la que elija la política por valor)
+    // y la da a la primera banda libre que pueda prepararla; si no hay, la manda
+    // al final y espera ESPERA_REINTENTO_MS. Cada vuelta adelanta el reloj, así
+    // que toda orden sale de la simulación asignada o expirada.
+    long long reloj = ahora;
+    long long espera = (long long)(ESPERA_REINTENTO_MS / aceleracion);
+    while (restantes > 0)
+    {
+        int k = 0;
+        if (politica_asignacion == POLITICA_VALOR)
+        {
+            int servible[NUM_TIPOS_HAMBURGUESA] = {0};
+            for (int b = 0; b < num_bandas; b++)
+            {
+                for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+                {
+                    if (puede_servir[b][r] && libre_ms[b] <= reloj)
+                        servible[r] = 1;
+                }
+            }
+            k = elegir_orden_por_valor(tipos, adelantos, restantes, servible);
+            if (k < 0)
+                k = 0;
+        }
+
+        // Sacar la orden k; las que estaban delante quedan adelantadas
+        int posicion = pendientes[k];
+        int adelantos_orden = adelantos[k];
+        for (int i = 0; i < k; i++)
+        {
+            adelantos[i]++;
+        }
+        for (int i = k; i < restantes - 1; i++)
+        {
+            pendientes[i] = pendientes[i + 1];
+            tipos[i] = tipos[i + 1];
+            adelantos[i] = adelantos[i + 1];
+        }
+        restantes--;
+
+        // El asignador descarta la que ya venció al sacarla
+        Orden *orden = &cola->ordenes[posicion];
+        if (orden_expirada(orden, reloj))
+        {
+            orden->eta_ms = 0;
+            continue;
+        }
+
+        // La misma elección que hará el asignador entre las bandas libres
+        int elegida = -1;
+        for (int b = 0; b < num_bandas; b++)
+        {
+            if (puede_servir[b][orden->tipo_hamburguesa] && libre_ms[b] <= reloj &&
+                preferir_banda(orden->tipo_hamburguesa, b, elegida))
+                elegida = b;
+        }
+
+        if (elegida >= 0)
+        {
+            // El asignador junta con ella las del mismo tipo de la ventana (sin mirar cuánto alcanza el inventario)
+            Orden *lote[MAX_LOTE];
+            int tamano = 1;
+            lote[0] = orden;
+            for (int i = 0; i < restantes && i < VENTANA_EQUIDAD && tamano < tamano_lote_maximo;)
+            {
+                if (tipos[i] != orden->tipo_hamburguesa)
+                {
+                    i++;
+                    continue;
+                }
+                lote[tamano++] = &cola->ordenes[pendientes[i]];
+                for (int j = i; j < restantes - 1; j++)
+                {
+                    pendientes[j] = pendientes[j + 1];
+                    tipos[j] = tipos[j + 1];
+                    adelantos[j] = adelantos[j + 1];
+                }
+                restantes--;
+            }
+
+            libre_ms[elegida] = reloj + (long long)(PASO_RECOGIDA_MS / aceleracion) +
+                                duracion_preparacion_ms(elegida, orden->tipo_hamburguesa, tamano);
+            for (int i = 0; i < tamano; i++)
+            {
+                lote[i]->eta_ms = libre_ms[elegida];
+                if (lote[i]->eta_prometida_ms == 0)
+                    lote[i]->eta_prometida_ms = lote[i]->eta_ms;
+            }
+            continue;
+        }
+
+        pendientes[restantes] = posicion;
+        tipos[restantes] = orden->tipo_hamburguesa;
+        adelantos[restantes] = adelantos_orden;
+        restantes++;
+        reloj += espera;
+    }
+
+    // Punto de partida de las estimaciones incrementales hasta el próximo recálculo
+    memcpy(libre_tras_cola_ms, libre_ms, sizeof(libre_ms));
+    memcpy(servibles_tras_cola, puede_servir, sizeof(puede_servir));
+    etas_calculadas = 1;
+}
+
+void estimar_eta_al_final(Orden *orden)
+{
+    // Sola en la cola, la simulación completa es exacta y no recorre nada más
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    if (!etas_calculadas || cola->tamano - cola->lapidas <= 1)
+    {
+        actualizar_etas_cola();
+        return;
+    }
+
+    // Reencolada por el asignador: ya ocupa su lugar en la estimación y conserva su ETA
+    if (orden->eta_prometida_ms != 0)
+        return;
+
+    // Una banda no queda libre antes de terminar su orden en curso, aunque la estimación anterior lo supusiera
+    long long ahora = reloj_ms();
+    int num_bandas = datos_compartidos->num_bandas;
+    for (int b = 0; b < num_bandas; b++)
+    {
+        Banda *banda = &datos_compartidos->bandas[b];
+        if (libre_tras_cola_ms[b] < ahora)
+            libre_tras_cola_ms[b] = ahora;
+        if (banda->procesando_orden && banda->orden_actual.eta_ms > libre_tras_cola_ms[b])
+            libre_tras_cola_ms[b] = banda->orden_actual.eta_ms;
+    }
+
+    // La primera banda que quede libre de las que pueden prepararla
+    int tipo = orden->tipo_hamburguesa;
+    long long reloj = -1;
+    for (int b = 0; b < num_bandas; b++)
+    {
+        if (servibles_tras_cola[b][tipo] && (reloj < 0 || libre_tras_cola_ms[b] < reloj))
+            reloj = libre_tras_cola_ms[b];
+    }
+
+    orden->eta_ms = 0;
+    if (reloj < 0 || orden_expirada(orden, reloj))
+        return;
+
+    int elegida = -1;
+    for (int b = 0; b < num_bandas; b++)
+    {
+        if (servibles_tras_cola[b][tipo] && libre_tras_cola_ms[b] <= reloj && preferir_banda(tipo, b, elegida))
+            elegida = b;
+    }
+    libre_tras_cola_ms[elegida] = reloj + (long long)(PASO_RECOGIDA_MS / aceleracion) +
+                                  duracion_preparacion_ms(elegida, tipo, 1);
+    orden->eta_ms = libre_tras_cola_ms[elegida];
+    if (orden->eta_prometida_ms == 0)
+        orden->eta_prometida_ms = orden->eta_ms;
+}
+
+void publicar_instantanea(float throughput, float llegadas, float ingresos)
+{
+    InstantaneaMetricas nueva;
+    memset(&nueva, 0, sizeof(nueva));
+
+    nueva.marca_ms = reloj_ms();
+    nueva.ordenes_generadas = datos_compartidos->total_ordenes_generadas;
+    nueva.ordenes_procesadas = datos_compartidos->total_ordenes_procesadas;
+    nueva.ordenes_en_cola = datos_compartidos->cola_espera.tamano - datos_compartidos->cola_espera.lapidas;
+    nueva.throughput_por_minuto = throughput;
+    nueva.llegadas_por_minuto = llegadas;
+    nueva.ingresos_por_minuto = ingresos;
+    nueva.ingresos_totales = datos_compartidos->ingresos_totales;
+    nueva.ingresos_perdidos = datos_compartidos->ingresos_perdidos;
+
+    // Por banda configurada y hora simulada desde el arranque
+    double horas = tiempo_simulado_ms() / 3600000.0;
+    if (horas > 0)
+        nueva.ingresos_por_banda_hora = datos_compartidos->ingresos_totales / (datos_compartidos->num_bandas * horas);
+    nueva.latencia_p50_ms = calcular_percentil_latencia(50);
+    nueva.latencia_p99_ms = calcular_percentil_latencia(99);
+    nueva.calentamiento_s = estacionario.calentamiento_s;
+    nueva.throughput_estacionario = estacionario.throughput;
+    nueva.ic_throughput_estacionario = estacionario.ic_throughput;
+    nueva.latencia_estacionaria_ms = estacionario.latencia_ms;
+    nueva.ic_latencia_estacionaria_ms = estacionario.ic_latencia_ms;
+    if (datos_compartidos->lotes_procesados > 0)
+        nueva.tamano_lote_medio = (float)datos_compartidos->total_ordenes_procesadas / datos_compartidos->lotes_procesados;
+
+    pthread_mutex_lock(&mutex_latencias);
+    if (muestras_error_eta > 0)
+    {
+        nueva.error_eta_medio_ms = suma_error_abs_eta_ms / muestras_error_eta;
+        nueva.sesgo_eta_ms = suma_error_eta_ms / muestras_error_eta;
+    }
+    pthread_mutex_unlock(&mutex_latencias);
+
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        Banda *banda = &datos_compartidos->bandas[i];
+        if (banda->activa && !banda->pausada)
+            nueva.bandas_operativas++;
+        if (banda->necesita_reabastecimiento)
+            nueva.bandas_sin_inventario++;
+        if (banda->atascada)
+            nueva.bandas_atascadas++;
+        nueva.ordenes_rescatadas += banda->ordenes_rescatadas;
+
+        // Lectura sin mutex: cada entero es atómico y solo se usa como indicador
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            if (banda->dispensadores[j].cantidad == 0)
+                nueva.dispensadores_agotados++;
+        }
+    }
+
+    // Escritura con seqlock: secuencia impar mientras se copian los datos
+    InstantaneaMetricas *destino = &datos_compartidos->instantanea;
+    unsigned int secuencia = destino->secuencia;
+    nueva.secuencia = secuencia + 2;
+
+    __atomic_store_n(&destino->secuencia, secuencia + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy((char *)destino + sizeof(destino->secuencia),
+           (char *)&nueva + sizeof(nueva.secuencia),
+           sizeof(nueva) - sizeof(nueva.secuencia));
+    __atomic_store_n(&destino->secuencia, secuencia + 2, __ATOMIC_RELEASE);
+}
+
+void *publicador_metricas(void *arg)
+{
+    (void)arg;
+    registrar_componente(COMPONENTE_PUBLICADOR, "publicador");
+
+    // Historial de procesadas, generadas e ingresos por segundo para las tasas de la ventana
+    int historial[VENTANA_THROUGHPUT];
+    int historial_generadas[VENTANA_THROUGHPUT];
+    double historial_ingresos[VENTANA_THROUGHPUT];
+    int posicion = 0;
+    int muestras = 0;
+
+    while (datos_compartidos->sistema_activo)
+    {
+        contabilizar_despertar();
+        int procesadas = datos_compartidos->total_ordenes_procesadas;
+        int generadas = datos_compartidos->total_ordenes_generadas;
+        double ingresos_acumulados = datos_compartidos->ingresos_totales;
+
+        // La muestra más antigua de la ventana está en la posición a sobrescribir
+        float throughput = 0;
+        float llegadas = 0;
+        float ingresos = 0;
+        if (muestras > 0)
+        {
+            int mas_antigua = (muestras < VENTANA_THROUGHPUT) ? 0 : posicion;
+            int segundos = (muestras < VENTANA_THROUGHPUT) ? muestras : VENTANA_THROUGHPUT;
+            throughput = (procesadas - historial[mas_antigua]) * 60.0f / segundos / aceleracion;
+            llegadas = (generadas - historial_generadas[mas_antigua]) * 60.0f / segundos / aceleracion;
+            ingresos = (ingresos_acumulados - historial_ingresos[mas_antigua]) * 60.0f / segundos / aceleracion;
+        }
+
+        historial[posicion] = procesadas;
+        historial_generadas[posicion] = generadas;
+        historial_ingresos[posicion] = ingresos_acumulados;
+        posicion = (posicion + 1) % VENTANA_THROUGHPUT;
+        if (muestras < VENTANA_THROUGHPUT)
+            muestras++;
+
+        // La estimación de MSER-5 se rehace cuando el reloj simulado cierra algún lote
+        if (cerrar_lotes_mser())
+            estimar_estacionario(&estacionario);
+
+        // Retirar las órdenes vencidas y recalcular las ETA, que envejecen con el estado de las bandas
+        pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+        avanzar_rueda_paciencia(reloj_ms());
+        actualizar_etas_cola();
+        pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+
+        publicar_instantanea(throughput, llegadas, ingresos);
+        actualizar_uso_cpu();
+        if (directorio_arrow[0] != '\0')
+            exportar_metricas(throughput, llegadas, ingresos);
+
+        // Uso de cada recurso compartido desde el arranque
+        long long transcurrido = tiempo_simulado_ms();
+        for (int r = 0; r < datos_compartidos->num_recursos; r++)
+        {
+            RecursoCompartido *recurso = &datos_compartidos->recursos[r];
+            pthread_mutex_lock(&recurso->mutex);
+            acumular_ocupacion(recurso);
+            if (recurso->capacidad > 0 && transcurrido > 0)
+                recurso->utilizacion = (float)recurso->ocupado_ms / (recurso->capacidad * transcurrido);
+            pthread_mutex_unlock(&recurso->mutex);
+        }
+        sleep(1);
+    }
+    cerrar_componente();
+    return NULL;
+}
+
+int abrir_diario(const char *ruta)
+{
+    archivo_diario = fopen(ruta, "wb");
+    if (archivo_diario == NULL)
+    {
+        perror("Error creando el diario");
+        return 0;
+    }
+
+    CabeceraDiario cabecera;
+    memset(&cabecera, 0, sizeof(cabecera));
+    memcpy(cabecera.magia, MAGIA_DIARIO, sizeof(cabecera.magia));
+    cabecera.tamano_estado = sizeof(DatosCompartidos);
+    cabecera.intervalo_ms = INTERVALO_DIARIO_MS;
+    cabecera.inicio_ms = reloj_ms();
+    snprintf(cabecera.nombre_instancia, MAX_NOMBRE_INSTANCIA, "%s", nombre_cocina);
+
+    fwrite(&cabecera, sizeof(cabecera), 1, archivo_diario);
+    return 1;
+}
+
+void escribir_cuadro_diario(const DatosCompartidos *actual, const DatosCompartidos *anterior, int es_clave,
+                            unsigned char *carga)
+{
+    CabeceraCuadro cuadro;
+    cuadro.tipo = es_clave ? CUADRO_CLAVE : CUADRO_DELTA;
+    cuadro.marca_ms = reloj_ms();
+
+    if (es_clave)
+    {
+        cuadro.longitud = sizeof(DatosCompartidos);
+        fwrite(&cuadro, sizeof(cuadro), 1, archivo_diario);
+        fwrite(actual, sizeof(DatosCompartidos), 1, archivo_diario);
+    }
+    else
+    {
+        // Agrupar bloques consecutivos modificados en un solo tramo
+        const unsigned char *nuevo = (const unsigned char *)actual;
+        const unsigned char *viejo = (const unsigned char *)anterior;
+        size_t tamano = sizeof(DatosCompartidos);
+        size_t usado = 0;
+        size_t pos = 0;
+
+        while (pos < tamano)
+        {
+            size_t bloque = (tamano - pos < BLOQUE_DIARIO) ? tamano - pos : BLOQUE_DIARIO;
+            if (memcmp(nuevo + pos, viejo + pos, bloque) == 0)
+            {
+                pos += bloque;
+                continue;
+            }
+
+            unsigned int desplazamiento = pos;
+            while (pos < tamano)
+            {
+                bloque = (tamano - pos < BLOQUE_DIARIO) ? tamano - pos : BLOQUE_DIARIO;
+                if (memcmp(nuevo + pos, viejo + pos, bloque) == 0)
+                    break;
+                pos += bloque;
+            }
+            unsigned int longitud = pos - desplazamiento;
+
+            memcpy(carga + usado, &desplazamiento, sizeof(desplazamiento));
+            memcpy(carga + usado + sizeof(desplazamiento), &longitud, sizeof(longitud));
+            usado += sizeof(desplazamiento) + sizeof(longitud);
+            memcpy(carga + usado, nuevo + desplazamiento, longitud);
+            usado += longitud;
+        }
+
+        cuadro.longitud = usado;
+        fwrite(&cuadro, sizeof(cuadro), 1, archivo_diario);
+        fwrite(carga, 1, usado, archivo_diario);
+    }
+
+    // Un diario cortado por una caída sigue siendo reproducible hasta el último cuadro
+    fflush(archivo_diario);
+}
+
+void *escritor_diario(void *arg)
+{
+    (void)arg;
+
+    DatosCompartidos *actual = malloc(sizeof(DatosCompartidos));
+    DatosCompartidos *anterior = malloc(sizeof(DatosCompartidos));
+
+    // Peor caso de un delta: todos los bloques cambiaron en tramos separados
+    size_t max_tramos = sizeof(DatosCompartidos) / BLOQUE_DIARIO + 1;
+    unsigned char *carga = malloc(sizeof(DatosCompartidos) + max_tramos * 2 * sizeof(unsigned int));
+
+    if (actual == NULL || anterior == NULL || carga == NULL)
+    {
+        printf("Error: Sin memoria para el diario de estado\n");
+        free(actual);
+        free(anterior);
+        free(carga);
+        return NULL;
+    }
+    registrar_componente(COMPONENTE_DIARIO, "diario");
+
+    int cuadro = 0;
+    int activo = 1;
+    while (activo)
+    {
+        contabilizar_despertar();
+        // El último cuadro se toma con el sistema ya detenido
+        activo = datos_compartidos->sistema_activo;
+
+        // Copia sin bloqueos, igual que la lectura que hace el panel
+        memcpy(actual, datos_compartidos, sizeof(DatosCompartidos));
+        escribir_cuadro_diario(actual, anterior, cuadro % CUADROS_POR_CLAVE == 0, carga);
+
+        DatosCompartidos *temporal = anterior;
+        anterior = actual;
+        actual = temporal;
+        cuadro++;
+
+        if (activo)
+            usleep(INTERVALO_DIARIO_MS * 1000);
+    }
+
+    free(actual);
+    free(anterior);
+    free(carga);
+    cerrar_componente();
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DEL ARCHIVO DE MÉTRICAS
+// ═══════════════════════════════════════════════════════════════
+
+int abrir_archivo_metricas(const char *ruta)
+{
+    // Geometría que debe tener el archivo: anillos de segundos, minutos y horas tras la cabecera
+    const int pasos[NUM_RESOLUCIONES_ARCHIVO] = {1, 60, 3600};
+    const int filas[NUM_RESOLUCIONES_ARCHIVO] = {FILAS_ARCHIVO_SEGUNDOS, FILAS_ARCHIVO_MINUTOS, FILAS_ARCHIVO_HORAS};
+    CabeceraArchivo esperada;
+    memset(&esperada, 0, sizeof(esperada));
+    memcpy(esperada.magia, MAGIA_ARCHIVO, sizeof(esperada.magia));
+    esperada.num_resoluciones = NUM_RESOLUCIONES_ARCHIVO;
+    long long desplazamiento = sizeof(CabeceraArchivo);
+    for (int r = 0; r < NUM_RESOLUCIONES_ARCHIVO; r++)
+    {
+        esperada.resoluciones[r].paso_s = pasos[r];
+        esperada.resoluciones[r].filas = filas[r];
+        esperada.resoluciones[r].desplazamiento = desplazamiento;
+        desplazamiento += (long long)filas[r] * sizeof(FilaArchivo);
+    }
+    esperada.tamano = desplazamiento;
+
+    int descriptor = open(ruta, O_RDWR | O_CREAT, 0644);
+    if (descriptor < 0)
+    {
+        perror("Error abriendo el archivo de métricas");
+        return 0;
+    }
+
+    // Una sola cocina escribe cada archivo; el panel solo lo lee
+    if (flock(descriptor, LOCK_EX | LOCK_NB) != 0)
+    {
+        printf("Error: Otra cocina ya escribe el archivo de métricas '%s'\n", ruta);
+        close(descriptor);
+        return 0;
+    }
+
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || (info.st_size != 0 && info.st_size != esperada.tamano))
+    {
+        printf("Error: '%s' no es un archivo de métricas con el formato actual\n", ruta);
+        close(descriptor);
+        return 0;
+    }
+    int nuevo = info.st_size == 0;
+    if (nuevo && ftruncate(descriptor, esperada.tamano) != 0)
+    {
+        perror("Error dimensionando el archivo de métricas");
+        close(descriptor);
+        return 0;
+    }
+
+    CabeceraArchivo *cabecera = mmap(NULL, esperada.tamano, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (cabecera == MAP_FAILED)
+    {
+        perror("Error proyectando el archivo de métricas");
+        close(descriptor);
+        return 0;
+    }
+
+    if (nuevo)
+    {
+        memcpy(cabecera, &esperada, sizeof(esperada));
+    }
+    else if (memcmp(cabecera->magia, MAGIA_ARCHIVO, sizeof(cabecera->magia)) != 0 ||
+             cabecera->num_resoluciones != NUM_RESOLUCIONES_ARCHIVO ||
+             memcmp(cabecera->resoluciones, esperada.resoluciones, sizeof(esperada.resoluciones)) != 0)
+    {
+        printf("Error: '%s' no es un archivo de métricas con el formato actual\n", ruta);
+        munmap(cabecera, esperada.tamano);
+        close(descriptor);
+        return 0;
+    }
+
+    // Una corrida que cayó a mitad de una escritura deja la secuencia impar
+    if (cabecera->secuencia % 2 != 0)
+        cabecera->secuencia++;
+    snprintf(cabecera->nombre_instancia, MAX_NOMBRE_INSTANCIA, "%s", nombre_cocina);
+
+    archivo_metricas = cabecera;
+    descriptor_archivo = descriptor;
+
+    // El panel puede correr en otro directorio: se publica la ruta absoluta
+    char absoluta[PATH_MAX];
+    if (realpath(ruta, absoluta) != NULL && strlen(absoluta) < sizeof(ruta_archivo_metricas))
+        strcpy(ruta_archivo_metricas, absoluta);
+    return 1;
+}
+
+FilaArchivo *fila_archivo(CabeceraArchivo *cabecera, int resolucion, long long inicio_s)
+{
+    ResolucionArchivo *anillo = &cabecera->resoluciones[resolucion];
+    FilaArchivo *filas = (FilaArchivo *)((char *)cabecera + anillo->desplazamiento);
+    return &filas[(inicio_s / anillo->paso_s) % anillo->filas];
+}
+
+void *archivador_metricas(void *arg)
+{
+    (void)arg;
+    registrar_componente(COMPONENTE_ARCHIVO, "archivo");
+
+    // Histograma del intervalo abierto de cada resolución: los percentiles no se pueden promediar
+    static int abiertos[NUM_RESOLUCIONES_ARCHIVO][NUM_CUBETAS_LATENCIA];
+    static int recientes[NUM_CUBETAS_LATENCIA];
+    int muestras_abiertas[NUM_RESOLUCIONES_ARCHIVO] = {0};
+    long long inicio_abierto[NUM_RESOLUCIONES_ARCHIVO] = {0};
+
+    CabeceraArchivo *cabecera = archivo_metricas;
+    int completadas_previas = datos_compartidos->total_ordenes_procesadas;
+    int generadas_previas = datos_compartidos->total_ordenes_generadas;
+    unsigned int agotamientos_previos = __atomic_load_n(&agotamientos_dispensador, __ATOMIC_RELAXED);
+
+    int activo = 1;
+    while (activo)
+    {
+        contabilizar_despertar();
+        // La última muestra se toma con el sistema ya detenido
+        activo = datos_compartidos->sistema_activo;
+
+        // Lecturas sin bloqueo, como las de la instantánea del panel
+        long long ahora_s = time(NULL);
+        int completadas = datos_compartidos->total_ordenes_procesadas;
+        int generadas = datos_compartidos->total_ordenes_generadas;
+        unsigned int agotamientos = __atomic_load_n(&agotamientos_dispensador, __ATOMIC_RELAXED);
+        int en_cola = datos_compartidos->cola_espera.tamano - datos_compartidos->cola_espera.lapidas;
+
+        pthread_mutex_lock(&mutex_latencias);
+        int nuevas = muestras_archivo;
+        if (nuevas > 0)
+        {
+            memcpy(recientes, histograma_archivo, sizeof(recientes));
+            memset(histograma_archivo, 0, sizeof(histograma_archivo));
+            muestras_archivo = 0;
+        }
+        pthread_mutex_unlock(&mutex_latencias);
+
+        // Escritura con seqlock: secuencia impar mientras se actualizan las filas
+        unsigned int secuencia = cabecera->secuencia;
+        __atomic_store_n(&cabecera->secuencia, secuencia + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        for (int r = 0; r < NUM_RESOLUCIONES_ARCHIVO; r++)
+        {
+            long long inicio = ahora_s - ahora_s % cabecera->resoluciones[r].paso_s;
+            FilaArchivo *fila = fila_archivo(cabecera, r, inicio);
+            if (inicio_abierto[r] != inicio)
+            {
+                memset(abiertos[r], 0, sizeof(abiertos[r]));
+                muestras_abiertas[r] = 0;
+                inicio_abierto[r] = inicio;
+            }
+
+            // Fila de otra vuelta del anillo. Si es del mismo intervalo de una corrida anterior se suman
+            // los contadores, pero no los percentiles: el histograma de esa corrida no queda en el archivo
+            if (fila->inicio_s != inicio)
+            {
+                memset(fila, 0, sizeof(*fila));
+                fila->inicio_s = inicio;
+            }
+
+            fila->muestras++;
+            fila->completadas += completadas - completadas_previas;
+            fila->llegadas += generadas - generadas_previas;
+            fila->agotamientos += agotamientos - agotamientos_previos;
+            fila->cola_suma += en_cola;
+            if (en_cola > fila->cola_maxima)
+                fila->cola_maxima = en_cola;
+
+            if (nuevas > 0)
+            {
+                for (int i = 0; i < NUM_CUBETAS_LATENCIA; i++)
+                    abiertos[r][i] += recientes[i];
+                muestras_abiertas[r] += nuevas;
+                fila->latencias += nuevas;
+                fila->latencia_p50_ms = percentil_histograma(abiertos[r], muestras_abiertas[r], 50);
+                fila->latencia_p99_ms = percentil_histograma(abiertos[r], muestras_abiertas[r], 99);
+                fila->latencias_percentil = muestras_abiertas[r];
+            }
+        }
+        cabecera->actualizado_s = ahora_s;
+        __atomic_store_n(&cabecera->secuencia, secuencia + 2, __ATOMIC_RELEASE);
+
+        completadas_previas = completadas;
+        generadas_previas = generadas;
+        agotamientos_previos = agotamientos;
+
+        if (activo)
+            usleep(PERIODO_ARCHIVO_MS * 1000);
+    }
+
+    msync(cabecera, cabecera->tamano, MS_ASYNC);
+    cerrar_componente();
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE EXPORTACIÓN ARROW
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * @brief Convierte una marca del reloj monotónico a ms simulados desde el arranque
+ */
+static long long marca_simulada_ms(long long marca_ms)
+{
+    return (long long)((marca_ms - inicio_simulacion_ms) * aceleracion);
+}
+
+void exportar_orden_entregada(const Orden *orden, int banda_id, int tamano_lote, long long inicio_ms,
+                              long long entrega_ms)
+{
+    pthread_mutex_lock(&mutex_exportacion);
+    long long fila = anillo_ordenes.total++ % CAPACIDAD_EXPORTACION;
+    anillo_ordenes.id_orden[fila] = orden->id_orden;
+    anillo_ordenes.tipo[fila] = orden->tipo_hamburguesa;
+    anillo_ordenes.banda[fila] = banda_id;
+    anillo_ordenes.lote[fila] = tamano_lote;
+    anillo_ordenes.creacion_ms[fila] = marca_simulada_ms(orden->creacion_ms);
+    anillo_ordenes.inicio_ms[fila] = marca_simulada_ms(inicio_ms);
+    anillo_ordenes.entrega_ms[fila] = marca_simulada_ms(entrega_ms);
+    anillo_ordenes.latencia_ms[fila] = (long long)((entrega_ms - orden->creacion_ms) * aceleracion);
+    anillo_ordenes.prometida_ms[fila] = orden->eta_prometida_ms > 0 ? marca_simulada_ms(orden->eta_prometida_ms) : -1;
+    anillo_ordenes.precio[fila] = menu_hamburguesas[orden->tipo_hamburguesa].precio;
+    pthread_mutex_unlock(&mutex_exportacion);
+}
+
+void exportar_transicion_banda(int banda_id, int estado, int tipo_hamburguesa, long long marca_ms)
+{
+    pthread_mutex_lock(&mutex_exportacion);
+    long long fila = anillo_transiciones.total++ % CAPACIDAD_EXPORTACION;
+    anillo_transiciones.marca_ms[fila] = marca_simulada_ms(marca_ms);
+    anillo_transiciones.banda[fila] = banda_id;
+    anillo_transiciones.estado[fila] = estado;
+    anillo_transiciones.tipo[fila] = tipo_hamburguesa;
+    pthread_mutex_unlock(&mutex_exportacion);
+}
+
+void exportar_metricas(float throughput, float llegadas, float ingresos)
+{
+    // Lecturas sin bloqueo, como las de la instantánea del panel
+    int ocupadas = 0;
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        if (datos_compartidos->bandas[i].procesando_orden)
+            ocupadas++;
+    }
+
+    pthread_mutex_lock(&mutex_exportacion);
+    long long fila = anillo_metricas.total++ % CAPACIDAD_EXPORTACION;
+    anillo_metricas.marca_ms[fila] = tiempo_simulado_ms();
+    anillo_metricas.generadas[fila] = datos_compartidos->total_ordenes_generadas;
+    anillo_metricas.completadas[fila] = datos_compartidos->total_ordenes_procesadas;
+    anillo_metricas.en_cola[fila] = datos_compartidos->cola_espera.tamano - datos_compartidos->cola_espera.lapidas;
+    anillo_metricas.bandas_ocupadas[fila] = ocupadas;
+    anillo_metricas.throughput[fila] = throughput;
+    anillo_metricas.llegadas[fila] = llegadas;
+    anillo_metricas.ingresos_por_minuto[fila] = ingresos;
+    pthread_mutex_unlock(&mutex_exportacion);
+}
+
+/**
+ * @brief Bytes de cada valor de una columna numérica
+ */
+static int ancho_arrow(int tipo)
+{
+    return (tipo == ARROW_INT64 || tipo == ARROW_FLOAT64) ? 8 : 4;
+}
+
+/**
+ * @brief Arma la columna de un arreglo de anillo, de la fila más antigua a la más nueva
+ * @param total Filas agregadas al anillo desde el arranque
+ */
+static ColumnaArrow columna_anillo(const char *nombre, int tipo, const void *valores, long long total)
+{
+    ColumnaArrow columna;
+    memset(&columna, 0, sizeof(columna));
+    columna.nombre = nombre;
+    columna.tipo = tipo;
+
+    // Si el anillo ya dio la vuelta, la más antigua es la siguiente a sobrescribir
+    long long inicio = total < CAPACIDAD_EXPORTACION ? 0 : total % CAPACIDAD_EXPORTACION;
+    long long filas = total < CAPACIDAD_EXPORTACION ? total : CAPACIDAD_EXPORTACION;
+    columna.tramos[0] = (const char *)valores + inicio * ancho_arrow(tipo);
+    columna.filas_tramo[0] = filas - inicio;
+    columna.tramos[1] = valores;
+    columna.filas_tramo[1] = inicio;
+    return columna;
+}
+
+static int fb_escribir(Flatbuffer *fb, const void *valor, int tamano)
+{
+    int posicion = fb->largo;
+    if (valor != NULL)
+        memcpy(fb->datos + posicion, valor, tamano);
+    else
+        memset(fb->datos + posicion, 0, tamano);
+    fb->largo += tamano;
+    return posicion;
+}
+
+static void fb_alinear(Flatbuffer *fb, int alineacion)
+{
+    while (fb->largo % alineacion != 0)
+        fb->datos[fb->largo++] = 0;
+}
+
+/**
+ * @brief Apunta la referencia escrita en posicion hacia destino (siempre más adelante)
+ */
+static void fb_enlazar(Flatbuffer *fb, int posicion, int destino)
+{
+    unsigned int relativo = destino - posicion;
+    memcpy(fb->datos + posicion, &relativo, sizeof(relativo));
+}
+
+/**
+ * @brief Escribe una tabla con su vtable justo antes
+ * @param posiciones Recibe dónde quedó cada campo, para enlazar las referencias
+ * @return Posición de la tabla
+ */
+static int fb_tabla(Flatbuffer *fb, const CampoFlatbuffer *campos, int num_campos, int *posiciones)
+{
+    fb_alinear(fb, 4);
+    int vtabla = fb_escribir(fb, NULL, 4 + 2 * num_campos);
+    fb_alinear(fb, 4);
+    int tabla = fb_escribir(fb, NULL, 4);
+
+    // La vtable está en tabla - desplazamiento
+    int desplazamiento = tabla - vtabla;
+    memcpy(fb->datos + tabla, &desplazamiento, sizeof(desplazamiento));
+
+    unsigned short entradas[2 + MAX_COLUMNAS_ARROW];
+    for (int c = 0; c < num_campos; c++)
+    {
+        entradas[2 + c] = 0;
+        posiciones[c] = -1;
+        if (campos[c].tamano == 0)
+            continue;
+        // Los escalares se alinean a su tamaño; en little-endian los bytes bajos van primero
+        fb_alinear(fb, campos[c].tamano);
+        posiciones[c] = fb_escribir(fb, &campos[c].valor, campos[c].tamano);
+        entradas[2 + c] = posiciones[c] - tabla;
+    }
+    entradas[0] = 4 + 2 * num_campos;
+    entradas[1] = fb->largo - tabla;
+    memcpy(fb->datos + vtabla, entradas, entradas[0]);
+    return tabla;
+}
+
+/**
+ * @brief Escribe un vector de structs o de referencias (elementos NULL = referencias por enlazar)
+ * @return Posición del largo del vector; el primer elemento está 4 bytes después
+ */
+static int fb_vector(Flatbuffer *fb, int num_elementos, int tamano_elemento, const void *elementos)
+{
+    // El largo va justo antes del primer elemento, que queda alineado a su tamaño
+    int alineacion = tamano_elemento >= 8 ? 8 : 4;
+    fb_alinear(fb, 4);
+    while ((fb->largo + 4) % alineacion != 0)
+        fb_escribir(fb, NULL, 4);
+    int posicion = fb_escribir(fb, &num_elementos, 4);
+    fb_escribir(fb, elementos, num_elementos * tamano_elemento);
+    return posicion;
+}
+
+static int fb_cadena(Flatbuffer *fb, const char *texto)
+{
+    int largo = strlen(texto);
+    fb_alinear(fb, 4);
+    int posicion = fb_escribir(fb, &largo, 4);
+    fb_escribir(fb, texto, largo + 1);
+    return posicion;
+}
+
+/**
+ * @brief Escribe la tabla Schema con un Field por columna, todas sin nulos
+ * @return Posición de la tabla Schema
+ */
+static int fb_esquema(Flatbuffer *fb, const ColumnaArrow *columnas, int num_columnas)
+{
+    int posiciones[6];
+    int auxiliares[2];
+
+    // endianness ausente = Little; fields
+    CampoFlatbuffer campos_esquema[2] = {{0, 0}, {4, 0}};
+    int esquema = fb_tabla(fb, campos_esquema, 2, posiciones);
+    int vector = fb_vector(fb, num_columnas, 4, NULL);
+    fb_enlazar(fb, posiciones[1], vector);
+
+    for (int c = 0; c < num_columnas; c++)
+    {
+        // Tipo de la unión Type: Int = 2, FloatingPoint = 3, Utf8 = 5
+        int tipo = columnas[c].tipo;
+        int tipo_union = tipo == ARROW_UTF8 ? 5 : (tipo == ARROW_FLOAT32 || tipo == ARROW_FLOAT64) ? 3 : 2;
+
+        // name, nullable, type_type, type, dictionary (ausente), children
+        CampoFlatbuffer campos[6] = {{4, 0}, {1, 0}, {1, tipo_union}, {4, 0}, {0, 0}, {4, 0}};
+        int campo = fb_tabla(fb, campos, 6, posiciones);
+        fb_enlazar(fb, vector + 4 + 4 * c, campo);
+        fb_enlazar(fb, posiciones[0], fb_cadena(fb, columnas[c].nombre));
+
+        int tabla_tipo;
+        if (tipo_union == 2)
+        {
+            CampoFlatbuffer entero[2] = {{4, tipo == ARROW_INT64 ? 64 : 32}, {1, 1}};
+            tabla_tipo = fb_tabla(fb, entero, 2, auxiliares);
+        }
+        else if (tipo_union == 3)
+        {
+            // Precisión SINGLE = 1, DOUBLE = 2
+            CampoFlatbuffer flotante[1] = {{2, tipo == ARROW_FLOAT64 ? 2 : 1}};
+            tabla_tipo = fb_tabla(fb, flotante, 1, auxiliares);
+        }
+        else
+        {
+            tabla_tipo = fb_tabla(fb, NULL, 0, auxiliares);
+        }
+        fb_enlazar(fb, posiciones[3], tabla_tipo);
+
+        // Los lectores exigen la lista de hijos aunque esté vacía
+        fb_enlazar(fb, posiciones[5], fb_vector(fb, 0, 4, NULL));
+    }
+    return esquema;
+}
+
+/**
+ * @brief Escribe un mensaje encapsulado: marca de continuación, largo y metadatos rellenados a 8
+ * @return Bytes escritos (el metaDataLength del bloque)
+ */
+static int escribir_mensaje_arrow(FILE *archivo, Flatbuffer *fb)
+{
+    fb_alinear(fb, 8);
+    int prefijo[2] = {-1, fb->largo};
+    fwrite(prefijo, sizeof(int), 2, archivo);
+    fwrite(fb->datos, 1, fb->largo, archivo);
+    return sizeof(prefijo) + fb->largo;
+}
+
+/**
+ * @brief Completa con ceros hasta el siguiente múltiplo de 8 tras escribir bytes
+ */
+static void escribir_relleno_arrow(FILE *archivo, long long bytes)
+{
+    static const char ceros[8] = {0};
+    fwrite(ceros, 1, (8 - bytes % 8) % 8, archivo);
+}
+
+static long long alinear_8(long long bytes)
+{
+    return (bytes + 7) / 8 * 8;
+}
+
+int escribir_arrow(const char *ruta, const ColumnaArrow *columnas, int num_columnas, long long filas)
+{
+    FILE *archivo = fopen(ruta, "wb");
+    Flatbuffer *fb = malloc(sizeof(Flatbuffer));
+    if (archivo == NULL || fb == NULL)
+    {
+        printf("Error: No se pudo crear '%s'\n", ruta);
+        if (archivo != NULL)
+            fclose(archivo);
+        free(fb);
+        return 0;
+    }
+
+    static const char magia[8] = "ARROW1";
+    fwrite(magia, 1, sizeof(magia), archivo);
+
+    // Mensaje con el esquema: version, header_type, header
+    int posiciones[4];
+    fb->largo = 0;
+    int raiz = fb_escribir(fb, NULL, 4);
+    CampoFlatbuffer mensaje_esquema[3] = {{2, VERSION_ARROW}, {1, MENSAJE_ARROW_ESQUEMA}, {4, 0}};
+    fb_enlazar(fb, raiz, fb_tabla(fb, mensaje_esquema, 3, posiciones));
+    fb_enlazar(fb, posiciones[2], fb_esquema(fb, columnas, num_columnas));
+    escribir_mensaje_arrow(archivo, fb);
+
+    // Buffers de cada columna en el cuerpo: validez vacía (sin nulos) y sus valores, alineados a 8
+    long long nodos[MAX_COLUMNAS_ARROW][2];
+    long long buffers[MAX_COLUMNAS_ARROW * 3][2];
+    int num_buffers = 0;
+    long long cuerpo = 0;
+    for (int c = 0; c < num_columnas; c++)
+    {
+        nodos[c][0] = filas;
+        nodos[c][1] = 0;
+        buffers[num_buffers][0] = cuerpo;
+        buffers[num_buffers++][1] = 0;
+
+        long long largos[2] = {filas * ancho_arrow(columnas[c].tipo), 0};
+        if (columnas[c].tipo == ARROW_UTF8)
+        {
+            largos[0] = (filas + 1) * sizeof(int);
+            largos[1] = columnas[c].desplazamientos[filas];
+        }
+        for (int b = 0; b < (columnas[c].tipo == ARROW_UTF8 ? 2 : 1); b++)
+        {
+            buffers[num_buffers][0] = cuerpo;
+            buffers[num_buffers++][1] = largos[b];
+            cuerpo += alinear_8(largos[b]);
+        }
+    }
+
+    // Mensaje del lote: version, header_type, header, bodyLength; RecordBatch: length, nodes, buffers
+    BloqueArrow bloque = {ftell(archivo), 0, 0, cuerpo};
+    fb->largo = 0;
+    raiz = fb_escribir(fb, NULL, 4);
+    CampoFlatbuffer mensaje_lote[4] = {{2, VERSION_ARROW}, {1, MENSAJE_ARROW_LOTE}, {4, 0}, {8, cuerpo}};
+    fb_enlazar(fb, raiz, fb_tabla(fb, mensaje_lote, 4, posiciones));
+    CampoFlatbuffer lote[3] = {{8, filas}, {4, 0}, {4, 0}};
+    int posiciones_lote[3];
+    fb_enlazar(fb, posiciones[2], fb_tabla(fb, lote, 3, posiciones_lote));
+    fb_enlazar(fb, posiciones_lote[1], fb_vector(fb, num_columnas, sizeof(nodos[0]), nodos));
+    fb_enlazar(fb, posiciones_lote[2], fb_vector(fb, num_buffers, sizeof(buffers[0]), buffers));
+    bloque.largo_metadatos = escribir_mensaje_arrow(archivo, fb);
+
+    // Cuerpo: cada columna sale tal cual de su arreglo, sin copias intermedias
+    for (int c = 0; c < num_columnas; c++)
+    {
+        if (columnas[c].tipo == ARROW_UTF8)
+        {
+            fwrite(columnas[c].desplazamientos, sizeof(int), filas + 1, archivo);
+            escribir_relleno_arrow(archivo, (filas + 1) * sizeof(int));
+            fwrite(columnas[c].caracteres, 1, columnas[c].desplazamientos[filas], archivo);
+            escribir_relleno_arrow(archivo, columnas[c].desplazamientos[filas]);
+            continue;
+        }
+        int ancho = ancho_arrow(columnas[c].tipo);
+        for (int t = 0; t < 2; t++)
+        {
+            if (columnas[c].filas_tramo[t] > 0)
+                fwrite(columnas[c].tramos[t], ancho, columnas[c].filas_tramo[t], archivo);
+        }
+        escribir_relleno_arrow(archivo, filas * ancho);
+    }
+
+    // Fin del flujo y pie: version, schema, dictionaries (vacío), recordBatches
+    int fin_flujo[2] = {-1, 0};
+    fwrite(fin_flujo, sizeof(int), 2, archivo);
+    fb->largo = 0;
+    raiz = fb_escribir(fb, NULL, 4);
+    CampoFlatbuffer pie[4] = {{2, VERSION_ARROW}, {4, 0}, {4, 0}, {4, 0}};
+    fb_enlazar(fb, raiz, fb_tabla(fb, pie, 4, posiciones));
+    fb_enlazar(fb, posiciones[1], fb_esquema(fb, columnas, num_columnas));
+    fb_enlazar(fb, posiciones[2], fb_vector(fb, 0, sizeof(BloqueArrow), NULL));
+    fb_enlazar(fb, posiciones[3], fb_vector(fb, 1, sizeof(BloqueArrow), &bloque));
+    fwrite(fb->datos, 1, fb->largo, archivo);
+    fwrite(&fb->largo, sizeof(int), 1, archivo);
+    fwrite(magia, 1, 6, archivo);
+
+    int correcto = !ferror(archivo);
+    if (fclose(archivo) != 0)
+        correcto = 0;
+    free(fb);
+    if (!correcto)
+        printf("Error: No se pudo escribir '%s'\n", ruta);
+    return correcto;
+}
+
+void exportar_resultados_arrow()
+{
+    char ruta[320];
+    int escritos = 0;
+
+    pthread_mutex_lock(&mutex_exportacion);
+
+    long long total_ordenes = anillo_ordenes.total;
+    ColumnaArrow ordenes[] = {
+        columna_anillo("orden", ARROW_INT32, anillo_ordenes.id_orden, total_ordenes),
+        columna_anillo("tipo", ARROW_INT32, anillo_ordenes.tipo, total_ordenes),
+        columna_anillo("banda", ARROW_INT32, anillo_ordenes.banda, total_ordenes),
+        columna_anillo("lote", ARROW_INT32, anillo_ordenes.lote, total_ordenes),
+        columna_anillo("creacion_ms", ARROW_INT64, anillo_ordenes.creacion_ms, total_ordenes),
+        columna_anillo("inicio_ms", ARROW_INT64, anillo_ordenes.inicio_ms, total_ordenes),
+        columna_anillo("entrega_ms", ARROW_INT64, anillo_ordenes.entrega_ms, total_ordenes),
+        columna_anillo("latencia_ms", ARROW_INT64, anillo_ordenes.latencia_ms, total_ordenes),
+        columna_anillo("prometida_ms", ARROW_INT64, anillo_ordenes.prometida_ms, total_ordenes),
+        columna_anillo("precio", ARROW_FLOAT64, anillo_ordenes.precio, total_ordenes),
+    };
+    long long filas_ordenes = ordenes[0].filas_tramo[0] + ordenes[0].filas_tramo[1];
+    snprintf(ruta, sizeof(ruta), "%s/ordenes.arrow", directorio_arrow);
+    escritos += escribir_arrow(ruta, ordenes, sizeof(ordenes) / sizeof(ordenes[0]), filas_ordenes);
+
+    long long total_transiciones = anillo_transiciones.total;
+    ColumnaArrow transiciones[] = {
+        columna_anillo("marca_ms", ARROW_INT64, anillo_transiciones.marca_ms, total_transiciones),
+        columna_anillo("banda", ARROW_INT32, anillo_transiciones.banda, total_transiciones),
+        columna_anillo("estado", ARROW_INT32, anillo_transiciones.estado, total_transiciones),
+        columna_anillo("tipo", ARROW_INT32, anillo_transiciones.tipo, total_transiciones),
+    };
+    long long filas_transiciones = transiciones[0].filas_tramo[0] + transiciones[0].filas_tramo[1];
+    snprintf(ruta, sizeof(ruta), "%s/transiciones.arrow", directorio_arrow);
+    escritos += escribir_arrow(ruta, transiciones, sizeof(transiciones) / sizeof(transiciones[0]),
+                               filas_transiciones);
+
+    long long total_metricas = anillo_metricas.total;
+    ColumnaArrow metricas[] = {
+        columna_anillo("marca_ms", ARROW_INT64, anillo_metricas.marca_ms, total_metricas),
+        columna_anillo("generadas", ARROW_INT32, anillo_metricas.generadas, total_metricas),
+        columna_anillo("completadas", ARROW_INT32, anillo_metricas.completadas, total_metricas),
+        columna_anillo("en_cola", ARROW_INT32, anillo_metricas.en_cola, total_metricas),
+        columna_anillo("bandas_ocupadas", ARROW_INT32, anillo_metricas.bandas_ocupadas, total_metricas),
+        columna_anillo("throughput", ARROW_FLOAT32, anillo_metricas.throughput, total_metricas),
+        columna_anillo("llegadas", ARROW_FLOAT32, anillo_metricas.llegadas, total_metricas),
+        columna_anillo("ingresos_por_minuto", ARROW_FLOAT32, anillo_metricas.ingresos_por_minuto, total_metricas),
+    };
+    long long filas_metricas = metricas[0].filas_tramo[0] + metricas[0].filas_tramo[1];
+    snprintf(ruta, sizeof(ruta), "%s/metricas.arrow", directorio_arrow);
+    escritos += escribir_arrow(ruta, metricas, sizeof(metricas) / sizeof(metricas[0]), filas_metricas);
+
+    pthread_mutex_unlock(&mutex_exportacion);
+
+    // Menú para unir por tipo: tipo, nombre, precio e ingredientes
+    int tipos[NUM_TIPOS_HAMBURGUESA];
+    double precios[NUM_TIPOS_HAMBURGUESA];
+    int ingredientes[NUM_TIPOS_HAMBURGUESA];
+    int desplazamientos[NUM_TIPOS_HAMBURGUESA + 1];
+    char nombres[NUM_TIPOS_HAMBURGUESA * sizeof(menu_hamburguesas[0].nombre)];
+    desplazamientos[0] = 0;
+    for (int t = 0; t < NUM_TIPOS_HAMBURGUESA; t++)
+    {
+        tipos[t] = t;
+        precios[t] = menu_hamburguesas[t].precio;
+        ingredientes[t] = menu_hamburguesas[t].num_ingredientes;
+        int largo = strlen(menu_hamburguesas[t].nombre);
+        memcpy(nombres + desplazamientos[t], menu_hamburguesas[t].nombre, largo);
+        desplazamientos[t + 1] = desplazamientos[t] + largo;
+    }
+    ColumnaArrow menu[] = {
+        columna_anillo("tipo", ARROW_INT32, tipos, NUM_TIPOS_HAMBURGUESA),
+        {"nombre", ARROW_UTF8, {NULL, NULL}, {0, 0}, desplazamientos, nombres},
+        columna_anillo("precio", ARROW_FLOAT64, precios, NUM_TIPOS_HAMBURGUESA),
+        columna_anillo("ingredientes", ARROW_INT32, ingredientes, NUM_TIPOS_HAMBURGUESA),
+    };
+    snprintf(ruta, sizeof(ruta), "%s/menu.arrow", directorio_arrow);
+    escritos += escribir_arrow(ruta, menu, sizeof(menu) / sizeof(menu[0]), NUM_TIPOS_HAMBURGUESA);
+
+    printf("[ARROW] %d archivos en %s/: %lld órdenes, %lld transiciones, %lld segundos de métricas%s\n", escritos,
+           directorio_arrow, filas_ordenes, filas_transiciones, filas_metricas,
+           total_ordenes > CAPACIDAD_EXPORTACION || total_transiciones > CAPACIDAD_EXPORTACION ||
+                   total_metricas > CAPACIDAD_EXPORTACION
+               ? " (solo las más recientes)"
+               : "");
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE CONTABILIDAD DE CPU
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * @brief Lee los relojes del hilo en curso y los copia a su cuenta
+ */
+static void leer_relojes_hilo(CuentaCpu *cuenta)
+{
+    struct timespec cpu;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == 0)
+        cuenta->cpu_ns = (long long)cpu.tv_sec * 1000000000LL + cpu.tv_nsec;
+
+    struct rusage uso;
+    if (getrusage(RUSAGE_THREAD, &uso) == 0)
+    {
+        cuenta->cambios_voluntarios = uso.ru_nvcsw;
+        cuenta->cambios_involuntarios = uso.ru_nivcsw;
+    }
+    cuenta->ultima_lectura_ms = reloj_ms();
+}
+
+void registrar_componente(int componente, const char *nombre)
+{
+    CuentaCpu *cuenta = &datos_compartidos->cuentas_cpu[componente];
+    componente_hilo = componente;
+    snprintf(cuenta->nombre, sizeof(cuenta->nombre), "%s", nombre);
+    leer_relojes_hilo(cuenta);
+    cuenta->activo = 1;
+}
+
+void contabilizar_despertar()
+{
+    if (componente_hilo < 0)
+        return;
+
+    // Cada cuenta tiene un único escritor, su hilo; los lectores toleran valores de distintas lecturas
+    CuentaCpu *cuenta = &datos_compartidos->cuentas_cpu[componente_hilo];
+    cuenta->despertares++;
+    if (reloj_ms() - cuenta->ultima_lectura_ms >= INTERVALO_CUENTA_CPU_MS)
+        leer_relojes_hilo(cuenta);
+}
+
+void cerrar_componente()
+{
+    if (componente_hilo < 0)
+        return;
+
+    CuentaCpu *cuenta = &datos_compartidos->cuentas_cpu[componente_hilo];
+    leer_relojes_hilo(cuenta);
+    cuenta->activo = 0;
+    componente_hilo = -1;
+}
+
+void actualizar_uso_cpu()
+{
+    static long long ultima_ms = 0;
+    static long long cpu_proceso_anterior_ns = 0;
+
+    long long ahora = reloj_ms();
+    long long transcurrido_ms = ultima_ms > 0 ? ahora - ultima_ms : 0;
+    ultima_ms = ahora;
+
+    struct timespec cpu;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu) == 0)
+        datos_compartidos->cpu_proceso_ns = (long long)cpu.tv_sec * 1000000000LL + cpu.tv_nsec;
+
+    // Primera llamada: solo fija la referencia
+    if (transcurrido_ms <= 0)
+    {
+        cpu_proceso_anterior_ns = datos_compartidos->cpu_proceso_ns;
+        for (int c = 0; c < datos_compartidos->num_componentes; c++)
+        {
+            datos_compartidos->cuentas_cpu[c].cpu_anterior_ns = datos_compartidos->cuentas_cpu[c].cpu_ns;
+            datos_compartidos->cuentas_cpu[c].despertares_anteriores = datos_compartidos->cuentas_cpu[c].despertares;
+        }
+        return;
+    }
+
+    datos_compartidos->uso_cpu_proceso =
+        (datos_compartidos->cpu_proceso_ns - cpu_proceso_anterior_ns) / (transcurrido_ms * 1e6);
+    cpu_proceso_anterior_ns = datos_compartidos->cpu_proceso_ns;
+
+    for (int c = 0; c < datos_compartidos->num_componentes; c++)
+    {
+        CuentaCpu *cuenta = &datos_compartidos->cuentas_cpu[c];
+        long long cpu_ns = cuenta->cpu_ns;
+        long long despertares = cuenta->despertares;
+        cuenta->uso_cpu = (cpu_ns - cuenta->cpu_anterior_ns) / (transcurrido_ms * 1e6);
+        cuenta->despertares_por_segundo = (despertares - cuenta->despertares_anteriores) * 1000.0f / transcurrido_ms;
+        cuenta->cpu_anterior_ns = cpu_ns;
+        cuenta->despertares_anteriores = despertares;
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE TIEMPO SIMULADO Y ESCENARIOS
+// ═══════════════════════════════════════════════════════════════
+
+long long tiempo_simulado_ms()
+{
+    return (long long)((reloj_ms() - inicio_simulacion_ms) * aceleracion);
+}
+
+void dormir_simulado(long long ms)
+{
+    // Con --estres los pasos y las esperas no duran nada: solo se cede el procesador
+    if (segundos_estres > 0)
+    {
+        sched_yield();
+        return;
+    }
+    usleep((useconds_t)(ms * 1000 / aceleracion));
+}
+
+int cargar_escenario(const char *ruta, int num_bandas)
+{
+    FILE *archivo = fopen(ruta, "r");
+    if (archivo == NULL)
+    {
+        printf("Error: No se pudo abrir el escenario '%s'\n", ruta);
+        return 0;
+    }
+
+    const char *nombres_acciones[] = {"", "pausar", "reanudar", "tasa", "reabastecer", "fallar", "reparar",
+                                      "terminar", "bloquear", "cancelar", "exportar"};
+    char linea[256];
+    int num_linea = 0;
+    int valido = 1;
+
+    while (valido && fgets(linea, sizeof(linea), archivo) != NULL)
+    {
+        num_linea++;
+
+        // Ignorar comentarios y líneas vacías
+        char *comentario = strchr(linea, '#');
+        if (comentario != NULL)
+            *comentario = '\0';
+
+        char instante[32], accion[32], argumento[32] = "";
+        int campos = sscanf(linea, "%31s %31s %31s", instante, accion, argumento);
+        if (campos <= 0)
+            continue;
+
+        EventoEscenario evento;
+        memset(&evento, 0, sizeof(evento));
+        evento.linea = num_linea;
+
+        // El instante admite una "s" final: "60" o "60s"
+        char *fin;
+        double segundos = strtod(instante, &fin);
+        if (fin == instante || (*fin != '\0' && strcmp(fin, "s") != 0) || segundos < 0 || campos < 2)
+        {
+            printf("Error en escenario (línea %d): se esperaba \"<segundo> <acción> [argumento]\"\n", num_linea);
+            valido = 0;
+            break;
+        }
+        evento.instante_ms = (long long)(segundos * 1000);
+
+        for (int a = ACCION_PAUSAR; a <= ACCION_EXPORTAR; a++)
+        {
+            if (strcmp(accion, nombres_acciones[a]) == 0)
+                evento.accion = a;
+        }
+
+        switch (evento.accion)
+        {
+        case ACCION_PAUSAR:
+        case ACCION_REANUDAR:
+        case ACCION_REABASTECER:
+        case ACCION_FALLAR:
+        case ACCION_REPARAR:
+        case ACCION_BLOQUEAR:
+            if (strcmp(argumento, "todas") == 0)
+            {
+                evento.banda = TODAS_LAS_BANDAS;
+            }
+            else
+            {
+                evento.banda = atoi(argumento) - 1;
+                if (evento.banda < 0 || evento.banda >= num_bandas)
+                {
+                    printf("Error en escenario (línea %d): banda debe ser 1-%d o \"todas\"\n", num_linea,
+                           num_bandas);
+                    valido = 0;
+                }
+            }
+            break;
+        case ACCION_TASA:
+            evento.tasa = atof(argumento);
+            if (evento.tasa <= 0 || evento.tasa > 100)
+            {
+                printf("Error en escenario (línea %d): la tasa debe estar entre 0 y 100 órdenes/segundo\n",
+                       num_linea);
+                valido = 0;
+            }
+            break;
+        case ACCION_CANCELAR:
+            evento.id_orden = atoi(argumento);
+            if (evento.id_orden <= 0)
+            {
+                printf("Error en escenario (línea %d): cancelar requiere el número de orden\n", num_linea);
+                valido = 0;
+            }
+            break;
+        case ACCION_EXPORTAR:
+            if (directorio_arrow[0] == '\0')
+            {
+                printf("Error en escenario (línea %d): exportar requiere --arrow <DIR>\n", num_linea);
+                valido = 0;
+            }
+            break;
+        case ACCION_TERMINAR:
+            break;
+        default:
+            printf("Error en escenario (línea %d): acción desconocida '%s'\n", num_linea, accion);
+            valido = 0;
+            break;
+        }
+
+        if (valido && num_eventos_escenario >= MAX_EVENTOS_ESCENARIO)
+        {
+            printf("Error: El escenario supera los %d eventos\n", MAX_EVENTOS_ESCENARIO);
+            valido = 0;
+        }
+        if (!valido)
+            break;
+
+        // Inserción ordenada por instante; los eventos simultáneos conservan el orden del archivo
+        int pos = num_eventos_escenario++;
+        while (pos > 0 && eventos_escenario[pos - 1].instante_ms > evento.instante_ms)
+        {
+            eventos_escenario[pos] = eventos_escenario[pos - 1];
+            pos--;
+        }
+        eventos_escenario[pos] = evento;
+    }
+
+    fclose(archivo);
+    return valido;
+}
+
+void aplicar_evento_escenario(const EventoEscenario *evento)
+{
+    int desde = evento->banda == TODAS_LAS_BANDAS ? 0 : evento->banda;
+    int hasta = evento->banda == TODAS_LAS_BANDAS ? datos_compartidos->num_bandas - 1 : evento->banda;
+
+    printf("\n[ESCENARIO] t=%.1fs (línea %d)\n", evento->instante_ms / 1000.0, evento->linea);
+
+    switch (evento->accion)
+    {
+    case ACCION_TASA:
+        intervalo_orden_ms = (int)(1000 / evento->tasa);
+        if (intervalo_orden_ms < 1)
+            intervalo_orden_ms = 1;
+        printf("[ESCENARIO] Tasa de llegada: %.2f órdenes/segundo\n", evento->tasa);
+        return;
+
+    case ACCION_TERMINAR:
+        terminar_solicitado = 1;
+        return;
+
+    case ACCION_EXPORTAR:
+        exportar_resultados_arrow();
+        return;
+
+    case ACCION_CANCELAR:
+    {
+        const char *donde[] = {"no encontrada", "quitada de la cola", "la suelta su banda",
+                               "la descarta el asignador"};
+        printf("[ESCENARIO] Cancelar orden #%d: %s\n", evento->id_orden, donde[cancelar_orden(evento->id_orden)]);
+        return;
+    }
+    }
+
+    for (int i = desde; i <= hasta; i++)
+    {
+        Banda *banda = &datos_compartidos->bandas[i];
+
+        switch (evento->accion)
+        {
+        case ACCION_PAUSAR:
+        case ACCION_REANUDAR:
+        case ACCION_FALLAR:
+        case ACCION_REPARAR:
+            pthread_mutex_lock(&banda->mutex);
+            if (evento->accion == ACCION_PAUSAR || evento->accion == ACCION_REANUDAR)
+                banda->pausada = evento->accion == ACCION_PAUSAR;
+            else
+                banda->activa = evento->accion == ACCION_REPARAR;
+            notificar_eventos(&banda->eventos, DESPERTAR_UNO);
+            pthread_mutex_unlock(&banda->mutex);
+
+            agregar_log_banda(i,
+                              evento->accion == ACCION_PAUSAR     ? "BANDA PAUSADA POR ESCENARIO"
+                              : evento->accion == ACCION_REANUDAR ? "BANDA REANUDADA POR ESCENARIO"
+                              : evento->accion == ACCION_FALLAR   ? "BANDA AVERIADA POR ESCENARIO"
+                                                                  : "BANDA REPARADA POR ESCENARIO",
+                              evento->accion == ACCION_FALLAR);
+            break;
+
+        case ACCION_BLOQUEAR:
+            // Se aplica en el siguiente paso que prepare la banda
+            __atomic_store_n(&bloqueo_solicitado[i], 1, __ATOMIC_RELEASE);
+            agregar_log_banda(i, "ATASCO PROVOCADO POR ESCENARIO", 1);
+            break;
+        }
+    }
+
+    // Un solo reabastecimiento masivo para todas las bandas del evento
+    if (evento->accion == ACCION_REABASTECER)
+    {
+        BuzonComandos comando;
+        memset(&comando, 0, sizeof(comando));
+        comando.comando = COMANDO_REABASTECER;
+        comando.modo = REABASTECER_TODO;
+        comando.banda = evento->banda;
+        comando.ingrediente = -1;
+        aplicar_reabastecimiento_masivo(&comando);
+        despertar_asignador();
+        printf("[ESCENARIO] %d dispensadores reabastecidos en %d bandas\n", comando.dispensadores, comando.bandas);
+    }
+}
+
+void *ejecutor_escenario(void *arg)
+{
+    (void)arg;
+    registrar_componente(COMPONENTE_ESCENARIO, "escenario");
+
+    for (int i = 0; i < num_eventos_escenario && datos_compartidos->sistema_activo; i++)
+    {
+        // Esperar en tramos cortos para responder rápido a la terminación
+        while (datos_compartidos->sistema_activo && tiempo_simulado_ms() < eventos_escenario[i].instante_ms)
+        {
+            contabilizar_despertar();
+            long long restante_real = (eventos_escenario[i].instante_ms - tiempo_simulado_ms()) / aceleracion;
+            usleep((restante_real > 100 ? 100 : restante_real + 1) * 1000);
+        }
+
+        if (datos_compartidos->sistema_activo)
+            aplicar_evento_escenario(&eventos_escenario[i]);
+    }
+    cerrar_componente();
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DEL VIGILANTE DE BANDAS
+// ═══════════════════════════════════════════════════════════════
+
+void publicar_latido(Banda *banda, long long duracion_simulada_ms)
+{
+    long long esperado = (long long)(duracion_simulada_ms / aceleracion);
+    if (duracion_simulada_ms > 0 && esperado < 1)
+        esperado = 1;
+
+    __atomic_store_n(&banda->latido_ms, reloj_ms(), __ATOMIC_RELAXED);
+    __atomic_store_n(&banda->paso_esperado_ms, esperado, __ATOMIC_RELEASE);
+}
+
+int rescatar_orden(int banda_id, unsigned int generacion)
+{
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+
+    // Copia antes del CAS: mientras nadie reclame la generación, orden_actual y el lote no cambian
+    Orden ordenes[MAX_LOTE];
+    int tamano = banda->tamano_lote > 1 ? banda->tamano_lote : 1;
+    ordenes[0] = banda->orden_actual;
+    for (int i = 1; i < tamano; i++)
+    {
+        ordenes[i] = banda->lote[i - 1];
+    }
+    if (!__atomic_compare_exchange_n(&banda->generacion_orden, &generacion, generacion + 1, 0, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE))
+        return 0;
+
+    __atomic_store_n(&banda->atascada, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&banda->ordenes_rescatadas, tamano, __ATOMIC_RELAXED);
+
+    // Una cancelación pudo marcar la banda después de la copia. Con la cola y la banda tomadas se
+    // releen las marcas y el índice deja de apuntar a la banda: una cancelación posterior marca la
+    // entrada y la orden se da de baja al reencolarla
+    int reencoladas = 0;
+    pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+    pthread_mutex_lock(&banda->mutex);
+    for (int i = 0; i < tamano; i++)
+    {
+        const Orden *miembro = i == 0 ? &banda->orden_actual : &banda->lote[i - 1];
+        if (miembro->id_orden == ordenes[i].id_orden && miembro->cancelada)
+            ordenes[i].cancelada = 1;
+
+        EntradaIndice *entrada = buscar_en_indice(ordenes[i].id_orden);
+        if (ordenes[i].cancelada)
+        {
+            dar_de_baja_cancelada(&ordenes[i]);
+            continue;
+        }
+        if (entrada != NULL)
+            entrada->banda = -1;
+        reencoladas++;
+    }
+    pthread_mutex_unlock(&banda->mutex);
+    pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+
+    printf("\n⚠️  [VIGILANTE] Banda %d atascada en el paso %d/%d de %s #%d: %d orden(es) reencolada(s)\n",
+           banda_id + 1, ordenes[0].paso_actual, ordenes[0].num_ingredientes, ordenes[0].nombre_hamburguesa,
+           ordenes[0].id_orden, reencoladas);
+
+    // Los ingredientes que la banda atascada reservó se dan por perdidos
+    for (int i = 0; i < tamano; i++)
+    {
+        if (ordenes[i].cancelada)
+            continue;
+        ordenes[i].paso_actual = 0;
+        ordenes[i].asignada_a_banda = -1;
+        ordenes[i].intentos_asignacion = 0;
+        encolar_orden(&ordenes[i]);
+    }
+    notificar_eventos(&datos_compartidos->nueva_orden, DESPERTAR_TODOS);
+    return 1;
+}
+
+void *vigilante_bandas(void *arg)
+{
+    (void)arg;
+    registrar_componente(COMPONENTE_VIGILANTE, "vigilante");
+
+    while (datos_compartidos->sistema_activo)
+    {
+        contabilizar_despertar();
+        long long ahora = reloj_ms();
+
+        for (int i = 0; i < datos_compartidos->num_bandas; i++)
+        {
+            Banda *banda = &datos_compartidos->bandas[i];
+
+            // La generación se lee primero: el asignador la publica después del latido
+            unsigned int generacion = __atomic_load_n(&banda->generacion_asignada, __ATOMIC_ACQUIRE);
+            long long esperado = __atomic_load_n(&banda->paso_esperado_ms, __ATOMIC_ACQUIRE);
+            long long latido = __atomic_load_n(&banda->latido_ms, __ATOMIC_RELAXED);
+
+            // Una banda pausada no está atascada: el operador la detuvo a propósito
+            if (!banda->procesando_orden || banda->pausada || banda->atascada || esperado == 0)
+                continue;
+
+            if (ahora - latido > FACTOR_ATASCO * esperado + MARGEN_ATASCO_MS)
+                rescatar_orden(i, generacion);
+        }
+
+        usleep(PERIODO_VIGILANTE_MS * 1000);
+    }
+    cerrar_componente();
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE CONTADORES DE EVENTOS
+// ═══════════════════════════════════════════════════════════════
+
+void iniciar_mutex_compartido(pthread_mutex_t *mutex)
+{
+    pthread_mutexattr_t atributos;
+    pthread_mutexattr_init(&atributos);
+    pthread_mutexattr_setpshared(&atributos, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(mutex, &atributos);
+    pthread_mutexattr_destroy(&atributos);
+}
+
+long llamada_futex(unsigned int *palabra, int operacion, unsigned int valor, long long espera_us)
+{
+    struct timespec espera = {espera_us / 1000000, (espera_us % 1000000) * 1000};
+    int con_plazo = operacion == FUTEX_WAIT && espera_us != SIN_LIMITE;
+    return syscall(SYS_futex, palabra, operacion, valor, con_plazo ? &espera : NULL, NULL, 0);
+}
+
+unsigned int leer_eventos(ContadorEventos *eventos)
+{
+    return __atomic_load_n(&eventos->secuencia, __ATOMIC_ACQUIRE);
+}
+
+void esperar_eventos(ContadorEventos *eventos, unsigned int clave, long long espera_us)
+{
+    struct timespec ahora;
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    long long limite_us = ahora.tv_sec * 1000000LL + ahora.tv_nsec / 1000 + (espera_us > 0 ? espera_us : 0);
+
+    // Registrarse y después mirar la secuencia: o quien notifica ve el registro y
+    // despierta, o aquí se ve la secuencia nueva y no se duerme
+    __atomic_add_fetch(&eventos->esperando, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&eventos->secuencia, __ATOMIC_SEQ_CST) == clave)
+    {
+        // Lo que falta hasta el límite fijado al entrar: una señal o un despertar de más no alargan la espera
+        long long restante_us = SIN_LIMITE;
+        if (espera_us != SIN_LIMITE)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &ahora);
+            restante_us = limite_us - (ahora.tv_sec * 1000000LL + ahora.tv_nsec / 1000);
+            if (restante_us <= 0)
+                break;
+        }
+        llamada_futex(&eventos->secuencia, FUTEX_WAIT, clave, restante_us);
+    }
+    __atomic_sub_fetch(&eventos->esperando, 1, __ATOMIC_RELEASE);
+}
+
+void notificar_eventos(ContadorEventos *eventos, int despertar)
+{
+    __atomic_add_fetch(&eventos->secuencia, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&eventos->esperando, __ATOMIC_SEQ_CST) > 0)
+        llamada_futex(&eventos->secuencia, FUTEX_WAKE, despertar, 0);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DEL BUZÓN DE COMANDOS
+// ═══════════════════════════════════════════════════════════════
+
+void aplicar_reabastecimiento_masivo(BuzonComandos *comando)
+{
+    struct timespec inicio, fin;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    comando->dispensadores = 0;
+    comando->unidades = 0;
+    comando->bandas = 0;
+    comando->programado = tiempo_reabasto_ms > 0;
+
+    int num_bandas = datos_compartidos->num_bandas;
+    int es_plan = comando->comando == COMANDO_APLICAR_PLAN;
+    int desde = (es_plan || comando->banda == TODAS_LAS_BANDAS) ? 0 : comando->banda;
+    int hasta = (es_plan || comando->banda == TODAS_LAS_BANDAS) ? num_bandas - 1 : comando->banda;
+    int primer_ingrediente = comando->ingrediente < 0 ? 0 : comando->ingrediente;
+    int ultimo_ingrediente = comando->ingrediente < 0 ? MAX_INGREDIENTES - 1 : comando->ingrediente;
+
+    if (desde < 0 || hasta >= num_bandas || ultimo_ingrediente >= MAX_INGREDIENTES)
+        return;
+
+    // Un plan se agrupa por banda para aplicarlo con la misma pasada
+    int unidades_plan[MAX_BANDAS][MAX_INGREDIENTES];
+    int bandas_en_plan[MAX_BANDAS] = {0};
+    if (es_plan)
+    {
+        memset(unidades_plan, 0, sizeof(unidades_plan));
+        for (int r = 0; r < comando->num_recargas && r < MAX_RECARGAS_PLAN; r++)
+        {
+            RecargaPlan *recarga = &comando->recargas[r];
+            if (recarga->banda >= 0 && recarga->banda < num_bandas && recarga->ingrediente >= 0 &&
+                recarga->ingrediente < MAX_INGREDIENTES && recarga->unidades > 0)
+            {
+                unidades_plan[recarga->banda][recarga->ingrediente] += recarga->unidades;
+                bandas_en_plan[recarga->banda] = 1;
+            }
+        }
+    }
+
+    int rellenados_por_banda[MAX_BANDAS] = {0};
+
+    for (int b = desde; b <= hasta; b++)
+    {
+        Banda *banda = &datos_compartidos->bandas[b];
+        if (es_plan && !bandas_en_plan[b])
+            continue;
+
+        // Los workers toman un dispensador a la vez, así que tomarlos todos en
+        // orden de índice no puede interbloquearse y deja la banda consistente
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            pthread_mutex_lock(&banda->dispensadores[j].mutex);
+        }
+        // Una sola escritura para toda la banda: un lector no ve una banda rellenada a medias
+        abrir_escritura_inventario(banda);
+
+        int criticos_restantes = 0;
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            int cantidad = banda->dispensadores[j].cantidad;
+            int objetivo = cantidad;
+            if (es_plan)
+            {
+                objetivo = cantidad + unidades_plan[b][j];
+                if (objetivo > CAPACIDAD_DISPENSADOR)
+                    objetivo = CAPACIDAD_DISPENSADOR;
+            }
+            else if (j >= primer_ingrediente && j <= ultimo_ingrediente &&
+                     (comando->modo == REABASTECER_CRITICOS   ? cantidad <= UMBRAL_INVENTARIO_BAJO
+                      : comando->modo == REABASTECER_AGOTADOS ? cantidad == 0
+                                                              : 1))
+            {
+                objetivo = CAPACIDAD_DISPENSADOR;
+            }
+
+            int repuestas = reponer_dispensador(b, j, objetivo);
+            if (repuestas > 0)
+            {
+                comando->unidades += repuestas;
+                rellenados_por_banda[b]++;
+            }
+            if (objetivo <= UMBRAL_INVENTARIO_BAJO)
+            {
+                criticos_restantes++;
+            }
+        }
+        cerrar_escritura_inventario(banda);
+
+        for (int j = MAX_INGREDIENTES - 1; j >= 0; j--)
+        {
+            pthread_mutex_unlock(&banda->dispensadores[j].mutex);
+        }
+
+        if (rellenados_por_banda[b] > 0)
+        {
+            comando->dispensadores += rellenados_por_banda[b];
+            comando->bandas++;
+            if (comando->programado)
+                notificar_eventos(&banda->eventos, DESPERTAR_UNO);
+        }
+        // Programados, las alertas se apagan cuando la banda termina de rellenar
+        if (criticos_restantes == 0 && !comando->programado)
+        {
+            banda->necesita_reabastecimiento = 0;
+            banda->ultima_alerta_inventario = 0;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    comando->duracion_ns = (fin.tv_sec - inicio.tv_sec) * 1000000000LL + (fin.tv_nsec - inicio.tv_nsec);
+
+    // Los logs se escriben fuera de la pasada para no alargarla
+    for (int b = desde; b <= hasta; b++)
+    {
+        if (rellenados_por_banda[b] > 0)
+        {
+            char log_msg[60];
+            snprintf(log_msg, sizeof(log_msg), "%s (%d dispensadores)",
+                     comando->programado ? "REABASTECIMIENTO PROGRAMADO" : "REABASTECIDA", rellenados_por_banda[b]);
+            agregar_log_banda(b, log_msg, 0);
+        }
+    }
+}
+
+void despertar_asignador()
+{
+    notificar_eventos(&eventos_reabastecimiento, DESPERTAR_TODOS);
+}
+
+void esperar_reabastecimiento(unsigned int generacion, long long ms)
+{
+    if (segundos_estres > 0)
+    {
+        sched_yield();
+        return;
+    }
+
+    // limpiar_sistema también despierta al asignador para que note el apagado
+    esperar_eventos(&eventos_reabastecimiento, generacion, (long long)(ms * 1000 / aceleracion));
+}
+
+void *procesador_comandos(void *arg)
+{
+    (void)arg;
+    registrar_componente(COMPONENTE_COMANDOS, "comandos");
+    BuzonComandos *buzon = &datos_compartidos->buzon;
+
+    while (datos_compartidos->sistema_activo)
+    {
+        contabilizar_despertar();
+        // Tomar el comando; si el panel lo retiró antes, el CAS falla
+        unsigned int pendiente = BUZON_PENDIENTE;
+        if (!__atomic_compare_exchange_n(&buzon->estado, &pendiente, BUZON_APLICANDO, 0, __ATOMIC_ACQ_REL,
+                                         __ATOMIC_ACQUIRE))
+        {
+            // Dormir hasta que cambie el estado (o 200 ms para notar el apagado)
+            llamada_futex(&buzon->estado, FUTEX_WAIT, pendiente, 200000);
+            continue;
+        }
+
+        if (buzon->comando == COMANDO_REABASTECER || buzon->comando == COMANDO_APLICAR_PLAN)
+        {
+            aplicar_reabastecimiento_masivo(buzon);
+            if (buzon->dispensadores > 0)
+                despertar_asignador();
+        }
+        else if (buzon->comando == COMANDO_CANCELAR)
+        {
+            buzon->resultado_cancelacion = cancelar_orden(buzon->id_orden);
+            if (buzon->resultado_cancelacion != CANCELACION_NO_ENCONTRADA)
+                printf("\n[CANCELADA] Orden #%d cancelada desde el panel\n", buzon->id_orden);
+        }
+
+        __atomic_store_n(&buzon->estado, BUZON_RESUELTO, __ATOMIC_RELEASE);
+        llamada_futex(&buzon->estado, FUTEX_WAKE, INT_MAX, 0);
+    }
+    cerrar_componente();
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE HILOS DE TRABAJO
+// ═══════════════════════════════════════════════════════════════
+
+void *banda_worker(void *arg)
+{
+    int banda_id = *(int *)arg;
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+
+    char nombre_componente[MAX_NOMBRE_COMPONENTE];
+    snprintf(nombre_componente, sizeof(nombre_componente), "banda %d", banda_id + 1);
+    registrar_componente(COMPONENTE_PRIMERA_BANDA + banda_id, nombre_componente);
+    registrar_transicion_banda(banda, ESTADO_LINEA_OCIOSA, -1);
+
+    while (datos_compartidos->sistema_activo)
+    {
+        contabilizar_despertar();
+        pthread_mutex_lock(&banda->mutex);
+
+        // La clave va antes de mirar el estado: el panel cambia la pausa sin tomar el mutex
+        unsigned int clave = leer_eventos(&banda->eventos);
+
+        // Esperar mientras esté pausada o averiada
+        while ((banda->pausada || !banda->activa) && datos_compartidos->sistema_activo)
+        {
+            strcpy(banda->estado_actual, banda->activa ? "PAUSADA" : "AVERIADA");
+            registrar_transicion_banda(banda, ESTADO_LINEA_PAUSADA, -1);
+            pthread_mutex_unlock(&banda->mutex);
+            esperar_eventos(&banda->eventos, clave, SIN_LIMITE);
+            pthread_mutex_lock(&banda->mutex);
+            clave = leer_eventos(&banda->eventos);
+        }
+
+        if (!datos_compartidos->sistema_activo)
+        {
+            pthread_mutex_unlock(&banda->mutex);
+            break;
+        }
+
+        // Rellenos programados entre órdenes: los urgentes pasan antes que la cola, el resto usa los huecos
+        if (!banda->procesando_orden && (banda->reabasteciendo || reabasto_pendiente(banda, ordenes_en_espera() > 0)))
+        {
+            banda->reabasteciendo = 1;
+            strcpy(banda->estado_actual, "REABASTECIENDO");
+            registrar_transicion_banda(banda, ESTADO_LINEA_REABASTECIENDO, -1);
+            pthread_mutex_unlock(&banda->mutex);
+            ejecutar_reabastecimientos(banda_id);
+            continue;
+        }
+
+        // Si no está procesando, esperar
+        if (!banda->procesando_orden)
+        {
+            strcpy(banda->estado_actual, "ESPERANDO");
+
+            // Ociosa por falta de ingredientes si el asignador la descartó hace poco
+            int desabastecida = reloj_ms() - banda->ultimo_rechazo_inventario_ms < VENTANA_DESABASTECIDA_MS;
+            registrar_transicion_banda(banda, desabastecida ? ESTADO_LINEA_SIN_INVENTARIO : ESTADO_LINEA_OCIOSA, -1);
+
+            // Hasta que el asignador le entregue una orden, revisando el desabastecimiento cada 100 ms simulados
+            pthread_mutex_unlock(&banda->mutex);
+            esperar_eventos(&banda->eventos, clave, (long long)(100 * 1000 / aceleracion));
+            continue;
+        }
+
+        registrar_transicion_banda(banda, ESTADO_LINEA_OCUPADA, banda->orden_actual.tipo_hamburguesa);
+        unsigned int generacion = banda->generacion_asignada;
+        pthread_mutex_unlock(&banda->mutex);
+
+        // Procesar la orden asignada (con el resto de su lote, si lo tiene)
+        long long inicio_preparacion_ms = reloj_ms();
+        int resultado = procesar_orden(banda_id, &banda->orden_actual, generacion);
+        publicar_latido(banda, 0);
+        long long entrega_ms = reloj_ms();
+
+        // Cola antes que banda, como el asignador y cancelar_orden: el lote sale del
+        // índice antes de que la banda quede libre para otro
+        pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+        pthread_mutex_lock(&banda->mutex);
+
+        // Copia del lote antes de liberar la banda: el asignador puede darle otro enseguida
+        int tamano = banda->tamano_lote > 1 ? banda->tamano_lote : 1;
+        long long creacion_ms[MAX_LOTE];
+        long long prometida_ms[MAX_LOTE];
+        int entregadas = 0;
+        int canceladas = 0;
+        for (int i = 0; i < tamano; i++)
+        {
+            Orden *miembro = i == 0 ? &banda->orden_actual : &banda->lote[i - 1];
+            if (resultado == 0)
+                continue; // El vigilante ya la reencoló y la reindexó
+
+            desindexar_orden(miembro->id_orden);
+            anotar_desenlace_estres(miembro->id_orden);
+            liberar_cliente(miembro);
+            if (miembro->cancelada || resultado < 0)
+            {
+                canceladas++;
+                continue;
+            }
+            creacion_ms[entregadas] = miembro->creacion_ms;
+            prometida_ms[entregadas] = miembro->eta_prometida_ms;
+            entregadas++;
+            if (directorio_arrow[0] != '\0')
+                exportar_orden_entregada(miembro, banda_id, tamano, inicio_preparacion_ms, entrega_ms);
+        }
+        int tipo = banda->orden_actual.tipo_hamburguesa;
+        float precio = menu_hamburguesas[tipo].precio * entregadas;
+
+        char log_msg[100];
+        if (entregadas > 1)
+            sprintf(log_msg, "COMPLETADO lote de %d %s #%d", entregadas, banda->orden_actual.nombre_hamburguesa,
+                    banda->orden_actual.id_orden);
+        else if (entregadas == 1)
+            sprintf(log_msg, "COMPLETADA %s #%d", banda->orden_actual.nombre_hamburguesa, banda->orden_actual.id_orden);
+        else if (resultado != 0)
+            sprintf(log_msg, "CANCELADA %s #%d", banda->orden_actual.nombre_hamburguesa, banda->orden_actual.id_orden);
+        else
+            sprintf(log_msg, "RECUPERADA: %s #%d reasignada por atasco", banda->orden_actual.nombre_hamburguesa,
+                    banda->orden_actual.id_orden);
+
+        if (entregadas > 0)
+        {
+            banda->hamburguesas_procesadas += entregadas;
+            if (receta_larga(banda->orden_actual.tipo_hamburguesa))
+                largas_por_banda[banda_id] += entregadas;
+            banda->ingresos += precio;
+            if (entregadas > 1)
+                banda->lotes_completados++;
+        }
+        banda->procesando_orden = 0;
+        __atomic_store_n(&banda->atascada, 0, __ATOMIC_RELEASE);
+        strcpy(banda->estado_actual, "ESPERANDO");
+        strcpy(banda->ingrediente_actual, "");
+        registrar_transicion_banda(banda, ESTADO_LINEA_OCIOSA, -1);
+
+        // Con la cola tomada el asignador no puede darle otra orden antes de que se aparte para rellenar
+        if (umbral_reabasto != SIN_UMBRAL_REABASTO)
+            programar_reabasto_por_umbral(banda_id);
+        if (reabasto_pendiente(banda, ordenes_en_espera() > 0))
+            banda->reabasteciendo = 1;
+        pthread_mutex_unlock(&banda->mutex);
+        pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+
+        if (canceladas > 0)
+        {
+            pthread_mutex_lock(&datos_compartidos->mutex_global);
+            datos_compartidos->ordenes_canceladas += canceladas;
+            pthread_mutex_unlock(&datos_compartidos->mutex_global);
+        }
+
+        if (entregadas == 0)
+        {
+            // Rescatada por el vigilante (ya está en la cola) o cancelada entera: no cuenta como procesada
+            agregar_log_banda(banda_id, log_msg, resultado == 0);
+            verificar_inventario_banda(banda_id);
+            continue;
+        }
+
+        pthread_mutex_lock(&datos_compartidos->mutex_global);
+        datos_compartidos->total_ordenes_procesadas += entregadas;
+        datos_compartidos->lotes_procesados++;
+        datos_compartidos->ingresos_totales += precio;
+        pthread_mutex_unlock(&datos_compartidos->mutex_global);
+
+        // Latencia y error de la hora prometida en tiempo simulado para que sean comparables entre aceleraciones
+        registrar_preparacion(tipo, tamano, (entrega_ms - inicio_preparacion_ms) * aceleracion);
+        for (int i = 0; i < entregadas; i++)
+        {
+            registrar_latencia_orden((entrega_ms - creacion_ms[i]) * aceleracion);
+            if (prometida_ms[i] > 0)
+                registrar_error_eta((entrega_ms - prometida_ms[i]) * aceleracion);
+        }
+
+        agregar_log_banda(banda_id, log_msg, 0);
+
+        verificar_inventario_banda(banda_id);
+    }
+    cerrar_componente();
+    return NULL;
+}
+
+void *generador_ordenes(void *arg)
+{
+    (void)arg;
+    registrar_componente(COMPONENTE_GENERADOR, "generador");
+    int contador_ordenes = 1;
+    unsigned int semilla = (unsigned int)time(NULL);
+
+    while (datos_compartidos->sistema_activo)
+    {
+        contabilizar_despertar();
+
+        // En el drenado de --estres ya no entran órdenes (tampoco pasado el último número que sigue la prueba)
+        if (segundos_estres > 0 && (__atomic_load_n(&estres.drenando, __ATOMIC_ACQUIRE) ||
+                                    contador_ordenes >= CAPACIDAD_DESENLACES_ESTRES))
+        {
+            dormir_simulado(100);
+            continue;
+        }
+
+        if (num_clientes > 0)
+        {
+            // Población cerrada: la clave va antes de revisar, así un desenlace posterior corta la espera
+            unsigned int clave = leer_eventos(&eventos_clientes);
+            long long espera_ms = atender_clientes(&contador_ordenes, &semilla);
+            if (espera_ms > 0)
+                esperar_eventos(&eventos_clientes, clave, espera_ms * 1000);
+            continue;
+        }
+
+        emitir_orden(contador_ordenes++, SIN_CLIENTE);
+
+        // Intervalo configurado, modificable por la acción "tasa" de un escenario
+        dormir_simulado(intervalo_orden_ms);
+    }
+    cerrar_componente();
+    return NULL;
+}
+
+int emitir_orden(int id_orden, int cliente)
+{
+    Orden nueva_orden;
+    generar_orden_especifica(&nueva_orden, id_orden);
+    nueva_orden.intentos_asignacion = 0;
+    nueva_orden.cliente = cliente;
+    int admitida = admitir_orden(&nueva_orden);
+
+    pthread_mutex_lock(&datos_compartidos->mutex_global);
+    datos_compartidos->total_ordenes_generadas++;
+    if (!admitida)
+    {
+        datos_compartidos->ingresos_perdidos += menu_hamburguesas[nueva_orden.tipo_hamburguesa].precio;
+        datos_compartidos->ordenes_rechazadas++;
+    }
+    pthread_mutex_unlock(&datos_compartidos->mutex_global);
+    if (!admitida)
+    {
+        anotar_desenlace_estres(nueva_orden.id_orden);
+        liberar_cliente(&nueva_orden);
+    }
+
+    if (!admitida)
+        printf("\n⚠️  [RECHAZADA] Orden %s #%d: cola llena\n", nueva_orden.nombre_hamburguesa,
+               nueva_orden.id_orden);
+    else if (nueva_orden.eta_ms > 0)
+        printf("\n[NUEVA ORDEN] %s #%d generada - En cola, entrega estimada en %.0f s\n",
+               nueva_orden.nombre_hamburguesa, nueva_orden.id_orden,
+               (nueva_orden.eta_ms - reloj_ms()) * aceleracion / 1000.0);
+    else
+        printf("\n[NUEVA ORDEN] %s #%d generada - En cola (sin banda disponible para estimar entrega)\n",
+               nueva_orden.nombre_hamburguesa, nueva_orden.id_orden);
+
+    notificar_eventos(&datos_compartidos->nueva_orden, DESPERTAR_TODOS);
+    return admitida;
+}
+
+long long atender_clientes(int *contador_ordenes, unsigned int *semilla)
+{
+    long long ahora = reloj_ms();
+    long long proximo = ahora + ESPERA_MAXIMA_CLIENTES_MS;
+    int listos[MAX_CLIENTES];
+    int num_listos = 0;
+
+    pthread_mutex_lock(&mutex_clientes);
+    for (int c = 0; c < num_clientes; c++)
+    {
+        if (regreso_cliente[c] == CLIENTE_LIBERADO)
+        {
+            // Reflexión exponencial; con --estres los clientes vuelven enseguida
+            double u = (rand_r(semilla) + 1.0) / (RAND_MAX + 2.0);
+            long long pensar_ms = segundos_estres > 0 ? 0 : (long long)(-log(u) * tiempo_pensar_ms / aceleracion);
+            regreso_cliente[c] = ahora + pensar_ms;
+        }
+        if (regreso_cliente[c] == CLIENTE_ESPERANDO)
+            continue;
+
+        if (regreso_cliente[c] <= ahora)
+        {
+            regreso_cliente[c] = CLIENTE_ESPERANDO;
+            datos_compartidos->clientes_esperando++;
+            listos[num_listos++] = c;
+        }
+        else if (regreso_cliente[c] < proximo)
+        {
+            proximo = regreso_cliente[c];
+        }
+    }
+    pthread_mutex_unlock(&mutex_clientes);
+
+    // Fuera del mutex: si la cola está llena el rechazo libera al cliente en la misma llamada
+    for (int i = 0; i < num_listos; i++)
+    {
+        emitir_orden((*contador_ordenes)++, listos[i]);
+    }
+    return num_listos > 0 ? 0 : proximo - ahora;
+}
+
+void liberar_cliente(const Orden *orden)
+{
+    if (orden->cliente < 0 || orden->cliente >= num_clientes)
+        return;
+
+    pthread_mutex_lock(&mutex_clientes);
+    regreso_cliente[orden->cliente] = CLIENTE_LIBERADO;
+    datos_compartidos->clientes_esperando--;
+    suma_respuesta_clientes_ms += (long long)((reloj_ms() - orden->creacion_ms) * aceleracion);
+    ciclos_clientes++;
+    pthread_mutex_unlock(&mutex_clientes);
+
+    notificar_eventos(&eventos_clientes, DESPERTAR_UNO);
+}
+
+void *asignador_ordenes(void *arg)
+{
+    (void)arg;
+    registrar_componente(COMPONENTE_ASIGNADOR, "asignador");
+
+    while (datos_compartidos->sistema_activo)
+    {
+        contabilizar_despertar();
+        // Leídas antes del intento: un reabastecimiento o una llegada posterior cortan la espera
+        unsigned int generacion = leer_eventos(&eventos_reabastecimiento);
+        unsigned int llegadas = leer_eventos(&datos_compartidos->cola_espera.no_vacia);
+
+        Orden *orden = politica_asignacion == POLITICA_VALOR ? desencolar_orden_por_valor() : desencolar_orden();
+        if (orden != NULL && orden_expirada(orden, reloj_ms()))
+        {
+            // Venció mientras esperaba: no se le dedica tiempo de banda
+            pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+            registrar_orden_expirada(orden);
+            pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+        }
+        else if (orden != NULL)
+        {
+            orden->intentos_asignacion++;
+            int banda_asignada = encontrar_banda_disponible(orden);
+
+            // Con la banda elegida se forma el lote y se reservan sus ingredientes de una vez
+            Orden extras[MAX_LOTE - 1];
+            int num_extras = banda_asignada >= 0 ? reservar_lote(banda_asignada, orden, extras) : -1;
+
+            if (num_extras >= 0)
+            {
+                // Asignar orden a la banda encontrada
+                Banda *banda = &datos_compartidos->bandas[banda_asignada];
+                long long eta_ms = reloj_ms() + (long long)(PASO_RECOGIDA_MS / aceleracion) +
+                                   duracion_preparacion_ms(banda_asignada, orden->tipo_hamburguesa, num_extras + 1);
+
+                // Con la cola tomada el índice pasa a apuntar a la banda a la vez que se le entrega el lote
+                pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+                pthread_mutex_lock(&banda->mutex);
+                banda->procesando_orden = 1;
+                banda->orden_actual = *orden;
+                banda->tamano_lote = num_extras + 1;
+                for (int i = 0; i < num_extras; i++)
+                {
+                    banda->lote[i] = extras[i];
+                }
+                for (int i = 0; i <= num_extras; i++)
+                {
+                    Orden *miembro = i == 0 ? &banda->orden_actual : &banda->lote[i - 1];
+                    miembro->asignada_a_banda = banda_asignada;
+                    miembro->eta_ms = eta_ms;
+
+                    // Cancelada mientras el asignador la tenía: la banda devuelve sus ingredientes al empezar
+                    EntradaIndice *entrada = indexar_orden(miembro->id_orden);
+                    entrada->banda = banda_asignada;
+                    if (entrada->cancelar)
+                        miembro->cancelada = 1;
+                }
+                if (num_extras > 0)
+                    sprintf(banda->estado_actual, "PREPARANDO %dx %s", num_extras + 1, orden->nombre_hamburguesa);
+                else
+                    sprintf(banda->estado_actual, "PREPARANDO %s", orden->nombre_hamburguesa);
+
+                // Latido antes que la generación: el vigilante lee primero la generación
+                publicar_latido(banda, PASO_RECOGIDA_MS);
+                __atomic_store_n(&banda->generacion_asignada,
+                                 __atomic_load_n(&banda->generacion_orden, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+                pthread_mutex_unlock(&banda->mutex);
+                pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+                notificar_eventos(&banda->eventos, DESPERTAR_UNO);
+
+                char log_msg[100];
+                if (num_extras > 0)
+                    sprintf(log_msg, "ASIGNADO lote de %d %s #%d", num_extras + 1, orden->nombre_hamburguesa,
+                            orden->id_orden);
+                else
+                    sprintf(log_msg, "ASIGNADA %s #%d", orden->nombre_hamburguesa, orden->id_orden);
+                agregar_log_banda(banda_asignada, log_msg, 0);
+            }
+            else
+            {
+                // Re-encolar para intentar más tarde; si no llega a prepararse, la edad máxima la retira
+                encolar_orden(orden);
+                esperar_reabastecimiento(generacion, ESPERA_REINTENTO_MS); // Esperar antes del siguiente intento
+            }
+        }
+        else
+        {
+            // No hay órdenes: esperar a que llegue una, como mucho 200 ms simulados
+            esperar_eventos(&datos_compartidos->cola_espera.no_vacia, llegadas, (long long)(200 * 1000 / aceleracion));
+        }
+    }
+    cerrar_componente();
+    return NULL;
+}
+
+int encontrar_banda_disponible(Orden *orden)
+{
+    // Buscar banda libre con recursos suficientes; con velocidades distintas se comparan todas
+    int elegida = -1;
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        Banda *banda = &datos_compartidos->bandas[i];
+
+        pthread_mutex_lock(&banda->mutex);
+        int banda_libre = banda->activa && !banda->pausada && !banda->procesando_orden && !banda->reabasteciendo;
+        pthread_mutex_unlock(&banda->mutex);
+
+        if (banda_libre)
+        {
+            if (verificar_ingredientes_banda(i, orden))
+            {
+                if (preferir_banda(orden->tipo_hamburguesa, i, elegida))
+                    elegida = i;
+                if (!bandas_heterogeneas || asignacion_primera_libre)
+                    return elegida;
+                continue;
+            }
+
+            // Libre pero sin ingredientes: la línea de tiempo la muestra desabastecida
+            banda->ultimo_rechazo_inventario_ms = reloj_ms();
+        }
+    }
+    return elegida;
+}
+
+int receta_larga(int tipo)
+{
+    int suma = 0;
+    for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+    {
+        suma += planes_receta[r].duracion_total;
+    }
+    return planes_receta[tipo].duracion_total * NUM_TIPOS_HAMBURGUESA >= suma;
+}
+
+int preferir_banda(int tipo, int candidata, int actual)
+{
+    if (actual < 0)
+        return 1;
+    if (!bandas_heterogeneas || asignacion_primera_libre)
+        return 0;
+
+    const Banda *nueva = &datos_compartidos->bandas[candidata];
+    const Banda *previa = &datos_compartidos->bandas[actual];
+    long long duracion_nueva = duracion_restante_ms(nueva, tipo, 0, 1);
+    long long duracion_previa = duracion_restante_ms(previa, tipo, 0, 1);
+    // Corta con órdenes esperando detrás: la banda más lenta en general, las rápidas quedan para las largas
+    if (!receta_larga(tipo) && ordenes_en_espera() > 0 && nueva->velocidad != previa->velocidad)
+        return nueva->velocidad < previa->velocidad;
+    return duracion_nueva < duracion_previa;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE PROCESAMIENTO DE ÓRDENES
+// ═══════════════════════════════════════════════════════════════
+
+int procesar_orden(int banda_id, Orden *orden, unsigned int generacion)
+{
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+
+    // El vigilante pudo rescatarla antes de que la banda la tomara
+    if (__atomic_load_n(&banda->generacion_orden, __ATOMIC_ACQUIRE) != generacion)
+        return 0;
+
+    // Los ingredientes ya los reservó el asignador para todo el lote
+    int tamano = banda->tamano_lote > 1 ? banda->tamano_lote : 1;
+    const PlanReceta *plan = &planes_receta[orden->tipo_hamburguesa];
+    long long paso_ms = 0;
+    long long final_ms = (long long)(1000 * factor_lote(tamano));
+
+    char log_msg[100];
+    if (tamano > 1)
+        sprintf(log_msg, "INICIANDO lote de %d %s #%d", tamano, orden->nombre_hamburguesa, orden->id_orden);
+    else
+        sprintf(log_msg, "INICIANDO %s #%d", orden->nombre_hamburguesa, orden->id_orden);
+    agregar_log_banda(banda_id, log_msg, 0);
+
+    // Recursos compartidos tomados por los pasos en curso y la unidad en que terminan
+    int recursos_tomados[MAX_PASOS_RECETA];
+    int fin_recurso[MAX_PASOS_RECETA];
+    int num_tomados = 0;
+
+    // Simular la preparación según el calendario de la receta (cada paso para todo el lote).
+    // Los ingredientes de la orden vienen en el orden en que empiezan sus pasos; con --dag
+    // varios pasos corren a la vez y la espera es hasta que empieza el siguiente
+    int vivas = tamano;
+    for (int i = 0; i < orden->num_ingredientes; i++)
+    {
+        if (__atomic_load_n(&banda->generacion_orden, __ATOMIC_ACQUIRE) != generacion)
+        {
+            soltar_recursos(recursos_tomados, fin_recurso, &num_tomados, INT_MAX);
+            return 0;
+        }
+
+        // Equipo compartido: el paso no empieza hasta tener lugar (un lugar por banda, aunque sea un lote)
+        int recurso = recurso_de_paso(banda_id, orden->ingredientes_solicitados[i]);
+        if (recurso >= 0)
+        {
+            adquirir_recurso(recurso, banda);
+            recursos_tomados[num_tomados] = recurso;
+            fin_recurso[num_tomados] = plan->fin[i];
+            num_tomados++;
+        }
+
+        pthread_mutex_lock(&banda->mutex);
+
+        // Las canceladas dejan de ocupar la banda: el paso se hace solo para las vigentes
+        vivas = atender_cancelaciones_lote(banda, i);
+        if (vivas == 0)
+        {
+            pthread_mutex_unlock(&banda->mutex);
+            break;
+        }
+        tamano = vivas;
+        // La banda y la estación de este ingrediente pueden ir más lentas o más rápidas (--velocidad)
+        long long unidad_ms = (long long)(datos_compartidos->tiempo_por_ingrediente * 1000 * factor_lote(tamano) /
+                                          factor_paso(banda, orden->ingredientes_solicitados[i]));
+        int siguiente = i + 1 < orden->num_ingredientes ? plan->inicio[i + 1] : plan->duracion_total;
+        paso_ms = (siguiente - plan->inicio[i]) * unidad_ms;
+        final_ms = (long long)(1000 * factor_lote(tamano) / banda->velocidad);
+
+        orden->paso_actual = i + 1;
+        orden->eta_ms =
+            reloj_ms() + (long long)(duracion_restante_ms(banda, orden->tipo_hamburguesa, i, tamano) / aceleracion);
+        for (int k = 0; k < banda->tamano_lote - 1; k++)
+        {
+            banda->lote[k].paso_actual = orden->paso_actual;
+            banda->lote[k].eta_ms = orden->eta_ms;
+        }
+        strcpy(banda->ingrediente_actual, orden->ingredientes_solicitados[i]);
+        if (recetas_en_dag)
+        {
+            // Pasos en curso en las distintas estaciones
+            int largo = sprintf(banda->estado_actual, "EN CURSO");
+            char separador = ' ';
+            for (int k = 0; k <= i; k++)
+            {
+                if (plan->fin[k] > plan->inicio[i] && largo < (int)sizeof(banda->estado_actual) - 20)
+                {
+                    largo += sprintf(banda->estado_actual + largo, "%c%s", separador, orden->ingredientes_solicitados[k]);
+                    separador = '+';
+                }
+            }
+            if (tamano > 1)
+                sprintf(banda->estado_actual + largo, " x%d", tamano);
+        }
+        else if (tamano > 1)
+            sprintf(banda->estado_actual, "AGREGANDO %s x%d", orden->ingredientes_solicitados[i], tamano);
+        else
+            sprintf(banda->estado_actual, "AGREGANDO %s", orden->ingredientes_solicitados[i]);
+        pthread_mutex_unlock(&banda->mutex);
+
+        sprintf(log_msg, "Agregando %s...", orden->ingredientes_solicitados[i]);
+        agregar_log_banda(banda_id, log_msg, 0);
+
+        // Cada paso sigue a la espera del anterior
+        contabilizar_despertar();
+        publicar_latido(banda, paso_ms);
+
+        // Atasco provocado por un escenario: el paso se alarga sin publicar latidos
+        if (__atomic_exchange_n(&bloqueo_solicitado[banda_id], 0, __ATOMIC_ACQ_REL))
+        {
+            for (long long t = 0; t < DURACION_BLOQUEO_MS && datos_compartidos->sistema_activo; t += 100)
+                dormir_simulado(100);
+        }
+
+        // MODIFICADO: Usar tiempo configurado en lugar de valor fijo.
+        // Hasta el siguiente paso, soltando el equipo compartido en cuanto su paso termina
+        for (int t = plan->inicio[i]; t < siguiente;)
+        {
+            int hasta = siguiente;
+            for (int k = 0; k < num_tomados; k++)
+            {
+                if (fin_recurso[k] > t && fin_recurso[k] < hasta)
+                    hasta = fin_recurso[k];
+            }
+            dormir_simulado((hasta - t) * unidad_ms);
+            t = hasta;
+            soltar_recursos(recursos_tomados, fin_recurso, &num_tomados, t);
+        }
+    }
+    soltar_recursos(recursos_tomados, fin_recurso, &num_tomados, INT_MAX);
+
+    pthread_mutex_lock(&banda->mutex);
+    if (vivas > 0)
+        vivas = atender_cancelaciones_lote(banda, orden->num_ingredientes);
+    if (vivas == 0)
+    {
+        // Todo el lote cancelado: la banda lo suelta sin terminarlo, salvo que el vigilante ya lo rescatara
+        pthread_mutex_unlock(&banda->mutex);
+        return __atomic_compare_exchange_n(&banda->generacion_orden, &generacion, generacion + 1, 0,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+                   ? -1
+                   : 0;
+    }
+    sprintf(banda->estado_actual, "FINALIZANDO %s", orden->nombre_hamburguesa);
+    orden->eta_ms = reloj_ms() + (long long)(final_ms / aceleracion);
+    pthread_mutex_unlock(&banda->mutex);
+
+    agregar_log_banda(banda_id, tamano > 1 ? "LOTE LISTO!" : "HAMBURGUESA LISTA!", 0);
+    publicar_latido(banda, final_ms);
+    dormir_simulado(final_ms); // Tiempo final
+
+    // Cerrar la orden; si el vigilante la rescató mientras tanto, ya no es de esta banda
+    return __atomic_compare_exchange_n(&banda->generacion_orden, &generacion, generacion + 1, 0, __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE);
+}
+
+int verificar_ingredientes_banda(int banda_id, Orden *orden)
+{
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+
+    for (int i = 0; i < orden->num_ingredientes; i++)
+    {
+        int encontrado = 0;
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            if (strcmp(orden->ingredientes_solicitados[i],
+                       banda->dispensadores[j].nombre) == 0)
+            {
+                pthread_mutex_lock(&banda->dispensadores[j].mutex);
+                if (banda->dispensadores[j].cantidad <= 0)
+                {
+                    pthread_mutex_unlock(&banda->dispensadores[j].mutex);
+                    return 0;
+                }
+                pthread_mutex_unlock(&banda->dispensadores[j].mutex);
+                encontrado = 1;
+                break;
+            }
+        }
+        if (!encontrado)
+            return 0;
+    }
+    return 1;
+}
+
+int reservar_lote(int banda_id, Orden *orden, Orden extras[MAX_LOTE - 1])
+{
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+
+    // Unidades de cada dispensador que lleva una hamburguesa de este tipo
+    int por_orden[MAX_INGREDIENTES] = {0};
+    for (int i = 0; i < orden->num_ingredientes; i++)
+    {
+        int j = 0;
+        while (j < MAX_INGREDIENTES && strcmp(orden->ingredientes_solicitados[i], banda->dispensadores[j].nombre) != 0)
+            j++;
+        if (j == MAX_INGREDIENTES)
+            return -1;
+        por_orden[j]++;
+    }
+
+    pthread_mutex_lock(&cola->mutex);
+
+    // Candidatas del mismo tipo en la ventana, sin sacarlas todavía (ni lápidas ni vencidas)
+    int candidatas[MAX_LOTE - 1];
+    int num_candidatas = 0;
+    long long ahora = reloj_ms();
+    for (int k = 0; k < cola->tamano && k < VENTANA_EQUIDAD && num_candidatas < tamano_lote_maximo - 1; k++)
+    {
+        Orden *candidata = &cola->ordenes[(cola->frente + k) % MAX_ORDENES];
+        if (candidata->tipo_hamburguesa == orden->tipo_hamburguesa && !candidata->cancelada &&
+            !orden_expirada(candidata, ahora))
+            candidatas[num_candidatas++] = k;
+    }
+
+    // Todos los dispensadores de la receta a la vez, siempre en orden de índice
+    int tamano = num_candidatas + 1;
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
+    {
+        if (por_orden[j] == 0)
+            continue;
+        pthread_mutex_lock(&banda->dispensadores[j].mutex);
+        if (banda->dispensadores[j].cantidad / por_orden[j] < tamano)
+            tamano = banda->dispensadores[j].cantidad / por_orden[j];
+    }
+    abrir_escritura_inventario(banda);
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
+    {
+        if (por_orden[j] == 0)
+            continue;
+        banda->dispensadores[j].cantidad -= tamano * por_orden[j];
+        if (tamano > 0 && banda->dispensadores[j].cantidad == 0)
+            __atomic_add_fetch(&agotamientos_dispensador, 1, __ATOMIC_RELAXED);
+        banda->consumido[j] += tamano * por_orden[j];
+        libro_inventario[banda_id][j].retirado += tamano * por_orden[j];
+        pthread_mutex_unlock(&banda->dispensadores[j].mutex);
+    }
+    cerrar_escritura_inventario(banda);
+
+    if (tamano == 0)
+    {
+        pthread_mutex_unlock(&cola->mutex);
+        return -1;
+    }
+
+    // Sacar las que entran en el lote; las de la ventana que quedan avanzan sin perder su orden
+    int tomadas = tamano - 1;
+    if (tomadas > 0)
+    {
+        int ventana = candidatas[tomadas - 1] + 1;
+        int destino = ventana - 1;
+        int c = tomadas - 1;
+        for (int k = ventana - 1; k >= 0; k--)
+        {
+            Orden *actual = &cola->ordenes[(cola->frente + k) % MAX_ORDENES];
+            if (c >= 0 && candidatas[c] == k)
+            {
+                extras[c] = *actual;
+                desarmar_paciencia(&extras[c--]);
+                continue;
+            }
+            actual->veces_adelantada++;
+            if (destino != k)
+            {
+                cola->ordenes[(cola->frente + destino) % MAX_ORDENES] = *actual;
+                EntradaIndice *entrada = actual->cancelada ? NULL : buscar_en_indice(actual->id_orden);
+                if (entrada != NULL)
+                    entrada->posicion = (cola->frente + destino) % MAX_ORDENES;
+            }
+            destino--;
+        }
+        cola->frente = (cola->frente + tomadas) % MAX_ORDENES;
+        cola->tamano -= tomadas;
+        notificar_eventos(&cola->no_llena, DESPERTAR_UNO);
+    }
+
+    pthread_mutex_unlock(&cola->mutex);
+    return tomadas;
+}
+
+void devolver_ingredientes(Banda *banda, const Orden *orden, int desde_paso)
+{
+    for (int i = desde_paso; i < orden->num_ingredientes; i++)
+    {
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            if (strcmp(orden->ingredientes_solicitados[i], banda->dispensadores[j].nombre) == 0)
+            {
+                pthread_mutex_lock(&banda->dispensadores[j].mutex);
+                abrir_escritura_inventario(banda);
+                if (banda->dispensadores[j].cantidad < CAPACIDAD_DISPENSADOR)
+                {
+                    banda->dispensadores[j].cantidad++;
+                    libro_inventario[banda->id][j].devuelto++;
+                }
+                banda->consumido[j]--;
+                cerrar_escritura_inventario(banda);
+                pthread_mutex_unlock(&banda->dispensadores[j].mutex);
+                break;
+            }
+        }
+    }
+}
+
+int atender_cancelaciones_lote(Banda *banda, int paso)
+{
+    int vivas = 0;
+    for (int i = 0; i < banda->tamano_lote && i < MAX_LOTE; i++)
+    {
+        Orden *miembro = i == 0 ? &banda->orden_actual : &banda->lote[i - 1];
+        if (miembro->cancelada == 1)
+        {
+            devolver_ingredientes(banda, miembro, paso);
+            miembro->cancelada = 2;
+        }
+        if (!miembro->cancelada)
+            vivas++;
+    }
+    return vivas;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE COLA FIFO
+// ═══════════════════════════════════════════════════════════════
+
+void encolar_orden(Orden *orden)
+{
+    pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+
+    saltar_lapidas_frente();
+    unsigned int clave = leer_eventos(&datos_compartidos->cola_espera.no_llena);
+    while (datos_compartidos->cola_espera.tamano >= MAX_ORDENES)
+    {
+        pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+        esperar_eventos(&datos_compartidos->cola_espera.no_llena, clave, SIN_LIMITE);
+        pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+        clave = leer_eventos(&datos_compartidos->cola_espera.no_llena);
+    }
+
+    insertar_en_cola(orden);
+
+    notificar_eventos(&datos_compartidos->cola_espera.no_vacia, DESPERTAR_UNO);
+    pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+}
+
+int admitir_orden(Orden *orden)
+{
+    pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+
+    if (datos_compartidos->cola_espera.tamano >= MAX_ORDENES - RESERVA_REENCOLADO)
+    {
+        pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+        return 0;
+    }
+
+    orden->cola_al_llegar = datos_compartidos->cola_espera.tamano - datos_compartidos->cola_espera.lapidas;
+    if (insertar_en_cola(orden))
+        llegadas_por_tramo[tramo_carga(orden->cola_al_llegar)]++;
+
+    notificar_eventos(&datos_compartidos->cola_espera.no_vacia, DESPERTAR_UNO);
+    pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+    return 1;
+}
+
+int insertar_en_cola(Orden *orden)
+{
+    // Cancelada mientras estaba fuera de la cola (en manos del asignador o rescatada de una banda): no vuelve
+    EntradaIndice *entrada = buscar_en_indice(orden->id_orden);
+    if (orden->cancelada || (entrada != NULL && entrada->cancelar))
+    {
+        dar_de_baja_cancelada(orden);
+        return 0;
+    }
+
+    int posicion = datos_compartidos->cola_espera.atras;
+    Orden *encolada = &datos_compartidos->cola_espera.ordenes[posicion];
+    *encolada = *orden;
+    datos_compartidos->cola_espera.atras = (datos_compartidos->cola_espera.atras + 1) % MAX_ORDENES;
+    datos_compartidos->cola_espera.tamano++;
+
+    entrada = indexar_orden(orden->id_orden);
+    entrada->banda = -1;
+    entrada->posicion = posicion;
+    armar_paciencia(encolada);
+
+    // Estampar la hora estimada de entrega (la primera vez queda como prometida) y devolverla
+    estimar_eta_al_final(encolada);
+    orden->eta_ms = encolada->eta_ms;
+    orden->eta_prometida_ms = encolada->eta_prometida_ms;
+    return 1;
+}
+
+void dar_de_baja_cancelada(const Orden *orden)
+{
+    desindexar_orden(orden->id_orden);
+    anotar_desenlace_estres(orden->id_orden);
+    liberar_cliente(orden);
+    pthread_mutex_lock(&datos_compartidos->mutex_global);
+    datos_compartidos->ordenes_canceladas++;
+    pthread_mutex_unlock(&datos_compartidos->mutex_global);
+}
+
+Orden *desencolar_orden()
+{
+    static Orden orden_temp;
+
+    pthread_mutex_lock(&datos_compartidos->cola_espera.mutex);
+
+    // Las lápidas del frente se saltan aquí; su orden ya salió del índice
+    avanzar_rueda_paciencia(reloj_ms());
+    saltar_lapidas_frente();
+    if (datos_compartidos->cola_espera.tamano == 0)
+    {
+        pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+        return NULL;
+    }
+
+    orden_temp = datos_compartidos->cola_espera.ordenes[datos_compartidos->cola_espera.frente];
+    desarmar_paciencia(&orden_temp);
+    datos_compartidos->cola_espera.frente = (datos_compartidos->cola_espera.frente + 1) % MAX_ORDENES;
+    datos_compartidos->cola_espera.tamano--;
+
+    notificar_eventos(&datos_compartidos->cola_espera.no_llena, DESPERTAR_UNO);
+    pthread_mutex_unlock(&datos_compartidos->cola_espera.mutex);
+
+    return &orden_temp;
+}
+
+Orden *desencolar_orden_por_valor()
+{
+    static Orden orden_temp;
+
+    // Tipos que alguna banda libre puede preparar ahora (antes de tomar el mutex de la cola)
+    int puede_servir[MAX_BANDAS][NUM_TIPOS_HAMBURGUESA];
+    int servible[NUM_TIPOS_HAMBURGUESA] = {0};
+    calcular_bandas_servibles(puede_servir);
+    for (int b = 0; b < datos_compartidos->num_bandas; b++)
+    {
+        for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+        {
+            if (puede_servir[b][r] && !datos_compartidos->bandas[b].procesando_orden &&
+                !datos_compartidos->bandas[b].reabasteciendo)
+                servible[r] = 1;
+        }
+    }
+
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    pthread_mutex_lock(&cola->mutex);
+
+    avanzar_rueda_paciencia(reloj_ms());
+    saltar_lapidas_frente();
+    if (cola->tamano == 0)
+    {
+        pthread_mutex_unlock(&cola->mutex);
+        return NULL;
+    }
+
+    // Las lápidas de la ventana van con tipo -1 para que no se elijan
+    int tipos[VENTANA_EQUIDAD];
+    int adelantos[VENTANA_EQUIDAD];
+    int n = cola->tamano < VENTANA_EQUIDAD ? cola->tamano : VENTANA_EQUIDAD;
+    for (int k = 0; k < n; k++)
+    {
+        tipos[k] = cola->ordenes[(cola->frente + k) % MAX_ORDENES].cancelada
+                       ? -1
+                       : cola->ordenes[(cola->frente + k) % MAX_ORDENES].tipo_hamburguesa;
+        adelantos[k] = cola->ordenes[(cola->frente + k) % MAX_ORDENES].veces_adelantada;
+    }
+
+    // Si ninguna puede asignarse ahora se comporta como FIFO y la cabeza rota
+    int elegida = elegir_orden_por_valor(tipos, adelantos, n, servible);
+    if (elegida < 0)
+        elegida = 0;
+
+    // Las órdenes por delante de la elegida avanzan una posición y anotan el adelanto
+    orden_temp = cola->ordenes[(cola->frente + elegida) % MAX_ORDENES];
+    desarmar_paciencia(&orden_temp);
+    for (int k = elegida; k > 0; k--)
+    {
+        Orden *destino = &cola->ordenes[(cola->frente + k) % MAX_ORDENES];
+        *destino = cola->ordenes[(cola->frente + k - 1) % MAX_ORDENES];
+        destino->veces_adelantada++;
+
+        EntradaIndice *entrada = destino->cancelada ? NULL : buscar_en_indice(destino->id_orden);
+        if (entrada != NULL)
+            entrada->posicion = (cola->frente + k) % MAX_ORDENES;
+    }
+    cola->frente = (cola->frente + 1) % MAX_ORDENES;
+    cola->tamano--;
+
+    notificar_eventos(&cola->no_llena, DESPERTAR_UNO);
+    pthread_mutex_unlock(&cola->mutex);
+
+    return &orden_temp;
+}
+
+void saltar_lapidas_frente()
+{
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    while (cola->tamano > 0 && cola->ordenes[cola->frente].cancelada)
+    {
+        cola->frente = (cola->frente + 1) % MAX_ORDENES;
+        cola->tamano--;
+        cola->lapidas--;
+        notificar_eventos(&cola->no_llena, DESPERTAR_UNO);
+    }
+}
+
+static unsigned int casilla_indice(int id_orden)
+{
+    return ((unsigned int)id_orden * 2654435761u) & (CAPACIDAD_INDICE - 1);
+}
+
+EntradaIndice *buscar_en_indice(int id_orden)
+{
+    for (unsigned int i = casilla_indice(id_orden); indice_ordenes[i].id_orden != 0; i = (i + 1) & (CAPACIDAD_INDICE - 1))
+    {
+        if (indice_ordenes[i].id_orden == id_orden)
+            return &indice_ordenes[i];
+    }
+    return NULL;
+}
+
+EntradaIndice *indexar_orden(int id_orden)
+{
+    unsigned int i = casilla_indice(id_orden);
+    while (indice_ordenes[i].id_orden != 0 && indice_ordenes[i].id_orden != id_orden)
+        i = (i + 1) & (CAPACIDAD_INDICE - 1);
+
+    if (indice_ordenes[i].id_orden == 0)
+    {
+        indice_ordenes[i].id_orden = id_orden;
+        indice_ordenes[i].banda = -1;
+        indice_ordenes[i].posicion = -1;
+        indice_ordenes[i].cancelar = 0;
+    }
+    return &indice_ordenes[i];
+}
+
+void desindexar_orden(int id_orden)
+{
+    EntradaIndice *entrada = buscar_en_indice(id_orden);
+    if (entrada == NULL)
+        return;
+
+    // Borrado con desplazamiento hacia atrás: ninguna entrada queda detrás de un hueco que corte su sondeo
+    unsigned int hueco = entrada - indice_ordenes;
+    indice_ordenes[hueco].id_orden = 0;
+    for (unsigned int i = (hueco + 1) & (CAPACIDAD_INDICE - 1); indice_ordenes[i].id_orden != 0;
+         i = (i + 1) & (CAPACIDAD_INDICE - 1))
+    {
+        unsigned int ideal = casilla_indice(indice_ordenes[i].id_orden);
+        if (((i - ideal) & (CAPACIDAD_INDICE - 1)) >= ((i - hueco) & (CAPACIDAD_INDICE - 1)))
+        {
+            indice_ordenes[hueco] = indice_ordenes[i];
+            indice_ordenes[i].id_orden = 0;
+            hueco = i;
+        }
+    }
+}
+
+int cancelar_orden(int id_orden)
+{
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    int resultado = CANCELACION_NO_ENCONTRADA;
+
+    pthread_mutex_lock(&cola->mutex);
+    EntradaIndice *entrada = buscar_en_indice(id_orden);
+
+    if (entrada != NULL && entrada->banda >= 0)
+    {
+        // En una banda: la marca y la banda la suelta en su próximo paso
+        Banda *banda = &datos_compartidos->bandas[entrada->banda];
+        pthread_mutex_lock(&banda->mutex);
+        for (int i = 0; i < banda->tamano_lote && i < MAX_LOTE; i++)
+        {
+            Orden *miembro = i == 0 ? &banda->orden_actual : &banda->lote[i - 1];
+            if (miembro->id_orden == id_orden && !miembro->cancelada)
+            {
+                miembro->cancelada = 1;
+                resultado = CANCELACION_EN_BANDA;
+            }
+        }
+        pthread_mutex_unlock(&banda->mutex);
+    }
+    else if (entrada != NULL && (entrada->posicion - cola->frente + MAX_ORDENES) % MAX_ORDENES < cola->tamano &&
+             cola->ordenes[entrada->posicion].id_orden == id_orden)
+    {
+        // En la cola: lápida en su lugar, sin mover las demás
+        desarmar_paciencia(&cola->ordenes[entrada->posicion]);
+        cola->ordenes[entrada->posicion].cancelada = 1;
+        cola->lapidas++;
+        desindexar_orden(id_orden);
+        anotar_desenlace_estres(id_orden);
+        liberar_cliente(&cola->ordenes[entrada->posicion]);
+        resultado = CANCELACION_EN_COLA;
+
+        pthread_mutex_lock(&datos_compartidos->mutex_global);
+        datos_compartidos->ordenes_canceladas++;
+        pthread_mutex_unlock(&datos_compartidos->mutex_global);
+    }
+    else if (entrada != NULL && !entrada->cancelar)
+    {
+        // Fuera de la cola y aún sin banda: el asignador la tiene en mano
+        entrada->cancelar = 1;
+        resultado = CANCELACION_EN_ASIGNACION;
+    }
+    pthread_mutex_unlock(&cola->mutex);
+
+    return resultado;
+}
+
+int orden_expirada(const Orden *orden, long long ahora)
+{
+    return (ahora - orden->creacion_ms) * aceleracion > orden->paciencia_ms;
+}
+
+long long sortear_paciencia()
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    if (distribucion_paciencia == PACIENCIA_EXPONENCIAL)
+        return (long long)(-log(u) * edad_maxima_ms);
+    if (distribucion_paciencia == PACIENCIA_UNIFORME)
+        return (long long)((0.5 + u) * edad_maxima_ms);
+    return edad_maxima_ms;
+}
+
+int tramo_carga(int en_cola)
+{
+    int tramo = TRAMOS_CARGA_ABANDONO - 1;
+    while (tramo > 0 && en_cola < inicio_tramo_carga[tramo])
+        tramo--;
+    return tramo;
+}
+
+void mostrar_curva_abandonos()
+{
+    static const char *nombres[] = {"fija", "exponencial", "uniforme"};
+    long long admitidas = 0, abandonos = 0;
+    for (int t = 0; t < TRAMOS_CARGA_ABANDONO; t++)
+    {
+        admitidas += llegadas_por_tramo[t];
+        abandonos += abandonos_por_tramo[t];
+    }
+    printf("- Abandonos: %lld de %lld admitidas (%.1f%%), $%.2f perdidos, paciencia %s de media %lld s\n", abandonos,
+           admitidas, admitidas > 0 ? 100.0 * abandonos / admitidas : 0.0, ingresos_abandonados,
+           nombres[distribucion_paciencia], edad_maxima_ms / 1000);
+    if (admitidas == 0)
+        return;
+
+    // Proporción que abandona según cuántas había delante al llegar
+    printf("  Por cola al llegar:");
+    for (int t = 0; t < TRAMOS_CARGA_ABANDONO; t++)
+    {
+        if (t + 1 < TRAMOS_CARGA_ABANDONO)
+            printf(" %d-%d", inicio_tramo_carga[t], inicio_tramo_carga[t + 1] - 1);
+        else
+            printf(" %d+", inicio_tramo_carga[t]);
+        if (llegadas_por_tramo[t] > 0)
+            printf(" %.0f%% (%lld)", 100.0 * abandonos_por_tramo[t] / llegadas_por_tramo[t], llegadas_por_tramo[t]);
+        else
+            printf(" -");
+    }
+    printf("\n");
+}
+
+void iniciar_rueda_paciencia()
+{
+    for (int c = 0; c < CASILLAS_RUEDA_PACIENCIA; c++)
+    {
+        rueda_paciencia[c] = -1;
+    }
+    for (int i = 0; i < MAX_ORDENES; i++)
+    {
+        temporizadores_paciencia[i].id_orden = 0;
+        temporizadores_paciencia[i].siguiente = i + 1 < MAX_ORDENES ? i + 1 : -1;
+    }
+    temporizadores_libres = 0;
+    casilla_revisada = reloj_ms() / MS_CASILLA_PACIENCIA;
+}
+
+void armar_paciencia(Orden *orden)
+{
+    orden->temporizador = temporizadores_libres;
+    if (orden->temporizador < 0)
+        return; // Sin nodos: el asignador igual la descarta al sacarla
+
+    TemporizadorPaciencia *nodo = &temporizadores_paciencia[orden->temporizador];
+    temporizadores_libres = nodo->siguiente;
+
+    nodo->id_orden = orden->id_orden;
+    nodo->vence_ms = orden->creacion_ms + (long long)(orden->paciencia_ms / aceleracion);
+
+    // Uno ya vencido va a la próxima casilla a revisar
+    long long casilla = nodo->vence_ms / MS_CASILLA_PACIENCIA;
+    if (casilla <= casilla_revisada)
+        casilla = casilla_revisada + 1;
+    nodo->casilla = casilla % CASILLAS_RUEDA_PACIENCIA;
+    nodo->anterior = -1;
+    nodo->siguiente = rueda_paciencia[nodo->casilla];
+    if (nodo->siguiente >= 0)
+        temporizadores_paciencia[nodo->siguiente].anterior = orden->temporizador;
+    rueda_paciencia[nodo->casilla] = orden->temporizador;
+}
+
+void desarmar_paciencia(Orden *orden)
+{
+    int i = orden->temporizador;
+    orden->temporizador = -1;
+    if (i < 0 || i >= MAX_ORDENES || temporizadores_paciencia[i].id_orden != orden->id_orden)
+        return;
+
+    TemporizadorPaciencia *nodo = &temporizadores_paciencia[i];
+    if (nodo->anterior >= 0)
+        temporizadores_paciencia[nodo->anterior].siguiente = nodo->siguiente;
+    else
+        rueda_paciencia[nodo->casilla] = nodo->siguiente;
+    if (nodo->siguiente >= 0)
+        temporizadores_paciencia[nodo->siguiente].anterior = nodo->anterior;
+
+    nodo->id_orden = 0;
+    nodo->siguiente = temporizadores_libres;
+    temporizadores_libres = i;
+}
+
+void avanzar_rueda_paciencia(long long ahora)
+{
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    long long hasta = ahora / MS_CASILLA_PACIENCIA;
+
+    // Si pasó más de una vuelta basta con revisar cada casilla una vez
+    long long desde = casilla_revisada + 1;
+    if (hasta - desde >= CASILLAS_RUEDA_PACIENCIA)
+        desde = hasta - CASILLAS_RUEDA_PACIENCIA + 1;
+
+    int abandonos = 0;
+    for (long long casilla = desde; casilla <= hasta; casilla++)
+    {
+        int i = rueda_paciencia[casilla % CASILLAS_RUEDA_PACIENCIA];
+        while (i >= 0)
+        {
+            TemporizadorPaciencia *nodo = &temporizadores_paciencia[i];
+            int siguiente = nodo->siguiente;
+            // Vence en esta casilla o en una anterior (ya atrasado); los de otra vuelta esperan
+            if (nodo->vence_ms / MS_CASILLA_PACIENCIA <= casilla)
+            {
+                // El índice dice dónde está en la cola; el nodo solo existe mientras está ahí
+                EntradaIndice *entrada = buscar_en_indice(nodo->id_orden);
+                Orden *orden = entrada != NULL && entrada->banda < 0 && entrada->posicion >= 0
+                                   ? &cola->ordenes[entrada->posicion]
+                                   : NULL;
+                if (orden != NULL && orden->id_orden == nodo->id_orden && !orden->cancelada)
+                {
+                    desarmar_paciencia(orden);
+                    registrar_orden_expirada(orden);
+                    orden->cancelada = 1;
+                    cola->lapidas++;
+                    abandonos++;
+                }
+                else
+                {
+                    Orden suelta;
+                    suelta.id_orden = nodo->id_orden;
+                    suelta.temporizador = i;
+                    desarmar_paciencia(&suelta);
+                }
+            }
+            i = siguiente;
+        }
+        casilla_revisada = casilla;
+    }
+    if (hasta > casilla_revisada)
+        casilla_revisada = hasta;
+
+    if (abandonos > 0)
+        saltar_lapidas_frente();
+}
+
+void registrar_orden_expirada(const Orden *orden)
+{
+    printf("\n⚠️  [EXPIRADA] Orden %s #%d descartada tras %.0f s sin prepararse\n", orden->nombre_hamburguesa,
+           orden->id_orden, (reloj_ms() - orden->creacion_ms) * aceleracion / 1000.0);
+
+    desindexar_orden(orden->id_orden);
+    anotar_desenlace_estres(orden->id_orden);
+    liberar_cliente(orden);
+    abandonos_por_tramo[tramo_carga(orden->cola_al_llegar)]++;
+    ingresos_abandonados += menu_hamburguesas[orden->tipo_hamburguesa].precio;
+
+    pthread_mutex_lock(&datos_compartidos->mutex_global);
+    datos_compartidos->ingresos_perdidos += menu_hamburguesas[orden->tipo_hamburguesa].precio;
+    datos_compartidos->ordenes_descartadas++;
+    pthread_mutex_unlock(&datos_compartidos->mutex_global);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE DISPLAY
+// ═══════════════════════════════════════════════════════════════
+
+void mostrar_estado_columnar()
+{
+    printf("\033[2J\033[H"); // Limpiar pantalla
+
+    // Encabezado del sistema
+    printf("╔═══════════════════════════════════════════════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                                      SISTEMA DE HAMBURGUESAS - ESTADO                                         ║\n");
+    printf("║ Generadas: %-6d  │  Procesadas: %-6d  │  En cola: %-6d  │  Bandas: %-6d                              ║\n",
+           datos_compartidos->total_ordenes_generadas,
+           datos_compartidos->total_ordenes_procesadas,
+           datos_compartidos->cola_espera.tamano,
+           datos_compartidos->num_bandas);
+    printf("║ Nueva orden cada %ds │ Ingrediente cada %ds │ Asignacion inteligente FIFO                                  ║\n",
+           datos_compartidos->tiempo_nueva_orden,
+           datos_compartidos->tiempo_por_ingrediente);
+    printf("╚═══════════════════════════════════════════════════════════════════════════════════════════════════════════════╝\n");
+
+    // Mostrar alertas de inventario
+    int bandas_con_alertas = 0;
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+        {
+            bandas_con_alertas++;
+        }
+    }
+
+    if (bandas_con_alertas > 0)
+    {
+        printf("\n🚨 ALERTAS DE INVENTARIO: %d bandas necesitan reabastecimiento 🚨\n", bandas_con_alertas);
+        for (int i = 0; i < datos_compartidos->num_bandas; i++)
+        {
+            if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+            {
+                printf("   ⚠️  BANDA %d requiere reabastecimiento urgente\n", i + 1);
+            }
+        }
+        printf("\n");
+    }
+
+    // Layout columnar
+    const int ANCHO_COLUMNA = 40;
+    const int MAX_COLUMNAS = 3;
+
+    int filas_bandas = (datos_compartidos->num_bandas + MAX_COLUMNAS - 1) / MAX_COLUMNAS;
+
+    for (int fila = 0; fila < filas_bandas; fila++)
+    {
+        int banda_inicio = fila * MAX_COLUMNAS;
+        int banda_fin = (banda_inicio + MAX_COLUMNAS > datos_compartidos->num_bandas) ? datos_compartidos->num_bandas : banda_inicio + MAX_COLUMNAS;
+        int num_columnas_fila = banda_fin - banda_inicio;
+
+        // Bordes superiores
+        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╔", "╗  ╔", "╗", "═");
+
+        // Encabezados de bandas
+        char titulos[MAX_COLUMNAS][50];
+        for (int col = 0; col < num_columnas_fila; col++)
+        {
+            int banda_actual = banda_inicio + col;
+            sprintf(titulos[col], "BANDA %d", banda_actual + 1);
+            strcpy(titulos[col], centrar_texto(titulos[col], ANCHO_COLUMNA - 2));
+        }
+        imprimir_fila_contenido(titulos, num_columnas_fila, ANCHO_COLUMNA);
+
+        // Separador
+        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "═");
+
+        // Sección inventario
+        char subtitulo_inv[MAX_COLUMNAS][50];
+        for (int col = 0; col < num_columnas_fila; col++)
+        {
+            strcpy(subtitulo_inv[col], centrar_texto("INVENTARIO", ANCHO_COLUMNA - 2));
+        }
+        imprimir_fila_contenido(subtitulo_inv, num_columnas_fila, ANCHO_COLUMNA);
+
+        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "─");
+
+        // Mostrar inventario (8 líneas)
+        for (int ing = 0; ing < 8; ing++)
+        {
+            char lineas_inventario[MAX_COLUMNAS][50];
+
+            for (int col = 0; col < num_columnas_fila; col++)
+            {
+                int banda = banda_inicio + col;
+                if (banda < datos_compartidos->num_bandas && ing < MAX_INGREDIENTES)
+                {
+                    Banda *b = &datos_compartidos->bandas[banda];
+                    pthread_mutex_lock(&b->dispensadores[ing].mutex);
+
+                    char nombre_corto[15];
+                    strncpy(nombre_corto, b->dispensadores[ing].nombre, 14);
+                    nombre_corto[14] = '\0';
+
+                    int cantidad = b->dispensadores[ing].cantidad;
+
+                    if (cantidad == 0)
+                    {
+                        sprintf(lineas_inventario[col], "%-14s: %2d [AGOTADO]", nombre_corto, cantidad);
+                    }
+                    else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
+                    {
+                        sprintf(lineas_inventario[col], "%-14s: %2d [CRITICO]", nombre_corto, cantidad);
+                    }
+                    else
+                    {
+                        sprintf(lineas_inventario[col], "%-14s: %2d", nombre_corto, cantidad);
+                    }
+
+                    pthread_mutex_unlock(&b->dispensadores[ing].mutex);
+                }
+                else
+                {
+                    strcpy(lineas_inventario[col], "");
+                }
+            }
             imprimir_fila_contenido(lineas_inventario, num_columnas_fila, ANCHO_COLUMNA);
         }
 
-        // Separador para preparación
-        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "═");
+        // Separador para preparación
+        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "═");
+
+        // Sección preparación
+        char subtitulo_prep[MAX_COLUMNAS][50];
+        for (int col = 0; col < num_columnas_fila; col++)
+        {
+            strcpy(subtitulo_prep[col], centrar_texto("PREPARACION", ANCHO_COLUMNA - 2));
+        }
+        imprimir_fila_contenido(subtitulo_prep, num_columnas_fila, ANCHO_COLUMNA);
+
+        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "─");
+
+        // Estado de preparación (6 líneas)
+        for (int linea = 0; linea < 6; linea++)
+        {
+            char lineas_prep[MAX_COLUMNAS][50];
+
+            for (int col = 0; col < num_columnas_fila; col++)
+            {
+                int banda = banda_inicio + col;
+                if (banda < datos_compartidos->num_bandas)
+                {
+                    Banda *b = &datos_compartidos->bandas[banda];
+                    pthread_mutex_lock(&b->mutex);
+
+                    switch (linea)
+                    {
+                    case 0:
+                        if (b->procesando_orden)
+                        {
+                            char nombre_corto[18];
+                            strncpy(nombre_corto, b->orden_actual.nombre_hamburguesa, 17);
+                            nombre_corto[17] = '\0';
+                            sprintf(lineas_prep[col], "Orden %d: %s",
+                                    b->orden_actual.id_orden, nombre_corto);
+                        }
+                        else
+                        {
+                            strcpy(lineas_prep[col], "Sin orden activa");
+                        }
+                        break;
+                    case 1:
+                    {
+                        char estado_corto[25];
+                        strncpy(estado_corto, b->estado_actual, 24);
+                        estado_corto[24] = '\0';
+                        sprintf(lineas_prep[col], "Estado: %s", estado_corto);
+                    }
+                    break;
+                    case 2:
+                        if (b->procesando_orden && strlen(b->ingrediente_actual) > 0)
+                        {
+                            char ing_corto[18];
+                            strncpy(ing_corto, b->ingrediente_actual, 17);
+                            ing_corto[17] = '\0';
+                            sprintf(lineas_prep[col], "Ingrediente: %s", ing_corto);
+                        }
+                        else
+                        {
+                            strcpy(lineas_prep[col], "");
+                        }
+                        break;
+                    case 3:
+                        if (b->procesando_orden)
+                        {
+                            sprintf(lineas_prep[col], "Progreso: %d/%d pasos",
+                                    b->orden_actual.paso_actual, b->orden_actual.num_ingredientes);
+                        }
+                        else
+                        {
+                            strcpy(lineas_prep[col], "");
+                        }
+                        break;
+                    case 4:
+                        sprintf(lineas_prep[col], "Procesadas: %d", b->hamburguesas_procesadas);
+                        break;
+                    case 5:
+                        if (b->atascada)
+                        {
+                            strcpy(lineas_prep[col], "[ATASCADA]");
+                        }
+                        else if (b->pausada)
+                        {
+                            strcpy(lineas_prep[col], "[PAUSADA]");
+                        }
+                        else if (b->necesita_reabastecimiento)
+                        {
+                            strcpy(lineas_prep[col], "[NECESITA INVENTARIO]");
+                        }
+                        else
+                        {
+                            strcpy(lineas_prep[col], "");
+                        }
+                        break;
+                    }
+
+                    pthread_mutex_unlock(&b->mutex);
+                }
+                else
+                {
+                    strcpy(lineas_prep[col], "");
+                }
+            }
+            imprimir_fila_contenido(lineas_prep, num_columnas_fila, ANCHO_COLUMNA);
+        }
+
+        // Separador para logs
+        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "═");
+
+        // Sección logs
+        char subtitulo_logs[MAX_COLUMNAS][50];
+        for (int col = 0; col < num_columnas_fila; col++)
+        {
+            strcpy(subtitulo_logs[col], centrar_texto("LOGS", ANCHO_COLUMNA - 2));
+        }
+        imprimir_fila_contenido(subtitulo_logs, num_columnas_fila, ANCHO_COLUMNA);
+
+        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "─");
+
+        // Mostrar logs (6 líneas)
+        for (int log_line = 0; log_line < 6; log_line++)
+        {
+            char lineas_logs[MAX_COLUMNAS][50];
+
+            for (int col = 0; col < num_columnas_fila; col++)
+            {
+                int banda = banda_inicio + col;
+                if (banda < datos_compartidos->num_bandas)
+                {
+                    Banda *b = &datos_compartidos->bandas[banda];
+                    pthread_mutex_lock(&b->mutex);
+
+                    if (log_line < b->num_logs)
+                    {
+                        int log_idx = b->num_logs - 1 - log_line;
+                        if (log_idx >= 0)
+                        {
+                            char log_texto[44];
+                            strncpy(log_texto, b->logs[log_idx].mensaje, 35);
+                            log_texto[35] = '\0';
+                            if (b->logs[log_idx].es_alerta)
+                            {
+                                sprintf(lineas_logs[col], "🚨 %s", log_texto);
+                            }
+                            else
+                            {
+                                strcpy(lineas_logs[col], log_texto);
+                            }
+                        }
+                        else
+                        {
+                            strcpy(lineas_logs[col], "");
+                        }
+                    }
+                    else
+                    {
+                        strcpy(lineas_logs[col], "");
+                    }
+
+                    pthread_mutex_unlock(&b->mutex);
+                }
+                else
+                {
+                    strcpy(lineas_logs[col], "");
+                }
+            }
+            imprimir_fila_contenido(lineas_logs, num_columnas_fila, ANCHO_COLUMNA);
+        }
+
+        // Bordes inferiores
+        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╚", "╝  ╚", "╝", "═");
+        printf("\n");
+    }
+
+    printf("Presiona Ctrl+C para salir del sistema\n");
+    printf("⏱️  Tiempos: %ds por ingrediente, %ds entre órdenes\n",
+           datos_compartidos->tiempo_por_ingrediente,
+           datos_compartidos->tiempo_nueva_orden);
+}
+
+void mostrar_estado_compacto()
+{
+    printf("\033[2J\033[H");
+
+    printf("╔═══════════════════════════════════════════════════════════════════╗\n");
+    printf("║              SISTEMA DE HAMBURGUESAS - COMPACTO                   ║\n");
+    printf("╚═══════════════════════════════════════════════════════════════════╝\n");
+    printf("Generadas: %d │ Procesadas: %d │ En cola: %d │ Bandas: %d\n",
+           datos_compartidos->total_ordenes_generadas,
+           datos_compartidos->total_ordenes_procesadas,
+           datos_compartidos->cola_espera.tamano,
+           datos_compartidos->num_bandas);
+    printf("⏱️ Tiempos: %ds/ingrediente │ %ds entre órdenes\n\n",
+           datos_compartidos->tiempo_por_ingrediente,
+           datos_compartidos->tiempo_nueva_orden);
+
+    // Mostrar alertas
+    int bandas_con_alertas = 0;
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+        {
+            bandas_con_alertas++;
+        }
+    }
+
+    if (bandas_con_alertas > 0)
+    {
+        printf("🚨 ALERTAS: %d bandas necesitan reabastecimiento\n\n", bandas_con_alertas);
+    }
+
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        Banda *b = &datos_compartidos->bandas[i];
+
+        pthread_mutex_lock(&b->mutex);
+
+        printf("BANDA %d: %s%s", i + 1,
+               b->atascada ? "[ATASCADA]" : b->pausada ? "[PAUSADA]" : (b->activa ? "[ACTIVA]" : "[INACT]"),
+               b->necesita_reabastecimiento ? " ⚠️" : "");
+
+        if (b->procesando_orden)
+        {
+            char nombre_corto[16];
+            strncpy(nombre_corto, b->orden_actual.nombre_hamburguesa, 15);
+            nombre_corto[15] = '\0';
+            printf(" │ Orden %d: %s - Progreso: %d/%d",
+                   b->orden_actual.id_orden, nombre_corto,
+                   b->orden_actual.paso_actual, b->orden_actual.num_ingredientes);
+        }
+        else
+        {
+            char estado_corto[20];
+            strncpy(estado_corto, b->estado_actual, 19);
+            estado_corto[19] = '\0';
+            printf(" │ %s", estado_corto);
+        }
+
+        printf(" │ Procesadas: %d\n", b->hamburguesas_procesadas);
+
+        // Mostrar inventario crítico
+        printf("  Stock crítico: ");
+        int items_criticos = 0;
+        for (int j = 0; j < MAX_INGREDIENTES && items_criticos < 5; j++)
+        {
+            pthread_mutex_lock(&b->dispensadores[j].mutex);
+            if (b->dispensadores[j].cantidad == 0)
+            {
+                char nombre_muy_corto[8];
+                strncpy(nombre_muy_corto, b->dispensadores[j].nombre, 7);
+                nombre_muy_corto[7] = '\0';
+                printf("%s(AGOTADO) ", nombre_muy_corto);
+                items_criticos++;
+            }
+            else if (b->dispensadores[j].cantidad <= UMBRAL_INVENTARIO_BAJO)
+            {
+                char nombre_muy_corto[8];
+                strncpy(nombre_muy_corto, b->dispensadores[j].nombre, 7);
+                nombre_muy_corto[7] = '\0';
+                printf("%s(%d) ", nombre_muy_corto, b->dispensadores[j].cantidad);
+                items_criticos++;
+            }
+            pthread_mutex_unlock(&b->dispensadores[j].mutex);
+        }
+        if (items_criticos == 0)
+            printf("Ninguno");
+        printf("\n\n");
+
+        pthread_mutex_unlock(&b->mutex);
+    }
+
+    printf("Presiona Ctrl+C para salir del sistema\n");
+}
+
+void mostrar_estado_adaptativo()
+{
+#ifdef TIOCGWINSZ
+    struct winsize w;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0)
+    {
+        if (w.ws_col < 120)
+        {
+            mostrar_estado_compacto();
+            return;
+        }
+    }
+#endif
+    mostrar_estado_columnar();
+}
+
+void generar_orden_especifica(Orden *orden, int id)
+{
+    int tipo = rand() % NUM_TIPOS_HAMBURGUESA;
+    TipoHamburguesa *hamburguesa = &menu_hamburguesas[tipo];
+
+    orden->id_orden = id;
+    orden->tipo_hamburguesa = tipo;
+    strcpy(orden->nombre_hamburguesa, hamburguesa->nombre);
+    orden->num_ingredientes = hamburguesa->num_ingredientes;
+    orden->tiempo_creacion = time(NULL);
+    orden->creacion_ms = reloj_ms();
+    orden->paso_actual = 0;
+    orden->completada = 0;
+    orden->asignada_a_banda = -1;
+    orden->intentos_asignacion = 0;
+    orden->eta_ms = 0;
+    orden->eta_prometida_ms = 0;
+    orden->veces_adelantada = 0;
+    orden->cliente = SIN_CLIENTE;
+    orden->paciencia_ms = sortear_paciencia();
+    orden->cola_al_llegar = 0;
+    orden->temporizador = -1;
+    orden->cancelada = 0;
+
+    // En el orden en que empiezan los pasos: así devolver_ingredientes sabe qué no se usó
+    for (int i = 0; i < hamburguesa->num_ingredientes; i++)
+    {
+        strcpy(orden->ingredientes_solicitados[i], hamburguesa->ingredientes[planes_receta[tipo].orden[i]]);
+    }
+}
+
+void reabastecer_banda(int banda_id)
+{
+    if (banda_id >= 0 && banda_id < datos_compartidos->num_bandas)
+    {
+        // Todos los dispensadores en orden de índice y una sola escritura para la banda
+        Banda *banda = &datos_compartidos->bandas[banda_id];
+        for (int i = 0; i < MAX_INGREDIENTES; i++)
+        {
+            pthread_mutex_lock(&banda->dispensadores[i].mutex);
+        }
+        abrir_escritura_inventario(banda);
+        for (int i = 0; i < MAX_INGREDIENTES; i++)
+        {
+            reponer_dispensador(banda_id, i, CAPACIDAD_DISPENSADOR);
+        }
+        cerrar_escritura_inventario(banda);
+        for (int i = MAX_INGREDIENTES - 1; i >= 0; i--)
+        {
+            pthread_mutex_unlock(&banda->dispensadores[i].mutex);
+        }
+
+        if (tiempo_reabasto_ms > 0)
+        {
+            notificar_eventos(&datos_compartidos->bandas[banda_id].eventos, DESPERTAR_UNO);
+            agregar_log_banda(banda_id, "REABASTECIMIENTO PROGRAMADO", 0);
+            printf("\n📦 Banda %d: reabastecimiento programado\n", banda_id + 1);
+            return;
+        }
+
+        datos_compartidos->bandas[banda_id].necesita_reabastecimiento = 0;
+        datos_compartidos->bandas[banda_id].ultima_alerta_inventario = 0;
+
+        agregar_log_banda(banda_id, "BANDA REABASTECIDA", 0);
+        printf("\n✅ Banda %d reabastecida completamente\n", banda_id + 1);
+    }
+}
+
+int reponer_dispensador(int banda_id, int ingrediente, int objetivo)
+{
+    Ingrediente *dispensador = &datos_compartidos->bandas[banda_id].dispensadores[ingrediente];
+    int faltan = objetivo - dispensador->cantidad;
+    if (faltan <= 0)
+        return 0;
+
+    if (tiempo_reabasto_ms > 0)
+    {
+        // Queda el nivel más alto pedido; la banda lo aplica en su próximo hueco
+        if (objetivo > dispensador->objetivo_reabasto)
+            dispensador->objetivo_reabasto = objetivo;
+        return faltan;
+    }
+
+    libro_inventario[banda_id][ingrediente].repuesto += faltan;
+    dispensador->cantidad = objetivo;
+    return faltan;
+}
+
+void programar_reabasto_por_umbral(int banda_id)
+{
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+
+    // Todos los dispensadores en orden de índice y una sola escritura para la banda
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
+    {
+        pthread_mutex_lock(&banda->dispensadores[j].mutex);
+    }
+    abrir_escritura_inventario(banda);
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
+    {
+        if (banda->dispensadores[j].cantidad <= umbral_reabasto)
+            reponer_dispensador(banda_id, j, CAPACIDAD_DISPENSADOR);
+    }
+    cerrar_escritura_inventario(banda);
+    for (int j = MAX_INGREDIENTES - 1; j >= 0; j--)
+    {
+        pthread_mutex_unlock(&banda->dispensadores[j].mutex);
+    }
+}
+
+int ordenes_en_espera()
+{
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    return __atomic_load_n(&cola->tamano, __ATOMIC_RELAXED) - __atomic_load_n(&cola->lapidas, __ATOMIC_RELAXED);
+}
+
+int reabasto_pendiente(Banda *banda, int hay_espera)
+{
+    // Lectura sin mutex: a lo sumo la banda entra a rellenar y no encuentra nada
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
+    {
+        int cantidad = __atomic_load_n(&banda->dispensadores[j].cantidad, __ATOMIC_RELAXED);
+        int objetivo = __atomic_load_n(&banda->dispensadores[j].objetivo_reabasto, __ATOMIC_RELAXED);
+        if (objetivo > cantidad && (!hay_espera || cantidad <= UMBRAL_INVENTARIO_BAJO))
+            return 1;
+    }
+    return 0;
+}
+
+void ejecutar_reabastecimientos(int banda_id)
+{
+    Banda *banda = &datos_compartidos->bandas[banda_id];
+    int rellenados = 0;
+    long long parada_ms = 0;
+
+    for (int j = 0; j < MAX_INGREDIENTES && datos_compartidos->sistema_activo; j++)
+    {
+        Ingrediente *dispensador = &banda->dispensadores[j];
+
+        pthread_mutex_lock(&dispensador->mutex);
+        int cantidad = dispensador->cantidad;
+        if (dispensador->objetivo_reabasto <= cantidad)
+            dispensador->objetivo_reabasto = 0;
+        int programado = dispensador->objetivo_reabasto > 0;
+        pthread_mutex_unlock(&dispensador->mutex);
+
+        // Uno que no es urgente cede el turno en cuanto hay una orden esperando o asignada
+        int urgente = cantidad <= UMBRAL_INVENTARIO_BAJO;
+        if (!programado || (!urgente && (ordenes_en_espera() > 0 || banda->procesando_orden)))
+            continue;
+
+        pthread_mutex_lock(&banda->mutex);
+        strcpy(banda->ingrediente_actual, dispensador->nombre);
+        pthread_mutex_unlock(&banda->mutex);
+
+        long long inicio_ms = reloj_ms();
+        publicar_latido(banda, tiempo_reabasto_ms);
+        dormir_simulado(tiempo_reabasto_ms);
+        long long duracion_ms = (long long)((reloj_ms() - inicio_ms) * aceleracion);
+
+        // Parada con órdenes esperando: capacidad que la banda pudo haber usado
+        int perdida = ordenes_en_espera() > 0 || banda->procesando_orden;
+
+        // El objetivo pudo subir durante la parada; se aplica el último
+        pthread_mutex_lock(&dispensador->mutex);
+        if (dispensador->objetivo_reabasto > dispensador->cantidad)
+        {
+            abrir_escritura_inventario(banda);
+            libro_inventario[banda_id][j].repuesto += dispensador->objetivo_reabasto - dispensador->cantidad;
+            dispensador->cantidad = dispensador->objetivo_reabasto;
+            cerrar_escritura_inventario(banda);
+        }
+        dispensador->objetivo_reabasto = 0;
+        pthread_mutex_unlock(&dispensador->mutex);
+
+        pthread_mutex_lock(&banda->mutex);
+        banda->reabasto_ms += duracion_ms;
+        if (perdida)
+            banda->reabasto_perdido_ms += duracion_ms;
+        banda->dispensadores_reabastecidos++;
+        if (urgente)
+            banda->reabastos_urgentes++;
+        pthread_mutex_unlock(&banda->mutex);
+
+        rellenados++;
+        parada_ms += duracion_ms;
+    }
+    publicar_latido(banda, 0);
+
+    pthread_mutex_lock(&banda->mutex);
+    banda->reabasteciendo = 0;
+    strcpy(banda->ingrediente_actual, "");
+    pthread_mutex_unlock(&banda->mutex);
+
+    if (rellenados > 0)
+    {
+        despertar_asignador();
+
+        char log_msg[80];
+        snprintf(log_msg, sizeof(log_msg), "REABASTECIDA (%d dispensadores, %.1f s de parada)", rellenados,
+                 parada_ms / 1000.0);
+        agregar_log_banda(banda_id, log_msg, 0);
+
+        // Recalcular la alerta con el inventario nuevo, sin esperar el intervalo entre avisos
+        banda->ultima_alerta_inventario = 0;
+        verificar_inventario_banda(banda_id);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE MICROBENCHMARK
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * @brief Reloj monotónico en nanosegundos, para medir operaciones cortas
+ */
+static long long reloj_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int ejecutar_microbenchmarks()
+{
+    Orden muestras[MUESTRAS_MICROBENCH];
+    for (int i = 0; i < MUESTRAS_MICROBENCH; i++)
+        generar_orden_especifica(&muestras[i], i + 1);
+
+    int num_bandas = datos_compartidos->num_bandas;
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    volatile int resultado = 0;
+
+    // Despacho: solo la última banda está libre
+    for (int b = 0; b < num_bandas - 1; b++)
+        datos_compartidos->bandas[b].procesando_orden = 1;
+
+    long long mejor_despacho = LLONG_MAX;
+    for (int r = 0; r < REPETICIONES_MICROBENCH; r++)
+    {
+        long long inicio = reloj_ns();
+        for (int k = 0; k < ITERACIONES_MICROBENCH; k++)
+            resultado += encontrar_banda_disponible(&muestras[k % MUESTRAS_MICROBENCH]);
+        long long duracion = reloj_ns() - inicio;
+        if (duracion < mejor_despacho)
+            mejor_despacho = duracion;
+    }
+
+    for (int b = 0; b < num_bandas - 1; b++)
+        datos_compartidos->bandas[b].procesando_orden = 0;
+
+    // Cola: tamaño estable, cada orden que entra saca a la más antigua
+    int siguiente_id = 1;
+    for (int i = 0; i < MAX_ORDENES / 4; i++)
+    {
+        Orden orden = muestras[i % MUESTRAS_MICROBENCH];
+        orden.id_orden = siguiente_id++;
+        admitir_orden(&orden);
+    }
+
+    long long mejor_cola = LLONG_MAX;
+    for (int r = 0; r < REPETICIONES_MICROBENCH; r++)
+    {
+        long long inicio = reloj_ns();
+        for (int k = 0; k < ITERACIONES_MICROBENCH; k++)
+        {
+            Orden orden = muestras[k % MUESTRAS_MICROBENCH];
+            orden.id_orden = siguiente_id++;
+            resultado += admitir_orden(&orden);
+
+            Orden *sacada = desencolar_orden();
+            pthread_mutex_lock(&cola->mutex);
+            desindexar_orden(sacada->id_orden);
+            pthread_mutex_unlock(&cola->mutex);
+        }
+        long long duracion = reloj_ns() - inicio;
+        if (duracion < mejor_cola)
+            mejor_cola = duracion;
+    }
+
+    printf("- Microbenchmark despacho: %.1f ns/op (%d operaciones, %d bandas, mejor de %d)\n",
+           (double)mejor_despacho / ITERACIONES_MICROBENCH, ITERACIONES_MICROBENCH, num_bandas,
+           REPETICIONES_MICROBENCH);
+    printf("- Microbenchmark cola: %.1f ns/op (%d operaciones, %d en cola, mejor de %d)\n",
+           (double)mejor_cola / ITERACIONES_MICROBENCH, ITERACIONES_MICROBENCH, cola->tamano,
+           REPETICIONES_MICROBENCH);
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// FUNCIONES DE PRUEBA DE ESTRÉS
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * @brief Cuenta una violación y guarda la descripción de la primera
+ */
+static void anotar_violacion_estres(long long *contador, const char *formato, ...)
+{
+    pthread_mutex_lock(&mutex_estres);
+    (*contador)++;
+    if (estres.primera_violacion[0] == '\0')
+    {
+        va_list argumentos;
+        va_start(argumentos, formato);
+        vsnprintf(estres.primera_violacion, sizeof(estres.primera_violacion), formato, argumentos);
+        va_end(argumentos);
+    }
+    pthread_mutex_unlock(&mutex_estres);
+}
+
+void anotar_desenlace_estres(int id_orden)
+{
+    if (desenlaces_estres == NULL || id_orden <= 0 || id_orden >= CAPACIDAD_DESENLACES_ESTRES)
+        return;
+
+    if (__atomic_add_fetch(&desenlaces_estres[id_orden], 1, __ATOMIC_RELAXED) > 1)
+        anotar_violacion_estres(&estres.duplicadas, "orden #%d con más de un desenlace", id_orden);
+}
+
+int preparar_estres()
+{
+    // Memoria virtual: solo ocupa las páginas de los números que llegan a generarse
+    desenlaces_estres = calloc(CAPACIDAD_DESENLACES_ESTRES, 1);
+    if (desenlaces_estres == NULL)
+    {
+        printf("Error: No hay memoria para seguir las órdenes de la prueba de estrés\n");
+        return 0;
+    }
+
+    fflush(stdout);
+    int salida = dup(STDOUT_FILENO);
+    salida_estres = salida >= 0 ? fdopen(salida, "w") : NULL;
+    if (salida_estres == NULL || freopen("/dev/null", "w", stdout) == NULL)
+    {
+        fprintf(stderr, "Error: No se pudo desviar la salida de la simulación\n");
+        return 0;
+    }
+    setvbuf(salida_estres, NULL, _IOLBF, 0);
+    return 1;
+}
+
+/**
+ * @brief Manda un comando por el buzón con el mismo protocolo que el panel y espera su resultado
+ * @return 1 si se aplicó, 0 si la carga terminó antes de poder reservar el buzón
+ */
+static int enviar_comando_estres(BuzonComandos *comando)
+{
+    BuzonComandos *buzon = &datos_compartidos->buzon;
+
+    // El otro inyector o un panel conectado pueden tener el buzón
+    unsigned int estado = BUZON_LIBRE;
+    while (!__atomic_compare_exchange_n(&buzon->estado, &estado, BUZON_OCUPADO, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+    {
+        if (__atomic_load_n(&estres.drenando, __ATOMIC_ACQUIRE))
+            return 0;
+        sched_yield();
+        estado = BUZON_LIBRE;
+    }
+
+    buzon->pid_emisor = getpid();
+    buzon->reservado_ms = reloj_ms();
+    buzon->secuencia++;
+    buzon->comando = comando->comando;
+    buzon->modo = comando->modo;
+    buzon->banda = comando->banda;
+    buzon->ingrediente = comando->ingrediente;
+    buzon->num_recargas = 0;
+    buzon->id_orden = comando->id_orden;
+
+    __atomic_store_n(&buzon->estado, BUZON_PENDIENTE, __ATOMIC_RELEASE);
+    llamada_futex(&buzon->estado, FUTEX_WAKE, 1, 0);
+
+    // El procesador de comandos sigue vivo hasta que termina el drenado
+    while ((estado = __atomic_load_n(&buzon->estado, __ATOMIC_ACQUIRE)) != BUZON_RESUELTO)
+        llamada_futex(&buzon->estado, FUTEX_WAIT, estado, 100000);
+
+    comando->dispensadores = buzon->dispensadores;
+    comando->resultado_cancelacion = buzon->resultado_cancelacion;
+    __atomic_store_n(&buzon->estado, BUZON_LIBRE, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void *inyector_comandos_estres(void *arg)
+{
+    unsigned int semilla = (unsigned int)time(NULL) * 2654435761u + (unsigned int)(long)arg;
+
+    while (!__atomic_load_n(&estres.drenando, __ATOMIC_ACQUIRE))
+    {
+        int num_bandas = datos_compartidos->num_bandas;
+        int accion = rand_r(&semilla) % 8;
+        BuzonComandos comando;
+        memset(&comando, 0, sizeof(comando));
+
+        if (accion == 0)
+        {
+            // Una orden reciente: puede estar en la cola, en una banda, en manos del asignador o ya fuera
+            int reciente = datos_compartidos->total_ordenes_generadas - rand_r(&semilla) % (2 * MAX_ORDENES);
+            comando.comando = COMANDO_CANCELAR;
+            comando.id_orden = reciente - reciente % CANCELABLES_CADA_ESTRES;
+            if (enviar_comando_estres(&comando))
+                __atomic_add_fetch(&estres.comandos_cancelar, 1, __ATOMIC_RELAXED);
+        }
+        else if (accion < 6)
+        {
+            comando.comando = COMANDO_REABASTECER;
+            comando.modo = rand_r(&semilla) % 3;
+            comando.banda = rand_r(&semilla) % 2 ? TODAS_LAS_BANDAS : (int)(rand_r(&semilla) % num_bandas);
+            comando.ingrediente = rand_r(&semilla) % 2 ? -1 : (int)(rand_r(&semilla) % MAX_INGREDIENTES);
+            if (enviar_comando_estres(&comando))
+                __atomic_add_fetch(&estres.comandos_reabastecer, 1, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            // Pausar o averiar una banda, o devolverla al servicio, como el panel o un escenario
+            Banda *banda = &datos_compartidos->bandas[rand_r(&semilla) % num_bandas];
+            pthread_mutex_lock(&banda->mutex);
+            if (accion == 6)
+                banda->pausada = !banda->pausada;
+            else
+                banda->activa = !banda->activa;
+            notificar_eventos(&banda->eventos, DESPERTAR_UNO);
+            pthread_mutex_unlock(&banda->mutex);
+            __atomic_add_fetch(&estres.cambios_banda, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+void *reabastecedor_estres(void *arg)
+{
+    (void)arg;
+    unsigned int semilla = (unsigned int)time(NULL);
+
+    while (!__atomic_load_n(&estres.drenando, __ATOMIC_ACQUIRE))
+    {
+        reabastecer_banda(rand_r(&semilla) % datos_compartidos->num_bandas);
+        despertar_asignador();
+        __atomic_add_fetch(&estres.reabastecimientos, 1, __ATOMIC_RELAXED);
+        sched_yield();
+    }
+    return NULL;
+}
+
+/**
+ * @brief Toma una foto consistente de las órdenes y devuelve cuántas faltan o sobran
+ *
+ * Con la cola, todas las bandas y el mutex global tomados (en ese orden, el del
+ * resto del sistema) cuenta las vivas y los desenlaces. Fuera de la foto solo
+ * quedan órdenes en tránsito: el lote que tiene el asignador, los que una banda
+ * ya soltó y aún no contó, la admitida que el generador no contó y los lotes
+ * que el vigilante está reencolando.
+ *
+ * @param contadores Contadores acumulados en el instante de la foto
+ * @param vivas Órdenes en la cola (sin lápidas) y en las bandas
+ * @return Generadas menos desenlaces menos vivas
+ */
+static int descuadre_ordenes(ContadoresEstres *contadores, int *vivas)
+{
+    ColaFIFO *cola = &datos_compartidos->cola_espera;
+    int num_bandas = datos_compartidos->num_bandas;
+    int en_bandas = 0;
+
+    pthread_mutex_lock(&cola->mutex);
+    for (int b = 0; b < num_bandas; b++)
+    {
+        Banda *banda = &datos_compartidos->bandas[b];
+        pthread_mutex_lock(&banda->mutex);
+        if (banda->procesando_orden)
+            en_bandas += banda->tamano_lote > 1 ? banda->tamano_lote : 1;
+        contadores->hamburguesas[b] = banda->hamburguesas_procesadas;
+        contadores->rescatadas[b] = __atomic_load_n(&banda->ordenes_rescatadas, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&datos_compartidos->mutex_global);
+    contadores->generadas = datos_compartidos->total_ordenes_generadas;
+    contadores->procesadas = datos_compartidos->total_ordenes_procesadas;
+    contadores->canceladas = datos_compartidos->ordenes_canceladas;
+    contadores->descartadas = datos_compartidos->ordenes_descartadas;
+    contadores->rechazadas = datos_compartidos->ordenes_rechazadas;
+    contadores->lotes = datos_compartidos->lotes_procesados;
+    contadores->ingresos = datos_compartidos->ingresos_totales;
+    pthread_mutex_unlock(&datos_compartidos->mutex_global);
+
+    *vivas = cola->tamano - cola->lapidas + en_bandas;
+    for (int b = num_bandas - 1; b >= 0; b--)
+    {
+        pthread_mutex_unlock(&datos_compartidos->bandas[b].mutex);
+    }
+    pthread_mutex_unlock(&cola->mutex);
+
+    return (int)(contadores->generadas - contadores->procesadas - contadores->canceladas - contadores->descartadas -
+                 contadores->rechazadas) -
+           *vivas;
+}
+
+/**
+ * @brief Anota una violación de monotonía si el contador retrocedió
+ */
+static void comparar_contador_estres(const char *nombre, double anterior, double actual)
+{
+    if (actual < anterior)
+        anotar_violacion_estres(&estres.violaciones_monotonia, "%s retrocedió de %.0f a %.0f", nombre, anterior,
+                                actual);
+}
+
+void verificar_invariantes_estres()
+{
+    int num_bandas = datos_compartidos->num_bandas;
+
+    for (int b = 0; b < num_bandas; b++)
+    {
+        Banda *banda = &datos_compartidos->bandas[b];
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            pthread_mutex_lock(&banda->dispensadores[j].mutex);
+            int cantidad = banda->dispensadores[j].cantidad;
+            LibroDispensador libro = libro_inventario[b][j];
+            pthread_mutex_unlock(&banda->dispensadores[j].mutex);
+
+            long long esperado = CAPACIDAD_DISPENSADOR + libro.repuesto - libro.retirado + libro.devuelto;
+            if (cantidad != esperado || cantidad < 0 || cantidad > CAPACIDAD_DISPENSADOR)
+                anotar_violacion_estres(&estres.violaciones_inventario, "banda %d, %s: %d unidades y el libro da %lld",
+                                        b + 1, banda->dispensadores[j].nombre, cantidad, esperado);
+        }
+    }
+
+    ContadoresEstres actuales;
+    int vivas;
+    int descuadre = descuadre_ordenes(&actuales, &vivas);
+    int en_transito = MAX_LOTE * (num_bandas + 1) + 1;
+    if (descuadre > en_transito || descuadre < -en_transito)
+        anotar_violacion_estres(&estres.violaciones_conservacion,
+                                "descuadre de %d órdenes (%lld generadas, %d vivas, hasta %d en tránsito)", descuadre,
+                                actuales.generadas, vivas, en_transito);
+
+    const ContadoresEstres *anteriores = &estres.anteriores;
+    comparar_contador_estres("órdenes generadas", anteriores->generadas, actuales.generadas);
+    comparar_contador_estres("órdenes procesadas", anteriores->procesadas, actuales.procesadas);
+    comparar_contador_estres("órdenes canceladas", anteriores->canceladas, actuales.canceladas);
+    comparar_contador_estres("órdenes expiradas", anteriores->descartadas, actuales.descartadas);
+    comparar_contador_estres("órdenes rechazadas", anteriores->rechazadas, actuales.rechazadas);
+    comparar_contador_estres("lotes procesados", anteriores->lotes, actuales.lotes);
+    comparar_contador_estres("ingresos", anteriores->ingresos, actuales.ingresos);
+    for (int b = 0; b < num_bandas; b++)
+    {
+        comparar_contador_estres("hamburguesas de una banda", anteriores->hamburguesas[b], actuales.hamburguesas[b]);
+        comparar_contador_estres("rescates de una banda", anteriores->rescatadas[b], actuales.rescatadas[b]);
+    }
 
-        // Sección preparación
-        char subtitulo_prep[MAX_COLUMNAS][50];
-        for (int col = 0; col < num_columnas_fila; col++)
+    estres.anteriores = actuales;
+    estres.verificaciones++;
+}
+
+int ejecutar_estres()
+{
+    int num_bandas = datos_compartidos->num_bandas;
+    pthread_t inyectores[INYECTORES_ESTRES];
+    pthread_t reabastecedor;
+    for (int i = 0; i < INYECTORES_ESTRES; i++)
+    {
+        pthread_create(&inyectores[i], NULL, inyector_comandos_estres, (void *)(long)i);
+    }
+    pthread_create(&reabastecedor, NULL, reabastecedor_estres, NULL);
+
+    fprintf(salida_estres,
+            "PRUEBA DE ESTRÉS: %d s con %d bandas, %d inyectores de comandos y un reabastecedor, pasos sin duración\n",
+            segundos_estres, num_bandas, INYECTORES_ESTRES);
+
+    long long inicio = reloj_ms();
+    long long fin = inicio + segundos_estres * 1000LL;
+    long long proximo_avance = inicio + INTERVALO_AVANCE_ESTRES_MS;
+    long long procesadas_avance = 0;
+    while (reloj_ms() < fin && !terminar_solicitado)
+    {
+        usleep(INTERVALO_VERIFICACION_ESTRES_MS * 1000);
+        verificar_invariantes_estres();
+
+        if (reloj_ms() >= proximo_avance)
         {
-            strcpy(subtitulo_prep[col], centrar_texto("PREPARACION", ANCHO_COLUMNA - 2));
+            ContadoresEstres *actuales = &estres.anteriores;
+            long long comandos = __atomic_load_n(&estres.comandos_reabastecer, __ATOMIC_RELAXED) +
+                                 __atomic_load_n(&estres.comandos_cancelar, __ATOMIC_RELAXED);
+            pthread_mutex_lock(&mutex_estres);
+            long long violaciones = estres.violaciones_inventario + estres.violaciones_conservacion +
+                                    estres.violaciones_monotonia + estres.duplicadas;
+            pthread_mutex_unlock(&mutex_estres);
+            fprintf(salida_estres, "[ESTRÉS] %3lld s: %lld entregadas (%.0f/s), %lld comandos, %lld violaciones\n",
+                    (reloj_ms() - inicio) / 1000, actuales->procesadas,
+                    (actuales->procesadas - procesadas_avance) * 1000.0 / INTERVALO_AVANCE_ESTRES_MS, comandos,
+                    violaciones);
+            procesadas_avance = actuales->procesadas;
+            proximo_avance += INTERVALO_AVANCE_ESTRES_MS;
         }
-        imprimir_fila_contenido(subtitulo_prep, num_columnas_fila, ANCHO_COLUMNA);
+    }
 
-        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "─");
+    // Fin de la carga: sin órdenes nuevas ni comandos
+    __atomic_store_n(&estres.drenando, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < INYECTORES_ESTRES; i++)
+    {
+        pthread_join(inyectores[i], NULL);
+    }
+    pthread_join(reabastecedor, NULL);
+    long long duracion_carga_ms = reloj_ms() - inicio;
+    ContadoresEstres carga;
+    int vivas;
+    descuadre_ordenes(&carga, &vivas);
+
+    // Drenado: todas las bandas en servicio y abastecidas hasta vaciar la cola y las bandas
+    for (int b = 0; b < num_bandas; b++)
+    {
+        Banda *banda = &datos_compartidos->bandas[b];
+        pthread_mutex_lock(&banda->mutex);
+        banda->pausada = 0;
+        banda->activa = 1;
+        notificar_eventos(&banda->eventos, DESPERTAR_UNO);
+        pthread_mutex_unlock(&banda->mutex);
+    }
+    ContadoresEstres final;
+    int descuadre;
+    long long limite = reloj_ms() + DRENADO_ESTRES_MS;
+    do
+    {
+        BuzonComandos comando;
+        memset(&comando, 0, sizeof(comando));
+        comando.comando = COMANDO_REABASTECER;
+        comando.modo = REABASTECER_TODO;
+        comando.banda = TODAS_LAS_BANDAS;
+        comando.ingrediente = -1;
+        aplicar_reabastecimiento_masivo(&comando);
+        despertar_asignador();
+        usleep(10000);
+        descuadre = descuadre_ordenes(&final, &vivas);
+    } while ((vivas > 0 || descuadre != 0) && reloj_ms() < limite);
+    verificar_invariantes_estres();
+    long long duracion_drenado_ms = reloj_ms() - inicio - duracion_carga_ms;
 
-        // Estado de preparación (6 líneas)
-        for (int linea = 0; linea < 6; linea++)
+    limpiar_sistema();
+
+    // Con los hilos detenidos cada número generado tiene un desenlace, o sigue vivo si el drenado no alcanzó
+    int drenado_completo = vivas == 0 && descuadre == 0;
+    for (int id = 1; id <= final.generadas && id < CAPACIDAD_DESENLACES_ESTRES; id++)
+    {
+        if (desenlaces_estres[id] == 0 && (drenado_completo || buscar_en_indice(id) == NULL))
+            anotar_violacion_estres(&estres.perdidas, "orden #%d sin desenlace ni lugar en la cola o una banda", id);
+    }
+
+    long long comandos = estres.comandos_reabastecer + estres.comandos_cancelar;
+    long long rescates = 0;
+    for (int b = 0; b < num_bandas; b++)
+    {
+        rescates += final.rescatadas[b];
+    }
+    long long violaciones = estres.violaciones_inventario + estres.violaciones_conservacion +
+                            estres.violaciones_monotonia + estres.duplicadas + estres.perdidas;
+    double segundos = duracion_carga_ms / 1000.0;
+
+    fprintf(salida_estres, "\n══════════ RESULTADO DE LA PRUEBA DE ESTRÉS ══════════\n");
+    fprintf(salida_estres, "- Duración: %.1f s de carga y %.2f s de drenado%s, %d bandas\n", segundos,
+            duracion_drenado_ms / 1000.0, drenado_completo ? "" : " (incompleto)", num_bandas);
+    fprintf(salida_estres,
+            "- Órdenes: %lld generadas, %lld entregadas en %lld lotes, %lld canceladas, %lld expiradas, %lld rechazadas\n",
+            final.generadas, final.procesadas, final.lotes, final.canceladas, final.descartadas, final.rechazadas);
+    fprintf(salida_estres, "- Rendimiento: %.0f entregas/s, %.0f órdenes generadas/s, %.0f comandos/s\n",
+            carga.procesadas / segundos, carga.generadas / segundos, comandos / segundos);
+    fprintf(salida_estres,
+            "- Inyectado: %lld cancelaciones y %lld reabastecimientos por el buzón, %lld cambios de banda, "
+            "%lld reabastecimientos directos, %lld rescates del vigilante\n",
+            estres.comandos_cancelar, estres.comandos_reabastecer, estres.cambios_banda, estres.reabastecimientos,
+            rescates);
+    fprintf(salida_estres, "- Verificaciones en marcha: %lld\n", estres.verificaciones);
+    fprintf(salida_estres, "- Inventario conservado: %s (%lld discrepancias)\n",
+            estres.violaciones_inventario ? "NO" : "sí", estres.violaciones_inventario);
+    fprintf(salida_estres, "- Órdenes conservadas: %s (%lld descuadres, %lld duplicadas, %lld perdidas)\n",
+            estres.violaciones_conservacion + estres.duplicadas + estres.perdidas ? "NO" : "sí",
+            estres.violaciones_conservacion, estres.duplicadas, estres.perdidas);
+    fprintf(salida_estres, "- Contadores monótonos: %s (%lld retrocesos)\n", estres.violaciones_monotonia ? "NO" : "sí",
+            estres.violaciones_monotonia);
+    if (violaciones > 0)
+        fprintf(salida_estres, "- Primera violación: %s\n", estres.primera_violacion);
+    fprintf(salida_estres, "RESULTADO: %s\n", violaciones > 0 ? "FALLÓ" : "OK");
+
+    return violaciones > 0 ? 1 : 0;
+}
+
+void limpiar_sistema()
+{
+    datos_compartidos->sistema_activo = 0;
+
+    // Despertar todos los hilos bloqueados
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        notificar_eventos(&datos_compartidos->bandas[i].eventos, DESPERTAR_TODOS);
+    }
+    notificar_eventos(&datos_compartidos->cola_espera.no_vacia, DESPERTAR_TODOS);
+    notificar_eventos(&datos_compartidos->nueva_orden, DESPERTAR_TODOS);
+    notificar_eventos(&eventos_clientes, DESPERTAR_TODOS);
+
+    // Esperar que terminen los hilos
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        pthread_join(datos_compartidos->bandas[i].hilo, NULL);
+    }
+
+    despertar_asignador();
+    pthread_join(hilo_generador_ordenes, NULL);
+    pthread_join(hilo_asignador_ordenes, NULL);
+    pthread_join(hilo_procesador_comandos, NULL);
+    pthread_join(hilo_vigilante, NULL);
+    pthread_join(hilo_monitor_inventario, NULL);
+    pthread_join(hilo_publicador_metricas, NULL);
+    if (num_eventos_escenario > 0)
+        pthread_join(hilo_escenario, NULL);
+    if (archivo_diario != NULL)
+    {
+        pthread_join(hilo_escritor_diario, NULL);
+        fclose(archivo_diario);
+    }
+    if (archivo_metricas != NULL)
+    {
+        pthread_join(hilo_archivador, NULL);
+        munmap(archivo_metricas, archivo_metricas->tamano);
+        close(descriptor_archivo);
+    }
+    if (directorio_arrow[0] != '\0')
+        exportar_resultados_arrow();
+
+    shm_unlink(nombre_memoria);
+    printf("\nSistema terminado correctamente\n");
+    printf("Estadísticas finales:\n");
+    printf("- Órdenes generadas: %d\n", datos_compartidos->total_ordenes_generadas);
+    printf("- Órdenes completadas: %d\n", datos_compartidos->total_ordenes_procesadas);
+    printf("- Órdenes pendientes: %d\n", datos_compartidos->cola_espera.tamano - datos_compartidos->cola_espera.lapidas);
+    printf("- Órdenes canceladas: %d\n", datos_compartidos->ordenes_canceladas);
+    printf("- Latencia p50/p99: %d / %d ms\n", calcular_percentil_latencia(50), calcular_percentil_latencia(99));
+    mostrar_estacionario();
+    int rescatadas = 0;
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        rescatadas += datos_compartidos->bandas[i].ordenes_rescatadas;
+    }
+    printf("- Órdenes rescatadas de bandas atascadas: %d\n", rescatadas);
+    printf("- Ingresos: $%.2f  (perdidos por %d expiradas y %d rechazos: $%.2f, política %s)\n",
+           datos_compartidos->ingresos_totales, datos_compartidos->ordenes_descartadas,
+           datos_compartidos->ordenes_rechazadas, datos_compartidos->ingresos_perdidos,
+           politica_asignacion == POLITICA_VALOR ? "por valor" : "FIFO");
+    mostrar_curva_abandonos();
+    if (bandas_heterogeneas)
+    {
+        // Cuánto de cada banda fueron recetas largas: con la asignación por velocidad se cargan las rápidas
+        printf("- Velocidades (asignación %s):", asignacion_primera_libre ? "a la primera libre" : "por velocidad");
+        for (int i = 0; i < datos_compartidos->num_bandas; i++)
         {
-            char lineas_prep[MAX_COLUMNAS][50];
+            Banda *banda = &datos_compartidos->bandas[i];
+            printf(" B%d x%.2f %d (%d largas)", i + 1, banda->velocidad, banda->hamburguesas_procesadas,
+                   largas_por_banda[i]);
+        }
+        printf("\n");
+    }
+    if (datos_compartidos->lotes_procesados > 0)
+        printf("- Lotes: hasta %d órdenes, %.2f órdenes por lote en promedio (costo n^%.2f)\n", tamano_lote_maximo,
+               (float)datos_compartidos->total_ordenes_procesadas / datos_compartidos->lotes_procesados,
+               exponente_lote);
+    if (muestras_error_eta > 0)
+        printf("- Error de ETA medio/sesgo: %lld / %+lld ms\n", suma_error_abs_eta_ms / muestras_error_eta,
+               suma_error_eta_ms / muestras_error_eta);
+    if (muestras_preparacion > 0 && recetas_en_dag)
+        printf("- Preparación media: %.1f s (ruta crítica %.1f s, paso a paso %.1f s, recetas en DAG)\n",
+               suma_preparacion_ms / 1000.0 / muestras_preparacion,
+               suma_ruta_critica_ms / 1000.0 / muestras_preparacion,
+               suma_secuencial_ms / 1000.0 / muestras_preparacion);
+    else if (muestras_preparacion > 0)
+        printf("- Preparación media: %.1f s (recetas paso a paso)\n", suma_preparacion_ms / 1000.0 / muestras_preparacion);
+    for (int r = 0; r < datos_compartidos->num_recursos; r++)
+    {
+        RecursoCompartido *recurso = &datos_compartidos->recursos[r];
+        if (recurso->capacidad == 0)
+            continue;
+        printf("- %s (%d lugar%s, bandas %d-%d): %.1f%% de uso, %d usos, %d esperaron (media %.1f s), hasta %d en "
+               "espera\n",
+               recurso->nombre, recurso->capacidad, recurso->capacidad == 1 ? "" : "es", recurso->banda_desde + 1,
+               recurso->banda_hasta + 1, recurso->utilizacion * 100, recurso->usos, recurso->esperas,
+               recurso->esperas > 0 ? recurso->espera_total_ms / 1000.0 / recurso->esperas : 0.0,
+               recurso->max_esperando);
+    }
+    if (num_clientes > 0 && ciclos_clientes > 0)
+    {
+        // Ley del tiempo de respuesta interactivo: N = X (R + Z), con X medido y Z la reflexión media
+        double segundos = tiempo_simulado_ms() / 1000.0;
+        double productividad = ciclos_clientes / segundos;
+        printf("- Población cerrada: %d clientes, reflexión media %.1f s: %.2f órdenes/min, respuesta media "
+               "%.1f s (N/X - Z = %.1f s)\n",
+               num_clientes, tiempo_pensar_ms / 1000.0, productividad * 60,
+               suma_respuesta_clientes_ms / 1000.0 / ciclos_clientes,
+               num_clientes / productividad - tiempo_pensar_ms / 1000.0);
+    }
+    int rellenos = 0;
+    int rellenos_urgentes = 0;
+    long long reabasto_ms = 0;
+    long long reabasto_perdido_ms = 0;
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        Banda *banda = &datos_compartidos->bandas[i];
+        rellenos += banda->dispensadores_reabastecidos;
+        rellenos_urgentes += banda->reabastos_urgentes;
+        reabasto_ms += banda->reabasto_ms;
+        reabasto_perdido_ms += banda->reabasto_perdido_ms;
+    }
+    if (rellenos > 0)
+    {
+        // Capacidad perdida expresada en lotes con la preparación media del turno
+        long long capacidad_ms = tiempo_simulado_ms() * datos_compartidos->num_bandas;
+        printf("- Reabastecimiento: %d dispensadores (%d urgentes), %.1f s de parada (%.1f%% de la capacidad); "
+               "perdidos %.1f s con órdenes esperando, ~%.1f lotes\n",
+               rellenos, rellenos_urgentes, reabasto_ms / 1000.0,
+               capacidad_ms > 0 ? reabasto_ms * 100.0 / capacidad_ms : 0.0, reabasto_perdido_ms / 1000.0,
+               muestras_preparacion > 0 ? reabasto_perdido_ms / ((double)suma_preparacion_ms / muestras_preparacion)
+                                        : 0.0);
+    }
+    // Los tres hilos que más CPU usaron
+    long long cpu_proceso_ns = datos_compartidos->cpu_proceso_ns;
+    struct timespec cpu;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu) == 0)
+        cpu_proceso_ns = (long long)cpu.tv_sec * 1000000000LL + cpu.tv_nsec;
+    printf("- CPU del proceso: %.3f s; más costosos:", cpu_proceso_ns / 1e9);
+    int mostrados[3] = {-1, -1, -1};
+    for (int k = 0; k < 3; k++)
+    {
+        for (int c = 0; c < datos_compartidos->num_componentes; c++)
+        {
+            CuentaCpu *cuenta = &datos_compartidos->cuentas_cpu[c];
+            if (cuenta->nombre[0] == '\0' || c == mostrados[0] || c == mostrados[1])
+                continue;
+            if (mostrados[k] < 0 || cuenta->cpu_ns > datos_compartidos->cuentas_cpu[mostrados[k]].cpu_ns)
+                mostrados[k] = c;
+        }
+        if (mostrados[k] >= 0)
+            printf("%s %s %.3f s (%lld despertares)", k > 0 ? "," : "",
+                   datos_compartidos->cuentas_cpu[mostrados[k]].nombre,
+                   datos_compartidos->cuentas_cpu[mostrados[k]].cpu_ns / 1e9,
+                   datos_compartidos->cuentas_cpu[mostrados[k]].despertares);
+    }
+    printf("\n");
+    printf("- Configuración de tiempos:\n");
+    printf("  • %d segundos por ingrediente\n", datos_compartidos->tiempo_por_ingrediente);
+    if (num_clientes > 0)
+        printf("  • %d clientes pensando %.1f s en promedio entre órdenes\n", num_clientes, tiempo_pensar_ms / 1000.0);
+    else
+        printf("  • %d segundos entre órdenes\n", datos_compartidos->tiempo_nueva_orden);
+}
 
-            for (int col = 0; col < num_columnas_fila; col++)
+void manejar_senal(int sig)
+{
+    switch (sig)
+    {
+    case SIGINT:
+    case SIGTERM:
+        printf("\nRecibida señal de terminación...\n");
+        limpiar_sistema();
+        exit(0);
+        break;
+    case SIGUSR1:
+        if (datos_compartidos->num_bandas > 0)
+        {
+            int banda = rand() % datos_compartidos->num_bandas;
+            datos_compartidos->bandas[banda].pausada = 1;
+            agregar_log_banda(banda, "BANDA PAUSADA POR SEÑAL", 0);
+        }
+        break;
+    case SIGUSR2:
+        for (int i = 0; i < datos_compartidos->num_bandas; i++)
+        {
+            if (datos_compartidos->bandas[i].pausada)
             {
-                int banda = banda_inicio + col;
-                if (banda < datos_compartidos->num_bandas)
-                {
-                    Banda *b = &datos_compartidos->bandas[banda];
-                    pthread_mutex_lock(&b->mutex);
+                datos_compartidos->bandas[i].pausada = 0;
+                notificar_eventos(&datos_compartidos->bandas[i].eventos, DESPERTAR_UNO);
+                agregar_log_banda(i, "BANDA REANUDADA", 0);
+            }
+        }
+        break;
+    case SIGCONT:
+    {
+        int bandas_reabastecidas = 0;
+        for (int i = 0; i < datos_compartidos->num_bandas; i++)
+        {
+            if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+            {
+                reabastecer_banda(i);
+                bandas_reabastecidas++;
+            }
+        }
+        if (bandas_reabastecidas == 0)
+        {
+            int banda = rand() % datos_compartidos->num_bandas;
+            reabastecer_banda(banda);
+        }
+        printf("\n📦 Reabastecimiento automático completado\n");
+    }
+    break;
+    }
+}
 
-                    switch (linea)
-                    {
-                    case 0:
-                        if (b->procesando_orden)
-                        {
-                            char nombre_corto[18];
-                            strncpy(nombre_corto, b->orden_actual.nombre_hamburguesa, 17);
-                            nombre_corto[17] = '\0';
-                            sprintf(lineas_prep[col], "Orden %d: %s",
-                                    b->orden_actual.id_orden, nombre_corto);
-                        }
-                        else
-                        {
-                            strcpy(lineas_prep[col], "Sin orden activa");
-                        }
-                        break;
-                    case 1:
-                    {
-                        char estado_corto[25];
-                        strncpy(estado_corto, b->estado_actual, 24);
-                        estado_corto[24] = '\0';
-                        sprintf(lineas_prep[col], "Estado: %s", estado_corto);
-                    }
-                    break;
-                    case 2:
-                        if (b->procesando_orden && strlen(b->ingrediente_actual) > 0)
-                        {
-                            char ing_corto[18];
-                            strncpy(ing_corto, b->ingrediente_actual, 17);
-                            ing_corto[17] = '\0';
-                            sprintf(lineas_prep[col], "Ingrediente: %s", ing_corto);
-                        }
-                        else
-                        {
-                            strcpy(lineas_prep[col], "");
-                        }
-                        break;
-                    case 3:
-                        if (b->procesando_orden)
-                        {
-                            sprintf(lineas_prep[col], "Progreso: %d/%d pasos",
-                                    b->orden_actual.paso_actual, b->orden_actual.num_ingredientes);
-                        }
-                        else
-                        {
-                            strcpy(lineas_prep[col], "");
-                        }
-                        break;
-                    case 4:
-                        sprintf(lineas_prep[col], "Procesadas: %d", b->hamburguesas_procesadas);
-                        break;
-                    case 5:
-                        if (b->pausada)
-                        {
-                            strcpy(lineas_prep[col], "[PAUSADA]");
-                        }
-                        else if (b->necesita_reabastecimiento)
-                        {
-                            strcpy(lineas_prep[col], "[NECESITA INVENTARIO]");
-                        }
-                        else
-                        {
-                            strcpy(lineas_prep[col], "");
-                        }
-                        break;
-                    }
+int validar_parametros(int argc, char *argv[], int *num_bandas, int *tiempo_ingrediente, int *tiempo_orden,
+                       char *nombre_instancia, char *ruta_diario, char *ruta_escenario)
+{
+    *num_bandas = 3;                                  // Valor por defecto
+    *tiempo_ingrediente = TIEMPO_DEFAULT_INGREDIENTE; // 2 segundos por defecto
+    *tiempo_orden = TIEMPO_DEFAULT_NUEVA_ORDEN;       // 7 segundos por defecto
 
-                    pthread_mutex_unlock(&b->mutex);
-                }
-                else
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+        {
+            mostrar_ayuda();
+            return 0;
+        }
+        else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--bandas") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                *num_bandas = atoi(argv[i + 1]);
+                if (*num_bandas <= 0 || *num_bandas > MAX_BANDAS)
                 {
-                    strcpy(lineas_prep[col], "");
+                    printf("Error: Número de bandas debe estar entre 1 y %d\n", MAX_BANDAS);
+                    return 0;
                 }
+                i++;
+            }
+            else
+            {
+                printf("Error: -n requiere un número\n");
+                return 0;
             }
-            imprimir_fila_contenido(lineas_prep, num_columnas_fila, ANCHO_COLUMNA);
         }
-
-        // Separador para logs
-        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "═");
-
-        // Sección logs
-        char subtitulo_logs[MAX_COLUMNAS][50];
-        for (int col = 0; col < num_columnas_fila; col++)
+        else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--tiempo-ingrediente") == 0)
         {
-            strcpy(subtitulo_logs[col], centrar_texto("LOGS", ANCHO_COLUMNA - 2));
+            if (i + 1 < argc)
+            {
+                *tiempo_ingrediente = atoi(argv[i + 1]);
+                if (*tiempo_ingrediente <= 0 || *tiempo_ingrediente > 60)
+                {
+                    printf("Error: Tiempo por ingrediente debe estar entre 1 y 60 segundos\n");
+                    return 0;
+                }
+                i++;
+            }
+            else
+            {
+                printf("Error: -t requiere un número (segundos)\n");
+                return 0;
+            }
         }
-        imprimir_fila_contenido(subtitulo_logs, num_columnas_fila, ANCHO_COLUMNA);
-
-        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╠", "╣  ╠", "╣", "─");
-
-        // Mostrar logs (6 líneas)
-        for (int log_line = 0; log_line < 6; log_line++)
+        else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--tiempo-orden") == 0)
         {
-            char lineas_logs[MAX_COLUMNAS][50];
-
-            for (int col = 0; col < num_columnas_fila; col++)
+            if (i + 1 < argc)
             {
-                int banda = banda_inicio + col;
-                if (banda < datos_compartidos->num_bandas)
+                *tiempo_orden = atoi(argv[i + 1]);
+                if (*tiempo_orden <= 0 || *tiempo_orden > 300)
                 {
-                    Banda *b = &datos_compartidos->bandas[banda];
-                    pthread_mutex_lock(&b->mutex);
-
-                    if (log_line < b->num_logs)
-                    {
-                        int log_idx = b->num_logs - 1 - log_line;
-                        if (log_idx >= 0)
-                        {
-                            char log_texto[44];
-                            strncpy(log_texto, b->logs[log_idx].mensaje, 35);
-                            log_texto[35] = '\0';
-                            if (b->logs[log_idx].es_alerta)
-                            {
-                                sprintf(lineas_logs[col], "🚨 %s", log_texto);
-                            }
-                            else
-                            {
-                                strcpy(lineas_logs[col], log_texto);
-                            }
-                        }
-                        else
-                        {
-                            strcpy(lineas_logs[col], "");
-                        }
-                    }
-                    else
-                    {
-                        strcpy(lineas_logs[col], "");
-                    }
-
-                    pthread_mutex_unlock(&b->mutex);
+                    printf("Error: Tiempo entre órdenes debe estar entre 1 y 300 segundos\n");
+                    return 0;
                 }
-                else
+                i++;
+            }
+            else
+            {
+                printf("Error: -o requiere un número (segundos)\n");
+                return 0;
+            }
+        }
+        else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--nombre") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                // El nombre forma parte del segmento /dev/shm: solo alfanuméricos, '-' y '_'
+                const char *nombre = argv[i + 1];
+                int longitud = strlen(nombre);
+                if (longitud == 0 || longitud >= MAX_NOMBRE_INSTANCIA ||
+                    strspn(nombre, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_") != (size_t)longitud)
                 {
-                    strcpy(lineas_logs[col], "");
+                    printf("Error: El nombre debe tener 1-%d caracteres alfanuméricos, '-' o '_'\n",
+                           MAX_NOMBRE_INSTANCIA - 1);
+                    return 0;
                 }
+                strcpy(nombre_instancia, nombre);
+                i++;
+            }
+            else
+            {
+                printf("Error: -s requiere un nombre de cocina\n");
+                return 0;
             }
-            imprimir_fila_contenido(lineas_logs, num_columnas_fila, ANCHO_COLUMNA);
         }
-
-        // Bordes inferiores
-        imprimir_linea_separacion(num_columnas_fila, ANCHO_COLUMNA, "╚", "╝  ╚", "╝", "═");
-        printf("\n");
-    }
-
-    printf("Presiona Ctrl+C para salir del sistema\n");
-    printf("⏱️  Tiempos: %ds por ingrediente, %ds entre órdenes\n",
-           datos_compartidos->tiempo_por_ingrediente,
-           datos_compartidos->tiempo_nueva_orden);
-}
-
-void mostrar_estado_compacto()
-{
-    printf("\033[2J\033[H");
-
-    printf("╔═══════════════════════════════════════════════════════════════════╗\n");
-    printf("║              SISTEMA DE HAMBURGUESAS - COMPACTO                   ║\n");
-    printf("╚═══════════════════════════════════════════════════════════════════╝\n");
-    printf("Generadas: %d │ Procesadas: %d │ En cola: %d │ Bandas: %d\n",
-           datos_compartidos->total_ordenes_generadas,
-           datos_compartidos->total_ordenes_procesadas,
-           datos_compartidos->cola_espera.tamano,
-           datos_compartidos->num_bandas);
-    printf("⏱️ Tiempos: %ds/ingrediente │ %ds entre órdenes\n\n",
-           datos_compartidos->tiempo_por_ingrediente,
-           datos_compartidos->tiempo_nueva_orden);
-
-    // Mostrar alertas
-    int bandas_con_alertas = 0;
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
-    {
-        if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+        else if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--diario") == 0)
         {
-            bandas_con_alertas++;
+            if (i + 1 < argc && strlen(argv[i + 1]) < 256)
+            {
+                strcpy(ruta_diario, argv[i + 1]);
+                i++;
+            }
+            else
+            {
+                printf("Error: -j requiere la ruta del archivo de diario\n");
+                return 0;
+            }
         }
-    }
-
-    if (bandas_con_alertas > 0)
-    {
-        printf("🚨 ALERTAS: %d bandas necesitan reabastecimiento\n\n", bandas_con_alertas);
-    }
-
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
-    {
-        Banda *b = &datos_compartidos->bandas[i];
-
-        pthread_mutex_lock(&b->mutex);
-
-        printf("BANDA %d: %s%s", i + 1,
-               b->pausada ? "[PAUSADA]" : (b->activa ? "[ACTIVA]" : "[INACT]"),
-               b->necesita_reabastecimiento ? " ⚠️" : "");
-
-        if (b->procesando_orden)
+        else if (strcmp(argv[i], "-A") == 0 || strcmp(argv[i], "--arrow") == 0)
         {
-            char nombre_corto[16];
-            strncpy(nombre_corto, b->orden_actual.nombre_hamburguesa, 15);
-            nombre_corto[15] = '\0';
-            printf(" │ Orden %d: %s - Progreso: %d/%d",
-                   b->orden_actual.id_orden, nombre_corto,
-                   b->orden_actual.paso_actual, b->orden_actual.num_ingredientes);
+            if (i + 1 < argc && strlen(argv[i + 1]) > 0 && strlen(argv[i + 1]) < sizeof(directorio_arrow))
+            {
+                strcpy(directorio_arrow, argv[i + 1]);
+                i++;
+            }
+            else
+            {
+                printf("Error: -A requiere el directorio donde exportar los resultados\n");
+                return 0;
+            }
         }
-        else
+        else if (strcmp(argv[i], "-R") == 0 || strcmp(argv[i], "--archivo") == 0)
         {
-            char estado_corto[20];
-            strncpy(estado_corto, b->estado_actual, 19);
-            estado_corto[19] = '\0';
-            printf(" │ %s", estado_corto);
+            if (i + 1 < argc && strlen(argv[i + 1]) > 0 && strlen(argv[i + 1]) < sizeof(ruta_archivo_metricas))
+            {
+                strcpy(ruta_archivo_metricas, argv[i + 1]);
+                i++;
+            }
+            else
+            {
+                printf("Error: -R requiere la ruta del archivo de métricas\n");
+                return 0;
+            }
         }
-
-        printf(" │ Procesadas: %d\n", b->hamburguesas_procesadas);
-
-        // Mostrar inventario crítico
-        printf("  Stock crítico: ");
-        int items_criticos = 0;
-        for (int j = 0; j < MAX_INGREDIENTES && items_criticos < 5; j++)
+        else if (strcmp(argv[i], "-C") == 0 || strcmp(argv[i], "--clientes") == 0)
         {
-            pthread_mutex_lock(&b->dispensadores[j].mutex);
-            if (b->dispensadores[j].cantidad == 0)
+            if (i + 1 < argc)
             {
-                char nombre_muy_corto[8];
-                strncpy(nombre_muy_corto, b->dispensadores[j].nombre, 7);
-                nombre_muy_corto[7] = '\0';
-                printf("%s(AGOTADO) ", nombre_muy_corto);
-                items_criticos++;
+                num_clientes = atoi(argv[i + 1]);
+                if (num_clientes < 1 || num_clientes > MAX_CLIENTES)
+                {
+                    printf("Error: El número de clientes debe estar entre 1 y %d\n", MAX_CLIENTES);
+                    return 0;
+                }
+                i++;
             }
-            else if (b->dispensadores[j].cantidad <= UMBRAL_INVENTARIO_BAJO)
+            else
             {
-                char nombre_muy_corto[8];
-                strncpy(nombre_muy_corto, b->dispensadores[j].nombre, 7);
-                nombre_muy_corto[7] = '\0';
-                printf("%s(%d) ", nombre_muy_corto, b->dispensadores[j].cantidad);
-                items_criticos++;
+                printf("Error: -C requiere el número de clientes de la población cerrada\n");
+                return 0;
+            }
+        }
+        else if (strcmp(argv[i], "-W") == 0 || strcmp(argv[i], "--pensar") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                double segundos = atof(argv[i + 1]);
+                if (segundos < 0 || segundos > 3600)
+                {
+                    printf("Error: El tiempo de reflexión debe estar entre 0 y 3600 segundos\n");
+                    return 0;
+                }
+                tiempo_pensar_ms = (long long)(segundos * 1000);
+                i++;
+            }
+            else
+            {
+                printf("Error: -W requiere los segundos medios de reflexión\n");
+                return 0;
+            }
+        }
+        else if (strcmp(argv[i], "-T") == 0 || strcmp(argv[i], "--tiempo-reabasto") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                double segundos = atof(argv[i + 1]);
+                if (segundos < 0 || segundos > MAX_TIEMPO_REABASTO)
+                {
+                    printf("Error: El tiempo de reabastecimiento debe estar entre 0 y %d segundos\n",
+                           MAX_TIEMPO_REABASTO);
+                    return 0;
+                }
+                tiempo_reabasto_ms = (long long)(segundos * 1000);
+                i++;
+            }
+            else
+            {
+                printf("Error: -T requiere los segundos de parada por dispensador\n");
+                return 0;
+            }
+        }
+        else if (strcmp(argv[i], "-U") == 0 || strcmp(argv[i], "--umbral-reabasto") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                umbral_reabasto = atoi(argv[i + 1]);
+                if (umbral_reabasto < 0 || umbral_reabasto >= CAPACIDAD_DISPENSADOR)
+                {
+                    printf("Error: El umbral de reabastecimiento debe estar entre 0 y %d\n",
+                           CAPACIDAD_DISPENSADOR - 1);
+                    return 0;
+                }
+                i++;
+            }
+            else
+            {
+                printf("Error: -U requiere el nivel en el que se programa el relleno\n");
+                return 0;
             }
-            pthread_mutex_unlock(&b->dispensadores[j].mutex);
         }
-        if (items_criticos == 0)
-            printf("Ninguno");
-        printf("\n\n");
-
-        pthread_mutex_unlock(&b->mutex);
-    }
-
-    printf("Presiona Ctrl+C para salir del sistema\n");
-}
-
-void mostrar_estado_adaptativo()
-{
-#ifdef TIOCGWINSZ
-    struct winsize w;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0)
-    {
-        if (w.ws_col < 120)
+        else if (strcmp(argv[i], "-V") == 0 || strcmp(argv[i], "--velocidad") == 0)
         {
-            mostrar_estado_compacto();
-            return;
+            int banda = 0, leidos = 0;
+            float factor = 0;
+            if (i + 1 >= argc || sscanf(argv[i + 1], "%d:%f%n", &banda, &factor, &leidos) != 2 ||
+                (argv[i + 1][leidos] != '\0' && argv[i + 1][leidos] != ':'))
+            {
+                printf("Error: -V requiere BANDA:FACTOR o BANDA:FACTOR:INGREDIENTE\n");
+                return 0;
+            }
+            if (banda < 1 || banda > MAX_BANDAS || factor < VELOCIDAD_MINIMA || factor > VELOCIDAD_MAXIMA)
+            {
+                printf("Error: La banda debe estar entre 1 y %d y el factor de velocidad entre %.2f y %.1f\n",
+                       MAX_BANDAS, VELOCIDAD_MINIMA, VELOCIDAD_MAXIMA);
+                return 0;
+            }
+            if (argv[i + 1][leidos] == '\0')
+                velocidad_banda[banda - 1] = factor;
+            else
+            {
+                const char *ingrediente = argv[i + 1] + leidos + 1;
+                int j = 0;
+                while (j < MAX_INGREDIENTES && strcmp(ingredientes_base[j], ingrediente) != 0)
+                    j++;
+                if (j == MAX_INGREDIENTES)
+                {
+                    printf("Error: Ingrediente desconocido en -V: %s\n", ingrediente);
+                    return 0;
+                }
+                velocidad_estacion[banda - 1][j] = factor;
+            }
+            i++;
         }
-    }
-#endif
-    mostrar_estado_columnar();
-}
-
-void generar_orden_especifica(Orden *orden, int id)
-{
-    int tipo = rand() % NUM_TIPOS_HAMBURGUESA;
-    TipoHamburguesa *hamburguesa = &menu_hamburguesas[tipo];
-
-    orden->id_orden = id;
-    orden->tipo_hamburguesa = tipo;
-    strcpy(orden->nombre_hamburguesa, hamburguesa->nombre);
-    orden->num_ingredientes = hamburguesa->num_ingredientes;
-    orden->tiempo_creacion = time(NULL);
-    orden->paso_actual = 0;
-    orden->completada = 0;
-    orden->asignada_a_banda = -1;
-    orden->intentos_asignacion = 0;
-
-    for (int i = 0; i < hamburguesa->num_ingredientes; i++)
-    {
-        strcpy(orden->ingredientes_solicitados[i], hamburguesa->ingredientes[i]);
-    }
-}
-
-void reabastecer_banda(int banda_id)
-{
-    if (banda_id >= 0 && banda_id < datos_compartidos->num_bandas)
-    {
-        for (int i = 0; i < MAX_INGREDIENTES; i++)
+        else if (strcmp(argv[i], "-F") == 0 || strcmp(argv[i], "--primera-libre") == 0)
         {
-            pthread_mutex_lock(&datos_compartidos->bandas[banda_id].dispensadores[i].mutex);
-            datos_compartidos->bandas[banda_id].dispensadores[i].cantidad = CAPACIDAD_DISPENSADOR;
-            pthread_mutex_unlock(&datos_compartidos->bandas[banda_id].dispensadores[i].mutex);
+            asignacion_primera_libre = 1;
         }
-
-        datos_compartidos->bandas[banda_id].necesita_reabastecimiento = 0;
-        datos_compartidos->bandas[banda_id].ultima_alerta_inventario = 0;
-
-        agregar_log_banda(banda_id, "BANDA REABASTECIDA", 0);
-        printf("\n✅ Banda %d reabastecida completamente\n", banda_id + 1);
-    }
-}
-
-void limpiar_sistema()
-{
-    datos_compartidos->sistema_activo = 0;
-
-    // Despertar todos los hilos bloqueados
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
-    {
-        pthread_cond_broadcast(&datos_compartidos->bandas[i].condicion);
-    }
-    pthread_cond_broadcast(&datos_compartidos->cola_espera.no_vacia);
-    pthread_cond_broadcast(&datos_compartidos->nueva_orden);
-
-    // Esperar que terminen los hilos
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
-    {
-        pthread_join(datos_compartidos->bandas[i].hilo, NULL);
-    }
-
-    pthread_join(hilo_generador_ordenes, NULL);
-    pthread_join(hilo_asignador_ordenes, NULL);
-    pthread_join(hilo_monitor_inventario, NULL);
-
-    shm_unlink("/burger_system");
-    printf("\nSistema terminado correctamente\n");
-    printf("Estadísticas finales:\n");
-    printf("- Órdenes generadas: %d\n", datos_compartidos->total_ordenes_generadas);
-    printf("- Órdenes completadas: %d\n", datos_compartidos->total_ordenes_procesadas);
-    printf("- Órdenes pendientes: %d\n", datos_compartidos->cola_espera.tamano);
-    printf("- Configuración de tiempos:\n");
-    printf("  • %d segundos por ingrediente\n", datos_compartidos->tiempo_por_ingrediente);
-    printf("  • %d segundos entre órdenes\n", datos_compartidos->tiempo_nueva_orden);
-}
-
-void manejar_senal(int sig)
-{
-    switch (sig)
-    {
-    case SIGINT:
-    case SIGTERM:
-        printf("\nRecibida señal de terminación...\n");
-        limpiar_sistema();
-        exit(0);
-        break;
-    case SIGUSR1:
-        if (datos_compartidos->num_bandas > 0)
+        else if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--escenario") == 0)
         {
-            int banda = rand() % datos_compartidos->num_bandas;
-            datos_compartidos->bandas[banda].pausada = 1;
-            agregar_log_banda(banda, "BANDA PAUSADA POR SEÑAL", 0);
+            if (i + 1 < argc && strlen(argv[i + 1]) < 256)
+            {
+                strcpy(ruta_escenario, argv[i + 1]);
+                i++;
+            }
+            else
+            {
+                printf("Error: -e requiere la ruta del archivo de escenario\n");
+                return 0;
+            }
         }
-        break;
-    case SIGUSR2:
-        for (int i = 0; i < datos_compartidos->num_bandas; i++)
+        else if (strcmp(argv[i], "-x") == 0 || strcmp(argv[i], "--aceleracion") == 0)
         {
-            if (datos_compartidos->bandas[i].pausada)
+            if (i + 1 < argc)
             {
-                datos_compartidos->bandas[i].pausada = 0;
-                pthread_cond_signal(&datos_compartidos->bandas[i].condicion);
-                agregar_log_banda(i, "BANDA REANUDADA", 0);
+                aceleracion = atof(argv[i + 1]);
+                if (aceleracion < 1 || aceleracion > MAX_ACELERACION)
+                {
+                    printf("Error: La aceleración debe estar entre 1 y %d\n", MAX_ACELERACION);
+                    return 0;
+                }
+                i++;
+            }
+            else
+            {
+                printf("Error: -x requiere un factor de aceleración\n");
+                return 0;
             }
         }
-        break;
-    case SIGCONT:
-    {
-        int bandas_reabastecidas = 0;
-        for (int i = 0; i < datos_compartidos->num_bandas; i++)
+        else if (strcmp(argv[i], "-P") == 0 || strcmp(argv[i], "--politica") == 0)
         {
-            if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+            if (i + 1 < argc && (strcmp(argv[i + 1], "fifo") == 0 || strcmp(argv[i + 1], "valor") == 0))
             {
-                reabastecer_banda(i);
-                bandas_reabastecidas++;
+                politica_asignacion = strcmp(argv[i + 1], "valor") == 0 ? POLITICA_VALOR : POLITICA_FIFO;
+                i++;
+            }
+            else
+            {
+                printf("Error: -P requiere una política: fifo o valor\n");
+                return 0;
             }
         }
-        if (bandas_reabastecidas == 0)
+        else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--lote") == 0)
         {
-            int banda = rand() % datos_compartidos->num_bandas;
-            reabastecer_banda(banda);
+            if (i + 1 < argc)
+            {
+                tamano_lote_maximo = atoi(argv[i + 1]);
+                if (tamano_lote_maximo < 1 || tamano_lote_maximo > MAX_LOTE)
+                {
+                    printf("Error: El tamaño de lote debe estar entre 1 y %d\n", MAX_LOTE);
+                    return 0;
+                }
+                i++;
+            }
+            else
+            {
+                printf("Error: -b requiere el número máximo de órdenes por lote\n");
+                return 0;
+            }
         }
-        printf("\n📦 Reabastecimiento automático completado\n");
-    }
-    break;
-    }
-}
-
-int validar_parametros(int argc, char *argv[], int *num_bandas, int *tiempo_ingrediente, int *tiempo_orden)
-{
-    *num_bandas = 3;                                  // Valor por defecto
-    *tiempo_ingrediente = TIEMPO_DEFAULT_INGREDIENTE; // 2 segundos por defecto
-    *tiempo_orden = TIEMPO_DEFAULT_NUEVA_ORDEN;       // 7 segundos por defecto
-
-    for (int i = 1; i < argc; i++)
-    {
-        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+        else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--costo-lote") == 0)
         {
-            mostrar_ayuda();
-            return 0;
+            if (i + 1 < argc)
+            {
+                exponente_lote = atof(argv[i + 1]);
+                if (exponente_lote < 0 || exponente_lote > 1)
+                {
+                    printf("Error: El exponente de costo de lote debe estar entre 0 y 1\n");
+                    return 0;
+                }
+                i++;
+            }
+            else
+            {
+                printf("Error: -c requiere el exponente del costo de lote\n");
+                return 0;
+            }
         }
-        else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--bandas") == 0)
+        else if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--edad-maxima") == 0)
         {
             if (i + 1 < argc)
             {
-                *num_bandas = atoi(argv[i + 1]);
-                if (*num_bandas <= 0 || *num_bandas > MAX_BANDAS)
+                int segundos = atoi(argv[i + 1]);
+                if (segundos < 10 || segundos > 600)
                 {
-                    printf("Error: Número de bandas debe estar entre 1 y %d\n", MAX_BANDAS);
+                    printf("Error: La edad máxima de una orden debe estar entre 10 y 600 segundos\n");
                     return 0;
                 }
+                edad_maxima_ms = segundos * 1000LL;
                 i++;
             }
             else
             {
-                printf("Error: -n requiere un número\n");
+                printf("Error: -a requiere la edad máxima en segundos\n");
                 return 0;
             }
         }
-        else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--tiempo-ingrediente") == 0)
+        else if (strcmp(argv[i], "-Q") == 0 || strcmp(argv[i], "--paciencia") == 0)
+        {
+            if (i + 1 < argc && strcmp(argv[i + 1], "fija") == 0)
+                distribucion_paciencia = PACIENCIA_FIJA;
+            else if (i + 1 < argc && strcmp(argv[i + 1], "exp") == 0)
+                distribucion_paciencia = PACIENCIA_EXPONENCIAL;
+            else if (i + 1 < argc && strcmp(argv[i + 1], "unif") == 0)
+                distribucion_paciencia = PACIENCIA_UNIFORME;
+            else
+            {
+                printf("Error: -Q requiere una distribución de paciencia: fija, exp o unif\n");
+                return 0;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--dag") == 0)
+        {
+            recetas_en_dag = 1;
+        }
+        else if (strcmp(argv[i], "-g") == 0 || strcmp(argv[i], "--parrillas") == 0)
         {
             if (i + 1 < argc)
             {
-                *tiempo_ingrediente = atoi(argv[i + 1]);
-                if (*tiempo_ingrediente <= 0 || *tiempo_ingrediente > 60)
+                lugares_parrilla = atoi(argv[i + 1]);
+                if (lugares_parrilla < 1 || lugares_parrilla > MAX_BANDAS)
                 {
-                    printf("Error: Tiempo por ingrediente debe estar entre 1 y 60 segundos\n");
+                    printf("Error: Los lugares de la parrilla compartida deben estar entre 1 y %d\n", MAX_BANDAS);
                     return 0;
                 }
                 i++;
             }
             else
             {
-                printf("Error: -t requiere un número (segundos)\n");
+                printf("Error: -g requiere los lugares de la parrilla compartida\n");
                 return 0;
             }
         }
-        else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--tiempo-orden") == 0)
+        else if (strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--tolvas") == 0)
+        {
+            tolvas_compartidas = 1;
+        }
+        else if (strcmp(argv[i], "-u") == 0 || strcmp(argv[i], "--microbench") == 0)
+        {
+            modo_microbench = 1;
+        }
+        else if (strcmp(argv[i], "-z") == 0 || strcmp(argv[i], "--estres") == 0)
         {
             if (i + 1 < argc)
             {
-                *tiempo_orden = atoi(argv[i + 1]);
-                if (*tiempo_orden <= 0 || *tiempo_orden > 300)
+                segundos_estres = atoi(argv[i + 1]);
+                if (segundos_estres < 1 || segundos_estres > MAX_DURACION_ESTRES)
                 {
-                    printf("Error: Tiempo entre órdenes debe estar entre 1 y 300 segundos\n");
+                    printf("Error: La prueba de estrés debe durar entre 1 y %d segundos\n", MAX_DURACION_ESTRES);
                     return 0;
                 }
                 i++;
             }
             else
             {
-                printf("Error: -o requiere un número (segundos)\n");
+                printf("Error: -z requiere la duración de la prueba en segundos\n");
                 return 0;
             }
         }
         else if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--menu") == 0)
         {
+            planificar_recetas();
             mostrar_menu_hamburguesas();
             return 0;
         }
@@ -1965,6 +9118,21 @@ int validar_parametros(int argc, char *argv[], int *num_bandas, int *tiempo_ingr
             return 0;
         }
     }
+
+    // Las velocidades se validan contra el número de bandas, que puede venir después
+    for (int b = *num_bandas; b < MAX_BANDAS; b++)
+    {
+        int configurada = velocidad_banda[b] > 0;
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            configurada |= velocidad_estacion[b][j] > 0;
+        }
+        if (configurada)
+        {
+            printf("Error: -V configura la banda %d pero la cocina tiene %d\n", b + 1, *num_bandas);
+            return 0;
+        }
+    }
     return 1;
 }
 
@@ -1976,13 +9144,61 @@ void mostrar_ayuda()
     printf("  -n, --bandas <N>           Número de bandas de preparación (1-%d, default: 3)\n", MAX_BANDAS);
     printf("  -t, --tiempo-ingrediente <S> Segundos por ingrediente (1-60, default: %d)\n", TIEMPO_DEFAULT_INGREDIENTE);
     printf("  -o, --tiempo-orden <S>     Segundos entre órdenes (1-300, default: %d)\n", TIEMPO_DEFAULT_NUEVA_ORDEN);
+    printf("  -C, --clientes <N>         Población cerrada: N clientes que ordenan, esperan el desenlace y piensan\n");
+    printf("                             antes de volver (1-%d; reemplaza el intervalo de -o)\n", MAX_CLIENTES);
+    printf("  -W, --pensar <S>           Segundos simulados medios de reflexión, exponencial (default: %d)\n",
+           TIEMPO_DEFAULT_PENSAR);
+    printf("  -s, --nombre <NOMBRE>      Nombre de la cocina; segmento %s_<NOMBRE>\n", PREFIJO_MEMORIA);
+    printf("  -j, --diario <ARCHIVO>     Grabar el estado para reproducirlo con control_panel --replay\n");
+    printf("  -e, --escenario <ARCHIVO>  Ejecutar eventos programados (ver escenarios/)\n");
+    printf("  -A, --arrow <DIR>          Exportar órdenes, transiciones y métricas en Arrow IPC al terminar\n");
+    printf("  -R, --archivo <ARCHIVO>    Acumular métricas por segundo, minuto y hora en un archivo que sobrevive\n");
+    printf("                             entre corridas (el panel lo muestra con G)\n");
+    printf("  -x, --aceleracion <F>      Reloj simulado F veces más rápido (1-%d, default: 1)\n", MAX_ACELERACION);
+    printf("  -P, --politica <fifo|valor> Asignación: FIFO (default) o por ingreso/segundo con ventana de equidad\n");
+    printf("  -b, --lote <B>             Preparar juntas hasta B órdenes del mismo tipo (1-%d, default: 1)\n", MAX_LOTE);
+    printf("  -c, --costo-lote <A>       Un paso de un lote de n dura n^A pasos sueltos (0-1, default: %.1f)\n",
+           EXPONENTE_LOTE_DEFAULT);
+    printf("  -a, --edad-maxima <S>      Paciencia media en segundos simulados: el cliente abandona la orden que no\n");
+    printf("                             empezó a prepararse en ese tiempo (10-600, default: %d)\n",
+           EDAD_MAXIMA_DEFAULT_MS / 1000);
+    printf("  -Q, --paciencia <fija|exp|unif> Distribución de la paciencia de cada cliente: fija (default), exponencial\n");
+    printf("                             o uniforme entre 0.5 y 1.5 veces la media\n");
+    printf("  -d, --dag                  Recetas como DAG: pasos independientes en estaciones paralelas\n");
+    printf("  -T, --tiempo-reabasto <S>  Segundos simulados que una banda para por dispensador que rellena; los\n");
+    printf("                             rellenos se hacen entre órdenes (0-%d, default: 0 = al instante)\n",
+           MAX_TIEMPO_REABASTO);
+    printf("  -U, --umbral-reabasto <U>  Cada banda programa el relleno de los dispensadores con U o menos\n");
+    printf("  -V, --velocidad <B:F[:ING]> Factor de velocidad de la banda B (o solo de su estación de ING): sus\n");
+    printf("                             pasos duran lo normal / F (%.2f-%.1f; repetible)\n", VELOCIDAD_MINIMA,
+           VELOCIDAD_MAXIMA);
+    printf("  -F, --primera-libre        Con velocidades distintas, asignar igual a la primera banda libre\n");
+    printf("  -g, --parrillas <G>        Una parrilla de G lugares compartida por todas las bandas para la carne\n");
+    printf("  -k, --tolvas               Cada par de bandas vecinas comparte una tolva para las salsas\n");
+    printf("  -u, --microbench           Medir el despacho y la cola (ns/op) en vez de simular\n");
+    printf("  -z, --estres <S>           Prueba de estrés de S segundos a máxima velocidad verificando invariantes\n");
     printf("  -m, --menu                Mostrar menú de hamburguesas disponibles\n");
     printf("  -h, --help                Mostrar esta ayuda\n\n");
     printf("Ejemplos de uso:\n");
     printf("  ./burger_system -n 4                    # 4 bandas, tiempos por defecto\n");
     printf("  ./burger_system -n 2 -t 3 -o 10         # 2 bandas, 3s/ingrediente, 10s entre órdenes\n");
     printf("  ./burger_system -t 1 -o 5               # Tiempos rápidos: 1s/ingrediente, 5s entre órdenes\n");
-    printf("  ./burger_system -n 6 -t 5 -o 15         # 6 bandas, preparación lenta\n\n");
+    printf("  ./burger_system -n 6 -t 5 -o 15         # 6 bandas, preparación lenta\n");
+    printf("  ./burger_system -n 4 -s norte &         # Segunda cocina supervisable por el mismo panel\n");
+    printf("  ./burger_system -n 4 -j turno.diario    # Grabar el turno para revisarlo después\n");
+    printf("  ./burger_system -n 4 -e escenarios/simulacro_basico.txt -x 10\n");
+    printf("                                          # Simulacro programado a 10x\n");
+    printf("  ./burger_system -n 3 -b 4 -c 0.5        # Lotes de hasta 4 hamburguesas iguales\n");
+    printf("  ./burger_system -d -m                   # Calendario de cada receta en DAG\n");
+    printf("  ./burger_system -n 4 -g 2 -k            # Parrilla de 2 lugares y tolvas compartidas\n");
+    printf("  ./burger_system -n 4 -T 3 -U 3          # Rellenos de 3 s programados al bajar a 3 unidades\n");
+    printf("  ./burger_system -n 4 -C 12 -W 20        # Autoservicio con 12 autos que vuelven tras 20 s\n");
+    printf("  ./burger_system -n 4 -A resultados      # Resultados en resultados/*.arrow\n");
+    printf("  ./burger_system -n 4 -R cocina.rrd      # Tendencias de semana contra semana en el panel\n");
+    printf("  ./burger_system -n 6 -b 4 -z 120        # Dos minutos de estrés con lotes\n\n");
+    printf("Escenarios: una línea \"<segundo> <acción> [argumento]\" por evento, en tiempo simulado.\n");
+    printf("  pausar|reanudar|reabastecer|fallar|reparar|bloquear <N|todas>, tasa <órdenes/s>, cancelar <orden>,\n");
+    printf("  exportar (con -A), terminar\n\n");
     printf("-----------------------------------------------------------------\n");
 }
 
@@ -2020,11 +9236,48 @@ int main(int argc, char *argv[])
     int num_bandas, tiempo_ingrediente, tiempo_orden;
 
     // Validar y procesar parámetros de línea de comandos
-    if (!validar_parametros(argc, argv, &num_bandas, &tiempo_ingrediente, &tiempo_orden))
+    char nombre_parametro[MAX_NOMBRE_INSTANCIA] = "";
+    char ruta_diario[256] = "";
+    char ruta_escenario[256] = "";
+    if (!validar_parametros(argc, argv, &num_bandas, &tiempo_ingrediente, &tiempo_orden, nombre_parametro,
+                            ruta_diario, ruta_escenario))
     {
         return 0;
     }
 
+    // Validar el escenario completo antes de arrancar
+    if (strlen(ruta_escenario) > 0 && !cargar_escenario(ruta_escenario, num_bandas))
+    {
+        return 1;
+    }
+    intervalo_orden_ms = tiempo_orden * 1000;
+
+    // Cada cocina con nombre usa su propio segmento bajo el prefijo común
+    if (strlen(nombre_parametro) > 0)
+    {
+        strcpy(nombre_cocina, nombre_parametro);
+        snprintf(nombre_memoria, sizeof(nombre_memoria), "%s_%s", PREFIJO_MEMORIA, nombre_parametro);
+    }
+
+    // Crear el diario antes de levantar el sistema para fallar sin dejar recursos
+    if (strlen(ruta_diario) > 0 && !abrir_diario(ruta_diario))
+    {
+        return 1;
+    }
+    if (strlen(ruta_archivo_metricas) > 0 && !abrir_archivo_metricas(ruta_archivo_metricas))
+    {
+        return 1;
+    }
+    if (strlen(directorio_arrow) > 0 && mkdir(directorio_arrow, 0755) != 0 && errno != EEXIST)
+    {
+        printf("Error: No se pudo crear el directorio de exportación '%s'\n", directorio_arrow);
+        return 1;
+    }
+    if (segundos_estres > 0 && !preparar_estres())
+    {
+        return 1;
+    }
+
     // Configurar manejadores de señales del sistema operativo
     signal(SIGINT, manejar_senal);  // Ctrl+C
     signal(SIGTERM, manejar_senal); // Terminación del sistema
@@ -2034,8 +9287,21 @@ int main(int argc, char *argv[])
 
     // Inicializar generador de números aleatorios y sistema
     srand(time(NULL));
+    planificar_recetas();
     inicializar_sistema(num_bandas, tiempo_ingrediente, tiempo_orden);
 
+    // Los microbenchmarks usan el sistema recién inicializado, sin hilos
+    if (modo_microbench)
+    {
+        int resultado = ejecutar_microbenchmarks();
+        shm_unlink(nombre_memoria);
+        return resultado;
+    }
+
+    // El reloj simulado arranca antes que las bandas para que sus primeras transiciones tengan instante
+    inicio_simulacion_ms = reloj_ms();
+    registrar_componente(COMPONENTE_PANTALLA, "pantalla");
+
     // Crear hilos de trabajo para cada banda de preparación
     int banda_ids[MAX_BANDAS];
     for (int i = 0; i < num_bandas; i++)
@@ -2052,6 +9318,31 @@ int main(int argc, char *argv[])
     pthread_create(&hilo_generador_ordenes, NULL, generador_ordenes, NULL);
     pthread_create(&hilo_asignador_ordenes, NULL, asignador_ordenes, NULL);
     pthread_create(&hilo_monitor_inventario, NULL, monitor_inventario, NULL);
+    pthread_create(&hilo_publicador_metricas, NULL, publicador_metricas, NULL);
+    pthread_create(&hilo_procesador_comandos, NULL, procesador_comandos, NULL);
+    pthread_create(&hilo_vigilante, NULL, vigilante_bandas, NULL);
+    if (archivo_diario != NULL)
+    {
+        pthread_create(&hilo_escritor_diario, NULL, escritor_diario, NULL);
+        printf("Grabando diario de estado en %s\n", ruta_diario);
+    }
+    if (archivo_metricas != NULL)
+    {
+        pthread_create(&hilo_archivador, NULL, archivador_metricas, NULL);
+        printf("Archivando métricas en %s\n", ruta_archivo_metricas);
+    }
+    if (num_eventos_escenario > 0)
+    {
+        pthread_create(&hilo_escenario, NULL, ejecutor_escenario, NULL);
+        printf("Escenario %s: %d eventos (aceleración x%.0f)\n", ruta_escenario, num_eventos_escenario,
+               aceleracion);
+    }
+
+    // La prueba de estrés ocupa el hilo principal en lugar de la pantalla
+    if (segundos_estres > 0)
+    {
+        return ejecutar_estres();
+    }
 
     // Mostrar información de inicio del sistema
     printf("Sistema iniciado exitosamente con %d bandas\n", num_bandas);
@@ -2060,10 +9351,22 @@ int main(int argc, char *argv[])
     printf("Monitor de inventario ejecutándose\n");
     printf("⏱️  CONFIGURACIÓN DE TIEMPOS:\n");
     printf("   • %d segundos por ingrediente\n", tiempo_ingrediente);
-    printf("   • %d segundos entre órdenes nuevas\n", tiempo_orden);
+    if (num_clientes > 0)
+        printf("   • %d clientes en población cerrada, %.1f s de reflexión media\n", num_clientes,
+               tiempo_pensar_ms / 1000.0);
+    else
+        printf("   • %d segundos entre órdenes nuevas\n", tiempo_orden);
 
     // Calcular estadísticas estimadas de rendimiento del sistema
-    float hamburguesa_promedio = 6.5;                                                  // Promedio de ingredientes por hamburguesa
+    float hamburguesa_promedio = 6.5; // Promedio de ingredientes por hamburguesa
+    if (recetas_en_dag)
+    {
+        // Con recetas en DAG cuenta la duración de cada calendario, no el número de ingredientes
+        hamburguesa_promedio = 0;
+        for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+            hamburguesa_promedio += (float)planes_receta[r].duracion_total / NUM_TIPOS_HAMBURGUESA;
+        printf("Recetas en DAG: pasos independientes en paralelo por estación\n");
+    }
     float tiempo_promedio_preparacion = hamburguesa_promedio * tiempo_ingrediente + 1; // +1 segundo final
     float ordenes_por_minuto = 60.0 / tiempo_orden;
     float capacidad_teorica = (60.0 / tiempo_promedio_preparacion) * num_bandas;
@@ -2086,11 +9389,12 @@ int main(int argc, char *argv[])
     printf("PID del proceso: %d\n\n", getpid());
 
     // Pausa inicial para estabilización del sistema
-    sleep(3);
+    dormir_simulado(3000);
 
     // Bucle principal de visualización del estado del sistema
-    while (datos_compartidos->sistema_activo)
+    while (datos_compartidos->sistema_activo && !terminar_solicitado)
     {
+        contabilizar_despertar();
         mostrar_estado_adaptativo();
         sleep(2);
     }
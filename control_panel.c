@@ -67,6 +67,10 @@
  *
  * # Luego ejecutar el panel de control
  * ./control_panel
+ *
+ * # Supervisar varias cocinas (./burger_system -s norte, -s sur, ...)
+ * ./control_panel -s norte -s sur
+ * ./control_panel --descubrir
  * @endcode
  *
  * @section licencia Licencia
@@ -81,6 +85,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <sys/mman.h>
@@ -88,7 +93,14 @@
 #include <signal.h>
 #include <ncurses.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <dirent.h>
 #include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <limits.h>
 
 /**
  * @defgroup constantes_panel Constantes del Panel de Control
@@ -122,6 +134,136 @@
 /** @brief Umbral para considerar inventario bajo */
 #define UMBRAL_INVENTARIO_BAJO 2
 
+/** @brief Prefijo común de los segmentos de memoria compartida (registro de instancias) */
+#define PREFIJO_MEMORIA "/burger_system"
+
+/** @brief Longitud máxima del nombre de una instancia (cocina) */
+#define MAX_NOMBRE_INSTANCIA 32
+
+/** @brief Número máximo de cocinas que el panel puede supervisar a la vez */
+#define MAX_INSTANCIAS 16
+
+/** @brief Transiciones de estado que conserva cada banda para la línea de tiempo */
+#define MAX_TRANSICIONES_BANDA 256
+
+/** @brief Órdenes que una banda puede preparar juntas como máximo (igual que en burger_system) */
+#define MAX_LOTE 4
+
+/** @brief Columnas máximas de la franja de la línea de tiempo */
+#define MAX_COLUMNAS_LINEA 200
+
+/**
+ * @brief Estados de la línea de tiempo (deben coincidir con el sistema principal)
+ * @{
+ */
+#define ESTADO_LINEA_OCIOSA 0
+#define ESTADO_LINEA_OCUPADA 1
+#define ESTADO_LINEA_PAUSADA 2
+#define ESTADO_LINEA_SIN_INVENTARIO 3
+#define ESTADO_LINEA_REABASTECIENDO 4
+/** @} */
+
+/**
+ * @brief Formato del diario de estado (deben coincidir con el sistema principal)
+ * @{
+ */
+#define MAGIA_DIARIO "BURGDIA1"
+#define CUADRO_CLAVE 1
+#define CUADRO_DELTA 2
+/** @} */
+
+/**
+ * @brief Archivo persistente de métricas (deben coincidir con el sistema principal)
+ * @{
+ */
+#define MAGIA_ARCHIVO "BURGRRD2"
+#define NUM_RESOLUCIONES_ARCHIVO 3
+/** @} */
+
+/** @brief Segundos de una semana, para comparar cada intervalo con el de la semana anterior */
+#define SEGUNDOS_SEMANA (7 * 24 * 3600)
+
+/** @brief Filas como máximo en la tabla de tendencias */
+#define MAX_FILAS_TENDENCIAS 64
+
+/**
+ * @brief Contadores de eventos para las esperas entre hilos y procesos
+ * @{
+ */
+/** @brief Espera sin límite de tiempo */
+#define SIN_LIMITE -1
+/** @brief Despertar a uno de los hilos en espera */
+#define DESPERTAR_UNO 1
+/** @brief Despertar a todos los hilos en espera */
+#define DESPERTAR_TODOS INT_MAX
+/** @} */
+
+/**
+ * @brief Buzón de comandos entre el panel y el sistema principal
+ * @{
+ */
+/** @brief Buzón disponible */
+#define BUZON_LIBRE 0
+/** @brief Un panel está escribiendo un comando */
+#define BUZON_OCUPADO 1
+/** @brief Comando listo para que burger_system lo aplique */
+#define BUZON_PENDIENTE 2
+/** @brief burger_system tomó el comando y lo está aplicando */
+#define BUZON_APLICANDO 3
+/** @brief Comando aplicado; el resultado espera a que el panel lo lea */
+#define BUZON_RESUELTO 4
+
+/** @brief Reabastecimiento masivo de dispensadores */
+#define COMANDO_REABASTECER 1
+/** @brief Aplicar un plan de recargas calculado por el panel */
+#define COMANDO_APLICAR_PLAN 2
+/** @brief Cancelar una orden por su número */
+#define COMANDO_CANCELAR 3
+
+/** @brief Resultado de una cancelación: la orden no existe o ya salió del sistema */
+#define CANCELACION_NO_ENCONTRADA 0
+/** @brief Resultado de una cancelación: se quitó de la cola */
+#define CANCELACION_EN_COLA 1
+/** @brief Resultado de una cancelación: la banda la deja en su próximo paso y devuelve lo no usado */
+#define CANCELACION_EN_BANDA 2
+/** @brief Resultado de una cancelación: el asignador la tenía en mano; se descarta al soltarla */
+#define CANCELACION_EN_ASIGNACION 3
+
+/** @brief Recargas máximas de un plan (una por dispensador) */
+#define MAX_RECARGAS_PLAN (MAX_BANDAS * MAX_INGREDIENTES)
+
+/** @brief Rellenar todos los dispensadores seleccionados */
+#define REABASTECER_TODO 0
+/** @brief Rellenar solo los dispensadores con UMBRAL_INVENTARIO_BAJO o menos */
+#define REABASTECER_CRITICOS 1
+/** @brief Rellenar solo los dispensadores vacíos */
+#define REABASTECER_AGOTADOS 2
+
+/** @brief Argumento de banda que aplica el comando a todas las bandas */
+#define TODAS_LAS_BANDAS -1
+
+/** @brief Espera máxima por la confirmación de un comando (ms) */
+#define ESPERA_COMANDO_MS 1000
+/** @} */
+
+/** @brief Salto de --replay con las teclas < y > (ms de tiempo grabado) */
+#define SALTO_REPRODUCCION_MS 10000
+
+/** @brief Recursos compartidos como máximo: la parrilla y una tolva por cada par de bandas */
+#define MAX_RECURSOS (1 + (MAX_BANDAS + 1) / 2)
+
+/** @brief Largo máximo del nombre de un recurso */
+#define MAX_NOMBRE_RECURSO 32
+
+/** @brief Primera cuenta de CPU de banda; antes van los hilos fijos */
+#define COMPONENTE_PRIMERA_BANDA 10
+
+/** @brief Cuentas de CPU como máximo: los hilos fijos y uno por banda */
+#define MAX_COMPONENTES (COMPONENTE_PRIMERA_BANDA + MAX_BANDAS)
+
+/** @brief Largo máximo del nombre de un componente */
+#define MAX_NOMBRE_COMPONENTE 20
+
 /** @} */
 
 /**
@@ -133,6 +275,21 @@
  * Cualquier cambio en el sistema principal debe reflejarse aquí.
  */
 
+/**
+ * @brief Contador de eventos para esperar cambios en la memoria compartida
+ *
+ * Igual que en el sistema principal: la secuencia es la palabra de un futex
+ * compartido, así que el panel puede despertar a una banda que espera.
+ */
+typedef struct
+{
+    /** @brief Avanza con cada notificación; también es la palabra del futex */
+    unsigned int secuencia;
+
+    /** @brief Hilos de cualquier proceso dentro de esperar_eventos */
+    unsigned int esperando;
+} ContadorEventos;
+
 /**
  * @brief Estructura que representa un ingrediente en el inventario
  *
@@ -147,6 +304,12 @@ typedef struct
     /** @brief Cantidad disponible en el dispensador */
     int cantidad;
 
+    /** @brief Nivel al que la banda lo rellenará en su próximo hueco (0 si no hay relleno programado) */
+    int objetivo_reabasto;
+
+    /** @brief Factor de velocidad de la estación de este ingrediente (1 = normal) */
+    float velocidad;
+
     /** @brief Mutex para acceso thread-safe al inventario */
     pthread_mutex_t mutex;
 } Ingrediente;
@@ -227,8 +390,50 @@ typedef struct
 
     /** @brief Contador de intentos de asignación a bandas */
     int intentos_asignacion;
+
+    /** @brief Marca de creación en milisegundos de reloj monotónico */
+    long long creacion_ms;
+
+    /** @brief Hora estimada de entrega en ms de reloj monotónico (0 si no hay banda que pueda prepararla) */
+    long long eta_ms;
+
+    /** @brief Primera estimación de entrega, hecha al encolar la orden */
+    long long eta_prometida_ms;
+
+    /** @brief Veces que la política por valor asignó antes otra orden que estaba detrás de esta */
+    int veces_adelantada;
+
+    /** @brief Cliente de la población cerrada que la pidió (-1 con llegadas abiertas) */
+    int cliente;
+
+    /** @brief Espera que tolera el cliente antes de abandonarla (ms simulados) */
+    long long paciencia_ms;
+
+    /** @brief Órdenes en la cola cuando llegó */
+    int cola_al_llegar;
+
+    /** @brief Temporizador de paciencia del sistema (-1 si ninguno) */
+    int temporizador;
+
+    /** @brief Cancelación: en la cola 1 es una lápida; en una banda 1 está pendiente y 2 ya atendida */
+    int cancelada;
 } Orden;
 
+/**
+ * @brief Cambio de estado de una banda para la línea de tiempo
+ */
+typedef struct
+{
+    /** @brief Momento del cambio en milisegundos de reloj monotónico */
+    long long marca_ms;
+
+    /** @brief Nuevo estado (ESTADO_LINEA_*) */
+    int estado;
+
+    /** @brief Tipo de hamburguesa en preparación (-1 si no aplica) */
+    int tipo_hamburguesa;
+} TransicionBanda;
+
 /**
  * @brief Estructura que representa una banda de preparación
  *
@@ -271,8 +476,8 @@ typedef struct
     /** @brief Mutex para acceso exclusivo a los datos de la banda */
     pthread_mutex_t mutex;
 
-    /** @brief Variable de condición para sincronización */
-    pthread_cond_t condicion;
+    /** @brief Se notifica al pausar, reanudar, averiar, reparar o asignarle una orden */
+    ContadorEventos eventos;
 
     /** @brief Descripción del estado actual de la banda */
     char estado_actual[100];
@@ -285,6 +490,69 @@ typedef struct
 
     /** @brief Timestamp de la última alerta de inventario */
     time_t ultima_alerta_inventario;
+
+    /** @brief Último rechazo del asignador por falta de ingredientes (ms) */
+    long long ultimo_rechazo_inventario_ms;
+
+    /** @brief Anillo de transiciones de estado (escrito solo por el hilo de la banda) */
+    TransicionBanda transiciones[MAX_TRANSICIONES_BANDA];
+
+    /** @brief Número total de transiciones registradas */
+    unsigned int total_transiciones;
+
+    /** @brief Unidades consumidas de cada dispensador desde el inicio */
+    int consumido[MAX_INGREDIENTES];
+
+    /** @brief Versión del inventario (seqlock: impar mientras se escriben cantidades) */
+    unsigned int version_inventario;
+
+    /** @brief Último latido de progreso en ms de reloj monotónico (se publica en cada paso) */
+    long long latido_ms;
+
+    /** @brief Duración esperada del paso en curso en ms reales (0 si no hay nada que vigilar) */
+    long long paso_esperado_ms;
+
+    /** @brief Generación de la orden en curso (la reclaman la banda o el vigilante con un CAS) */
+    unsigned int generacion_orden;
+
+    /** @brief Valor de generacion_orden cuando el asignador entregó la orden en curso */
+    unsigned int generacion_asignada;
+
+    /** @brief Flag que indica que el vigilante la declaró atascada y le quitó la orden */
+    int atascada;
+
+    /** @brief Órdenes rescatadas de esta banda por el vigilante */
+    int ordenes_rescatadas;
+
+    /** @brief Ingresos (precio de menú) de las hamburguesas completadas por esta banda */
+    float ingresos;
+
+    /** @brief Órdenes del lote en curso contando orden_actual (1 si se prepara sola) */
+    int tamano_lote;
+
+    /** @brief Resto del lote en curso: órdenes del mismo tipo que orden_actual */
+    Orden lote[MAX_LOTE - 1];
+
+    /** @brief Lotes de más de una orden completados por esta banda */
+    int lotes_completados;
+
+    /** @brief Flag que indica que está rellenando dispensadores */
+    int reabasteciendo;
+
+    /** @brief Tiempo simulado total parada rellenando dispensadores (ms) */
+    long long reabasto_ms;
+
+    /** @brief Parte de reabasto_ms con órdenes esperando (ms simulados) */
+    long long reabasto_perdido_ms;
+
+    /** @brief Dispensadores rellenados por la propia banda */
+    int dispensadores_reabastecidos;
+
+    /** @brief De ellos, los urgentes que pasaron antes que las órdenes en espera */
+    int reabastos_urgentes;
+
+    /** @brief Factor de velocidad de la banda (1 = tiempo_por_ingrediente) */
+    float velocidad;
 } Banda;
 
 /**
@@ -307,807 +575,2964 @@ typedef struct
     /** @brief Número actual de órdenes en la cola */
     int tamano;
 
+    /** @brief Lugares de tamano ocupados por órdenes canceladas o expiradas que aún no se saltaron */
+    int lapidas;
+
     /** @brief Mutex para acceso exclusivo a la cola */
     pthread_mutex_t mutex;
 
-    /** @brief Variable de condición para cola no vacía */
-    pthread_cond_t no_vacia;
+    /** @brief Se notifica al entrar una orden a la cola */
+    ContadorEventos no_vacia;
 
-    /** @brief Variable de condición para cola no llena */
-    pthread_cond_t no_llena;
+    /** @brief Se notifica al salir una orden de la cola */
+    ContadorEventos no_llena;
 } ColaFIFO;
 
 /**
- * @brief Estructura principal de datos compartidos del sistema
+ * @brief Instantánea de métricas publicada por el sistema con un seqlock
  *
- * Contiene toda la información del sistema que se comparte entre
- * el sistema principal y el panel de control a través de memoria compartida.
+ * Se lee con leer_instantanea(), que reintenta mientras la secuencia sea
+ * impar o cambie durante la copia. No requiere tomar mutexes del sistema.
  */
 typedef struct
 {
-    /** @brief Array de todas las bandas del sistema */
-    Banda bandas[MAX_BANDAS];
+    /** @brief Contador del seqlock (impar mientras se escribe) */
+    unsigned int secuencia;
 
-    /** @brief Cola FIFO de órdenes pendientes */
-    ColaFIFO cola_espera;
+    /** @brief Momento de publicación en milisegundos de reloj monotónico */
+    long long marca_ms;
 
-    /** @brief Número actual de bandas activas */
-    int num_bandas;
+    /** @brief Órdenes generadas al momento de publicar */
+    int ordenes_generadas;
 
-    /** @brief Flag que indica si el sistema está operativo */
-    int sistema_activo;
+    /** @brief Órdenes procesadas al momento de publicar */
+    int ordenes_procesadas;
 
-    /** @brief Contador total de órdenes procesadas */
-    int total_ordenes_procesadas;
+    /** @brief Órdenes esperando en la cola FIFO */
+    int ordenes_en_cola;
 
-    /** @brief Contador total de órdenes generadas */
-    int total_ordenes_generadas;
+    /** @brief Bandas operativas y no pausadas */
+    int bandas_operativas;
 
-    /** @brief Mutex global para operaciones del sistema */
-    pthread_mutex_t mutex_global;
+    /** @brief Dispensadores vacíos sumando todas las bandas */
+    int dispensadores_agotados;
 
-    /** @brief Variable de condición para nuevas órdenes */
-    pthread_cond_t nueva_orden;
-} DatosCompartidos;
+    /** @brief Bandas que necesitan reabastecimiento */
+    int bandas_sin_inventario;
 
-/**
- * @defgroup variables_globales Variables Globales del Panel de Control
- * @{
- */
+    /** @brief Hamburguesas completadas por minuto en la última ventana */
+    float throughput_por_minuto;
 
-/** @brief Puntero a la estructura de datos compartidos del sistema principal */
-DatosCompartidos *datos_compartidos;
+    /** @brief Latencia mediana en milisegundos */
+    int latencia_p50_ms;
 
-/** @brief Ventana principal que muestra la vista general del sistema */
-WINDOW *win_main;
+    /** @brief Latencia percentil 99 en milisegundos */
+    int latencia_p99_ms;
 
-/** @brief Ventana que muestra detalles de banda o inventario */
-WINDOW *win_banda_detail;
+    /** @brief Órdenes que llegan por minuto (ventana deslizante) */
+    float llegadas_por_minuto;
 
-/** @brief Ventana que muestra los comandos disponibles según el modo actual */
-WINDOW *win_commands;
+    /** @brief Bandas que el vigilante tiene marcadas como atascadas */
+    int bandas_atascadas;
 
-/** @brief Ventana que muestra el estado del sistema y la vista actual */
-WINDOW *win_status;
+    /** @brief Órdenes reencoladas por el vigilante desde el arranque */
+    int ordenes_rescatadas;
 
-/** @brief Índice de la banda actualmente seleccionada (0 a num_bandas-1) */
-int banda_seleccionada = 0;
+    /** @brief Error absoluto medio de la hora prometida frente a la entrega real (ms simulados) */
+    int error_eta_medio_ms;
 
-/** @brief Índice del ingrediente seleccionado en modo inventario (0 a MAX_INGREDIENTES-1) */
-int ingrediente_seleccionado = 0;
+    /** @brief Error medio con signo de la hora prometida (positivo: se entregó tarde) en ms simulados */
+    int sesgo_eta_ms;
 
-/** @brief Modo de vista actual del panel de control
- *
- * Valores posibles:
- * - 0: Vista general (resumen de todas las bandas)
- * - 1: Detalle de banda específica
- * - 2: Inventario global (resumen por ingrediente)
- * - 3: Inventario de banda específica (editable)
- * - 4: Modo abastecimiento (operaciones masivas)
- */
-int modo_vista = 0;
+    /** @brief Ingresos por minuto simulado en la última ventana */
+    float ingresos_por_minuto;
 
-/** @brief Flag que indica si el panel está en modo abastecimiento */
-int en_modo_abastecimiento = 0;
+    /** @brief Ingresos acumulados de las órdenes completadas */
+    float ingresos_totales;
 
-/** @} */
+    /** @brief Ingresos perdidos por órdenes expiradas o rechazadas por cola llena */
+    float ingresos_perdidos;
 
-/**
- * @defgroup datos_estaticos Datos Estáticos del Sistema
- * @{
- */
+    /** @brief Ingresos por hora simulada de cada banda configurada */
+    float ingresos_por_banda_hora;
 
-/**
- * @brief Menú completo de hamburguesas disponibles
- *
- * Define todos los tipos de hamburguesas que se pueden preparar en el sistema,
- * incluyendo sus ingredientes específicos, cantidad de ingredientes y precios.
- * Cada hamburguesa tiene una receta única que determina el orden de preparación.
- *
- * @note Debe coincidir exactamente con el menú del sistema principal
- */
-TipoHamburguesa menu_hamburguesas[NUM_TIPOS_HAMBURGUESA] = {
-    /** @brief Hamburguesa Clásica: Pan, carne, lechuga, tomate */
-    {"Clasica", {"pan_inferior", "carne", "lechuga", "tomate", "pan_superior"}, 5, 8.50},
+    /** @brief Órdenes completadas por lote preparado, en promedio desde el arranque */
+    float tamano_lote_medio;
 
-    /** @brief Cheeseburger: Clásica + queso */
-    {"Cheeseburger", {"pan_inferior", "carne", "queso", "lechuga", "tomate", "pan_superior"}, 6, 9.25},
+    /** @brief Calentamiento descartado por MSER-5 (s simulados; -1 si aún no hay estado estacionario) */
+    int calentamiento_s;
 
-    /** @brief BBQ Bacon: Con bacon, queso, cebolla y salsa BBQ */
-    {"BBQ Bacon", {"pan_inferior", "carne", "bacon", "queso", "cebolla", "salsa_bbq", "pan_superior"}, 7, 11.75},
+    /** @brief Órdenes por minuto del estado estacionario */
+    float throughput_estacionario;
 
-    /** @brief Vegetariana: Sin carne, con vegetal y aguacate */
-    {"Vegetariana", {"pan_inferior", "vegetal", "lechuga", "tomate", "aguacate", "mayonesa", "pan_superior"}, 7, 10.25},
+    /** @brief Semiancho del intervalo de confianza del 95 % del throughput estacionario */
+    float ic_throughput_estacionario;
 
-    /** @brief Deluxe: Hamburguesa premium con todos los ingredientes */
-    {"Deluxe", {"pan_inferior", "carne", "queso", "bacon", "lechuga", "tomate", "cebolla", "mayonesa", "pan_superior"}, 9, 13.50},
+    /** @brief Latencia media del estado estacionario (ms simulados) */
+    float latencia_estacionaria_ms;
 
-    /** @brief Spicy Mexican: Con jalapeños y salsa picante */
-    {"Spicy Mexican", {"pan_inferior", "carne", "queso", "jalapenos", "tomate", "cebolla", "salsa_picante", "pan_superior"}, 8, 12.00}};
+    /** @brief Semiancho del intervalo de confianza del 95 % de la latencia estacionaria */
+    float ic_latencia_estacionaria_ms;
+} InstantaneaMetricas;
 
 /**
- * @brief Lista completa de ingredientes base disponibles
- *
- * Define todos los ingredientes que pueden estar presentes en cualquier
- * hamburguesa del sistema. Cada banda tiene dispensadores para todos estos
- * ingredientes, permitiendo preparar cualquier tipo de hamburguesa del menú.
- *
- * @note Debe coincidir exactamente con la lista del sistema principal
+ * @brief Recarga de un dispensador dentro de un plan de reabastecimiento
  */
-char ingredientes_base[MAX_INGREDIENTES][MAX_NOMBRE_INGREDIENTE] = {
-    "pan_inferior", "pan_superior", "carne", "queso", "tomate",
-    "lechuga", "cebolla", "bacon", "mayonesa", "jalapenos",
-    "aguacate", "vegetal", "salsa_bbq", "salsa_picante", "pepinillos"};
+typedef struct
+{
+    /** @brief Banda del dispensador */
+    int banda;
 
-/** @} */
+    /** @brief Índice del ingrediente en ingredientes_base */
+    int ingrediente;
+
+    /** @brief Unidades a añadir */
+    int unidades;
+} RecargaPlan;
 
 /**
- * @defgroup prototipos_panel Prototipos de Funciones del Panel de Control
- * @{
+ * @brief Buzón de comandos que el panel envía al sistema principal
  *
- * Declaraciones de todas las funciones del panel de control, organizadas
- * por categorías funcionales para facilitar la comprensión del código.
+ * Un solo comando en vuelo. El panel reserva el buzón con un CAS
+ * LIBRE -> OCUPADO, escribe el comando, lo publica como PENDIENTE y despierta
+ * al procesador con un futex. burger_system lo toma con un CAS
+ * PENDIENTE -> APLICANDO, escribe el resultado y lo marca RESUELTO. El panel
+ * lee el resultado y libera el buzón. Si el sistema no responde, el panel
+ * retira el comando con un CAS PENDIENTE -> LIBRE; solo uno de los dos CAS
+ * puede ganar, así que un comando nunca se aplica después de retirarse.
  */
+typedef struct
+{
+    /** @brief Estado del buzón (BUZON_*); también es la palabra del futex */
+    unsigned int estado;
 
-// ============================================================================
-// FUNCIONES DE INICIALIZACIÓN Y CONFIGURACIÓN
-// ============================================================================
+    /** @brief Número de comando, para asociar el resultado con su envío */
+    unsigned int secuencia;
 
-/**
- * @brief Inicializa la biblioteca ncurses y configura la interfaz gráfica
- * @note Configura colores, ventanas y parámetros de la terminal
- */
-void inicializar_ncurses();
+    /** @brief PID del panel que reservó el buzón (para recuperarlo si muere) */
+    pid_t pid_emisor;
 
-/**
- * @brief Conecta el panel con el sistema principal a través de memoria compartida
- * @warning Si no puede conectar, el programa termina con mensaje de error
- */
-void conectar_memoria_compartida();
+    /** @brief Reloj monotónico al reservar el buzón (ms) */
+    long long reservado_ms;
 
-// ============================================================================
-// FUNCIONES DE VISUALIZACIÓN PRINCIPAL
-// ============================================================================
+    /** @brief Comando solicitado (COMANDO_*) */
+    int comando;
 
-/**
- * @brief Muestra la vista general del sistema con resumen de todas las bandas
- * @note Incluye estadísticas generales y estado de cada banda
- */
-void mostrar_interfaz_general();
+    /** @brief Criterio de reabastecimiento (REABASTECER_*) */
+    int modo;
 
-/**
- * @brief Muestra información detallada de la banda seleccionada
- * @note Incluye estado, orden actual, inventario crítico y logs
- */
-void mostrar_detalle_banda();
+    /** @brief Banda destino o TODAS_LAS_BANDAS */
+    int banda;
 
-/**
- * @brief Muestra resumen global del inventario por ingrediente
- * @note Agrupa información de todas las bandas por tipo de ingrediente
- */
-void mostrar_inventario_global();
+    /** @brief Ingrediente destino o -1 para todos */
+    int ingrediente;
 
-/**
- * @brief Muestra inventario completo de la banda seleccionada
- * @note Permite edición interactiva de cantidades de ingredientes
- */
-void mostrar_inventario_banda();
+    /** @brief Resultado: dispensadores rellenados */
+    int dispensadores;
 
-/**
- * @brief Muestra el modo de abastecimiento con opciones masivas
- * @note Incluye opciones para reabastecer bandas específicas o todas
- */
-void mostrar_modo_abastecimiento();
+    /** @brief Resultado: unidades añadidas en total */
+    int unidades;
 
-/**
- * @brief Muestra los comandos disponibles según el modo de vista actual
- * @note Se actualiza dinámicamente según el contexto del usuario
- */
-void mostrar_comandos_disponibles();
+    /** @brief Resultado: bandas con algún dispensador rellenado */
+    int bandas;
 
-// ============================================================================
-// FUNCIONES DE CONTROL Y PROCESAMIENTO
-// ============================================================================
+    /** @brief Resultado: 1 si los rellenos quedaron programados para las bandas */
+    int programado;
 
-/**
- * @brief Procesa un comando de teclado del usuario
- * @param ch Código del carácter o tecla especial presionada
- * @note Maneja navegación, control de bandas y operaciones de inventario
- */
-void procesar_comando(int ch);
+    /** @brief Resultado: tiempo que tomó aplicar el comando (ns) */
+    long long duracion_ns;
 
-/**
- * @brief Pausa o reanuda una banda específica
- * @param banda_id ID de la banda a pausar/reanudar
- * @note Cambia el estado de la banda y muestra mensaje de confirmación
- */
-void pausar_reanudar_banda(int banda_id);
+    /** @brief Recargas del plan (solo COMANDO_APLICAR_PLAN) */
+    int num_recargas;
+
+    /** @brief Plan de recargas (solo COMANDO_APLICAR_PLAN) */
+    RecargaPlan recargas[MAX_RECARGAS_PLAN];
+
+    /** @brief Orden a cancelar (solo COMANDO_CANCELAR) */
+    int id_orden;
+
+    /** @brief Resultado de la cancelación (CANCELACION_*) */
+    int resultado_cancelacion;
+} BuzonComandos;
 
 /**
- * @brief Reabastece completamente el inventario de una banda
- * @param banda_id ID de la banda a reabastecer
- * @note Llena todos los dispensadores a capacidad máxima
+ * @brief Recurso de cocina con lugares contados compartido entre bandas
  */
-void reabastecer_banda_completa(int banda_id);
+typedef struct
+{
+    /** @brief Nombre para las estadísticas y el panel */
+    char nombre[MAX_NOMBRE_RECURSO];
 
-/**
- * @brief Reabastece un ingrediente específico de una banda
- * @param banda_id ID de la banda
- * @param ingrediente_id ID del ingrediente a reabastecer
- * @note Llena solo el ingrediente especificado
+    /** @brief Lugares del recurso */
+    int capacidad;
+
+    /** @brief Primera y última banda que lo usan (índices desde 0) */
+    int banda_desde;
+    int banda_hasta;
+
+    /** @brief Lugares ocupados ahora */
+    int en_uso;
+
+    /** @brief Bandas esperando un lugar ahora */
+    int esperando;
+
+    /** @brief Próximo turno a entregar a una banda que llega */
+    unsigned int siguiente_turno;
+
+    /** @brief Turno al que le toca tomar el próximo lugar libre */
+    unsigned int turno_actual;
+
+    /** @brief Lugares tomados en total */
+    int usos;
+
+    /** @brief Usos que tuvieron que esperar */
+    int esperas;
+
+    /** @brief Máximo de bandas esperando a la vez */
+    int max_esperando;
+
+    /** @brief Espera acumulada en ms simulados */
+    long long espera_total_ms;
+
+    /** @brief Integral de lugares ocupados en el tiempo (lugar-ms simulados) */
+    long long ocupado_ms;
+
+    /** @brief Reloj monotónico del último cambio de en_uso (ms) */
+    long long ultimo_cambio_ms;
+
+    /** @brief Fracción de la capacidad usada desde el arranque */
+    float utilizacion;
+
+    /** @brief Mutex del recurso */
+    pthread_mutex_t mutex;
+
+    /** @brief Se notifica al soltar o tomar un lugar */
+    ContadorEventos liberado;
+} RecursoCompartido;
+
+/**
+ * @brief Consumo de CPU de un hilo interno de burger_system
  */
-void reabastecer_ingrediente_especifico(int banda_id, int ingrediente_id);
+typedef struct
+{
+    /** @brief Nombre del componente; vacío si el hilo no existe */
+    char nombre[MAX_NOMBRE_COMPONENTE];
 
-// ============================================================================
-// FUNCIONES DE NAVEGACIÓN Y SELECCIÓN
-// ============================================================================
+    /** @brief 1 mientras el hilo está en ejecución */
+    int activo;
+
+    /** @brief CPU consumida por el hilo desde que arrancó (ns) */
+    long long cpu_ns;
+
+    /** @brief Vueltas del bucle del hilo (cada una sigue a una espera) */
+    long long despertares;
+
+    /** @brief Cambios de contexto voluntarios */
+    long long cambios_voluntarios;
+
+    /** @brief Cambios de contexto involuntarios */
+    long long cambios_involuntarios;
+
+    /** @brief Reloj monotónico de la última lectura de los relojes del hilo (ms) */
+    long long ultima_lectura_ms;
+
+    /** @brief Fracción de un núcleo usada en el último segundo */
+    float uso_cpu;
+
+    /** @brief Despertares por segundo en el último segundo */
+    float despertares_por_segundo;
+
+    /** @brief cpu_ns y despertares cuando se calcularon las tasas anteriores */
+    long long cpu_anterior_ns;
+    long long despertares_anteriores;
+} CuentaCpu;
 
 /**
- * @brief Cambia la banda seleccionada en la dirección especificada
- * @param direccion +1 para siguiente banda, -1 para anterior
- * @note Implementa navegación circular entre bandas
+ * @brief Estructura principal de datos compartidos del sistema
+ *
+ * Contiene toda la información del sistema que se comparte entre
+ * el sistema principal y el panel de control a través de memoria compartida.
  */
-void cambiar_banda_seleccionada(int direccion);
+typedef struct
+{
+    /** @brief Array de todas las bandas del sistema */
+    Banda bandas[MAX_BANDAS];
+
+    /** @brief Cola FIFO de órdenes pendientes */
+    ColaFIFO cola_espera;
+
+    /** @brief Número actual de bandas activas */
+    int num_bandas;
+
+    /** @brief Flag que indica si el sistema está operativo */
+    int sistema_activo;
+
+    /** @brief Contador total de órdenes procesadas */
+    int total_ordenes_procesadas;
+
+    /** @brief Contador total de órdenes generadas */
+    int total_ordenes_generadas;
+
+    /** @brief Mutex global para operaciones del sistema */
+    pthread_mutex_t mutex_global;
+
+    /** @brief Se notifica cuando hay nuevas órdenes disponibles */
+    ContadorEventos nueva_orden;
+
+    /** @brief Tiempo configurado para procesar cada ingrediente (segundos) */
+    int tiempo_por_ingrediente;
+
+    /** @brief Tiempo configurado entre nuevas órdenes (segundos) */
+    int tiempo_nueva_orden;
+
+    /** @brief Nombre de la instancia (cocina) */
+    char nombre_instancia[MAX_NOMBRE_INSTANCIA];
+
+    /** @brief PID del proceso burger_system dueño del segmento */
+    pid_t pid;
+
+    /** @brief Métricas agregadas legibles sin bloqueos */
+    InstantaneaMetricas instantanea;
+
+    /** @brief Buzón de comandos del panel (ver BuzonComandos) */
+    BuzonComandos buzon;
+
+    /** @brief Ingresos acumulados de las órdenes completadas */
+    double ingresos_totales;
+
+    /** @brief Ingresos de las órdenes expiradas o rechazadas */
+    double ingresos_perdidos;
+
+    /** @brief Órdenes expiradas por superar la edad máxima sin prepararse */
+    int ordenes_descartadas;
+
+    /** @brief Órdenes nuevas rechazadas por cola llena */
+    int ordenes_rechazadas;
+
+    /** @brief Política de asignación en uso (0 FIFO, 1 por valor) */
+    int politica_asignacion;
+
+    /** @brief Órdenes que una banda puede tomar juntas (1 = sin lotes) */
+    int tamano_lote_maximo;
+
+    /** @brief Exponente del modelo de costo de lote */
+    float exponente_lote;
+
+    /** @brief Lotes completados, contando como lote de 1 cada orden suelta */
+    int lotes_procesados;
+
+    /** @brief Órdenes canceladas desde el panel o un escenario */
+    int ordenes_canceladas;
+
+    /** @brief Edad máxima de una orden sin preparar en ms simulados */
+    int edad_maxima_ms;
+
+    /** @brief Recursos compartidos entre bandas (parrilla y tolvas) */
+    RecursoCompartido recursos[MAX_RECURSOS];
+
+    /** @brief Recursos configurados (0 si cada banda tiene todo propio) */
+    int num_recursos;
+
+    /** @brief CPU de cada hilo interno */
+    CuentaCpu cuentas_cpu[MAX_COMPONENTES];
+
+    /** @brief Cuentas en uso: los hilos fijos más una por banda */
+    int num_componentes;
+
+    /** @brief CPU de todo el proceso desde el arranque (ns) */
+    long long cpu_proceso_ns;
+
+    /** @brief Fracción de un núcleo usada por todo el proceso en el último segundo */
+    float uso_cpu_proceso;
+
+    /** @brief Archivo de métricas que escribe la cocina (--archivo), o "" si no archiva */
+    char ruta_archivo_metricas[256];
+
+    /** @brief Clientes de la población cerrada (--clientes); 0 con llegadas abiertas */
+    int num_clientes;
+
+    /** @brief Clientes con una orden en curso; el resto está pensando */
+    int clientes_esperando;
+
+    /** @brief Distribución de la paciencia: 0 fija, 1 exponencial, 2 uniforme */
+    int distribucion_paciencia;
+} DatosCompartidos;
 
 /**
- * @brief Cambia el ingrediente seleccionado en modo inventario
- * @param direccion +1 para siguiente ingrediente, -1 para anterior
- * @note Implementa navegación circular entre ingredientes
+ * @brief Cocina (instancia de burger_system) conectada al panel
+ *
+ * El panel puede supervisar varias cocinas; datos_compartidos apunta siempre
+ * a la cocina seleccionada para que las vistas existentes funcionen sin cambios.
  */
-void cambiar_ingrediente_seleccionado(int direccion);
+typedef struct
+{
+    /** @brief Nombre del segmento de memoria compartida (ej: "/burger_system_norte") */
+    char segmento[64];
 
-// ============================================================================
-// FUNCIONES DE UTILIDAD Y AYUDA
-// ============================================================================
+    /** @brief Segmento mapeado de la cocina */
+    DatosCompartidos *datos;
+
+    /** @brief Última instantánea leída (para detectar cocinas detenidas) */
+    InstantaneaMetricas ultima;
+} Instancia;
 
 /**
- * @brief Muestra un mensaje temporal en la parte inferior de la pantalla
- * @param mensaje Texto del mensaje a mostrar
- * @note El mensaje se muestra por 1.5 segundos y luego se borra
+ * @brief Cabecera del archivo de diario de estado (ver burger_system.c)
  */
-void mostrar_mensaje_temporal(const char *mensaje);
+typedef struct
+{
+    /** @brief Debe valer MAGIA_DIARIO */
+    char magia[8];
+
+    /** @brief Tamaño de DatosCompartidos al grabar */
+    unsigned int tamano_estado;
+
+    /** @brief Intervalo nominal entre cuadros (ms) */
+    int intervalo_ms;
+
+    /** @brief Reloj monotónico al iniciar la grabación (ms) */
+    long long inicio_ms;
+
+    /** @brief Nombre de la cocina grabada */
+    char nombre_instancia[MAX_NOMBRE_INSTANCIA];
+} CabeceraDiario;
 
 /**
- * @brief Muestra la ayuda detallada del panel de control
- * @note Incluye todos los controles disponibles y ejemplos de uso
+ * @brief Cabecera de cada cuadro del diario
  */
-void mostrar_ayuda_detallada();
+typedef struct
+{
+    /** @brief CUADRO_CLAVE o CUADRO_DELTA */
+    int tipo;
+
+    /** @brief Bytes de carga que siguen a esta cabecera */
+    unsigned int longitud;
+
+    /** @brief Reloj monotónico en que se tomó el cuadro (ms) */
+    long long marca_ms;
+} CabeceraCuadro;
 
 /**
- * @brief Limpia todos los recursos de ncurses y restaura la terminal
- * @note Debe ser llamada antes de terminar el programa
+ * @brief Fila del archivo de métricas: lo ocurrido en un intervalo de reloj real
+ *
+ * Mismo formato que en el sistema principal. El intervalo que empieza en t
+ * ocupa la fila (t / paso_s) % filas y solo vale si su inicio_s coincide.
  */
-void limpiar_ncurses();
+typedef struct
+{
+    /** @brief Inicio del intervalo en segundos desde la época (0: nunca escrita) */
+    long long inicio_s;
+
+    /** @brief Suma de la cola en cada muestra; la media es cola_suma / muestras */
+    long long cola_suma;
+
+    /** @brief Muestras del archivador consolidadas en la fila */
+    int muestras;
+
+    /** @brief Órdenes entregadas en el intervalo */
+    int completadas;
+
+    /** @brief Órdenes generadas en el intervalo */
+    int llegadas;
+
+    /** @brief Dispensadores que se vaciaron en el intervalo */
+    int agotamientos;
+
+    /** @brief Cola más larga observada en el intervalo */
+    int cola_maxima;
+
+    /** @brief Entregas del intervalo con latencia medida */
+    int latencias;
+
+    /** @brief Latencia mediana de las entregas del intervalo (ms simulados) */
+    int latencia_p50_ms;
+
+    /** @brief Latencia percentil 99 de las entregas del intervalo (ms simulados) */
+    int latencia_p99_ms;
+
+    /** @brief Entregas que cubren los percentiles; menos que latencias si el intervalo viene de varias corridas */
+    int latencias_percentil;
+} FilaArchivo;
 
 /**
- * @brief Determina el color apropiado para mostrar un ingrediente según su cantidad
- * @param cantidad Cantidad actual del ingrediente
- * @return Cadena con el código de color apropiado
- * @note Verde para normal, amarillo para crítico, rojo para agotado
+ * @brief Anillo de una resolución dentro del archivo de métricas
  */
-const char *obtener_color_ingrediente(int cantidad);
+typedef struct
+{
+    /** @brief Segundos que cubre cada fila */
+    int paso_s;
+
+    /** @brief Filas del anillo */
+    int filas;
+
+    /** @brief Posición de la primera fila desde el inicio del archivo (bytes) */
+    long long desplazamiento;
+} ResolucionArchivo;
 
 /**
- * @brief Muestra el menú de opciones de abastecimiento
- * @note Función auxiliar para mostrar_modo_abastecimiento()
+ * @brief Cabecera del archivo de métricas que escribe burger_system --archivo
  */
-void mostrar_menu_abastecimiento();
+typedef struct
+{
+    /** @brief Debe valer MAGIA_ARCHIVO */
+    char magia[8];
 
-/** @} */
+    /** @brief Contador del seqlock (impar mientras se escribe) */
+    unsigned int secuencia;
 
-// ================================================================
-// INICIALIZACION Y CONFIGURACION
-// ================================================================
+    /** @brief Resoluciones guardadas (NUM_RESOLUCIONES_ARCHIVO) */
+    int num_resoluciones;
 
-void inicializar_ncurses()
+    /** @brief Geometría de cada anillo, de la más fina a la más gruesa */
+    ResolucionArchivo resoluciones[NUM_RESOLUCIONES_ARCHIVO];
+
+    /** @brief Última muestra escrita, en segundos desde la época */
+    long long actualizado_s;
+
+    /** @brief Tamaño total del archivo (bytes) */
+    long long tamano;
+
+    /** @brief Cocina que escribió la última muestra */
+    char nombre_instancia[MAX_NOMBRE_INSTANCIA];
+} CabeceraArchivo;
+
+/**
+ * @brief Entrada del índice de cuadros construido al abrir un diario
+ */
+typedef struct
 {
-    initscr();
-    cbreak();
-    noecho();
-    nodelay(stdscr, TRUE);
-    keypad(stdscr, TRUE);
-    curs_set(0);
+    /** @brief Posición de la carga del cuadro en el archivo */
+    long posicion;
 
-    // Configurar colores
-    if (has_colors())
-    {
-        start_color();
-        init_pair(1, COLOR_GREEN, COLOR_BLACK);   // Verde - Normal
-        init_pair(2, COLOR_YELLOW, COLOR_BLACK);  // Amarillo - Advertencia
-        init_pair(3, COLOR_RED, COLOR_BLACK);     // Rojo - Critico/Error
-        init_pair(4, COLOR_CYAN, COLOR_BLACK);    // Cian - Encabezados
-        init_pair(5, COLOR_WHITE, COLOR_BLUE);    // Seleccion
-        init_pair(6, COLOR_MAGENTA, COLOR_BLACK); // Destacado
-        init_pair(7, COLOR_BLACK, COLOR_WHITE);   // Invertido
-        init_pair(8, COLOR_WHITE, COLOR_GREEN);   // Seleccion verde
-        init_pair(9, COLOR_BLACK, COLOR_YELLOW);  // Seleccion amarilla
-    }
+    /** @brief Cabecera del cuadro */
+    CabeceraCuadro cabecera;
+
+    /** @brief Índice del cuadro clave más reciente (el propio si es clave) */
+    int clave_previa;
+} IndiceCuadro;
+
+/**
+ * @brief Estado de la reproducción de un diario (--replay)
+ *
+ * El estado reconstruido vive en memoria local y se expone a las vistas a
+ * través de datos_compartidos, igual que el segmento de una cocina en vivo.
+ */
+typedef struct
+{
+    /** @brief Archivo de diario abierto */
+    FILE *archivo;
+
+    /** @brief Índice de todos los cuadros del diario */
+    IndiceCuadro *cuadros;
+
+    /** @brief Número de cuadros válidos en el índice */
+    int num_cuadros;
+
+    /** @brief Cuadro aplicado actualmente sobre estado */
+    int cuadro_actual;
+
+    /** @brief Estado reconstruido */
+    DatosCompartidos *estado;
+
+    /** @brief Buffer para leer la carga de los cuadros delta */
+    unsigned char *carga;
+
+    /** @brief Instante reproducido, en el reloj monotónico de la grabación (ms) */
+    long long marca_ms;
+
+    /** @brief Reloj real del último avance (ms) */
+    long long ultimo_avance_ms;
+
+    /** @brief Multiplicador de velocidad (1, 10 o 100) */
+    int velocidad;
+
+    /** @brief Si la reproducción está detenida */
+    int en_pausa;
+} Reproduccion;
+
+/**
+ * @defgroup variables_globales Variables Globales del Panel de Control
+ * @{
+ */
+
+/** @brief Puntero a la estructura de datos compartidos de la cocina seleccionada */
+DatosCompartidos *datos_compartidos;
+
+/** @brief Cocinas conectadas al panel */
+Instancia instancias[MAX_INSTANCIAS];
+
+/** @brief Número de cocinas conectadas */
+int num_instancias = 0;
+
+/** @brief Índice de la cocina seleccionada (la que muestran las vistas de detalle) */
+int instancia_seleccionada = 0;
+
+/** @brief Ventana principal que muestra la vista general del sistema */
+WINDOW *win_main;
+
+/** @brief Ventana que muestra detalles de banda o inventario */
+WINDOW *win_banda_detail;
+
+/** @brief Ventana que muestra los comandos disponibles según el modo actual */
+WINDOW *win_commands;
+
+/** @brief Ventana que muestra el estado del sistema y la vista actual */
+WINDOW *win_status;
+
+/** @brief Índice de la banda actualmente seleccionada (0 a num_bandas-1) */
+int banda_seleccionada = 0;
+
+/** @brief Índice del ingrediente seleccionado en modo inventario (0 a MAX_INGREDIENTES-1) */
+int ingrediente_seleccionado = 0;
+
+/** @brief Modo de vista actual del panel de control
+ *
+ * Valores posibles:
+ * - 0: Vista general (resumen de todas las bandas)
+ * - 1: Detalle de banda específica
+ * - 2: Inventario global (resumen por ingrediente)
+ * - 3: Inventario de banda específica (editable)
+ * - 4: Modo abastecimiento (operaciones masivas)
+ * - 5: Vista de flota (todas las cocinas conectadas)
+ * - 6: Línea de tiempo de las bandas
+ * - 7: Mapa de calor de inventario (bandas x ingredientes)
+ * - 8: Uso de CPU por componente
+ * - 9: Tendencias del archivo de métricas
+ */
+int modo_vista = 0;
+
+/** @brief Si el mapa de calor colorea por tiempo hasta agotarse (1) o por nivel de llenado (0) */
+int mapa_por_tiempo = 0;
+
+/** @brief Minutos que abarca la línea de tiempo */
+int minutos_linea_tiempo = 5;
+
+/** @brief Resolución del archivo de métricas que muestran las tendencias (0 segundos, 1 minutos, 2 horas) */
+int resolucion_tendencias = 1;
+
+/** @brief Bandas en las que el plan de reabastecimiento garantiza cada receta (K) */
+int plan_bandas_k = 2;
+
+/** @brief Minutos de demanda prevista que debe cubrir el plan de reabastecimiento (T) */
+int plan_minutos = 10;
+
+/** @brief Si el panel reproduce un diario en lugar de supervisar cocinas en vivo */
+int modo_reproduccion = 0;
+
+/** @brief Estado de la reproducción (válido solo con modo_reproduccion) */
+Reproduccion reproduccion;
+
+/** @brief Flag que indica si el panel está en modo abastecimiento */
+int en_modo_abastecimiento = 0;
+
+/** @} */
+
+/**
+ * @defgroup datos_estaticos Datos Estáticos del Sistema
+ * @{
+ */
+
+/**
+ * @brief Menú completo de hamburguesas disponibles
+ *
+ * Define todos los tipos de hamburguesas que se pueden preparar en el sistema,
+ * incluyendo sus ingredientes específicos, cantidad de ingredientes y precios.
+ * Cada hamburguesa tiene una receta única que determina el orden de preparación.
+ *
+ * @note Debe coincidir exactamente con el menú del sistema principal
+ */
+TipoHamburguesa menu_hamburguesas[NUM_TIPOS_HAMBURGUESA] = {
+    /** @brief Hamburguesa Clásica: Pan, carne, lechuga, tomate */
+    {"Clasica", {"pan_inferior", "carne", "lechuga", "tomate", "pan_superior"}, 5, 8.50},
+
+    /** @brief Cheeseburger: Clásica + queso */
+    {"Cheeseburger", {"pan_inferior", "carne", "queso", "lechuga", "tomate", "pan_superior"}, 6, 9.25},
+
+    /** @brief BBQ Bacon: Con bacon, queso, cebolla y salsa BBQ */
+    {"BBQ Bacon", {"pan_inferior", "carne", "bacon", "queso", "cebolla", "salsa_bbq", "pan_superior"}, 7, 11.75},
+
+    /** @brief Vegetariana: Sin carne, con vegetal y aguacate */
+    {"Vegetariana", {"pan_inferior", "vegetal", "lechuga", "tomate", "aguacate", "mayonesa", "pan_superior"}, 7, 10.25},
+
+    /** @brief Deluxe: Hamburguesa premium con todos los ingredientes */
+    {"Deluxe", {"pan_inferior", "carne", "queso", "bacon", "lechuga", "tomate", "cebolla", "mayonesa", "pan_superior"}, 9, 13.50},
+
+    /** @brief Spicy Mexican: Con jalapeños y salsa picante */
+    {"Spicy Mexican", {"pan_inferior", "carne", "queso", "jalapenos", "tomate", "cebolla", "salsa_picante", "pan_superior"}, 8, 12.00}};
+
+/**
+ * @brief Lista completa de ingredientes base disponibles
+ *
+ * Define todos los ingredientes que pueden estar presentes en cualquier
+ * hamburguesa del sistema. Cada banda tiene dispensadores para todos estos
+ * ingredientes, permitiendo preparar cualquier tipo de hamburguesa del menú.
+ *
+ * @note Debe coincidir exactamente con la lista del sistema principal
+ */
+char ingredientes_base[MAX_INGREDIENTES][MAX_NOMBRE_INGREDIENTE] = {
+    "pan_inferior", "pan_superior", "carne", "queso", "tomate",
+    "lechuga", "cebolla", "bacon", "mayonesa", "jalapenos",
+    "aguacate", "vegetal", "salsa_bbq", "salsa_picante", "pepinillos"};
+
+/** @} */
+
+/**
+ * @defgroup prototipos_panel Prototipos de Funciones del Panel de Control
+ * @{
+ *
+ * Declaraciones de todas las funciones del panel de control, organizadas
+ * por categorías funcionales para facilitar la comprensión del código.
+ */
+
+// ============================================================================
+// FUNCIONES DE INICIALIZACIÓN Y CONFIGURACIÓN
+// ============================================================================
+
+/**
+ * @brief Inicializa la biblioteca ncurses y configura la interfaz gráfica
+ * @note Configura colores, ventanas y parámetros de la terminal
+ */
+void inicializar_ncurses();
+
+/**
+ * @brief Conecta el panel con el sistema principal a través de memoria compartida
+ * @warning Si no puede conectar, el programa termina con mensaje de error
+ */
+void conectar_memoria_compartida();
+
+/**
+ * @brief Mapea el segmento de una cocina y la añade a la lista de instancias
+ * @param segmento Nombre del segmento POSIX (ej: "/burger_system_norte")
+ * @return Índice de la instancia, o -1 si no se pudo conectar
+ */
+int conectar_instancia(const char *segmento);
+
+/**
+ * @brief Descubre cocinas en ejecución buscando segmentos con PREFIJO_MEMORIA
+ * @return Número de cocinas nuevas conectadas
+ */
+int descubrir_instancias();
+
+/**
+ * @brief Obtiene el reloj monotónico en milisegundos (mismo origen que el sistema)
+ * @return Milisegundos de CLOCK_MONOTONIC
+ */
+long long reloj_ms();
+
+/**
+ * @brief Segundos de reloj que faltan para una marca de tiempo
+ * @param marca_ms Marca en ms de reloj monotónico (p. ej. la ETA de una orden)
+ * @return Segundos restantes; negativos si la marca ya pasó
+ */
+float segundos_hasta(long long marca_ms);
+
+/**
+ * @brief Copia la instantánea de métricas de una cocina sin tomar mutexes
+ * @param datos Segmento de la cocina
+ * @param destino Estructura donde se copia la instantánea consistente
+ */
+void leer_instantanea(DatosCompartidos *datos, InstantaneaMetricas *destino);
+
+// ============================================================================
+// FUNCIONES DE VISUALIZACIÓN PRINCIPAL
+// ============================================================================
+
+/**
+ * @brief Muestra la vista general del sistema con resumen de todas las bandas
+ * @note Incluye estadísticas generales y estado de cada banda
+ */
+void mostrar_interfaz_general();
+
+/**
+ * @brief Muestra información detallada de la banda seleccionada
+ * @note Incluye estado, orden actual, inventario crítico y logs
+ */
+void mostrar_detalle_banda();
+
+/**
+ * @brief Muestra resumen global del inventario por ingrediente
+ * @note Agrupa información de todas las bandas por tipo de ingrediente
+ */
+void mostrar_inventario_global();
+
+/**
+ * @brief Muestra inventario completo de la banda seleccionada
+ * @note Permite edición interactiva de cantidades de ingredientes
+ */
+void mostrar_inventario_banda();
+
+/**
+ * @brief Muestra el modo de abastecimiento con opciones masivas
+ * @note Incluye opciones para reabastecer bandas específicas o todas
+ */
+void mostrar_modo_abastecimiento();
+
+/**
+ * @brief Muestra la vista de flota con una fila por cocina conectada
+ * @note Lee solo instantáneas publicadas, sin bloquear ninguna cocina
+ */
+void mostrar_vista_flota();
+
+/**
+ * @brief Muestra el mapa de calor de inventario con una celda por banda e ingrediente
+ * @note Copia el inventario de cada banda una vez por cuadro, sin bloquear dispensadores
+ */
+void mostrar_mapa_calor();
+
+/**
+ * @brief Muestra la CPU, los despertares y los cambios de contexto de cada hilo de la cocina
+ * @note Agrega una fila con el consumo del propio panel, medido con sus relojes de proceso
+ */
+void mostrar_uso_cpu();
+
+/**
+ * @brief Proyecta en memoria, solo para lectura, el archivo de métricas de una cocina
+ * @param ruta Ruta publicada por la cocina en ruta_archivo_metricas
+ * @return Cabecera del archivo, o NULL si no existe o no tiene el formato esperado
+ * @note Conserva la última proyección y solo vuelve a abrir si cambia la ruta
+ */
+const CabeceraArchivo *proyectar_archivo_metricas(const char *ruta);
+
+/**
+ * @brief Copia las filas de los últimos intervalos de una resolución sin bloquear al archivador
+ * @param archivo Archivo proyectado
+ * @param resolucion Índice de la resolución
+ * @param ultimo_s Inicio del intervalo más reciente a copiar
+ * @param cantidad Filas a copiar, de la más reciente hacia atrás
+ * @param destino Array de cantidad filas; los huecos quedan con inicio_s = 0
+ */
+void leer_filas_archivo(const CabeceraArchivo *archivo, int resolucion, long long ultimo_s, int cantidad,
+                        FilaArchivo *destino);
+
+/**
+ * @brief Muestra las tendencias del archivo de métricas y la comparación con la semana anterior
+ */
+void mostrar_tendencias();
+
+/**
+ * @brief Copia las cantidades de todos los dispensadores de una banda sin bloquearlos
+ * @param banda Banda a copiar
+ * @param cantidades Array de MAX_INGREDIENTES donde se copian las cantidades
+ * @param consumido Array de MAX_INGREDIENTES donde se copian los consumos acumulados
+ * @return 1 si la copia es coherente, 0 si un escritor la invalidó en todos los intentos
+ */
+int copiar_inventario_banda(Banda *banda, int *cantidades, int *consumido);
+
+/**
+ * @brief Muestra la línea de tiempo (tipo Gantt) de los últimos minutos de cada banda
+ * @note Solo recalcula la franja de una banda si cambió su anillo o avanzó una columna
+ */
+void mostrar_linea_tiempo();
+
+/**
+ * @brief Muestra los comandos disponibles según el modo de vista actual
+ * @note Se actualiza dinámicamente según el contexto del usuario
+ */
+void mostrar_comandos_disponibles();
+
+// ============================================================================
+// FUNCIONES DE CONTROL Y PROCESAMIENTO
+// ============================================================================
+
+/**
+ * @brief Procesa un comando de teclado del usuario
+ * @param ch Código del carácter o tecla especial presionada
+ * @note Maneja navegación, control de bandas y operaciones de inventario
+ */
+void procesar_comando(int ch);
+
+/**
+ * @brief Pausa o reanuda una banda específica
+ * @param banda_id ID de la banda a pausar/reanudar
+ * @note Cambia el estado de la banda y muestra mensaje de confirmación
+ */
+void pausar_reanudar_banda(int banda_id);
+
+/**
+ * @brief Reabastece completamente el inventario de una banda
+ * @param banda_id ID de la banda a reabastecer
+ * @note Llena todos los dispensadores a capacidad máxima
+ */
+void reabastecer_banda_completa(int banda_id);
+
+/**
+ * @brief Reabastece un ingrediente específico de una banda
+ * @param banda_id ID de la banda
+ * @param ingrediente_id ID del ingrediente a reabastecer
+ * @note Llena solo el ingrediente especificado
+ */
+void reabastecer_ingrediente_especifico(int banda_id, int ingrediente_id);
+
+// ============================================================================
+// FUNCIONES DE NAVEGACIÓN Y SELECCIÓN
+// ============================================================================
+
+/**
+ * @brief Abre un diario de estado, construye su índice y carga el primer cuadro
+ * @param ruta Ruta del archivo grabado con burger_system --diario
+ * @return 1 si el diario es válido, 0 en caso contrario
+ */
+int abrir_reproduccion(const char *ruta);
+
+/**
+ * @brief Reconstruye el estado de un cuadro del diario
+ * @param destino Índice del cuadro a reconstruir
+ * @note Parte del cuadro clave previo salvo que el actual esté en el mismo tramo y antes
+ */
+void ir_a_cuadro(int destino);
+
+/**
+ * @brief Busca el último cuadro tomado en o antes de un instante
+ * @param marca_ms Instante en el reloj de la grabación
+ * @return Índice del cuadro (0 si el instante es anterior al primero)
+ */
+int buscar_cuadro(long long marca_ms);
+
+/**
+ * @brief Avanza el instante reproducido según el reloj real y la velocidad
+ * @return 1 si cambió el cuadro mostrado, 0 en caso contrario
+ */
+int avanzar_reproduccion();
+
+/**
+ * @brief Procesa las teclas propias de la reproducción y bloquea las que modifican la cocina
+ * @param ch Tecla presionada
+ * @return 1 si la tecla fue consumida, 0 si debe procesarla procesar_comando
+ */
+int procesar_comando_reproduccion(int ch);
+
+/**
+ * @brief Espera o despierta sobre una palabra de memoria compartida (futex)
+ * @param palabra Palabra del futex (en memoria compartida entre procesos)
+ * @param operacion FUTEX_WAIT o FUTEX_WAKE
+ * @param valor Con FUTEX_WAIT, valor esperado; con FUTEX_WAKE, hilos a despertar
+ * @param espera_us Con FUTEX_WAIT, espera máxima en microsegundos (reloj monotónico) o SIN_LIMITE
+ * @return Resultado de la llamada al sistema
+ */
+long llamada_futex(unsigned int *palabra, int operacion, unsigned int valor, long long espera_us);
+
+/**
+ * @brief Avanza el contador y despierta a los hilos del sistema principal que esperan
+ * @param eventos Contador de eventos en la memoria compartida
+ * @param despertar DESPERTAR_UNO o DESPERTAR_TODOS
+ */
+void notificar_eventos(ContadorEventos *eventos, int despertar);
+
+/**
+ * @brief Indica si un proceso ya no existe
+ * @param pid PID a comprobar
+ * @return 1 si kill(pid, 0) confirma que no existe, 0 si existe o no se puede saber
+ */
+int proceso_terminado(pid_t pid);
+
+/**
+ * @brief Envía un comando por el buzón y espera su confirmación
+ * @param comando Campos comando, modo, banda e ingrediente; recibe el resultado
+ * @return 1 si burger_system confirmó el comando, 0 si no lo tomó a tiempo o terminó sin resolverlo
+ */
+int enviar_comando(BuzonComandos *comando);
+
+/**
+ * @brief Calcula el plan mínimo de recargas que deja cada receta servible en K bandas
+ *
+ * La demanda prevista de cada receta en T minutos es la tasa de llegada
+ * repartida por igual entre las recetas del menú. Cada una de las K bandas que
+ * sirven una receta debe tener 1/K de esa demanda de cada uno de sus
+ * ingredientes (al menos una unidad). El plan se construye con un algoritmo
+ * voraz de cobertura: en cada paso elige la banda y receta cuyas recargas
+ * faltantes cubren más recetas pendientes por recarga.
+ *
+ * @param k Bandas en las que debe poder servirse cada receta
+ * @param minutos Minutos de demanda prevista a cubrir
+ * @param plan Array de MAX_RECARGAS_PLAN donde se escriben las recargas
+ * @param recetas_sin_cubrir Recibe cuántas recetas no alcanzan K bandas (sin bandas operativas suficientes)
+ * @return Número de recargas del plan, o -1 si no se pudo copiar el inventario de forma coherente
+ */
+int calcular_plan_reabastecimiento(int k, int minutos, RecargaPlan *plan, int *recetas_sin_cubrir);
+
+/**
+ * @brief Calcula el plan de reabastecimiento actual y lo envía como un solo comando
+ */
+void aplicar_plan_reabastecimiento();
+
+/**
+ * @brief Pide a burger_system un reabastecimiento masivo y muestra el resultado
+ * @param modo Criterio (REABASTECER_TODO, REABASTECER_CRITICOS o REABASTECER_AGOTADOS)
+ * @param banda Banda destino o TODAS_LAS_BANDAS
+ * @param ingrediente Ingrediente destino o -1 para todos
+ * @param descripcion Texto inicial del mensaje de confirmación
+ */
+void reabastecer_por_buzon(int modo, int banda, int ingrediente, const char *descripcion);
+
+/**
+ * @brief Pide el número de una orden y envía su cancelación por el buzón
+ */
+void cancelar_orden_por_buzon();
+
+/**
+ * @brief Abre una escritura del inventario de una banda (deja su versión impar)
+ *
+ * Espera a que termine otro escritor. Se llama con el mutex del dispensador
+ * ya tomado y no se toma ningún mutex hasta cerrarla.
+ * @param banda Banda cuyo inventario se va a modificar desde el panel
+ */
+void abrir_escritura_inventario(Banda *banda);
+
+/**
+ * @brief Cierra la escritura del inventario de una banda (deja su versión par)
+ * @param banda Banda cuyo inventario se modificó desde el panel
+ */
+void cerrar_escritura_inventario(Banda *banda);
+
+/**
+ * @brief Cambia la banda seleccionada en la dirección especificada
+ * @param direccion +1 para siguiente banda, -1 para anterior
+ * @note Implementa navegación circular entre bandas
+ */
+void cambiar_banda_seleccionada(int direccion);
+
+/**
+ * @brief Cambia el ingrediente seleccionado en modo inventario
+ * @param direccion +1 para siguiente ingrediente, -1 para anterior
+ * @note Implementa navegación circular entre ingredientes
+ */
+void cambiar_ingrediente_seleccionado(int direccion);
+
+/**
+ * @brief Cambia la cocina seleccionada en la vista de flota
+ * @param direccion +1 para siguiente cocina, -1 para anterior
+ */
+void cambiar_instancia_seleccionada(int direccion);
+
+/**
+ * @brief Entra al detalle de una cocina: las demás vistas pasan a mostrarla
+ * @param indice Índice de la cocina en la lista de instancias
+ */
+void seleccionar_instancia(int indice);
+
+// ============================================================================
+// FUNCIONES DE UTILIDAD Y AYUDA
+// ============================================================================
+
+/**
+ * @brief Muestra un mensaje temporal en la parte inferior de la pantalla
+ * @param mensaje Texto del mensaje a mostrar
+ * @note El mensaje se muestra por 1.5 segundos y luego se borra
+ */
+void mostrar_mensaje_temporal(const char *mensaje);
+
+/**
+ * @brief Lee un número entero positivo en la línea inferior de la pantalla
+ * @param pregunta Texto mostrado antes del número
+ * @return Número leído, o -1 si se canceló con ESC o se dejó vacío
+ */
+int pedir_numero(const char *pregunta);
+
+/**
+ * @brief Muestra la ayuda detallada del panel de control
+ * @note Incluye todos los controles disponibles y ejemplos de uso
+ */
+void mostrar_ayuda_detallada();
+
+/**
+ * @brief Limpia todos los recursos de ncurses y restaura la terminal
+ * @note Debe ser llamada antes de terminar el programa
+ */
+void limpiar_ncurses();
+
+/**
+ * @brief Determina el color apropiado para mostrar un ingrediente según su cantidad
+ * @param cantidad Cantidad actual del ingrediente
+ * @return Cadena con el código de color apropiado
+ * @note Verde para normal, amarillo para crítico, rojo para agotado
+ */
+const char *obtener_color_ingrediente(int cantidad);
+
+/**
+ * @brief Muestra el menú de opciones de abastecimiento
+ * @note Función auxiliar para mostrar_modo_abastecimiento()
+ */
+void mostrar_menu_abastecimiento();
+
+/** @} */
+
+// ================================================================
+// INICIALIZACION Y CONFIGURACION
+// ================================================================
+
+void inicializar_ncurses()
+{
+    initscr();
+    cbreak();
+    noecho();
+    nodelay(stdscr, TRUE);
+    keypad(stdscr, TRUE);
+    curs_set(0);
+
+    // Configurar colores
+    if (has_colors())
+    {
+        start_color();
+        init_pair(1, COLOR_GREEN, COLOR_BLACK);   // Verde - Normal
+        init_pair(2, COLOR_YELLOW, COLOR_BLACK);  // Amarillo - Advertencia
+        init_pair(3, COLOR_RED, COLOR_BLACK);     // Rojo - Critico/Error
+        init_pair(4, COLOR_CYAN, COLOR_BLACK);    // Cian - Encabezados
+        init_pair(5, COLOR_WHITE, COLOR_BLUE);    // Seleccion
+        init_pair(6, COLOR_MAGENTA, COLOR_BLACK); // Destacado
+        init_pair(7, COLOR_BLACK, COLOR_WHITE);   // Invertido
+        init_pair(8, COLOR_WHITE, COLOR_GREEN);   // Seleccion verde
+        init_pair(9, COLOR_BLACK, COLOR_YELLOW);  // Seleccion amarilla
+        init_pair(10, COLOR_WHITE, COLOR_RED);    // Celda de mapa: agotado
+        init_pair(11, COLOR_BLACK, COLOR_YELLOW); // Celda de mapa: bajo
+        init_pair(12, COLOR_BLACK, COLOR_GREEN);  // Celda de mapa: medio
+        init_pair(13, COLOR_BLACK, COLOR_CYAN);   // Celda de mapa: lleno
+    }
+
+    // Calcular dimensiones
+    int altura, ancho;
+    getmaxyx(stdscr, altura, ancho);
+
+    // Crear ventanas principales
+    win_main = newwin(altura - 8, ancho - 2, 1, 1);
+    win_banda_detail = newwin(altura - 8, ancho / 2, 1, ancho / 2);
+    win_commands = newwin(6, ancho / 2, altura - 7, 1);
+    win_status = newwin(6, ancho / 2, altura - 7, ancho / 2);
+
+    // Habilitar teclas especiales
+    keypad(win_main, TRUE);
+    keypad(win_banda_detail, TRUE);
+    keypad(win_commands, TRUE);
+    keypad(win_status, TRUE);
+
+    refresh();
+}
+
+void conectar_memoria_compartida()
+{
+    if (conectar_instancia(PREFIJO_MEMORIA) < 0)
+    {
+        endwin();
+        printf("Error: No se pudo conectar con el sistema principal.\n");
+        printf("   Asegurate de que ./burger_system este ejecutandose.\n");
+        printf("   Uso: ./burger_system -n 4 &\n");
+        printf("        ./control_panel\n");
+        exit(1);
+    }
+}
+
+int conectar_instancia(const char *segmento)
+{
+    if (num_instancias >= MAX_INSTANCIAS)
+        return -1;
+
+    // Evitar conectar dos veces la misma cocina
+    for (int i = 0; i < num_instancias; i++)
+    {
+        if (strcmp(instancias[i].segmento, segmento) == 0)
+            return i;
+    }
+
+    int shm_fd = shm_open(segmento, O_RDWR, 0666);
+    if (shm_fd == -1)
+        return -1;
+
+    // Un segmento de otro tamaño pertenece a una versión incompatible del sistema
+    struct stat info;
+    if (fstat(shm_fd, &info) == -1 || info.st_size != (off_t)sizeof(DatosCompartidos))
+    {
+        close(shm_fd);
+        return -1;
+    }
+
+    DatosCompartidos *datos = mmap(0, sizeof(DatosCompartidos), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    close(shm_fd);
+
+    if (datos == MAP_FAILED)
+        return -1;
+
+    Instancia *instancia = &instancias[num_instancias];
+    memset(instancia, 0, sizeof(Instancia));
+    strncpy(instancia->segmento, segmento, sizeof(instancia->segmento) - 1);
+    instancia->datos = datos;
+
+    // La primera cocina conectada es la seleccionada por defecto
+    if (num_instancias == 0)
+        datos_compartidos = datos;
+
+    return num_instancias++;
+}
+
+int descubrir_instancias()
+{
+    // Los segmentos POSIX de Linux se publican como archivos en /dev/shm
+    DIR *directorio = opendir("/dev/shm");
+    if (directorio == NULL)
+        return 0;
+
+    const char *prefijo = PREFIJO_MEMORIA + 1; // Sin la barra inicial
+    int nuevas = 0;
+    struct dirent *entrada;
+
+    while ((entrada = readdir(directorio)) != NULL)
+    {
+        if (strncmp(entrada->d_name, prefijo, strlen(prefijo)) != 0)
+            continue;
+
+        // Aceptar "burger_system" y "burger_system_<nombre>"
+        char sufijo = entrada->d_name[strlen(prefijo)];
+        if (sufijo != '\0' && sufijo != '_')
+            continue;
+
+        char segmento[64];
+        snprintf(segmento, sizeof(segmento), "/%.62s", entrada->d_name);
+
+        int antes = num_instancias;
+        if (conectar_instancia(segmento) >= 0 && num_instancias > antes)
+            nuevas++;
+    }
+
+    closedir(directorio);
+    return nuevas;
+}
+
+long long reloj_ms()
+{
+    // Al reproducir, "ahora" es el instante reproducido para que las vistas
+    // que comparan marcas de tiempo (línea de tiempo, mapa) sigan funcionando
+    if (modo_reproduccion)
+        return reproduccion.marca_ms;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+float segundos_hasta(long long marca_ms)
+{
+    return (marca_ms - reloj_ms()) / 1000.0f;
+}
+
+void leer_instantanea(DatosCompartidos *datos, InstantaneaMetricas *destino)
+{
+    InstantaneaMetricas *origen = &datos->instantanea;
+
+    // Reintentar mientras el escritor esté publicando (secuencia impar o cambiada)
+    for (int intento = 0; intento < 100; intento++)
+    {
+        unsigned int antes = __atomic_load_n(&origen->secuencia, __ATOMIC_ACQUIRE);
+        if (antes & 1)
+        {
+            usleep(10);
+            continue;
+        }
+
+        memcpy(destino, origen, sizeof(InstantaneaMetricas));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&origen->secuencia, __ATOMIC_RELAXED) == antes)
+            return;
+    }
+}
+
+// ================================================================
+// FUNCIONES DE REPRODUCCION
+// ================================================================
+
+/**
+ * @brief Reloj monotónico real, independiente del instante reproducido
+ * @return Milisegundos desde un origen arbitrario
+ */
+static long long reloj_real_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int abrir_reproduccion(const char *ruta)
+{
+    memset(&reproduccion, 0, sizeof(reproduccion));
+
+    reproduccion.archivo = fopen(ruta, "rb");
+    if (reproduccion.archivo == NULL)
+    {
+        printf("Error: No se pudo abrir el diario '%s'\n", ruta);
+        return 0;
+    }
+
+    CabeceraDiario cabecera;
+    if (fread(&cabecera, sizeof(cabecera), 1, reproduccion.archivo) != 1 ||
+        memcmp(cabecera.magia, MAGIA_DIARIO, sizeof(cabecera.magia)) != 0)
+    {
+        printf("Error: '%s' no es un diario de burger_system\n", ruta);
+        return 0;
+    }
+    if (cabecera.tamano_estado != sizeof(DatosCompartidos))
+    {
+        printf("Error: El diario fue grabado por una versión incompatible del sistema\n");
+        return 0;
+    }
+
+    // Indexar los cuadros; un cuadro final incompleto (grabación cortada) se descarta
+    int capacidad = 1024;
+    reproduccion.cuadros = malloc(capacidad * sizeof(IndiceCuadro));
+    int clave_previa = -1;
+    CabeceraCuadro cuadro;
+
+    while (reproduccion.cuadros != NULL && fread(&cuadro, sizeof(cuadro), 1, reproduccion.archivo) == 1)
+    {
+        long posicion = ftell(reproduccion.archivo);
+        if (fseek(reproduccion.archivo, cuadro.longitud, SEEK_CUR) != 0 ||
+            ftell(reproduccion.archivo) != posicion + (long)cuadro.longitud)
+            break;
+
+        if (cuadro.tipo == CUADRO_CLAVE && cuadro.longitud == sizeof(DatosCompartidos))
+            clave_previa = reproduccion.num_cuadros;
+        else if (cuadro.tipo != CUADRO_DELTA)
+            break;
+
+        // Los deltas anteriores al primer cuadro clave no se pueden reconstruir
+        if (clave_previa < 0)
+            continue;
+
+        if (reproduccion.num_cuadros == capacidad)
+        {
+            capacidad *= 2;
+            reproduccion.cuadros = realloc(reproduccion.cuadros, capacidad * sizeof(IndiceCuadro));
+            if (reproduccion.cuadros == NULL)
+                break;
+        }
+
+        IndiceCuadro *entrada = &reproduccion.cuadros[reproduccion.num_cuadros++];
+        entrada->posicion = posicion;
+        entrada->cabecera = cuadro;
+        entrada->clave_previa = clave_previa;
+    }
+
+    // Buffer de carga del mayor cuadro posible: un delta con todos los bloques modificados
+    size_t max_carga = 0;
+    for (int i = 0; i < reproduccion.num_cuadros; i++)
+    {
+        if (reproduccion.cuadros[i].cabecera.longitud > max_carga)
+            max_carga = reproduccion.cuadros[i].cabecera.longitud;
+    }
+
+    reproduccion.estado = calloc(1, sizeof(DatosCompartidos));
+    reproduccion.carga = malloc(max_carga + 1);
+    if (reproduccion.num_cuadros == 0 || reproduccion.estado == NULL || reproduccion.carga == NULL)
+    {
+        printf("Error: El diario '%s' no contiene cuadros reproducibles\n", ruta);
+        return 0;
+    }
+
+    reproduccion.velocidad = 1;
+    reproduccion.cuadro_actual = -1;
+    reproduccion.ultimo_avance_ms = reloj_real_ms();
+    modo_reproduccion = 1;
+    ir_a_cuadro(0);
+    reproduccion.marca_ms = reproduccion.cuadros[0].cabecera.marca_ms;
+
+    // El diario ocupa el lugar de una cocina para que todas las vistas funcionen igual
+    Instancia *instancia = &instancias[0];
+    memset(instancia, 0, sizeof(Instancia));
+    snprintf(instancia->segmento, sizeof(instancia->segmento), "%.63s", ruta);
+    instancia->datos = reproduccion.estado;
+    num_instancias = 1;
+    datos_compartidos = reproduccion.estado;
+
+    printf("Diario '%s' (cocina %s): %d cuadros, %.1f minutos grabados\n", ruta, cabecera.nombre_instancia,
+           reproduccion.num_cuadros,
+           (reproduccion.cuadros[reproduccion.num_cuadros - 1].cabecera.marca_ms -
+            reproduccion.cuadros[0].cabecera.marca_ms) / 60000.0);
+    return 1;
+}
+
+/**
+ * @brief Aplica la carga de un cuadro sobre el estado reconstruido
+ * @param indice Cuadro a aplicar
+ */
+static void aplicar_cuadro(int indice)
+{
+    IndiceCuadro *entrada = &reproduccion.cuadros[indice];
+    unsigned int longitud = entrada->cabecera.longitud;
+
+    fseek(reproduccion.archivo, entrada->posicion, SEEK_SET);
+
+    if (entrada->cabecera.tipo == CUADRO_CLAVE)
+    {
+        if (fread(reproduccion.estado, sizeof(DatosCompartidos), 1, reproduccion.archivo) != 1)
+            return;
+    }
+    else
+    {
+        if (longitud > 0 && fread(reproduccion.carga, longitud, 1, reproduccion.archivo) != 1)
+            return;
+
+        // Tramos (desplazamiento, longitud, bytes); se ignora cualquiera fuera de rango
+        unsigned int pos = 0;
+        while (pos + 2 * sizeof(unsigned int) <= longitud)
+        {
+            unsigned int desplazamiento, largo;
+            memcpy(&desplazamiento, reproduccion.carga + pos, sizeof(desplazamiento));
+            memcpy(&largo, reproduccion.carga + pos + sizeof(desplazamiento), sizeof(largo));
+            pos += 2 * sizeof(unsigned int);
+
+            if (largo > longitud - pos || desplazamiento > sizeof(DatosCompartidos) ||
+                largo > sizeof(DatosCompartidos) - desplazamiento)
+                break;
+
+            memcpy((unsigned char *)reproduccion.estado + desplazamiento, reproduccion.carga + pos, largo);
+            pos += largo;
+        }
+    }
+}
+
+void ir_a_cuadro(int destino)
+{
+    if (destino < 0 || destino >= reproduccion.num_cuadros || destino == reproduccion.cuadro_actual)
+        return;
+
+    // Avanzar con deltas si el destino está en el mismo tramo; si no, partir del cuadro clave
+    int desde = reproduccion.cuadro_actual + 1;
+    int clave = reproduccion.cuadros[destino].clave_previa;
+    if (destino < reproduccion.cuadro_actual || clave > reproduccion.cuadro_actual)
+        desde = clave;
+
+    for (int i = desde; i <= destino; i++)
+    {
+        aplicar_cuadro(i);
+    }
+    reproduccion.cuadro_actual = destino;
+
+    // Los mutex y la secuencia grabados pueden haber quedado tomados a mitad de
+    // una operación; en la copia local nadie más los usa
+    DatosCompartidos *estado = reproduccion.estado;
+    for (int b = 0; b < MAX_BANDAS; b++)
+    {
+        pthread_mutex_init(&estado->bandas[b].mutex, NULL);
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            pthread_mutex_init(&estado->bandas[b].dispensadores[j].mutex, NULL);
+        }
+    }
+    estado->instantanea.secuencia &= ~1u;
+}
+
+int buscar_cuadro(long long marca_ms)
+{
+    int inferior = 0;
+    int superior = reproduccion.num_cuadros - 1;
+
+    while (inferior < superior)
+    {
+        int medio = (inferior + superior + 1) / 2;
+        if (reproduccion.cuadros[medio].cabecera.marca_ms <= marca_ms)
+            inferior = medio;
+        else
+            superior = medio - 1;
+    }
+    return inferior;
+}
+
+int avanzar_reproduccion()
+{
+    long long ahora = reloj_real_ms();
+    long long transcurrido = ahora - reproduccion.ultimo_avance_ms;
+    reproduccion.ultimo_avance_ms = ahora;
+
+    if (reproduccion.en_pausa)
+        return 0;
+
+    long long final_ms = reproduccion.cuadros[reproduccion.num_cuadros - 1].cabecera.marca_ms;
+    reproduccion.marca_ms += transcurrido * reproduccion.velocidad;
+    if (reproduccion.marca_ms >= final_ms)
+    {
+        // Al llegar al final queda detenido en el último cuadro
+        reproduccion.marca_ms = final_ms;
+        reproduccion.en_pausa = 1;
+    }
+
+    int anterior = reproduccion.cuadro_actual;
+    ir_a_cuadro(buscar_cuadro(reproduccion.marca_ms));
+    return reproduccion.cuadro_actual != anterior;
+}
+
+int procesar_comando_reproduccion(int ch)
+{
+    long long inicio_ms = reproduccion.cuadros[0].cabecera.marca_ms;
+    long long final_ms = reproduccion.cuadros[reproduccion.num_cuadros - 1].cabecera.marca_ms;
+
+    switch (ch)
+    {
+    case ' ':
+    case 'p':
+    case 'P':
+        reproduccion.en_pausa = !reproduccion.en_pausa;
+        if (!reproduccion.en_pausa && reproduccion.marca_ms >= final_ms)
+            reproduccion.marca_ms = inicio_ms; // Reanudar al final vuelve a empezar
+        return 1;
+
+    case 'x':
+    case 'X':
+        reproduccion.velocidad = reproduccion.velocidad >= 100 ? 1 : reproduccion.velocidad * 10;
+        return 1;
+
+    case '<':
+    case '>':
+        reproduccion.marca_ms += (ch == '>') ? SALTO_REPRODUCCION_MS : -SALTO_REPRODUCCION_MS;
+        if (reproduccion.marca_ms < inicio_ms)
+            reproduccion.marca_ms = inicio_ms;
+        if (reproduccion.marca_ms > final_ms)
+            reproduccion.marca_ms = final_ms;
+        ir_a_cuadro(buscar_cuadro(reproduccion.marca_ms));
+        return 1;
+
+    case '.':
+        // Paso a paso: detiene y avanza exactamente un cuadro
+        reproduccion.en_pausa = 1;
+        ir_a_cuadro(reproduccion.cuadro_actual + 1);
+        reproduccion.marca_ms = reproduccion.cuadros[reproduccion.cuadro_actual].cabecera.marca_ms;
+        return 1;
+
+    // Operaciones que modificarían la cocina: el diario es de solo lectura
+    case 'r':
+    case 'R':
+    case 'a':
+    case 'A':
+    case 'c':
+    case 'C':
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+        mostrar_mensaje_temporal("[REPLAY] Diario de solo lectura");
+        return 1;
+
+    case '+':
+    case '=':
+    case '-':
+    case '_':
+        if (modo_vista == 3)
+        {
+            mostrar_mensaje_temporal("[REPLAY] Diario de solo lectura");
+            return 1;
+        }
+        return 0;
+
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+        if (modo_vista == 4)
+        {
+            mostrar_mensaje_temporal("[REPLAY] Diario de solo lectura");
+            return 1;
+        }
+        return 0;
+    }
+    return 0;
+}
+
+// ================================================================
+// FUNCIONES DE VISUALIZACION
+// ================================================================
+
+void mostrar_interfaz_general()
+{
+    werase(win_main);
+
+    if (has_colors())
+        wattron(win_main, COLOR_PAIR(4));
+    wborder(win_main, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_main, 0, 2, " SISTEMA DE HAMBURGUESAS - VISTA GENERAL ");
+    if (has_colors())
+        wattroff(win_main, COLOR_PAIR(4));
+
+    // Estadisticas generales
+    mvwprintw(win_main, 2, 2, "ESTADISTICAS DEL SISTEMA:");
+    mvwprintw(win_main, 3, 4, "* Ordenes generadas:  %d", datos_compartidos->total_ordenes_generadas);
+    mvwprintw(win_main, 4, 4, "* Ordenes procesadas: %d", datos_compartidos->total_ordenes_procesadas);
+    mvwprintw(win_main, 5, 4, "* Ordenes en cola:    %d",
+              datos_compartidos->cola_espera.tamano - datos_compartidos->cola_espera.lapidas);
+    mvwprintw(win_main, 6, 4, "* Bandas activas:     %d", datos_compartidos->num_bandas);
+
+    // Eficiencia
+    float eficiencia = 0;
+    if (datos_compartidos->total_ordenes_generadas > 0)
+    {
+        eficiencia = (float)datos_compartidos->total_ordenes_procesadas / datos_compartidos->total_ordenes_generadas * 100;
+    }
+    mvwprintw(win_main, 7, 4, "* Eficiencia:         %.1f%%", eficiencia);
+
+    // Vigilante de bandas: atascos vigentes y órdenes que reencoló
+    InstantaneaMetricas metricas;
+    memset(&metricas, 0, sizeof(metricas));
+    leer_instantanea(datos_compartidos, &metricas);
+    if (has_colors() && metricas.bandas_atascadas > 0)
+        wattron(win_main, COLOR_PAIR(3));
+    mvwprintw(win_main, 3, 40, "* Bandas atascadas:   %d", metricas.bandas_atascadas);
+    if (has_colors() && metricas.bandas_atascadas > 0)
+        wattroff(win_main, COLOR_PAIR(3));
+    mvwprintw(win_main, 4, 40, "* Ordenes rescatadas: %d", metricas.ordenes_rescatadas);
+    mvwprintw(win_main, 5, 40, "* Error ETA: %.1f s (sesgo %+.1f s)", metricas.error_eta_medio_ms / 1000.0,
+              metricas.sesgo_eta_ms / 1000.0);
+
+    // Ingresos a precio de menú y lo que cuestan las órdenes expiradas
+    mvwprintw(win_main, 2, 40, "POLITICA: %s", datos_compartidos->politica_asignacion ? "POR VALOR" : "FIFO");
+    if (datos_compartidos->num_clientes > 0)
+        wprintw(win_main, "  CLIENTES: %d/%d esperan", datos_compartidos->clientes_esperando,
+                datos_compartidos->num_clientes);
+    mvwprintw(win_main, 6, 40, "* Ingresos: $%.2f ($%.2f/min)", metricas.ingresos_totales,
+              metricas.ingresos_por_minuto);
+    if (has_colors() && metricas.ingresos_perdidos > 0)
+        wattron(win_main, COLOR_PAIR(2));
+    mvwprintw(win_main, 7, 40, "* Perdido: $%.2f (%d exp./%d rech.)", metricas.ingresos_perdidos,
+              datos_compartidos->ordenes_descartadas, datos_compartidos->ordenes_rechazadas);
+    if (has_colors() && metricas.ingresos_perdidos > 0)
+        wattroff(win_main, COLOR_PAIR(2));
+    mvwprintw(win_main, 8, 40, "* Por banda-hora: $%.2f", metricas.ingresos_por_banda_hora);
+    static const char *paciencias[] = {"fija", "exp", "unif"};
+    int paciencia = datos_compartidos->distribucion_paciencia;
+    mvwprintw(win_main, 9, 40, "* Canceladas: %d (paciencia %s %d s)", datos_compartidos->ordenes_canceladas,
+              paciencias[paciencia >= 0 && paciencia <= 2 ? paciencia : 0], datos_compartidos->edad_maxima_ms / 1000);
+
+    // Estado estacionario tras el calentamiento que detecta MSER-5
+    if (metricas.calentamiento_s < 0)
+        mvwprintw(win_main, 10, 40, "* Estacionario: en calentamiento");
+    else
+        mvwprintw(win_main, 10, 40, "* Estacionario: %.1f+-%.1f/min, %.1f+-%.1f s", metricas.throughput_estacionario,
+                  metricas.ic_throughput_estacionario, metricas.latencia_estacionaria_ms / 1000.0,
+                  metricas.ic_latencia_estacionaria_ms / 1000.0);
+
+    // Lotes: solo si la cocina junta órdenes iguales
+    if (datos_compartidos->tamano_lote_maximo > 1)
+        mvwprintw(win_main, 8, 4, "* Lote medio:         %.2f (max %d)", metricas.tamano_lote_medio,
+                  datos_compartidos->tamano_lote_maximo);
+
+    // Estado de bandas
+    mvwprintw(win_main, 9, 2, "ESTADO DE BANDAS:");
+
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        Banda *banda = &datos_compartidos->bandas[i];
+        int linea = 11 + i;
+
+        // Determinar color segun estado
+        int color_pair = 1; // Verde por defecto
+        char estado_icono[10] = "[OK]";
+
+        pthread_mutex_lock(&banda->mutex);
+
+        if (banda->atascada)
+        {
+            color_pair = 3;
+            strcpy(estado_icono, "[!!]");
+        }
+        else if (!banda->activa)
+        {
+            color_pair = 3;
+            strcpy(estado_icono, "[X]");
+        }
+        else if (banda->pausada)
+        {
+            color_pair = 2;
+            strcpy(estado_icono, "[PAUSE]");
+        }
+        else if (banda->necesita_reabastecimiento)
+        {
+            color_pair = 2;
+            strcpy(estado_icono, "[!]");
+        }
+
+        if (i == banda_seleccionada)
+        {
+            color_pair = 5; // Destacar banda seleccionada
+        }
+
+        if (has_colors())
+            wattron(win_main, COLOR_PAIR(color_pair));
+
+        mvwprintw(win_main, linea, 4, "%s BANDA %d:", estado_icono, i + 1);
+
+        if (banda->atascada)
+        {
+            mvwprintw(win_main, linea, 18, "ATASCADA: #%d reencolada",
+                      banda->orden_actual.id_orden);
+        }
+        else if (banda->procesando_orden)
+        {
+            mvwprintw(win_main, linea, 18, "Procesando %s (#%d) - %d/%d",
+                      banda->orden_actual.nombre_hamburguesa,
+                      banda->orden_actual.id_orden,
+                      banda->orden_actual.paso_actual,
+                      banda->orden_actual.num_ingredientes);
+        }
+        else
+        {
+            mvwprintw(win_main, linea, 18, "%s", banda->estado_actual);
+        }
+
+        mvwprintw(win_main, linea, 55, "Completadas: %d", banda->hamburguesas_procesadas);
+
+        // Cuenta regresiva de la entrega, si cabe a la derecha sin partir la línea
+        if (banda->procesando_orden && !banda->atascada && getmaxx(win_main) > 86)
+            mvwprintw(win_main, linea, 72, "ETA %5.1fs", segundos_hasta(banda->orden_actual.eta_ms));
+
+        if (has_colors())
+            wattroff(win_main, COLOR_PAIR(color_pair));
+
+        pthread_mutex_unlock(&banda->mutex);
+    }
+
+    // Alertas de inventario
+    int bandas_con_alertas = 0;
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+        {
+            bandas_con_alertas++;
+        }
+    }
+
+    if (bandas_con_alertas > 0)
+    {
+        if (has_colors())
+            wattron(win_main, COLOR_PAIR(3));
+        mvwprintw(win_main, 11 + datos_compartidos->num_bandas + 1, 2,
+                  "ALERTAS: %d bandas necesitan reabastecimiento", bandas_con_alertas);
+        if (has_colors())
+            wattroff(win_main, COLOR_PAIR(3));
+    }
+
+    // Recursos compartidos: lugares ocupados, bandas en espera y uso desde el arranque
+    if (datos_compartidos->num_recursos > 0)
+    {
+        int linea_recursos = 11 + datos_compartidos->num_bandas + 2;
+        int ancho_disponible = getmaxx(win_main) - 4;
+        mvwprintw(win_main, linea_recursos, 2, "RECURSOS:");
+        int columna = 12;
+        for (int r = 0; r < datos_compartidos->num_recursos; r++)
+        {
+            RecursoCompartido *recurso = &datos_compartidos->recursos[r];
+            if (recurso->capacidad == 0)
+                continue;
+
+            char texto[64];
+            int largo = snprintf(texto, sizeof(texto), "%s %d/%d, %d en espera, %.0f%%", recurso->nombre, recurso->en_uso,
+                                 recurso->capacidad, recurso->esperando, recurso->utilizacion * 100);
+            if (columna + largo > ancho_disponible)
+                break;
+            if (has_colors() && recurso->esperando > 0)
+                wattron(win_main, COLOR_PAIR(2));
+            mvwprintw(win_main, linea_recursos, columna, "%s", texto);
+            if (has_colors() && recurso->esperando > 0)
+                wattroff(win_main, COLOR_PAIR(2));
+            columna += largo + 3;
+        }
+    }
+
+    // Próximas órdenes de la cola con su hora estimada de entrega
+    int linea_cola = 11 + datos_compartidos->num_bandas + 3;
+    int max_filas = getmaxy(win_main) - 2 - (linea_cola + 1);
+    if (max_filas > 0)
+    {
+        Orden proximas[MAX_ORDENES];
+        ColaFIFO *cola = &datos_compartidos->cola_espera;
+
+        // Las órdenes canceladas o expiradas siguen ocupando su lugar hasta que se saltan
+        pthread_mutex_lock(&cola->mutex);
+        int en_cola = cola->tamano - cola->lapidas;
+        int mostradas = 0;
+        for (int k = 0; k < cola->tamano && mostradas < max_filas; k++)
+        {
+            Orden *orden = &cola->ordenes[(cola->frente + k) % MAX_ORDENES];
+            if (!orden->cancelada)
+                proximas[mostradas++] = *orden;
+        }
+        pthread_mutex_unlock(&cola->mutex);
+
+        mvwprintw(win_main, linea_cola, 2, "PROXIMAS ORDENES (%d en cola):", en_cola);
+        for (int k = 0; k < mostradas; k++)
+        {
+            mvwprintw(win_main, linea_cola + 1 + k, 4, "#%-4d %-14s", proximas[k].id_orden,
+                      proximas[k].nombre_hamburguesa);
+            if (proximas[k].eta_ms > 0)
+                wprintw(win_main, " ETA %5.1fs  (prometida %5.1fs)", segundos_hasta(proximas[k].eta_ms),
+                        segundos_hasta(proximas[k].eta_prometida_ms));
+            else
+                wprintw(win_main, " ETA   --    (ninguna banda puede prepararla)");
+        }
+    }
+
+    wrefresh(win_main);
+}
+
+void mostrar_detalle_banda()
+{
+    werase(win_banda_detail);
+
+    if (has_colors())
+        wattron(win_banda_detail, COLOR_PAIR(6));
+    wborder(win_banda_detail, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_banda_detail, 0, 2, " DETALLE BANDA %d ", banda_seleccionada + 1);
+    if (has_colors())
+        wattroff(win_banda_detail, COLOR_PAIR(6));
+
+    if (banda_seleccionada >= datos_compartidos->num_bandas)
+    {
+        mvwprintw(win_banda_detail, 2, 2, "Banda no valida");
+        wrefresh(win_banda_detail);
+        return;
+    }
+
+    Banda *banda = &datos_compartidos->bandas[banda_seleccionada];
+    pthread_mutex_lock(&banda->mutex);
+
+    // Estado actual
+    mvwprintw(win_banda_detail, 2, 2, "ESTADO:");
+    if (banda->atascada)
+    {
+        if (has_colors())
+            wattron(win_banda_detail, COLOR_PAIR(3));
+        mvwprintw(win_banda_detail, 3, 4, "[!] ATASCADA (sin progreso hace %.1f s)",
+                  (reloj_ms() - banda->latido_ms) / 1000.0);
+        if (has_colors())
+            wattroff(win_banda_detail, COLOR_PAIR(3));
+    }
+    else if (banda->pausada)
+    {
+        if (has_colors())
+            wattron(win_banda_detail, COLOR_PAIR(2));
+        mvwprintw(win_banda_detail, 3, 4, "[PAUSE] PAUSADA");
+        if (has_colors())
+            wattroff(win_banda_detail, COLOR_PAIR(2));
+    }
+    else if (!banda->activa)
+    {
+        if (has_colors())
+            wattron(win_banda_detail, COLOR_PAIR(3));
+        mvwprintw(win_banda_detail, 3, 4, "[X] INACTIVA");
+        if (has_colors())
+            wattroff(win_banda_detail, COLOR_PAIR(3));
+    }
+    else
+    {
+        if (has_colors())
+            wattron(win_banda_detail, COLOR_PAIR(1));
+        mvwprintw(win_banda_detail, 3, 4, "[OK] ACTIVA");
+        if (has_colors())
+            wattroff(win_banda_detail, COLOR_PAIR(1));
+    }
+
+    // Factor de velocidad de la banda y estaciones que difieren de él
+    int estaciones_distintas = 0;
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
+    {
+        if (banda->dispensadores[j].velocidad != 1)
+            estaciones_distintas++;
+    }
+    if (banda->velocidad != 1 || estaciones_distintas > 0)
+        mvwprintw(win_banda_detail, 3, 20, "Velocidad x%.2f (%d estaciones distintas)", banda->velocidad,
+                  estaciones_distintas);
+
+    if (banda->reabasteciendo && strlen(banda->ingrediente_actual) > 0)
+        mvwprintw(win_banda_detail, 4, 4, "Estado: %s %s", banda->estado_actual, banda->ingrediente_actual);
+    else
+        mvwprintw(win_banda_detail, 4, 4, "Estado: %s", banda->estado_actual);
+
+    // Orden actual
+    mvwprintw(win_banda_detail, 6, 2, "ORDEN ACTUAL:");
+    if (banda->procesando_orden)
+    {
+        if (banda->tamano_lote > 1)
+        {
+            // Lote: la orden que lo encabeza y las que se preparan con ella
+            char ids[40] = "";
+            for (int i = 0; i < banda->tamano_lote - 1 && i < MAX_LOTE - 1; i++)
+            {
+                snprintf(ids + strlen(ids), sizeof(ids) - strlen(ids), " #%d", banda->lote[i].id_orden);
+            }
+            mvwprintw(win_banda_detail, 7, 4, "* ID: #%d +%s", banda->orden_actual.id_orden, ids);
+            mvwprintw(win_banda_detail, 8, 4, "* Tipo: %s (lote de %d)", banda->orden_actual.nombre_hamburguesa,
+                      banda->tamano_lote);
+        }
+        else
+        {
+            mvwprintw(win_banda_detail, 7, 4, "* ID: #%d", banda->orden_actual.id_orden);
+            mvwprintw(win_banda_detail, 8, 4, "* Tipo: %s", banda->orden_actual.nombre_hamburguesa);
+        }
+        mvwprintw(win_banda_detail, 9, 4, "* Progreso: %d/%d ingredientes",
+                  banda->orden_actual.paso_actual, banda->orden_actual.num_ingredientes);
+        if (strlen(banda->ingrediente_actual) > 0)
+        {
+            mvwprintw(win_banda_detail, 10, 4, "* Agregando: %s", banda->ingrediente_actual);
+        }
+        if (banda->orden_actual.eta_prometida_ms > 0)
+            mvwprintw(win_banda_detail, 11, 4, "* ETA: %.1f s (prometida %.1f s)",
+                      segundos_hasta(banda->orden_actual.eta_ms),
+                      segundos_hasta(banda->orden_actual.eta_prometida_ms));
+    }
+    else
+    {
+        mvwprintw(win_banda_detail, 7, 4, "Sin orden asignada");
+    }
+
+    // Estadisticas
+    mvwprintw(win_banda_detail, 12, 2, "ESTADISTICAS:");
+    if (banda->lotes_completados > 0)
+        mvwprintw(win_banda_detail, 13, 4, "* Procesadas: %d (%d lotes)", banda->hamburguesas_procesadas,
+                  banda->lotes_completados);
+    else
+        mvwprintw(win_banda_detail, 13, 4, "* Hamburguesas procesadas: %d", banda->hamburguesas_procesadas);
+    if (banda->dispensadores_reabastecidos > 0)
+        mvwprintw(win_banda_detail, 14, 4, "* Ingresos: $%.2f  Rellenos: %.0f s (%.0f s perdidos)", banda->ingresos,
+                  banda->reabasto_ms / 1000.0, banda->reabasto_perdido_ms / 1000.0);
+    else
+        mvwprintw(win_banda_detail, 14, 4, "* Ingresos: $%.2f", banda->ingresos);
+
+    // Inventario critico
+    mvwprintw(win_banda_detail, 15, 2, "INVENTARIO CRITICO:");
+    int items_criticos = 0;
+    int linea_inv = 16;
+
+    for (int j = 0; j < MAX_INGREDIENTES && items_criticos < 8; j++)
+    {
+        pthread_mutex_lock(&banda->dispensadores[j].mutex);
+        int cantidad = banda->dispensadores[j].cantidad;
+
+        if (cantidad == 0 || cantidad <= UMBRAL_INVENTARIO_BAJO)
+        {
+            int color = (cantidad == 0) ? 3 : 2;
+            if (has_colors())
+                wattron(win_banda_detail, COLOR_PAIR(color));
+
+            char nombre_corto[15];
+            strncpy(nombre_corto, banda->dispensadores[j].nombre, 14);
+            nombre_corto[14] = '\0';
+
+            mvwprintw(win_banda_detail, linea_inv, 4, "* %-14s: %2d %s",
+                      nombre_corto, cantidad,
+                      cantidad == 0 ? "[AGOTADO]" : "[CRITICO]");
+
+            if (has_colors())
+                wattroff(win_banda_detail, COLOR_PAIR(color));
+            linea_inv++;
+            items_criticos++;
+        }
+        pthread_mutex_unlock(&banda->dispensadores[j].mutex);
+    }
+
+    if (items_criticos == 0)
+    {
+        if (has_colors())
+            wattron(win_banda_detail, COLOR_PAIR(1));
+        mvwprintw(win_banda_detail, linea_inv, 4, "[OK] Inventario en niveles normales");
+        if (has_colors())
+            wattroff(win_banda_detail, COLOR_PAIR(1));
+    }
+
+    pthread_mutex_unlock(&banda->mutex);
+    wrefresh(win_banda_detail);
+}
+
+void mostrar_inventario_banda()
+{
+    werase(win_banda_detail);
+
+    if (has_colors())
+        wattron(win_banda_detail, COLOR_PAIR(4));
+    wborder(win_banda_detail, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_banda_detail, 0, 2, " INVENTARIO BANDA %d ", banda_seleccionada + 1);
+    if (has_colors())
+        wattroff(win_banda_detail, COLOR_PAIR(4));
+
+    if (banda_seleccionada >= datos_compartidos->num_bandas)
+    {
+        mvwprintw(win_banda_detail, 2, 2, "Banda no valida");
+        wrefresh(win_banda_detail);
+        return;
+    }
+
+    Banda *banda = &datos_compartidos->bandas[banda_seleccionada];
+
+    mvwprintw(win_banda_detail, 2, 2, "INVENTARIO COMPLETO:");
+    mvwprintw(win_banda_detail, 3, 2, "Use ^/v para navegar, +/- para ajustar");
+
+    for (int i = 0; i < MAX_INGREDIENTES; i++)
+    {
+        int linea = 5 + i;
+        if (linea > getmaxy(win_banda_detail) - 3)
+            break; // No exceder ventana
+
+        pthread_mutex_lock(&banda->dispensadores[i].mutex);
+        int cantidad = banda->dispensadores[i].cantidad;
+
+        char nombre_corto[15];
+        strncpy(nombre_corto, banda->dispensadores[i].nombre, 14);
+        nombre_corto[14] = '\0';
+
+        // Determinar color y selección
+        int color = 1; // Verde por defecto
+        if (cantidad == 0)
+            color = 3; // Rojo
+        else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
+            color = 2; // Amarillo
+
+        // Destacar ingrediente seleccionado
+        if (i == ingrediente_seleccionado)
+        {
+            if (has_colors())
+                wattron(win_banda_detail, COLOR_PAIR(5));
+            mvwprintw(win_banda_detail, linea, 2, "> %-14s: %2d/%2d %s",
+                      nombre_corto, cantidad, CAPACIDAD_DISPENSADOR,
+                      cantidad == 0 ? "[AGOTADO]" : (cantidad <= UMBRAL_INVENTARIO_BAJO ? "[CRITICO]" : ""));
+            if (has_colors())
+                wattroff(win_banda_detail, COLOR_PAIR(5));
+        }
+        else
+        {
+            if (has_colors())
+                wattron(win_banda_detail, COLOR_PAIR(color));
+            mvwprintw(win_banda_detail, linea, 2, "  %-14s: %2d/%2d %s",
+                      nombre_corto, cantidad, CAPACIDAD_DISPENSADOR,
+                      cantidad == 0 ? "[AGOTADO]" : (cantidad <= UMBRAL_INVENTARIO_BAJO ? "[CRITICO]" : ""));
+            if (has_colors())
+                wattroff(win_banda_detail, COLOR_PAIR(color));
+        }
+
+        pthread_mutex_unlock(&banda->dispensadores[i].mutex);
+    }
+
+    // Mostrar controles
+    int linea_controles = MAX_INGREDIENTES + 7;
+    if (has_colors())
+        wattron(win_banda_detail, COLOR_PAIR(6));
+    mvwprintw(win_banda_detail, linea_controles, 2, "CONTROLES:");
+    mvwprintw(win_banda_detail, linea_controles + 1, 2, "+ : Añadir 1 unidad");
+    mvwprintw(win_banda_detail, linea_controles + 2, 2, "- : Quitar 1 unidad");
+    mvwprintw(win_banda_detail, linea_controles + 3, 2, "F : Llenar completamente");
+    if (has_colors())
+        wattroff(win_banda_detail, COLOR_PAIR(6));
+
+    wrefresh(win_banda_detail);
+}
+
+void mostrar_modo_abastecimiento()
+{
+    werase(win_banda_detail);
+
+    if (has_colors())
+        wattron(win_banda_detail, COLOR_PAIR(6));
+    wborder(win_banda_detail, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_banda_detail, 0, 2, " MODO ABASTECIMIENTO ");
+    if (has_colors())
+        wattroff(win_banda_detail, COLOR_PAIR(6));
+
+    mvwprintw(win_banda_detail, 2, 2, "OPCIONES DE ABASTECIMIENTO:");
+
+    // Mostrar opciones
+    const char *opciones[] = {
+        "1. Reabastecer banda seleccionada",
+        "2. Reabastecer TODAS las bandas",
+        "3. Reabastecer solo ingredientes criticos",
+        "4. Reabastecer ingredientes agotados",
+        "5. Modo personalizado (ingrediente por ingrediente)"};
+
+    for (int i = 0; i < 5; i++)
+    {
+        mvwprintw(win_banda_detail, 4 + i, 4, "%s", opciones[i]);
+    }
+
+    // Mostrar estado de bandas que necesitan abastecimiento
+    mvwprintw(win_banda_detail, 11, 2, "BANDAS QUE NECESITAN ABASTECIMIENTO:");
+    int bandas_criticas = 0;
+    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    {
+        if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+        {
+            if (has_colors())
+                wattron(win_banda_detail, COLOR_PAIR(3));
+            mvwprintw(win_banda_detail, 13 + bandas_criticas, 4, "* Banda %d - Requiere atencion", i + 1);
+            if (has_colors())
+                wattroff(win_banda_detail, COLOR_PAIR(3));
+            bandas_criticas++;
+        }
+    }
+
+    if (bandas_criticas == 0)
+    {
+        if (has_colors())
+            wattron(win_banda_detail, COLOR_PAIR(1));
+        mvwprintw(win_banda_detail, 13, 4, "[OK] Todas las bandas en niveles normales");
+        if (has_colors())
+            wattroff(win_banda_detail, COLOR_PAIR(1));
+    }
+
+    // Mostrar controles
+    mvwprintw(win_banda_detail, 18, 2, "CONTROLES:");
+    mvwprintw(win_banda_detail, 19, 2, "1-5: Ejecutar opcion");
+    mvwprintw(win_banda_detail, 20, 2, "ESC: Salir del modo abastecimiento");
+
+    // Plan mínimo: recargas que cubren el menú en K bandas durante T minutos
+    RecargaPlan plan[MAX_RECARGAS_PLAN];
+    int sin_cubrir;
+    int num_recargas = calcular_plan_reabastecimiento(plan_bandas_k, plan_minutos, plan, &sin_cubrir);
+    if (num_recargas < 0)
+    {
+        mvwprintw(win_banda_detail, 22, 2, "PLAN MINIMO: inventario en cambio, se recalcula en el proximo cuadro");
+        wrefresh(win_banda_detail);
+        return;
+    }
+    int unidades = 0;
+    for (int i = 0; i < num_recargas; i++)
+    {
+        unidades += plan[i].unidades;
+    }
+
+    mvwprintw(win_banda_detail, 22, 2, "PLAN MINIMO (K=%d bandas, T=%d min): %d recargas, %d u",
+              plan_bandas_k, plan_minutos, num_recargas, unidades);
+    if (sin_cubrir > 0)
+    {
+        if (has_colors())
+            wattron(win_banda_detail, COLOR_PAIR(3));
+        mvwprintw(win_banda_detail, 23, 4, "[!] %d recetas sin %d bandas operativas", sin_cubrir, plan_bandas_k);
+        if (has_colors())
+            wattroff(win_banda_detail, COLOR_PAIR(3));
+    }
+
+    // Recargas en columnas de 20 caracteres hasta llenar la ventana
+    int fila = sin_cubrir > 0 ? 24 : 23;
+    int columnas = (getmaxx(win_banda_detail) - 4) / 20;
+    for (int i = 0; i < num_recargas; i++)
+    {
+        int linea = fila + i / columnas;
+        if (linea >= getmaxy(win_banda_detail) - 1)
+        {
+            mvwprintw(win_banda_detail, linea - 1, 4 + (columnas - 1) * 20, "... +%d mas", num_recargas - i);
+            break;
+        }
+        mvwprintw(win_banda_detail, linea, 4 + (i % columnas) * 20, "B%d %.11s +%d", plan[i].banda + 1,
+                  ingredientes_base[plan[i].ingrediente], plan[i].unidades);
+    }
+
+    wrefresh(win_banda_detail);
+}
+
+void mostrar_inventario_global()
+{
+    werase(win_banda_detail);
+
+    if (has_colors())
+        wattron(win_banda_detail, COLOR_PAIR(4));
+    wborder(win_banda_detail, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_banda_detail, 0, 2, " INVENTARIO GLOBAL ");
+    if (has_colors())
+        wattroff(win_banda_detail, COLOR_PAIR(4));
+
+    mvwprintw(win_banda_detail, 2, 2, "RESUMEN POR INGREDIENTE:");
+
+    for (int ing = 0; ing < MAX_INGREDIENTES; ing++)
+    {
+        int total_ingrediente = 0;
+        int bandas_agotadas = 0;
+        int bandas_criticas = 0;
 
-    // Calcular dimensiones
-    int altura, ancho;
-    getmaxyx(stdscr, altura, ancho);
+        // Calcular totales
+        for (int banda = 0; banda < datos_compartidos->num_bandas; banda++)
+        {
+            pthread_mutex_lock(&datos_compartidos->bandas[banda].dispensadores[ing].mutex);
+            int cantidad = datos_compartidos->bandas[banda].dispensadores[ing].cantidad;
+            total_ingrediente += cantidad;
 
-    // Crear ventanas principales
-    win_main = newwin(altura - 8, ancho - 2, 1, 1);
-    win_banda_detail = newwin(altura - 8, ancho / 2, 1, ancho / 2);
-    win_commands = newwin(6, ancho / 2, altura - 7, 1);
-    win_status = newwin(6, ancho / 2, altura - 7, ancho / 2);
+            if (cantidad == 0)
+                bandas_agotadas++;
+            else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
+                bandas_criticas++;
 
-    // Habilitar teclas especiales
-    keypad(win_main, TRUE);
-    keypad(win_banda_detail, TRUE);
-    keypad(win_commands, TRUE);
-    keypad(win_status, TRUE);
+            pthread_mutex_unlock(&datos_compartidos->bandas[banda].dispensadores[ing].mutex);
+        }
 
-    refresh();
-}
+        // Mostrar solo primeros 12 ingredientes para no llenar la pantalla
+        if (ing < 12)
+        {
+            int linea = 4 + ing;
+            char nombre_corto[15];
+            strncpy(nombre_corto, ingredientes_base[ing], 14);
+            nombre_corto[14] = '\0';
 
-void conectar_memoria_compartida()
-{
-    int shm_fd = shm_open("/burger_system", O_RDWR, 0666);
-    if (shm_fd == -1)
-    {
-        endwin();
-        printf("Error: No se pudo conectar con el sistema principal.\n");
-        printf("   Asegurate de que ./burger_system este ejecutandose.\n");
-        printf("   Uso: ./burger_system -n 4 &\n");
-        printf("        ./control_panel\n");
-        exit(1);
-    }
+            int color = 1; // Verde por defecto
+            if (bandas_agotadas > 0)
+                color = 3; // Rojo si hay agotadas
+            else if (bandas_criticas > 0)
+                color = 2; // Amarillo si hay criticas
+
+            if (has_colors())
+                wattron(win_banda_detail, COLOR_PAIR(color));
 
-    datos_compartidos = mmap(0, sizeof(DatosCompartidos), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+            mvwprintw(win_banda_detail, linea, 2, "%-14s: Total:%3d",
+                      nombre_corto, total_ingrediente);
 
-    if (datos_compartidos == MAP_FAILED)
-    {
-        endwin();
-        perror("Error mapeando memoria compartida");
-        exit(1);
+            if (bandas_agotadas > 0)
+            {
+                mvwprintw(win_banda_detail, linea, 30, "[X]%d", bandas_agotadas);
+            }
+            if (bandas_criticas > 0)
+            {
+                mvwprintw(win_banda_detail, linea, 35, "[!]%d", bandas_criticas);
+            }
+
+            if (has_colors())
+                wattroff(win_banda_detail, COLOR_PAIR(color));
+        }
     }
 
-    close(shm_fd);
+    wrefresh(win_banda_detail);
 }
 
-// ================================================================
-// FUNCIONES DE VISUALIZACION
-// ================================================================
-
-void mostrar_interfaz_general()
+void mostrar_vista_flota()
 {
     werase(win_main);
 
     if (has_colors())
         wattron(win_main, COLOR_PAIR(4));
     wborder(win_main, '|', '|', '-', '-', '+', '+', '+', '+');
-    mvwprintw(win_main, 0, 2, " SISTEMA DE HAMBURGUESAS - VISTA GENERAL ");
+    mvwprintw(win_main, 0, 2, " FLOTA DE COCINAS (%d conectadas) ", num_instancias);
     if (has_colors())
         wattroff(win_main, COLOR_PAIR(4));
 
-    // Estadisticas generales
-    mvwprintw(win_main, 2, 2, "ESTADISTICAS DEL SISTEMA:");
-    mvwprintw(win_main, 3, 4, "* Ordenes generadas:  %d", datos_compartidos->total_ordenes_generadas);
-    mvwprintw(win_main, 4, 4, "* Ordenes procesadas: %d", datos_compartidos->total_ordenes_procesadas);
-    mvwprintw(win_main, 5, 4, "* Ordenes en cola:    %d", datos_compartidos->cola_espera.tamano);
-    mvwprintw(win_main, 6, 4, "* Bandas activas:     %d", datos_compartidos->num_bandas);
+    mvwprintw(win_main, 2, 2, "%-3s %-20s %-10s %8s %6s %8s %8s %8s %9s %8s",
+              "#", "COCINA", "ESTADO", "HAMB/MIN", "COLA", "P50(s)", "P99(s)", "AGOTADOS", "BANDAS", "$/MIN");
 
-    // Eficiencia
-    float eficiencia = 0;
-    if (datos_compartidos->total_ordenes_generadas > 0)
-    {
-        eficiencia = (float)datos_compartidos->total_ordenes_procesadas / datos_compartidos->total_ordenes_generadas * 100;
-    }
-    mvwprintw(win_main, 7, 4, "* Eficiencia:         %.1f%%", eficiencia);
+    long long ahora_ms = reloj_ms();
 
-    // Estado de bandas
-    mvwprintw(win_main, 9, 2, "ESTADO DE BANDAS:");
+    float total_throughput = 0;
+    float total_ingresos = 0;
+    int total_cola = 0;
+    int total_agotados = 0;
 
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    for (int i = 0; i < num_instancias; i++)
     {
-        Banda *banda = &datos_compartidos->bandas[i];
-        int linea = 11 + i;
-
-        // Determinar color segun estado
-        int color_pair = 1; // Verde por defecto
-        char estado_icono[10] = "[OK]";
-
-        pthread_mutex_lock(&banda->mutex);
-
-        if (!banda->activa)
+        Instancia *instancia = &instancias[i];
+        DatosCompartidos *datos = instancia->datos;
+        InstantaneaMetricas m;
+        leer_instantanea(datos, &m);
+        instancia->ultima = m;
+
+        // Sin publicaciones recientes la cocina está detenida o colgada
+        const char *estado = "ACTIVA";
+        int color = 1;
+        if (!datos->sistema_activo)
         {
-            color_pair = 3;
-            strcpy(estado_icono, "[X]");
+            estado = "INACTIVA";
+            color = 3;
         }
-        else if (banda->pausada)
+        else if (ahora_ms - m.marca_ms > 5000)
         {
-            color_pair = 2;
-            strcpy(estado_icono, "[PAUSE]");
+            estado = "SIN DATOS";
+            color = 3;
         }
-        else if (banda->necesita_reabastecimiento)
+        else if (m.bandas_atascadas > 0)
         {
-            color_pair = 2;
-            strcpy(estado_icono, "[!]");
+            estado = "ATASCADA";
+            color = 3;
         }
-
-        if (i == banda_seleccionada)
+        else if (m.dispensadores_agotados > 0 || m.bandas_sin_inventario > 0)
         {
-            color_pair = 5; // Destacar banda seleccionada
+            estado = "ALERTA";
+            color = 2;
         }
 
-        if (has_colors())
-            wattron(win_main, COLOR_PAIR(color_pair));
+        if (i == instancia_seleccionada)
+            color = 5;
 
-        mvwprintw(win_main, linea, 4, "%s BANDA %d:", estado_icono, i + 1);
+        if (has_colors())
+            wattron(win_main, COLOR_PAIR(color));
+        mvwprintw(win_main, 4 + i, 2, "%-3d %-20.20s %-10s %8.1f %6d %8.1f %8.1f %8d %4d/%-4d %8.2f",
+                  i + 1, datos->nombre_instancia, estado,
+                  m.throughput_por_minuto, m.ordenes_en_cola,
+                  m.latencia_p50_ms / 1000.0, m.latencia_p99_ms / 1000.0,
+                  m.dispensadores_agotados, m.bandas_operativas, datos->num_bandas, m.ingresos_por_minuto);
+        if (has_colors())
+            wattroff(win_main, COLOR_PAIR(color));
 
-        if (banda->procesando_orden)
-        {
-            mvwprintw(win_main, linea, 18, "Procesando %s (#%d) - %d/%d",
-                      banda->orden_actual.nombre_hamburguesa,
-                      banda->orden_actual.id_orden,
-                      banda->orden_actual.paso_actual,
-                      banda->orden_actual.num_ingredientes);
-        }
-        else
+        if (datos->sistema_activo)
         {
-            mvwprintw(win_main, linea, 18, "%s", banda->estado_actual);
+            total_throughput += m.throughput_por_minuto;
+            total_ingresos += m.ingresos_por_minuto;
+            total_cola += m.ordenes_en_cola;
+            total_agotados += m.dispensadores_agotados;
         }
+    }
 
-        mvwprintw(win_main, linea, 55, "Completadas: %d", banda->hamburguesas_procesadas);
+    int linea_total = 5 + num_instancias;
+    if (has_colors())
+        wattron(win_main, COLOR_PAIR(6));
+    mvwprintw(win_main, linea_total, 2, "%-3s %-20s %-10s %8.1f %6d %8s %8s %8d %9s %8.2f",
+              "", "TOTAL SITIO", "", total_throughput, total_cola, "", "", total_agotados, "", total_ingresos);
+    if (has_colors())
+        wattroff(win_main, COLOR_PAIR(6));
 
-        if (has_colors())
-            wattroff(win_main, COLOR_PAIR(color_pair));
+    mvwprintw(win_main, linea_total + 2, 2, "^/v Seleccionar cocina   ENTER Ver detalle de la cocina");
 
-        pthread_mutex_unlock(&banda->mutex);
-    }
+    wrefresh(win_main);
+}
 
-    // Alertas de inventario
-    int bandas_con_alertas = 0;
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+int copiar_inventario_banda(Banda *banda, int *cantidades, int *consumido)
+{
+    // Reintentar si había una escritura abierta (versión impar) o cambió la versión durante la copia
+    for (int intento = 0; intento <= 3; intento++)
     {
-        if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+        unsigned int version = __atomic_load_n(&banda->version_inventario, __ATOMIC_ACQUIRE);
+        if (version & 1)
+            continue;
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
         {
-            bandas_con_alertas++;
+            cantidades[j] = __atomic_load_n(&banda->dispensadores[j].cantidad, __ATOMIC_RELAXED);
+            consumido[j] = __atomic_load_n(&banda->consumido[j], __ATOMIC_RELAXED);
         }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&banda->version_inventario, __ATOMIC_RELAXED) == version)
+            return 1;
     }
-
-    if (bandas_con_alertas > 0)
-    {
-        if (has_colors())
-            wattron(win_main, COLOR_PAIR(3));
-        mvwprintw(win_main, 11 + datos_compartidos->num_bandas + 1, 2,
-                  "ALERTAS: %d bandas necesitan reabastecimiento", bandas_con_alertas);
-        if (has_colors())
-            wattroff(win_main, COLOR_PAIR(3));
-    }
-
-    wrefresh(win_main);
+    return 0;
 }
 
-void mostrar_detalle_banda()
+void mostrar_mapa_calor()
 {
-    werase(win_banda_detail);
+    // Consumo por minuto suavizado de cada celda para estimar el tiempo hasta agotarse
+    static float tasa_por_minuto[MAX_BANDAS][MAX_INGREDIENTES];
+    static int consumo_previo[MAX_BANDAS][MAX_INGREDIENTES];
+    static long long muestra_previa_ms = 0;
+    static DatosCompartidos *datos_vistos = NULL;
+    // Última copia coherente; una banda cuya copia falla conserva la del cuadro anterior
+    static int cantidades[MAX_BANDAS][MAX_INGREDIENTES];
+    static int consumido[MAX_BANDAS][MAX_INGREDIENTES];
+
+    // Abreviaturas de 3 letras en el orden de ingredientes_base
+    const char *abreviaturas[MAX_INGREDIENTES] = {
+        "PnI", "PnS", "Crn", "Qso", "Tom", "Lec", "Ceb", "Bac",
+        "May", "Jal", "Agu", "Veg", "BBQ", "Pic", "Pep"};
+
+    werase(win_main);
 
     if (has_colors())
-        wattron(win_banda_detail, COLOR_PAIR(6));
-    wborder(win_banda_detail, '|', '|', '-', '-', '+', '+', '+', '+');
-    mvwprintw(win_banda_detail, 0, 2, " DETALLE BANDA %d ", banda_seleccionada + 1);
+        wattron(win_main, COLOR_PAIR(4));
+    wborder(win_main, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_main, 0, 2, " MAPA DE CALOR DE INVENTARIO - %s ",
+              mapa_por_tiempo ? "MINUTOS HASTA AGOTARSE" : "NIVEL DE LLENADO");
     if (has_colors())
-        wattroff(win_banda_detail, COLOR_PAIR(6));
+        wattroff(win_main, COLOR_PAIR(4));
 
-    if (banda_seleccionada >= datos_compartidos->num_bandas)
+    // Una copia del inventario de todas las bandas por cuadro
+    int num_bandas = datos_compartidos->num_bandas;
+    for (int b = 0; b < num_bandas; b++)
     {
-        mvwprintw(win_banda_detail, 2, 2, "Banda no valida");
-        wrefresh(win_banda_detail);
-        return;
+        int copia_cantidades[MAX_INGREDIENTES];
+        int copia_consumido[MAX_INGREDIENTES];
+        if (copiar_inventario_banda(&datos_compartidos->bandas[b], copia_cantidades, copia_consumido) ||
+            datos_vistos != datos_compartidos)
+        {
+            memcpy(cantidades[b], copia_cantidades, sizeof(copia_cantidades));
+            memcpy(consumido[b], copia_consumido, sizeof(copia_consumido));
+        }
     }
 
-    Banda *banda = &datos_compartidos->bandas[banda_seleccionada];
-    pthread_mutex_lock(&banda->mutex);
-
-    // Estado actual
-    mvwprintw(win_banda_detail, 2, 2, "ESTADO:");
-    if (banda->pausada)
-    {
-        if (has_colors())
-            wattron(win_banda_detail, COLOR_PAIR(2));
-        mvwprintw(win_banda_detail, 3, 4, "[PAUSE] PAUSADA");
-        if (has_colors())
-            wattroff(win_banda_detail, COLOR_PAIR(2));
-    }
-    else if (!banda->activa)
-    {
-        if (has_colors())
-            wattron(win_banda_detail, COLOR_PAIR(3));
-        mvwprintw(win_banda_detail, 3, 4, "[X] INACTIVA");
-        if (has_colors())
-            wattroff(win_banda_detail, COLOR_PAIR(3));
-    }
-    else
+    // Actualizar tasas de consumo (media móvil exponencial con constante de 60 s)
+    long long ahora_ms = reloj_ms();
+    if (datos_vistos != datos_compartidos)
     {
-        if (has_colors())
-            wattron(win_banda_detail, COLOR_PAIR(1));
-        mvwprintw(win_banda_detail, 3, 4, "[OK] ACTIVA");
-        if (has_colors())
-            wattroff(win_banda_detail, COLOR_PAIR(1));
+        memset(tasa_por_minuto, 0, sizeof(tasa_por_minuto));
+        memcpy(consumo_previo, consumido, sizeof(consumido));
+        muestra_previa_ms = ahora_ms;
+        datos_vistos = datos_compartidos;
     }
-
-    mvwprintw(win_banda_detail, 4, 4, "Estado: %s", banda->estado_actual);
-
-    // Orden actual
-    mvwprintw(win_banda_detail, 6, 2, "ORDEN ACTUAL:");
-    if (banda->procesando_orden)
+    else if (ahora_ms - muestra_previa_ms >= 1000)
     {
-        mvwprintw(win_banda_detail, 7, 4, "* ID: #%d", banda->orden_actual.id_orden);
-        mvwprintw(win_banda_detail, 8, 4, "* Tipo: %s", banda->orden_actual.nombre_hamburguesa);
-        mvwprintw(win_banda_detail, 9, 4, "* Progreso: %d/%d ingredientes",
-                  banda->orden_actual.paso_actual, banda->orden_actual.num_ingredientes);
-        if (strlen(banda->ingrediente_actual) > 0)
+        float dt_ms = ahora_ms - muestra_previa_ms;
+        float alfa = dt_ms / (dt_ms + 60000.0f);
+        for (int b = 0; b < num_bandas; b++)
         {
-            mvwprintw(win_banda_detail, 10, 4, "* Agregando: %s", banda->ingrediente_actual);
+            for (int j = 0; j < MAX_INGREDIENTES; j++)
+            {
+                float instantanea = (consumido[b][j] - consumo_previo[b][j]) * 60000.0f / dt_ms;
+                tasa_por_minuto[b][j] += alfa * (instantanea - tasa_por_minuto[b][j]);
+                consumo_previo[b][j] = consumido[b][j];
+            }
         }
+        muestra_previa_ms = ahora_ms;
     }
-    else
+
+    // Celdas de 3 columnas; se reducen a 2 si la terminal es estrecha
+    int ancho_celda = (getmaxx(win_main) - 12) / MAX_INGREDIENTES >= 3 ? 3 : 2;
+
+    mvwprintw(win_main, 2, 2, "BANDA");
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
     {
-        mvwprintw(win_banda_detail, 7, 4, "Sin orden asignada");
+        mvwprintw(win_main, 2, 9 + j * ancho_celda, "%.*s", ancho_celda, abreviaturas[j]);
     }
 
-    // Estadisticas
-    mvwprintw(win_banda_detail, 12, 2, "ESTADISTICAS:");
-    mvwprintw(win_banda_detail, 13, 4, "* Hamburguesas procesadas: %d", banda->hamburguesas_procesadas);
-
-    // Inventario critico
-    mvwprintw(win_banda_detail, 15, 2, "INVENTARIO CRITICO:");
-    int items_criticos = 0;
-    int linea_inv = 16;
+    float peor_minutos = -1;
+    int peor_banda = -1, peor_ingrediente = -1;
 
-    for (int j = 0; j < MAX_INGREDIENTES && items_criticos < 8; j++)
+    for (int b = 0; b < num_bandas; b++)
     {
-        pthread_mutex_lock(&banda->dispensadores[j].mutex);
-        int cantidad = banda->dispensadores[j].cantidad;
+        int linea = 3 + b;
+        if (linea > getmaxy(win_main) - 6)
+            break;
 
-        if (cantidad == 0 || cantidad <= UMBRAL_INVENTARIO_BAJO)
+        if (has_colors() && b == banda_seleccionada)
+            wattron(win_main, COLOR_PAIR(5));
+        mvwprintw(win_main, linea, 2, "B%-4d", b + 1);
+        if (has_colors() && b == banda_seleccionada)
+            wattroff(win_main, COLOR_PAIR(5));
+
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
         {
-            int color = (cantidad == 0) ? 3 : 2;
-            if (has_colors())
-                wattron(win_banda_detail, COLOR_PAIR(color));
+            int cantidad = cantidades[b][j];
+            float tasa = tasa_por_minuto[b][j];
+            float minutos = (tasa > 0.01f) ? cantidad / tasa : -1; // -1: sin consumo
 
-            char nombre_corto[15];
-            strncpy(nombre_corto, banda->dispensadores[j].nombre, 14);
-            nombre_corto[14] = '\0';
+            if (minutos >= 0 && (peor_minutos < 0 || minutos < peor_minutos))
+            {
+                peor_minutos = minutos;
+                peor_banda = b;
+                peor_ingrediente = j;
+            }
 
-            mvwprintw(win_banda_detail, linea_inv, 4, "* %-14s: %2d %s",
-                      nombre_corto, cantidad,
-                      cantidad == 0 ? "[AGOTADO]" : "[CRITICO]");
+            int color;
+            char texto[4];
+            if (mapa_por_tiempo)
+            {
+                if (cantidad == 0)
+                    color = 10;
+                else if (minutos < 0)
+                    color = 13;
+                else if (minutos < 2)
+                    color = 10;
+                else if (minutos < 5)
+                    color = 11;
+                else
+                    color = 12;
+
+                if (cantidad == 0)
+                    strcpy(texto, "X");
+                else if (minutos < 0)
+                    strcpy(texto, "-");
+                else
+                    snprintf(texto, sizeof(texto), "%d", minutos > 99 ? 99 : (int)minutos);
+            }
+            else
+            {
+                float llenado = (float)cantidad / CAPACIDAD_DISPENSADOR;
+                if (cantidad == 0)
+                    color = 10;
+                else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
+                    color = 11;
+                else if (llenado < 0.75f)
+                    color = 12;
+                else
+                    color = 13;
+                snprintf(texto, sizeof(texto), "%d", cantidad);
+            }
 
             if (has_colors())
-                wattroff(win_banda_detail, COLOR_PAIR(color));
-            linea_inv++;
-            items_criticos++;
+                wattron(win_main, COLOR_PAIR(color));
+            mvwprintw(win_main, linea, 9 + j * ancho_celda, "%*s", ancho_celda - 1, texto);
+            if (has_colors())
+                wattroff(win_main, COLOR_PAIR(color));
         }
-        pthread_mutex_unlock(&banda->dispensadores[j].mutex);
     }
 
-    if (items_criticos == 0)
+    int linea_leyenda = 4 + num_bandas;
+    if (mapa_por_tiempo)
+        mvwprintw(win_main, linea_leyenda, 2,
+                  "Minutos estimados al ritmo de consumo actual: rojo <2  amarillo <5  verde >=5  cian sin consumo");
+    else
+        mvwprintw(win_main, linea_leyenda, 2,
+                  "Unidades de %d: rojo agotado  amarillo <=%d  verde <75%%  cian >=75%%",
+                  CAPACIDAD_DISPENSADOR, UMBRAL_INVENTARIO_BAJO);
+
+    if (peor_banda >= 0)
     {
         if (has_colors())
-            wattron(win_banda_detail, COLOR_PAIR(1));
-        mvwprintw(win_banda_detail, linea_inv, 4, "[OK] Inventario en niveles normales");
+            wattron(win_main, COLOR_PAIR(peor_minutos < 2 ? 3 : 6));
+        mvwprintw(win_main, linea_leyenda + 1, 2, "Proximo en agotarse: %s en banda %d (~%.1f min)",
+                  ingredientes_base[peor_ingrediente], peor_banda + 1, peor_minutos);
         if (has_colors())
-            wattroff(win_banda_detail, COLOR_PAIR(1));
+            wattroff(win_main, COLOR_PAIR(peor_minutos < 2 ? 3 : 6));
     }
 
-    pthread_mutex_unlock(&banda->mutex);
-    wrefresh(win_banda_detail);
+    wrefresh(win_main);
 }
 
-void mostrar_inventario_banda()
+void mostrar_linea_tiempo()
 {
-    werase(win_banda_detail);
+    // Franjas calculadas en el cuadro anterior, reutilizadas si nada cambió
+    static char franjas[MAX_BANDAS][MAX_COLUMNAS_LINEA];
+    static int ocupacion[MAX_BANDAS];
+    static unsigned int total_visto[MAX_BANDAS];
+    static long long columna_vista[MAX_BANDAS];
+    static DatosCompartidos *datos_vistos = NULL;
+    static int columnas_vistas = 0;
+    static int minutos_vistos = 0;
+
+    werase(win_main);
 
     if (has_colors())
-        wattron(win_banda_detail, COLOR_PAIR(4));
-    wborder(win_banda_detail, '|', '|', '-', '-', '+', '+', '+', '+');
-    mvwprintw(win_banda_detail, 0, 2, " INVENTARIO BANDA %d ", banda_seleccionada + 1);
+        wattron(win_main, COLOR_PAIR(4));
+    wborder(win_main, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_main, 0, 2, " LINEA DE TIEMPO - ULTIMOS %d MINUTOS ", minutos_linea_tiempo);
     if (has_colors())
-        wattroff(win_banda_detail, COLOR_PAIR(4));
+        wattroff(win_main, COLOR_PAIR(4));
 
-    if (banda_seleccionada >= datos_compartidos->num_bandas)
+    int columnas = getmaxx(win_main) - 22;
+    if (columnas > MAX_COLUMNAS_LINEA)
+        columnas = MAX_COLUMNAS_LINEA;
+    if (columnas < 10)
     {
-        mvwprintw(win_banda_detail, 2, 2, "Banda no valida");
-        wrefresh(win_banda_detail);
+        mvwprintw(win_main, 2, 2, "Terminal demasiado estrecha");
+        wrefresh(win_main);
         return;
     }
 
-    Banda *banda = &datos_compartidos->bandas[banda_seleccionada];
+    // Cambiar de cocina, de ancho o de ventana invalida todas las franjas
+    if (datos_vistos != datos_compartidos || columnas_vistas != columnas || minutos_vistos != minutos_linea_tiempo)
+    {
+        memset(total_visto, 0xff, sizeof(total_visto));
+        datos_vistos = datos_compartidos;
+        columnas_vistas = columnas;
+        minutos_vistos = minutos_linea_tiempo;
+    }
 
-    mvwprintw(win_banda_detail, 2, 2, "INVENTARIO COMPLETO:");
-    mvwprintw(win_banda_detail, 3, 2, "Use ^/v para navegar, +/- para ajustar");
+    long long ms_por_columna = (long long)minutos_linea_tiempo * 60000 / columnas;
+    long long columna_actual = reloj_ms() / ms_por_columna;
+    long long fin_ms = (columna_actual + 1) * ms_por_columna;
+    long long inicio_ms = fin_ms - (long long)columnas * ms_por_columna;
 
-    for (int i = 0; i < MAX_INGREDIENTES; i++)
+    // Letra por tipo de hamburguesa en el orden del menú
+    const char letras_tipo[NUM_TIPOS_HAMBURGUESA] = {'C', 'Q', 'B', 'V', 'D', 'S'};
+
+    for (int b = 0; b < datos_compartidos->num_bandas; b++)
     {
-        int linea = 5 + i;
-        if (linea > getmaxy(win_banda_detail) - 3)
-            break; // No exceder ventana
+        Banda *banda = &datos_compartidos->bandas[b];
+        unsigned int total = __atomic_load_n(&banda->total_transiciones, __ATOMIC_ACQUIRE);
 
-        pthread_mutex_lock(&banda->dispensadores[i].mutex);
-        int cantidad = banda->dispensadores[i].cantidad;
+        if (total != total_visto[b] || columna_actual != columna_vista[b])
+        {
+            // Recorrer las transiciones de la más reciente a la más antigua
+            memset(franjas[b], ' ', columnas);
+            long long ocupado_ms = 0;
+            long long hasta_ms = fin_ms;
+            unsigned int disponibles = total < MAX_TRANSICIONES_BANDA ? total : MAX_TRANSICIONES_BANDA;
 
-        char nombre_corto[15];
-        strncpy(nombre_corto, banda->dispensadores[i].nombre, 14);
-        nombre_corto[14] = '\0';
+            for (unsigned int k = 0; k < disponibles && hasta_ms > inicio_ms; k++)
+            {
+                TransicionBanda t = banda->transiciones[(total - 1 - k) % MAX_TRANSICIONES_BANDA];
+                long long desde_ms = t.marca_ms > inicio_ms ? t.marca_ms : inicio_ms;
+                if (desde_ms >= hasta_ms)
+                    continue;
 
-        // Determinar color y selección
-        int color = 1; // Verde por defecto
-        if (cantidad == 0)
-            color = 3; // Rojo
-        else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
-            color = 2; // Amarillo
+                char simbolo = '.';
+                if (t.estado == ESTADO_LINEA_OCUPADA)
+                {
+                    simbolo = (t.tipo_hamburguesa >= 0 && t.tipo_hamburguesa < NUM_TIPOS_HAMBURGUESA)
+                                  ? letras_tipo[t.tipo_hamburguesa]
+                                  : '#';
+                    ocupado_ms += hasta_ms - desde_ms;
+                }
+                else if (t.estado == ESTADO_LINEA_PAUSADA)
+                    simbolo = '=';
+                else if (t.estado == ESTADO_LINEA_SIN_INVENTARIO)
+                    simbolo = '!';
+                else if (t.estado == ESTADO_LINEA_REABASTECIENDO)
+                    simbolo = '+';
+
+                // Dentro de una columna prevalece el estado más grave: ! > = > + > ocupada > ociosa
+                int col_desde = (desde_ms - inicio_ms) / ms_por_columna;
+                int col_hasta = (hasta_ms - 1 - inicio_ms) / ms_por_columna;
+                for (int c = col_desde; c <= col_hasta && c < columnas; c++)
+                {
+                    char actual = franjas[b][c];
+                    if (actual == ' ' || actual == '.' ||
+                        (simbolo == '!') ||
+                        (simbolo == '=' && actual != '!') ||
+                        (simbolo == '+' && actual != '!' && actual != '='))
+                        franjas[b][c] = simbolo;
+                }
+                hasta_ms = desde_ms;
+            }
 
-        // Destacar ingrediente seleccionado
-        if (i == ingrediente_seleccionado)
-        {
-            if (has_colors())
-                wattron(win_banda_detail, COLOR_PAIR(5));
-            mvwprintw(win_banda_detail, linea, 2, "> %-14s: %2d/%2d %s",
-                      nombre_corto, cantidad, CAPACIDAD_DISPENSADOR,
-                      cantidad == 0 ? "[AGOTADO]" : (cantidad <= UMBRAL_INVENTARIO_BAJO ? "[CRITICO]" : ""));
-            if (has_colors())
-                wattroff(win_banda_detail, COLOR_PAIR(5));
+            ocupacion[b] = (int)(ocupado_ms * 100 / (fin_ms - inicio_ms));
+            total_visto[b] = total;
+            columna_vista[b] = columna_actual;
         }
-        else
+
+        int linea = 2 + b * 2;
+        int color_banda = (b == banda_seleccionada) ? 5 : 6;
+        if (has_colors())
+            wattron(win_main, COLOR_PAIR(color_banda));
+        mvwprintw(win_main, linea, 2, "BANDA %2d", b + 1);
+        if (has_colors())
+            wattroff(win_main, COLOR_PAIR(color_banda));
+
+        for (int c = 0; c < columnas; c++)
         {
-            if (has_colors())
-                wattron(win_banda_detail, COLOR_PAIR(color));
-            mvwprintw(win_banda_detail, linea, 2, "  %-14s: %2d/%2d %s",
-                      nombre_corto, cantidad, CAPACIDAD_DISPENSADOR,
-                      cantidad == 0 ? "[AGOTADO]" : (cantidad <= UMBRAL_INVENTARIO_BAJO ? "[CRITICO]" : ""));
-            if (has_colors())
-                wattroff(win_banda_detail, COLOR_PAIR(color));
+            char simbolo = franjas[b][c];
+            int color = 0;
+            if (simbolo == '!')
+                color = 3;
+            else if (simbolo == '=')
+                color = 2;
+            else if (simbolo == '+')
+                color = 4;
+            else if (simbolo != ' ' && simbolo != '.')
+                color = 1;
+
+            if (has_colors() && color)
+                wattron(win_main, COLOR_PAIR(color));
+            mvwaddch(win_main, linea, 11 + c, simbolo);
+            if (has_colors() && color)
+                wattroff(win_main, COLOR_PAIR(color));
         }
-
-        pthread_mutex_unlock(&banda->dispensadores[i].mutex);
+        mvwprintw(win_main, linea, 12 + columnas, "%3d%%", ocupacion[b]);
     }
 
-    // Mostrar controles
-    int linea_controles = MAX_INGREDIENTES + 7;
+    int linea_leyenda = 3 + datos_compartidos->num_bandas * 2;
+    mvwprintw(win_main, linea_leyenda, 2, "-%dm%*s ahora  |  %% = ocupacion en la ventana",
+              minutos_linea_tiempo, columnas - 4, "");
+    mvwprintw(win_main, linea_leyenda + 1, 2,
+              "C Clasica  Q Cheese  B BBQ  V Vegetariana  D Deluxe  S Spicy  . Ociosa");
     if (has_colors())
-        wattron(win_banda_detail, COLOR_PAIR(6));
-    mvwprintw(win_banda_detail, linea_controles, 2, "CONTROLES:");
-    mvwprintw(win_banda_detail, linea_controles + 1, 2, "+ : Añadir 1 unidad");
-    mvwprintw(win_banda_detail, linea_controles + 2, 2, "- : Quitar 1 unidad");
-    mvwprintw(win_banda_detail, linea_controles + 3, 2, "F : Llenar completamente");
+        wattron(win_main, COLOR_PAIR(2));
+    mvwprintw(win_main, linea_leyenda + 2, 2, "= Pausada");
     if (has_colors())
-        wattroff(win_banda_detail, COLOR_PAIR(6));
+        wattroff(win_main, COLOR_PAIR(2));
+    if (has_colors())
+        wattron(win_main, COLOR_PAIR(3));
+    mvwprintw(win_main, linea_leyenda + 2, 13, "! Sin inventario para la cola");
+    if (has_colors())
+        wattroff(win_main, COLOR_PAIR(3));
+    if (has_colors())
+        wattron(win_main, COLOR_PAIR(4));
+    mvwprintw(win_main, linea_leyenda + 2, 44, "+ Reabasteciendo");
+    if (has_colors())
+        wattroff(win_main, COLOR_PAIR(4));
 
-    wrefresh(win_banda_detail);
+    wrefresh(win_main);
 }
 
-void mostrar_modo_abastecimiento()
+void mostrar_uso_cpu()
 {
-    werase(win_banda_detail);
+    // Consumo del propio panel entre dos cuadros
+    static long long cpu_panel_previo_ns = 0;
+    static long long muestra_previa_ms = 0;
+    static float uso_panel = 0;
+
+    werase(win_main);
 
     if (has_colors())
-        wattron(win_banda_detail, COLOR_PAIR(6));
-    wborder(win_banda_detail, '|', '|', '-', '-', '+', '+', '+', '+');
-    mvwprintw(win_banda_detail, 0, 2, " MODO ABASTECIMIENTO ");
+        wattron(win_main, COLOR_PAIR(4));
+    wborder(win_main, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_main, 0, 2, " USO DE CPU POR COMPONENTE ");
     if (has_colors())
-        wattroff(win_banda_detail, COLOR_PAIR(6));
-
-    mvwprintw(win_banda_detail, 2, 2, "OPCIONES DE ABASTECIMIENTO:");
+        wattroff(win_main, COLOR_PAIR(4));
 
-    // Mostrar opciones
-    const char *opciones[] = {
-        "1. Reabastecer banda seleccionada",
-        "2. Reabastecer TODAS las bandas",
-        "3. Reabastecer solo ingredientes criticos",
-        "4. Reabastecer ingredientes agotados",
-        "5. Modo personalizado (ingrediente por ingrediente)"};
+    mvwprintw(win_main, 2, 2, "%-16s %11s %7s %-12s %9s %12s %10s %10s", "COMPONENTE", "CPU TOTAL", "%CPU", "",
+              "DESP/S", "DESPERTARES", "VOLUNT.", "INVOLUNT.");
 
-    for (int i = 0; i < 5; i++)
+    int linea = 3;
+    int max_linea = getmaxy(win_main) - 5;
+    for (int c = 0; c < datos_compartidos->num_componentes && c < MAX_COMPONENTES && linea < max_linea; c++)
     {
-        mvwprintw(win_banda_detail, 4 + i, 4, "%s", opciones[i]);
+        CuentaCpu *cuenta = &datos_compartidos->cuentas_cpu[c];
+        if (cuenta->nombre[0] == '\0')
+            continue;
+
+        // Barra de 10 posiciones por núcleo completo
+        char barra[11];
+        int llenas = (int)(cuenta->uso_cpu * 10 + 0.5f);
+        if (llenas > 10)
+            llenas = 10;
+        for (int k = 0; k < 10; k++)
+            barra[k] = k < llenas ? '#' : '.';
+        barra[10] = '\0';
+
+        int color = !cuenta->activo ? 0 : cuenta->uso_cpu >= 0.5f ? 3 : cuenta->uso_cpu >= 0.1f ? 2 : 1;
+        if (has_colors() && color)
+            wattron(win_main, COLOR_PAIR(color));
+        mvwprintw(win_main, linea, 2, "%-16s %9.3f s %6.1f%% [%s] %9.1f %12lld %10lld %10lld%s", cuenta->nombre,
+                  cuenta->cpu_ns / 1e9, cuenta->uso_cpu * 100, barra, cuenta->despertares_por_segundo,
+                  cuenta->despertares, cuenta->cambios_voluntarios, cuenta->cambios_involuntarios,
+                  cuenta->activo ? "" : "  (terminado)");
+        if (has_colors() && color)
+            wattroff(win_main, COLOR_PAIR(color));
+        linea++;
     }
 
-    // Mostrar estado de bandas que necesitan abastecimiento
-    mvwprintw(win_banda_detail, 11, 2, "BANDAS QUE NECESITAN ABASTECIMIENTO:");
-    int bandas_criticas = 0;
-    for (int i = 0; i < datos_compartidos->num_bandas; i++)
+    // Todo el proceso, incluido lo que no pasa por los bucles contabilizados
+    linea++;
+    mvwprintw(win_main, linea++, 2, "%-16s %9.3f s %6.1f%%", "proceso", datos_compartidos->cpu_proceso_ns / 1e9,
+              datos_compartidos->uso_cpu_proceso * 100);
+
+    struct timespec cpu;
+    struct rusage uso;
+    long long ahora_ms = reloj_ms();
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu) == 0 && getrusage(RUSAGE_SELF, &uso) == 0)
     {
-        if (datos_compartidos->bandas[i].necesita_reabastecimiento)
+        long long cpu_panel_ns = (long long)cpu.tv_sec * 1000000000LL + cpu.tv_nsec;
+        if (muestra_previa_ms > 0 && ahora_ms - muestra_previa_ms >= 1000)
         {
-            if (has_colors())
-                wattron(win_banda_detail, COLOR_PAIR(3));
-            mvwprintw(win_banda_detail, 13 + bandas_criticas, 4, "* Banda %d - Requiere atencion", i + 1);
-            if (has_colors())
-                wattroff(win_banda_detail, COLOR_PAIR(3));
-            bandas_criticas++;
+            uso_panel = (cpu_panel_ns - cpu_panel_previo_ns) / ((ahora_ms - muestra_previa_ms) * 1e6);
+            cpu_panel_previo_ns = cpu_panel_ns;
+            muestra_previa_ms = ahora_ms;
         }
+        else if (muestra_previa_ms == 0)
+        {
+            cpu_panel_previo_ns = cpu_panel_ns;
+            muestra_previa_ms = ahora_ms;
+        }
+        mvwprintw(win_main, linea++, 2, "%-16s %9.3f s %6.1f%% %-12s %9s %12s %10ld %10ld", "panel (este)",
+                  cpu_panel_ns / 1e9, uso_panel * 100, "", "", "", uso.ru_nvcsw, uso.ru_nivcsw);
     }
 
-    if (bandas_criticas == 0)
+    linea++;
+    mvwprintw(win_main, linea, 2, "%%CPU: fraccion de un nucleo en el ultimo segundo. Despertar: vuelta del bucle del");
+    mvwprintw(win_main, linea + 1, 2, "hilo tras una espera (en las bandas, tambien cada paso de la receta).");
+
+    wrefresh(win_main);
+}
+
+const CabeceraArchivo *proyectar_archivo_metricas(const char *ruta)
+{
+    static char ruta_proyectada[256] = "";
+    static const CabeceraArchivo *proyectado = NULL;
+
+    if (proyectado != NULL && strcmp(ruta, ruta_proyectada) == 0)
+        return proyectado;
+    if (proyectado != NULL)
     {
-        if (has_colors())
-            wattron(win_banda_detail, COLOR_PAIR(1));
-        mvwprintw(win_banda_detail, 13, 4, "[OK] Todas las bandas en niveles normales");
-        if (has_colors())
-            wattroff(win_banda_detail, COLOR_PAIR(1));
+        munmap((void *)proyectado, proyectado->tamano);
+        proyectado = NULL;
     }
+    snprintf(ruta_proyectada, sizeof(ruta_proyectada), "%s", ruta);
 
-    // Mostrar controles
-    mvwprintw(win_banda_detail, 18, 2, "CONTROLES:");
-    mvwprintw(win_banda_detail, 19, 2, "1-5: Ejecutar opcion");
-    mvwprintw(win_banda_detail, 20, 2, "ESC: Salir del modo abastecimiento");
+    int descriptor = open(ruta, O_RDONLY);
+    if (descriptor < 0)
+        return NULL;
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || info.st_size < (off_t)sizeof(CabeceraArchivo))
+    {
+        close(descriptor);
+        return NULL;
+    }
+    const CabeceraArchivo *archivo = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (archivo == MAP_FAILED)
+        return NULL;
+
+    // Cada anillo debe caber en el archivo antes de indexarlo
+    int valido = memcmp(archivo->magia, MAGIA_ARCHIVO, sizeof(archivo->magia)) == 0 &&
+                 archivo->num_resoluciones == NUM_RESOLUCIONES_ARCHIVO && archivo->tamano == info.st_size;
+    for (int r = 0; valido && r < NUM_RESOLUCIONES_ARCHIVO; r++)
+    {
+        const ResolucionArchivo *anillo = &archivo->resoluciones[r];
+        valido = anillo->paso_s > 0 && anillo->filas > 0 &&
+                 anillo->desplazamiento + (long long)anillo->filas * sizeof(FilaArchivo) <= archivo->tamano;
+    }
+    if (!valido)
+    {
+        munmap((void *)archivo, info.st_size);
+        return NULL;
+    }
 
-    wrefresh(win_banda_detail);
+    proyectado = archivo;
+    return proyectado;
 }
 
-void mostrar_inventario_global()
+void leer_filas_archivo(const CabeceraArchivo *archivo, int resolucion, long long ultimo_s, int cantidad,
+                        FilaArchivo *destino)
 {
-    werase(win_banda_detail);
-
-    if (has_colors())
-        wattron(win_banda_detail, COLOR_PAIR(4));
-    wborder(win_banda_detail, '|', '|', '-', '-', '+', '+', '+', '+');
-    mvwprintw(win_banda_detail, 0, 2, " INVENTARIO GLOBAL ");
-    if (has_colors())
-        wattroff(win_banda_detail, COLOR_PAIR(4));
-
-    mvwprintw(win_banda_detail, 2, 2, "RESUMEN POR INGREDIENTE:");
+    const ResolucionArchivo *anillo = &archivo->resoluciones[resolucion];
+    const FilaArchivo *filas = (const FilaArchivo *)((const char *)archivo + anillo->desplazamiento);
 
-    for (int ing = 0; ing < MAX_INGREDIENTES; ing++)
+    // Lectura con seqlock, como la de la instantánea de métricas
+    for (int intento = 0; intento < 100; intento++)
     {
-        int total_ingrediente = 0;
-        int bandas_agotadas = 0;
-        int bandas_criticas = 0;
+        unsigned int antes = __atomic_load_n(&archivo->secuencia, __ATOMIC_ACQUIRE);
+        if (antes % 2 != 0)
+        {
+            sched_yield();
+            continue;
+        }
 
-        // Calcular totales
-        for (int banda = 0; banda < datos_compartidos->num_bandas; banda++)
+        for (int k = 0; k < cantidad; k++)
         {
-            pthread_mutex_lock(&datos_compartidos->bandas[banda].dispensadores[ing].mutex);
-            int cantidad = datos_compartidos->bandas[banda].dispensadores[ing].cantidad;
-            total_ingrediente += cantidad;
+            long long inicio = ultimo_s - (long long)k * anillo->paso_s;
+            destino[k] = filas[(inicio / anillo->paso_s) % anillo->filas];
+            if (destino[k].inicio_s != inicio)
+                memset(&destino[k], 0, sizeof(destino[k]));
+        }
 
-            if (cantidad == 0)
-                bandas_agotadas++;
-            else if (cantidad <= UMBRAL_INVENTARIO_BAJO)
-                bandas_criticas++;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&archivo->secuencia, __ATOMIC_RELAXED) == antes)
+            return;
+    }
+}
 
-            pthread_mutex_unlock(&datos_compartidos->bandas[banda].dispensadores[ing].mutex);
-        }
+/**
+ * @brief Suma las filas válidas de un tramo del archivo para el resumen de tendencias
+ */
+static void sumar_filas_archivo(const FilaArchivo *filas, int cantidad, int *completadas, int *llegadas,
+                                int *agotamientos, int *p99_maxima)
+{
+    *completadas = *llegadas = *agotamientos = *p99_maxima = 0;
+    for (int k = 0; k < cantidad; k++)
+    {
+        *completadas += filas[k].completadas;
+        *llegadas += filas[k].llegadas;
+        *agotamientos += filas[k].agotamientos;
+        if (filas[k].latencia_p99_ms > *p99_maxima)
+            *p99_maxima = filas[k].latencia_p99_ms;
+    }
+}
 
-        // Mostrar solo primeros 12 ingredientes para no llenar la pantalla
-        if (ing < 12)
-        {
-            int linea = 4 + ing;
-            char nombre_corto[15];
-            strncpy(nombre_corto, ingredientes_base[ing], 14);
-            nombre_corto[14] = '\0';
+void mostrar_tendencias()
+{
+    static FilaArchivo filas[MAX_FILAS_TENDENCIAS];
+    static FilaArchivo semana_previa[MAX_FILAS_TENDENCIAS];
+    const char *nombres_resolucion[NUM_RESOLUCIONES_ARCHIVO] = {"1 segundo", "1 minuto", "1 hora"};
+    const char *formatos_hora[NUM_RESOLUCIONES_ARCHIVO] = {"%H:%M:%S", "%d/%m %H:%M", "%d/%m %H:00"};
 
-            int color = 1; // Verde por defecto
-            if (bandas_agotadas > 0)
-                color = 3; // Rojo si hay agotadas
-            else if (bandas_criticas > 0)
-                color = 2; // Amarillo si hay criticas
+    werase(win_main);
 
-            if (has_colors())
-                wattron(win_banda_detail, COLOR_PAIR(color));
+    if (has_colors())
+        wattron(win_main, COLOR_PAIR(4));
+    wborder(win_main, '|', '|', '-', '-', '+', '+', '+', '+');
+    mvwprintw(win_main, 0, 2, " TENDENCIAS DEL ARCHIVO DE METRICAS ");
+    if (has_colors())
+        wattroff(win_main, COLOR_PAIR(4));
 
-            mvwprintw(win_banda_detail, linea, 2, "%-14s: Total:%3d",
-                      nombre_corto, total_ingrediente);
+    const char *ruta = datos_compartidos->ruta_archivo_metricas;
+    const CabeceraArchivo *archivo = ruta[0] != '\0' ? proyectar_archivo_metricas(ruta) : NULL;
+    if (archivo == NULL)
+    {
+        if (ruta[0] == '\0')
+            mvwprintw(win_main, 2, 2, "La cocina '%s' no archiva metricas.", datos_compartidos->nombre_instancia);
+        else
+            mvwprintw(win_main, 2, 2, "No se pudo leer el archivo de metricas '%s'.", ruta);
+        mvwprintw(win_main, 3, 2, "Iniciarla con ./burger_system -R <ARCHIVO> para acumular segundos, minutos y horas");
+        mvwprintw(win_main, 4, 2, "entre corridas.");
+        wrefresh(win_main);
+        return;
+    }
 
-            if (bandas_agotadas > 0)
-            {
-                mvwprintw(win_banda_detail, linea, 30, "[X]%d", bandas_agotadas);
-            }
-            if (bandas_criticas > 0)
-            {
-                mvwprintw(win_banda_detail, linea, 35, "[!]%d", bandas_criticas);
-            }
+    int r = resolucion_tendencias;
+    const ResolucionArchivo *anillo = &archivo->resoluciones[r];
+    long long ahora_s = time(NULL);
+    long long actualizado_s = __atomic_load_n(&archivo->actualizado_s, __ATOMIC_RELAXED);
+    long long cubre_s = (long long)anillo->paso_s * anillo->filas;
+
+    mvwprintw(win_main, 2, 2, "Archivo: %.40s   Cocina: %s   Ultima muestra: hace %lld s", ruta,
+              archivo->nombre_instancia, ahora_s - actualizado_s);
+    mvwprintw(win_main, 3, 2, "Filas de %s (+/- cambia); el anillo guarda %d filas = %lld %s", nombres_resolucion[r],
+              anillo->filas, cubre_s >= 86400 ? cubre_s / 86400 : cubre_s / 60, cubre_s >= 86400 ? "dias" : "min");
+
+    // Semana contra semana con las filas por hora: las últimas 24 h y las mismas horas 7 días antes
+    int horaria = NUM_RESOLUCIONES_ARCHIVO - 1;
+    int paso_hora = archivo->resoluciones[horaria].paso_s;
+    long long ultima_hora = ahora_s - ahora_s % paso_hora;
+    int horas = 24 * 3600 / paso_hora;
+    if (horas > MAX_FILAS_TENDENCIAS)
+        horas = MAX_FILAS_TENDENCIAS;
+    int completadas, llegadas, agotamientos, p99;
+    int completadas_previas, llegadas_previas, agotamientos_previos, p99_previa;
+    leer_filas_archivo(archivo, horaria, ultima_hora, horas, filas);
+    sumar_filas_archivo(filas, horas, &completadas, &llegadas, &agotamientos, &p99);
+    leer_filas_archivo(archivo, horaria, ultima_hora - SEGUNDOS_SEMANA, horas, semana_previa);
+    sumar_filas_archivo(semana_previa, horas, &completadas_previas, &llegadas_previas, &agotamientos_previos,
+                        &p99_previa);
+
+    mvwprintw(win_main, 5, 2, "Ultimas 24 h:  %7d entregas %7d llegadas %5d agotamientos  p99 max %6d ms", completadas,
+              llegadas, agotamientos, p99);
+    mvwprintw(win_main, 6, 2, "Hace 7 dias:   %7d entregas %7d llegadas %5d agotamientos  p99 max %6d ms",
+              completadas_previas, llegadas_previas, agotamientos_previos, p99_previa);
+    if (completadas_previas > 0)
+    {
+        float cambio = (completadas - completadas_previas) * 100.0f / completadas_previas;
+        int color = cambio >= 0 ? 1 : 3;
+        if (has_colors())
+            wattron(win_main, COLOR_PAIR(color));
+        wprintw(win_main, "  %+.1f%%", cambio);
+        if (has_colors())
+            wattroff(win_main, COLOR_PAIR(color));
+    }
 
-            if (has_colors())
-                wattroff(win_banda_detail, COLOR_PAIR(color));
+    // Tabla de los intervalos más recientes de la resolución elegida, el más nuevo arriba
+    int cantidad = getmaxy(win_main) - 11;
+    if (cantidad > MAX_FILAS_TENDENCIAS)
+        cantidad = MAX_FILAS_TENDENCIAS;
+    if (cantidad < 1)
+        cantidad = 1;
+    int compara = cubre_s > SEGUNDOS_SEMANA;
+    long long ultimo = ahora_s - ahora_s % anillo->paso_s;
+    leer_filas_archivo(archivo, r, ultimo, cantidad, filas);
+    if (compara)
+        leer_filas_archivo(archivo, r, ultimo - SEGUNDOS_SEMANA, cantidad, semana_previa);
+
+    int maximo = 1;
+    int parciales = 0;
+    for (int k = 0; k < cantidad; k++)
+    {
+        if (filas[k].completadas > maximo)
+            maximo = filas[k].completadas;
+    }
+
+    mvwprintw(win_main, 8, 2, "%-12s %7s %6s %9s %5s %7s %7s %5s %8s  %s", "INTERVALO", "ENTREG", "LLEG", "COLA MED",
+              "MAX", "P50 ms", "P99 ms", "AGOT", "HACE 7D", "ENTREGAS");
+    for (int k = 0; k < cantidad; k++)
+    {
+        int linea = 9 + k;
+        time_t inicio = ultimo - (long long)k * anillo->paso_s;
+        struct tm local;
+        localtime_r(&inicio, &local);
+        char hora[16];
+        strftime(hora, sizeof(hora), formatos_hora[r], &local);
+
+        char previa[12] = "-";
+        if (compara && semana_previa[k].inicio_s != 0)
+            snprintf(previa, sizeof(previa), "%d", semana_previa[k].completadas);
+
+        const FilaArchivo *fila = &filas[k];
+        if (fila->inicio_s == 0)
+        {
+            mvwprintw(win_main, linea, 2, "%-12s %7s %6s %9s %5s %7s %7s %5s %8s", hora, "--", "--", "--", "--", "--",
+                      "--", "--", previa);
+            continue;
         }
+
+        char barra[21];
+        int llenas = fila->completadas * 20 / maximo;
+        for (int b = 0; b < 20; b++)
+            barra[b] = b < llenas ? '#' : '.';
+        barra[20] = '\0';
+
+        // Intervalo compartido por varias corridas: los percentiles son solo de la última
+        const char *marca = fila->latencias_percentil < fila->latencias ? "*" : " ";
+        parciales += marca[0] == '*';
+
+        int color = fila->agotamientos > 0 ? 3 : 0;
+        if (has_colors() && color)
+            wattron(win_main, COLOR_PAIR(color));
+        mvwprintw(win_main, linea, 2, "%-12s %7d %6d %9.1f %5d %6d%s %6d%s %5d %8s  %s", hora, fila->completadas,
+                  fila->llegadas, (float)fila->cola_suma / fila->muestras, fila->cola_maxima, fila->latencia_p50_ms,
+                  marca, fila->latencia_p99_ms, marca, fila->agotamientos, previa, barra);
+        if (has_colors() && color)
+            wattroff(win_main, COLOR_PAIR(color));
     }
+    if (parciales > 0)
+        mvwprintw(win_main, 9 + cantidad, 2, "* percentiles de las entregas de la ultima corrida del intervalo");
 
-    wrefresh(win_banda_detail);
+    wrefresh(win_main);
 }
 
 void mostrar_comandos_disponibles()
@@ -1128,15 +3553,15 @@ void mostrar_comandos_disponibles()
         mvwprintw(win_commands, 1, 2, "NAVEGACION:");
         mvwprintw(win_commands, 2, 2, "  ^/v  Cambiar banda    TAB  Cambiar vista");
         mvwprintw(win_commands, 3, 2, "CONTROL:");
-        mvwprintw(win_commands, 4, 2, "  ESPACIO Pausar/Reanudar  R  Reabastecer");
-        mvwprintw(win_commands, 5, 2, "  S  Modo abastecimiento  H  Ayuda  Q  Salir");
+        mvwprintw(win_commands, 4, 2, "  ESPACIO Pausar/Reanudar  R  Reabastecer  X  Cancelar");
+        mvwprintw(win_commands, 5, 2, "  S  Abastecimiento  V  Flota  H  Ayuda  Q  Salir");
         break;
 
     case 1: // Detalle banda
         mvwprintw(win_commands, 1, 2, "NAVEGACION:");
         mvwprintw(win_commands, 2, 2, "  ^/v  Cambiar banda    TAB  Cambiar vista");
         mvwprintw(win_commands, 3, 2, "CONTROL:");
-        mvwprintw(win_commands, 4, 2, "  ESPACIO Pausar/Reanudar  R  Reabastecer");
+        mvwprintw(win_commands, 4, 2, "  ESPACIO Pausar/Reanudar  R  Reabastecer  X  Cancelar");
         mvwprintw(win_commands, 5, 2, "  I  Ver inventario  S  Abastecimiento");
         break;
 
@@ -1158,10 +3583,50 @@ void mostrar_comandos_disponibles()
 
     case 4: // Modo abastecimiento
         mvwprintw(win_commands, 1, 2, "ABASTECIMIENTO:");
-        mvwprintw(win_commands, 2, 2, "  1-5  Seleccionar opcion");
-        mvwprintw(win_commands, 3, 2, "  ESC  Salir del modo");
-        mvwprintw(win_commands, 4, 2, "RAPIDO:");
-        mvwprintw(win_commands, 5, 2, "  A  Todas  C  Criticas  E  Agotadas");
+        mvwprintw(win_commands, 2, 2, "  1-5  Seleccionar opcion  ESC  Salir");
+        mvwprintw(win_commands, 3, 2, "RAPIDO:");
+        mvwprintw(win_commands, 4, 2, "  A  Todas  C  Criticas  E  Agotadas");
+        mvwprintw(win_commands, 5, 2, "  P  Aplicar plan  K/T  Bandas/minutos");
+        break;
+
+    case 7: // Mapa de calor
+        mvwprintw(win_commands, 1, 2, "NAVEGACION:");
+        mvwprintw(win_commands, 2, 2, "  ^/v  Cambiar banda    ESC  Volver");
+        mvwprintw(win_commands, 3, 2, "MAPA:");
+        mvwprintw(win_commands, 4, 2, "  T  Llenado / minutos hasta agotarse");
+        mvwprintw(win_commands, 5, 2, "  R  Reabastecer banda  S  Abastecimiento");
+        break;
+
+    case 8: // Uso de CPU
+        mvwprintw(win_commands, 1, 2, "NAVEGACION:");
+        mvwprintw(win_commands, 2, 2, "  ESC  Volver    V  Flota    L  Linea tiempo");
+        mvwprintw(win_commands, 3, 2, "CPU:");
+        mvwprintw(win_commands, 4, 2, "  %%CPU y desp/s: ultimo segundo; resto: total");
+        mvwprintw(win_commands, 5, 2, "  H  Ayuda    Q  Salir");
+        break;
+
+    case 9: // Tendencias
+        mvwprintw(win_commands, 1, 2, "NAVEGACION:");
+        mvwprintw(win_commands, 2, 2, "  ESC  Volver    V  Flota    U  Uso de CPU");
+        mvwprintw(win_commands, 3, 2, "RESOLUCION:");
+        mvwprintw(win_commands, 4, 2, "  +/-  Filas de hora / minuto / segundo");
+        mvwprintw(win_commands, 5, 2, "  H  Ayuda    Q  Salir");
+        break;
+
+    case 6: // Línea de tiempo
+        mvwprintw(win_commands, 1, 2, "NAVEGACION:");
+        mvwprintw(win_commands, 2, 2, "  ^/v  Cambiar banda    ESC  Volver");
+        mvwprintw(win_commands, 3, 2, "VENTANA:");
+        mvwprintw(win_commands, 4, 2, "  +/-  Ampliar/reducir minutos visibles");
+        mvwprintw(win_commands, 5, 2, "  ESPACIO Pausar/Reanudar  H  Ayuda");
+        break;
+
+    case 5: // Vista de flota
+        mvwprintw(win_commands, 1, 2, "NAVEGACION:");
+        mvwprintw(win_commands, 2, 2, "  ^/v  Cambiar cocina   ENTER  Ver detalle");
+        mvwprintw(win_commands, 3, 2, "  ESC  Volver a la cocina seleccionada");
+        mvwprintw(win_commands, 4, 2, "SISTEMA:");
+        mvwprintw(win_commands, 5, 2, "  H  Ayuda    Q  Salir");
         break;
 
     default:
@@ -1201,13 +3666,46 @@ void mostrar_estado_sistema()
     case 4:
         mvwprintw(win_status, 0, 2, " MODO ABASTECIMIENTO ");
         break;
+    case 5:
+        mvwprintw(win_status, 0, 2, " VISTA DE FLOTA ");
+        break;
+    case 6:
+        mvwprintw(win_status, 0, 2, " LINEA DE TIEMPO ");
+        break;
+    case 7:
+        mvwprintw(win_status, 0, 2, " MAPA DE CALOR ");
+        break;
+    case 8:
+        mvwprintw(win_status, 0, 2, " USO DE CPU ");
+        break;
+    case 9:
+        mvwprintw(win_status, 0, 2, " TENDENCIAS ");
+        break;
     }
 
     if (has_colors())
         wattroff(win_status, COLOR_PAIR(4));
 
+    // Cocina seleccionada (relevante cuando el panel supervisa varias)
+    mvwprintw(win_status, 1, 2, "[COCINA] %s (%d/%d)", datos_compartidos->nombre_instancia,
+              instancia_seleccionada + 1, num_instancias);
+
     // Estado del sistema
-    if (datos_compartidos->sistema_activo)
+    if (modo_reproduccion)
+    {
+        long long inicio_ms = reproduccion.cuadros[0].cabecera.marca_ms;
+        long long final_ms = reproduccion.cuadros[reproduccion.num_cuadros - 1].cabecera.marca_ms;
+        int actual_s = (reproduccion.marca_ms - inicio_ms) / 1000;
+        int total_s = (final_ms - inicio_ms) / 1000;
+
+        if (has_colors())
+            wattron(win_status, COLOR_PAIR(2));
+        mvwprintw(win_status, 2, 2, "[REPLAY] %02d:%02d/%02d:%02d x%d%s", actual_s / 60, actual_s % 60,
+                  total_s / 60, total_s % 60, reproduccion.velocidad, reproduccion.en_pausa ? " PAUSA" : "");
+        if (has_colors())
+            wattroff(win_status, COLOR_PAIR(2));
+    }
+    else if (datos_compartidos->sistema_activo)
     {
         if (has_colors())
             wattron(win_status, COLOR_PAIR(1));
@@ -1250,6 +3748,9 @@ void mostrar_estado_sistema()
 
 void procesar_comando(int ch)
 {
+    if (modo_reproduccion && procesar_comando_reproduccion(ch))
+        return;
+
     switch (ch)
     {
     case 'q':
@@ -1264,6 +3765,8 @@ void procesar_comando(int ch)
     case KEY_UP:
         if (modo_vista == 3) // Inventario banda
             cambiar_ingrediente_seleccionado(-1);
+        else if (modo_vista == 5) // Flota
+            cambiar_instancia_seleccionada(-1);
         else
             cambiar_banda_seleccionada(-1);
         break;
@@ -1271,20 +3774,76 @@ void procesar_comando(int ch)
     case KEY_DOWN:
         if (modo_vista == 3) // Inventario banda
             cambiar_ingrediente_seleccionado(1);
+        else if (modo_vista == 5) // Flota
+            cambiar_instancia_seleccionada(1);
         else
             cambiar_banda_seleccionada(1);
         break;
 
+    case 'v':
+    case 'V':
+        modo_vista = 5; // Vista de flota
+        break;
+
+    case 'l':
+    case 'L':
+        modo_vista = 6; // Línea de tiempo
+        break;
+
+    case 'm':
+    case 'M':
+        modo_vista = 7; // Mapa de calor
+        break;
+
+    case 'u':
+    case 'U':
+        modo_vista = 8; // Uso de CPU
+        break;
+
+    case 'g':
+    case 'G':
+        modo_vista = 9; // Tendencias del archivo de métricas
+        break;
+
+    case 't':
+    case 'T':
+        if (modo_vista == 7)
+            mapa_por_tiempo = !mapa_por_tiempo;
+        else if (modo_vista == 4) // Plan: minutos de demanda a cubrir
+            plan_minutos = plan_minutos >= 60 ? 5 : (plan_minutos < 15 ? plan_minutos + 5 : plan_minutos * 2);
+        break;
+
+    case 'k':
+    case 'K':
+        if (modo_vista == 4) // Plan: bandas por receta
+            plan_bandas_k = plan_bandas_k >= datos_compartidos->num_bandas ? 1 : plan_bandas_k + 1;
+        break;
+
+    case 'p':
+    case 'P':
+        if (modo_vista == 4)
+            aplicar_plan_reabastecimiento();
+        break;
+
+    case '\n':
+    case KEY_ENTER:
+        if (modo_vista == 5)
+        {
+            seleccionar_instancia(instancia_seleccionada);
+            modo_vista = 0;
+        }
+        break;
+
     case '\t':
     case KEY_RIGHT:
-        if (modo_vista == 4)
+        if (modo_vista >= 4)
             break;                         // No cambiar vista en modo abastecimiento
         modo_vista = (modo_vista + 1) % 4; // 0-3 (excluir modo abastecimiento)
         ingrediente_seleccionado = 0;      // Reset ingrediente
         break;
 
     case KEY_LEFT:
-        if (modo_vista == 4)
+        if (modo_vista >= 4)
             break;                             // No cambiar vista en modo abastecimiento
         modo_vista = (modo_vista - 1 + 4) % 4; // 0-3 (excluir modo abastecimiento)
         ingrediente_seleccionado = 0;          // Reset ingrediente
@@ -1310,8 +3869,14 @@ void procesar_comando(int ch)
         modo_vista = 4; // Cambiar a modo abastecimiento
         break;
 
+    case 'x':
+    case 'X':
+        if (modo_vista == 0 || modo_vista == 1)
+            cancelar_orden_por_buzon();
+        break;
+
     case 27: // ESC
-        if (modo_vista == 4)
+        if (modo_vista >= 4)
         {
             modo_vista = 0; // Volver a vista general
         }
@@ -1321,12 +3886,8 @@ void procesar_comando(int ch)
     case 'A':
         if (modo_vista == 4) // Modo abastecimiento
         {
-            // Reabastecer todas las bandas
-            for (int i = 0; i < datos_compartidos->num_bandas; i++)
-            {
-                reabastecer_banda_completa(i);
-            }
-            mostrar_mensaje_temporal("[OK] Todas las bandas reabastecidas");
+            // Reabastecer todas las bandas con un solo comando
+            reabastecer_por_buzon(REABASTECER_TODO, TODAS_LAS_BANDAS, -1, "Todas las bandas reabastecidas");
         }
         break;
 
@@ -1335,29 +3896,7 @@ void procesar_comando(int ch)
         if (modo_vista == 4) // Modo abastecimiento
         {
             // Reabastecer solo ingredientes críticos
-            int bandas_reabastecidas = 0;
-            for (int banda = 0; banda < datos_compartidos->num_bandas; banda++)
-            {
-                int tenia_criticos = 0;
-                for (int ing = 0; ing < MAX_INGREDIENTES; ing++)
-                {
-                    pthread_mutex_lock(&datos_compartidos->bandas[banda].dispensadores[ing].mutex);
-                    if (datos_compartidos->bandas[banda].dispensadores[ing].cantidad <= UMBRAL_INVENTARIO_BAJO)
-                    {
-                        datos_compartidos->bandas[banda].dispensadores[ing].cantidad = CAPACIDAD_DISPENSADOR;
-                        tenia_criticos = 1;
-                    }
-                    pthread_mutex_unlock(&datos_compartidos->bandas[banda].dispensadores[ing].mutex);
-                }
-                if (tenia_criticos)
-                {
-                    bandas_reabastecidas++;
-                    datos_compartidos->bandas[banda].necesita_reabastecimiento = 0;
-                }
-            }
-            char mensaje[60];
-            snprintf(mensaje, sizeof(mensaje), "[OK] %d bandas con ingredientes críticos reabastecidas", bandas_reabastecidas);
-            mostrar_mensaje_temporal(mensaje);
+            reabastecer_por_buzon(REABASTECER_CRITICOS, TODAS_LAS_BANDAS, -1, "Criticos reabastecidos");
         }
         break;
 
@@ -1366,35 +3905,31 @@ void procesar_comando(int ch)
         if (modo_vista == 4) // Modo abastecimiento
         {
             // Reabastecer solo ingredientes agotados
-            int ingredientes_reabastecidos = 0;
-            for (int banda = 0; banda < datos_compartidos->num_bandas; banda++)
-            {
-                for (int ing = 0; ing < MAX_INGREDIENTES; ing++)
-                {
-                    pthread_mutex_lock(&datos_compartidos->bandas[banda].dispensadores[ing].mutex);
-                    if (datos_compartidos->bandas[banda].dispensadores[ing].cantidad == 0)
-                    {
-                        datos_compartidos->bandas[banda].dispensadores[ing].cantidad = CAPACIDAD_DISPENSADOR;
-                        ingredientes_reabastecidos++;
-                    }
-                    pthread_mutex_unlock(&datos_compartidos->bandas[banda].dispensadores[ing].mutex);
-                }
-            }
-            char mensaje[60];
-            snprintf(mensaje, sizeof(mensaje), "[OK] %d ingredientes agotados reabastecidos", ingredientes_reabastecidos);
-            mostrar_mensaje_temporal(mensaje);
+            reabastecer_por_buzon(REABASTECER_AGOTADOS, TODAS_LAS_BANDAS, -1, "Agotados reabastecidos");
         }
         break;
 
     case '+':
     case '=':
-        if (modo_vista == 3) // Inventario banda
+        if (modo_vista == 6) // Línea de tiempo: ampliar ventana
+        {
+            if (minutos_linea_tiempo < 60)
+                minutos_linea_tiempo = minutos_linea_tiempo < 5 ? minutos_linea_tiempo + 1 : minutos_linea_tiempo + 5;
+        }
+        else if (modo_vista == 9) // Tendencias: filas más gruesas
+        {
+            if (resolucion_tendencias < NUM_RESOLUCIONES_ARCHIVO - 1)
+                resolucion_tendencias++;
+        }
+        else if (modo_vista == 3) // Inventario banda
         {
             Banda *banda = &datos_compartidos->bandas[banda_seleccionada];
             pthread_mutex_lock(&banda->dispensadores[ingrediente_seleccionado].mutex);
             if (banda->dispensadores[ingrediente_seleccionado].cantidad < CAPACIDAD_DISPENSADOR)
             {
+                abrir_escritura_inventario(banda);
                 banda->dispensadores[ingrediente_seleccionado].cantidad++;
+                cerrar_escritura_inventario(banda);
                 mostrar_mensaje_temporal("[+] Ingrediente añadido");
             }
             pthread_mutex_unlock(&banda->dispensadores[ingrediente_seleccionado].mutex);
@@ -1403,13 +3938,25 @@ void procesar_comando(int ch)
 
     case '-':
     case '_':
-        if (modo_vista == 3) // Inventario banda
+        if (modo_vista == 6) // Línea de tiempo: reducir ventana
+        {
+            if (minutos_linea_tiempo > 1)
+                minutos_linea_tiempo = minutos_linea_tiempo <= 5 ? minutos_linea_tiempo - 1 : minutos_linea_tiempo - 5;
+        }
+        else if (modo_vista == 9) // Tendencias: filas más finas
+        {
+            if (resolucion_tendencias > 0)
+                resolucion_tendencias--;
+        }
+        else if (modo_vista == 3) // Inventario banda
         {
             Banda *banda = &datos_compartidos->bandas[banda_seleccionada];
             pthread_mutex_lock(&banda->dispensadores[ingrediente_seleccionado].mutex);
             if (banda->dispensadores[ingrediente_seleccionado].cantidad > 0)
             {
+                abrir_escritura_inventario(banda);
                 banda->dispensadores[ingrediente_seleccionado].cantidad--;
+                cerrar_escritura_inventario(banda);
                 mostrar_mensaje_temporal("[-] Ingrediente removido");
             }
             pthread_mutex_unlock(&banda->dispensadores[ingrediente_seleccionado].mutex);
@@ -1420,14 +3967,7 @@ void procesar_comando(int ch)
     case 'F':
         if (modo_vista == 3) // Inventario banda
         {
-            Banda *banda = &datos_compartidos->bandas[banda_seleccionada];
-            pthread_mutex_lock(&banda->dispensadores[ingrediente_seleccionado].mutex);
-            banda->dispensadores[ingrediente_seleccionado].cantidad = CAPACIDAD_DISPENSADOR;
-            pthread_mutex_unlock(&banda->dispensadores[ingrediente_seleccionado].mutex);
-            char mensaje[80];
-            snprintf(mensaje, sizeof(mensaje), "[F] %s llenado completamente",
-                     ingredientes_base[ingrediente_seleccionado]);
-            mostrar_mensaje_temporal(mensaje);
+            reabastecer_ingrediente_especifico(banda_seleccionada, ingrediente_seleccionado);
         }
         break;
 
@@ -1446,11 +3986,7 @@ void procesar_comando(int ch)
     case '2':
         if (modo_vista == 4)
         {
-            for (int i = 0; i < datos_compartidos->num_bandas; i++)
-            {
-                reabastecer_banda_completa(i);
-            }
-            mostrar_mensaje_temporal("[OK] Todas las bandas reabastecidas");
+            procesar_comando('A');
         }
         else
         {
@@ -1536,6 +4072,393 @@ void cambiar_ingrediente_seleccionado(int direccion)
     }
 }
 
+long llamada_futex(unsigned int *palabra, int operacion, unsigned int valor, long long espera_us)
+{
+    struct timespec espera = {espera_us / 1000000, (espera_us % 1000000) * 1000};
+    int con_plazo = operacion == FUTEX_WAIT && espera_us != SIN_LIMITE;
+    return syscall(SYS_futex, palabra, operacion, valor, con_plazo ? &espera : NULL, NULL, 0);
+}
+
+void notificar_eventos(ContadorEventos *eventos, int despertar)
+{
+    __atomic_add_fetch(&eventos->secuencia, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&eventos->esperando, __ATOMIC_SEQ_CST) > 0)
+        llamada_futex(&eventos->secuencia, FUTEX_WAKE, despertar, 0);
+}
+
+int proceso_terminado(pid_t pid)
+{
+    return pid > 0 && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+int enviar_comando(BuzonComandos *comando)
+{
+    BuzonComandos *buzon = &datos_compartidos->buzon;
+    long long limite = reloj_ms() + ESPERA_COMANDO_MS;
+
+    // Reservar el buzón; otro panel puede tener un comando en vuelo
+    unsigned int estado = BUZON_LIBRE;
+    while (!__atomic_compare_exchange_n(&buzon->estado, &estado, BUZON_OCUPADO, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+    {
+        // Recuperar un buzón abandonado. Un emisor vivo siempre libera el buzón él mismo, aunque
+        // el comando se resuelva después de su plazo, así que solo se recupera si el emisor
+        // terminó o, con un comando en aplicación, si el sistema que lo tomó ya no existe
+        long long antiguedad = reloj_ms() - buzon->reservado_ms;
+        int abandonado = 0;
+        if ((estado == BUZON_OCUPADO || estado == BUZON_RESUELTO) && antiguedad > ESPERA_COMANDO_MS)
+            abandonado = proceso_terminado(buzon->pid_emisor);
+        else if (estado == BUZON_APLICANDO)
+            abandonado = proceso_terminado(datos_compartidos->pid);
+        if (abandonado)
+        {
+            __atomic_compare_exchange_n(&buzon->estado, &estado, BUZON_LIBRE, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE);
+        }
+        if (reloj_ms() > limite)
+            return 0;
+        usleep(1000);
+        estado = BUZON_LIBRE;
+    }
+
+    buzon->pid_emisor = getpid();
+    buzon->reservado_ms = reloj_ms();
+    buzon->secuencia++;
+    buzon->comando = comando->comando;
+    buzon->modo = comando->modo;
+    buzon->banda = comando->banda;
+    buzon->ingrediente = comando->ingrediente;
+    buzon->num_recargas = comando->num_recargas;
+    memcpy(buzon->recargas, comando->recargas, comando->num_recargas * sizeof(RecargaPlan));
+    buzon->id_orden = comando->id_orden;
+
+    __atomic_store_n(&buzon->estado, BUZON_PENDIENTE, __ATOMIC_RELEASE);
+    llamada_futex(&buzon->estado, FUTEX_WAKE, 1, 0);
+
+    // Esperar el resultado
+    limite = reloj_ms() + ESPERA_COMANDO_MS;
+    while ((estado = __atomic_load_n(&buzon->estado, __ATOMIC_ACQUIRE)) != BUZON_RESUELTO)
+    {
+        if (proceso_terminado(datos_compartidos->pid))
+        {
+            // Sin sistema nadie resolverá el comando; si quedó en aplicación, el buzón lo
+            // recupera el siguiente emisor
+            unsigned int pendiente = BUZON_PENDIENTE;
+            __atomic_compare_exchange_n(&buzon->estado, &pendiente, BUZON_LIBRE, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE);
+            return 0;
+        }
+        if (reloj_ms() > limite)
+        {
+            // Retirar el comando si el sistema todavía no lo tomó; si ya lo está aplicando se
+            // espera su resultado, que es el que cuenta, y este emisor libera el buzón
+            unsigned int pendiente = BUZON_PENDIENTE;
+            if (__atomic_compare_exchange_n(&buzon->estado, &pendiente, BUZON_LIBRE, 0, __ATOMIC_ACQ_REL,
+                                            __ATOMIC_ACQUIRE))
+                return 0;
+        }
+        llamada_futex(&buzon->estado, FUTEX_WAIT, estado, 100000);
+    }
+
+    comando->dispensadores = buzon->dispensadores;
+    comando->unidades = buzon->unidades;
+    comando->programado = buzon->programado;
+    comando->bandas = buzon->bandas;
+    comando->duracion_ns = buzon->duracion_ns;
+    comando->resultado_cancelacion = buzon->resultado_cancelacion;
+    __atomic_store_n(&buzon->estado, BUZON_LIBRE, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void reabastecer_por_buzon(int modo, int banda, int ingrediente, const char *descripcion)
+{
+    BuzonComandos comando;
+    memset(&comando, 0, sizeof(comando));
+    comando.comando = COMANDO_REABASTECER;
+    comando.modo = modo;
+    comando.banda = banda;
+    comando.ingrediente = ingrediente;
+
+    char mensaje[120];
+    if (enviar_comando(&comando))
+        snprintf(mensaje, sizeof(mensaje), "[OK] %s: %d dispensadores %sen %d bandas (+%d u, %.3f ms)",
+                 descripcion, comando.dispensadores, comando.programado ? "programados " : "", comando.bandas,
+                 comando.unidades, comando.duracion_ns / 1e6);
+    else
+        snprintf(mensaje, sizeof(mensaje), "[X] %s: el sistema no confirmó el comando", descripcion);
+    mostrar_mensaje_temporal(mensaje);
+}
+
+void cancelar_orden_por_buzon()
+{
+    int id_orden = pedir_numero("Cancelar orden #");
+    if (id_orden < 0)
+        return;
+
+    BuzonComandos comando;
+    memset(&comando, 0, sizeof(comando));
+    comando.comando = COMANDO_CANCELAR;
+    comando.id_orden = id_orden;
+
+    char mensaje[120];
+    if (!enviar_comando(&comando))
+        snprintf(mensaje, sizeof(mensaje), "[X] Cancelar #%d: el sistema no confirmó el comando", id_orden);
+    else if (comando.resultado_cancelacion == CANCELACION_EN_COLA)
+        snprintf(mensaje, sizeof(mensaje), "[OK] Orden #%d retirada de la cola", id_orden);
+    else if (comando.resultado_cancelacion == CANCELACION_EN_BANDA)
+        snprintf(mensaje, sizeof(mensaje), "[OK] Orden #%d: la banda la deja en su próximo paso", id_orden);
+    else if (comando.resultado_cancelacion == CANCELACION_EN_ASIGNACION)
+        snprintf(mensaje, sizeof(mensaje), "[OK] Orden #%d se descarta al terminar su asignación", id_orden);
+    else
+        snprintf(mensaje, sizeof(mensaje), "[X] Orden #%d no está pendiente", id_orden);
+    mostrar_mensaje_temporal(mensaje);
+}
+
+int calcular_plan_reabastecimiento(int k, int minutos, RecargaPlan *plan, int *recetas_sin_cubrir)
+{
+    int num_bandas = datos_compartidos->num_bandas;
+
+    // Ingredientes de cada receta como índices de ingredientes_base
+    int receta[NUM_TIPOS_HAMBURGUESA][MAX_INGREDIENTES];
+    int tamano_receta[NUM_TIPOS_HAMBURGUESA];
+    for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+    {
+        tamano_receta[r] = 0;
+        for (int i = 0; i < menu_hamburguesas[r].num_ingredientes; i++)
+        {
+            for (int j = 0; j < MAX_INGREDIENTES; j++)
+            {
+                if (strcmp(menu_hamburguesas[r].ingredientes[i], ingredientes_base[j]) == 0)
+                {
+                    receta[r][tamano_receta[r]++] = j;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Demanda prevista por banda y por ingrediente
+    InstantaneaMetricas metricas;
+    memset(&metricas, 0, sizeof(metricas));
+    leer_instantanea(datos_compartidos, &metricas);
+    float ordenes_por_receta = metricas.llegadas_por_minuto * minutos / NUM_TIPOS_HAMBURGUESA;
+
+    int necesidad[MAX_INGREDIENTES];
+    for (int j = 0; j < MAX_INGREDIENTES; j++)
+    {
+        float demanda = 0;
+        for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+        {
+            for (int i = 0; i < tamano_receta[r]; i++)
+            {
+                if (receta[r][i] == j)
+                    demanda += ordenes_por_receta;
+            }
+        }
+        necesidad[j] = (int)(demanda / k + 0.999f);
+        if (necesidad[j] < 1)
+            necesidad[j] = 1;
+        if (necesidad[j] > CAPACIDAD_DISPENSADOR)
+            necesidad[j] = CAPACIDAD_DISPENSADOR;
+    }
+
+    // Inventario proyectado: actual más lo que ya se planificó
+    int proyectado[MAX_BANDAS][MAX_INGREDIENTES];
+    int consumido[MAX_INGREDIENTES];
+    int operativa[MAX_BANDAS];
+    *recetas_sin_cubrir = 0;
+    for (int b = 0; b < num_bandas; b++)
+    {
+        if (!copiar_inventario_banda(&datos_compartidos->bandas[b], proyectado[b], consumido))
+            return -1;
+        for (int j = 0; j < MAX_INGREDIENTES; j++)
+        {
+            // Un relleno que la banda ya tiene programado cuenta como hecho
+            int objetivo = datos_compartidos->bandas[b].dispensadores[j].objetivo_reabasto;
+            if (objetivo > proyectado[b][j])
+                proyectado[b][j] = objetivo;
+        }
+        operativa[b] = datos_compartidos->bandas[b].activa && !datos_compartidos->bandas[b].pausada;
+    }
+
+    int num_recargas = 0;
+    while (1)
+    {
+        // Cobertura actual de cada receta
+        int servible[MAX_BANDAS][NUM_TIPOS_HAMBURGUESA];
+        int cobertura[NUM_TIPOS_HAMBURGUESA] = {0};
+        for (int b = 0; b < num_bandas; b++)
+        {
+            for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+            {
+                servible[b][r] = operativa[b];
+                for (int i = 0; i < tamano_receta[r] && servible[b][r]; i++)
+                {
+                    if (proyectado[b][receta[r][i]] < necesidad[receta[r][i]])
+                        servible[b][r] = 0;
+                }
+                cobertura[r] += servible[b][r];
+            }
+        }
+
+        // Elegir la (banda, receta) con más recetas pendientes cubiertas por recarga
+        int mejor_banda = -1, mejor_receta = -1;
+        float mejor_razon = 0;
+        for (int b = 0; b < num_bandas; b++)
+        {
+            for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+            {
+                if (!operativa[b] || servible[b][r] || cobertura[r] >= k)
+                    continue;
+
+                int faltante[MAX_INGREDIENTES] = {0};
+                int costo = 0;
+                for (int i = 0; i < tamano_receta[r]; i++)
+                {
+                    int j = receta[r][i];
+                    if (proyectado[b][j] < necesidad[j])
+                    {
+                        faltante[j] = 1;
+                        costo++;
+                    }
+                }
+
+                int beneficio = 0;
+                for (int otra = 0; otra < NUM_TIPOS_HAMBURGUESA; otra++)
+                {
+                    if (servible[b][otra] || cobertura[otra] >= k)
+                        continue;
+                    int queda_servible = 1;
+                    for (int i = 0; i < tamano_receta[otra] && queda_servible; i++)
+                    {
+                        int j = receta[otra][i];
+                        if (proyectado[b][j] < necesidad[j] && !faltante[j])
+                            queda_servible = 0;
+                    }
+                    beneficio += queda_servible;
+                }
+
+                float razon = (float)beneficio / costo;
+                if (razon > mejor_razon)
+                {
+                    mejor_razon = razon;
+                    mejor_banda = b;
+                    mejor_receta = r;
+                }
+            }
+        }
+
+        if (mejor_banda < 0)
+            break; // Todo cubierto o no hay más bandas operativas que recargar
+
+        for (int i = 0; i < tamano_receta[mejor_receta]; i++)
+        {
+            int j = receta[mejor_receta][i];
+            if (proyectado[mejor_banda][j] < necesidad[j])
+            {
+                plan[num_recargas].banda = mejor_banda;
+                plan[num_recargas].ingrediente = j;
+                plan[num_recargas].unidades = necesidad[j] - proyectado[mejor_banda][j];
+                proyectado[mejor_banda][j] = necesidad[j];
+                num_recargas++;
+            }
+        }
+    }
+
+    // Recetas que siguen sin K bandas: faltan bandas operativas
+    *recetas_sin_cubrir = 0;
+    for (int r = 0; r < NUM_TIPOS_HAMBURGUESA; r++)
+    {
+        int cobertura = 0;
+        for (int b = 0; b < num_bandas; b++)
+        {
+            int sirve = operativa[b];
+            for (int i = 0; i < tamano_receta[r] && sirve; i++)
+            {
+                if (proyectado[b][receta[r][i]] < necesidad[receta[r][i]])
+                    sirve = 0;
+            }
+            cobertura += sirve;
+        }
+        if (cobertura < k)
+            (*recetas_sin_cubrir)++;
+    }
+
+    return num_recargas;
+}
+
+void aplicar_plan_reabastecimiento()
+{
+    BuzonComandos comando;
+    memset(&comando, 0, sizeof(comando));
+    comando.comando = COMANDO_APLICAR_PLAN;
+    comando.banda = TODAS_LAS_BANDAS;
+    comando.ingrediente = -1;
+
+    int sin_cubrir;
+    comando.num_recargas = calcular_plan_reabastecimiento(plan_bandas_k, plan_minutos, comando.recargas, &sin_cubrir);
+    if (comando.num_recargas < 0)
+    {
+        mostrar_mensaje_temporal("[X] Plan: el inventario cambio mientras se leia, reintente");
+        return;
+    }
+    if (comando.num_recargas == 0)
+    {
+        mostrar_mensaje_temporal("[OK] El menu ya esta cubierto: el plan no tiene recargas");
+        return;
+    }
+
+    char mensaje[120];
+    if (enviar_comando(&comando))
+        snprintf(mensaje, sizeof(mensaje), "[OK] Plan %s: %d recargas en %d bandas (+%d u, %.3f ms)",
+                 comando.programado ? "programado" : "aplicado", comando.dispensadores, comando.bandas,
+                 comando.unidades, comando.duracion_ns / 1e6);
+    else
+        snprintf(mensaje, sizeof(mensaje), "[X] Plan: el sistema no confirmó el comando");
+    mostrar_mensaje_temporal(mensaje);
+}
+
+void abrir_escritura_inventario(Banda *banda)
+{
+    unsigned int version = __atomic_load_n(&banda->version_inventario, __ATOMIC_RELAXED);
+    while ((version & 1) ||
+           !__atomic_compare_exchange_n(&banda->version_inventario, &version, version + 1, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        // Un hilo del sistema está escribiendo; su escritura es de unas pocas instrucciones
+        if (version & 1)
+        {
+            sched_yield();
+            version = __atomic_load_n(&banda->version_inventario, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+void cerrar_escritura_inventario(Banda *banda)
+{
+    __atomic_add_fetch(&banda->version_inventario, 1, __ATOMIC_RELEASE);
+}
+
+void cambiar_instancia_seleccionada(int direccion)
+{
+    if (num_instancias == 0)
+        return;
+    instancia_seleccionada = (instancia_seleccionada + direccion + num_instancias) % num_instancias;
+}
+
+void seleccionar_instancia(int indice)
+{
+    if (indice < 0 || indice >= num_instancias)
+        return;
+
+    instancia_seleccionada = indice;
+    datos_compartidos = instancias[indice].datos;
+
+    // La nueva cocina puede tener menos bandas que la anterior
+    if (banda_seleccionada >= datos_compartidos->num_bandas)
+        banda_seleccionada = 0;
+}
+
 void pausar_reanudar_banda(int banda_id)
 {
     if (banda_id >= 0 && banda_id < datos_compartidos->num_bandas)
@@ -1545,7 +4468,7 @@ void pausar_reanudar_banda(int banda_id)
         if (banda->pausada)
         {
             banda->pausada = 0;
-            pthread_cond_signal(&banda->condicion);
+            notificar_eventos(&banda->eventos, DESPERTAR_UNO);
             char mensaje[50];
             snprintf(mensaje, sizeof(mensaje), "[OK] Banda %d REANUDADA", banda_id + 1);
             mostrar_mensaje_temporal(mensaje);
@@ -1553,6 +4476,7 @@ void pausar_reanudar_banda(int banda_id)
         else
         {
             banda->pausada = 1;
+            notificar_eventos(&banda->eventos, DESPERTAR_UNO);
             char mensaje[50];
             snprintf(mensaje, sizeof(mensaje), "[PAUSE] Banda %d PAUSADA", banda_id + 1);
             mostrar_mensaje_temporal(mensaje);
@@ -1564,19 +4488,9 @@ void reabastecer_banda_completa(int banda_id)
 {
     if (banda_id >= 0 && banda_id < datos_compartidos->num_bandas)
     {
-        for (int i = 0; i < MAX_INGREDIENTES; i++)
-        {
-            pthread_mutex_lock(&datos_compartidos->bandas[banda_id].dispensadores[i].mutex);
-            datos_compartidos->bandas[banda_id].dispensadores[i].cantidad = CAPACIDAD_DISPENSADOR;
-            pthread_mutex_unlock(&datos_compartidos->bandas[banda_id].dispensadores[i].mutex);
-        }
-
-        datos_compartidos->bandas[banda_id].necesita_reabastecimiento = 0;
-        datos_compartidos->bandas[banda_id].ultima_alerta_inventario = 0;
-
-        char mensaje[50];
-        snprintf(mensaje, sizeof(mensaje), "[OK] Banda %d REABASTECIDA", banda_id + 1);
-        mostrar_mensaje_temporal(mensaje);
+        char descripcion[40];
+        snprintf(descripcion, sizeof(descripcion), "Banda %d REABASTECIDA", banda_id + 1);
+        reabastecer_por_buzon(REABASTECER_TODO, banda_id, -1, descripcion);
     }
 }
 
@@ -1585,14 +4499,10 @@ void reabastecer_ingrediente_especifico(int banda_id, int ingrediente_id)
     if (banda_id >= 0 && banda_id < datos_compartidos->num_bandas &&
         ingrediente_id >= 0 && ingrediente_id < MAX_INGREDIENTES)
     {
-        pthread_mutex_lock(&datos_compartidos->bandas[banda_id].dispensadores[ingrediente_id].mutex);
-        datos_compartidos->bandas[banda_id].dispensadores[ingrediente_id].cantidad = CAPACIDAD_DISPENSADOR;
-        pthread_mutex_unlock(&datos_compartidos->bandas[banda_id].dispensadores[ingrediente_id].mutex);
-
-        char mensaje[70];
-        snprintf(mensaje, sizeof(mensaje), "[OK] %s en Banda %d reabastecido",
-                 ingredientes_base[ingrediente_id], banda_id + 1);
-        mostrar_mensaje_temporal(mensaje);
+        char descripcion[70];
+        snprintf(descripcion, sizeof(descripcion), "%s en Banda %d reabastecido", ingredientes_base[ingrediente_id],
+                 banda_id + 1);
+        reabastecer_por_buzon(REABASTECER_TODO, banda_id, ingrediente_id, descripcion);
     }
 }
 
@@ -1620,6 +4530,45 @@ void mostrar_mensaje_temporal(const char *mensaje)
     refresh();
 }
 
+int pedir_numero(const char *pregunta)
+{
+    int altura, ancho;
+    getmaxyx(stdscr, altura, ancho);
+
+    char digitos[10];
+    int largo = 0;
+    int ch = 0;
+
+    // En modo nodelay getch() no bloquea: esperar explícitamente cada tecla
+    nodelay(stdscr, FALSE);
+    while (ch != '\n' && ch != KEY_ENTER && ch != 27)
+    {
+        digitos[largo] = '\0';
+        if (has_colors())
+            attron(COLOR_PAIR(7));
+        mvprintw(altura - 1, 0, "%s%s_ (ENTER confirma, ESC cancela)", pregunta, digitos);
+        clrtoeol();
+        if (has_colors())
+            attroff(COLOR_PAIR(7));
+        refresh();
+
+        ch = getch();
+        if (ch >= '0' && ch <= '9' && largo < (int)sizeof(digitos) - 1)
+            digitos[largo++] = (char)ch;
+        else if ((ch == KEY_BACKSPACE || ch == 127 || ch == '\b') && largo > 0)
+            largo--;
+    }
+    nodelay(stdscr, TRUE);
+
+    mvprintw(altura - 1, 0, "%*s", ancho, "");
+    refresh();
+
+    if (ch == 27 || largo == 0)
+        return -1;
+    digitos[largo] = '\0';
+    return atoi(digitos);
+}
+
 void mostrar_ayuda_detallada()
 {
     clear();
@@ -1632,51 +4581,77 @@ void mostrar_ayuda_detallada()
     if (has_colors())
         attroff(COLOR_PAIR(4));
 
-    mvprintw(6, 5, "| NAVEGACION:                                                                    |");
-    mvprintw(7, 5, "|   ^/v              Cambiar banda/ingrediente seleccionado                     |");
-    mvprintw(8, 5, "|   TAB / <-/->      Cambiar vista (General/Detalle/Global/Inventario)           |");
-    mvprintw(9, 5, "|   1-9              Seleccionar banda directamente                             |");
-    mvprintw(10, 5, "|                                                                                |");
-    mvprintw(11, 5, "| CONTROL DE BANDAS:                                                             |");
-    mvprintw(12, 5, "|   ESPACIO          Pausar/Reanudar banda seleccionada                        |");
-    mvprintw(13, 5, "|   R                Reabastecer banda seleccionada completamente               |");
-    mvprintw(14, 5, "|   I                Ver inventario detallado de la banda                       |");
-    mvprintw(15, 5, "|   S                Entrar al modo de abastecimiento                           |");
-    mvprintw(16, 5, "|                                                                                |");
-    mvprintw(17, 5, "| MODO INVENTARIO BANDA:                                                         |");
-    mvprintw(18, 5, "|   +/-              Añadir/quitar 1 unidad del ingrediente seleccionado       |");
-    mvprintw(19, 5, "|   F                Llenar completamente el ingrediente seleccionado           |");
-    mvprintw(20, 5, "|                                                                                |");
-    mvprintw(21, 5, "| MODO ABASTECIMIENTO:                                                           |");
-    mvprintw(22, 5, "|   1                Reabastecer banda seleccionada                             |");
-    mvprintw(23, 5, "|   2 o A            Reabastecer TODAS las bandas                               |");
-    mvprintw(24, 5, "|   3 o C            Reabastecer solo ingredientes críticos                     |");
-    mvprintw(25, 5, "|   4 o E            Reabastecer solo ingredientes agotados                     |");
-    mvprintw(26, 5, "|   5                Modo personalizado (ingrediente por ingrediente)           |");
-    mvprintw(27, 5, "|   ESC              Salir del modo abastecimiento                              |");
-    mvprintw(28, 5, "|                                                                                |");
-    mvprintw(29, 5, "| VISTAS DISPONIBLES:                                                            |");
-    mvprintw(30, 5, "|   General          Resumen de todas las bandas y estadísticas                |");
-    mvprintw(31, 5, "|   Detalle          Información específica de la banda seleccionada           |");
-    mvprintw(32, 5, "|   Global           Resumen de inventarios por ingrediente                     |");
-    mvprintw(33, 5, "|   Inventario       Inventario completo de la banda seleccionada              |");
-    mvprintw(34, 5, "|   Abastecimiento   Opciones de reabastecimiento masivo                       |");
-    mvprintw(35, 5, "|                                                                                |");
-    mvprintw(36, 5, "| INDICADORES:                                                                   |");
-    mvprintw(37, 5, "|   [OK] Verde       Funcionamiento normal                                       |");
-    mvprintw(38, 5, "|   [!]  Amarillo    Advertencia/Crítico                                        |");
-    mvprintw(39, 5, "|   [X]  Rojo        Error/Agotado/Inactivo                                       |");
-    mvprintw(40, 5, "|   >    Azul        Elemento seleccionado                                       |");
-    mvprintw(41, 5, "+===============================================================================+");
+    // Una línea por entrada; el marco se completa al ancho fijo de la tabla
+    const char *lineas[] = {
+        " NAVEGACION:",
+        "   ^/v              Cambiar banda/ingrediente seleccionado",
+        "   TAB / <-/->      Cambiar vista (General/Detalle/Global/Inventario)",
+        "   1-9              Seleccionar banda directamente",
+        "",
+        " CONTROL DE BANDAS:",
+        "   ESPACIO          Pausar/Reanudar banda seleccionada",
+        "   R                Reabastecer banda seleccionada completamente",
+        "   I                Ver inventario detallado de la banda",
+        "   S                Entrar al modo de abastecimiento",
+        "   X                Cancelar una orden por su número (General/Detalle)",
+        "",
+        " MODO INVENTARIO BANDA:",
+        "   +/-              Añadir/quitar 1 unidad del ingrediente seleccionado",
+        "   F                Llenar completamente el ingrediente seleccionado",
+        "",
+        " MODO ABASTECIMIENTO:",
+        "   1                Reabastecer banda seleccionada",
+        "   2 o A            Reabastecer TODAS las bandas",
+        "   3 o C            Reabastecer solo ingredientes críticos",
+        "   4 o E            Reabastecer solo ingredientes agotados",
+        "   5                Modo personalizado (ingrediente por ingrediente)",
+        "   P                Aplicar plan minimo (cubre el menu en K bandas, T min)",
+        "   K / T            Cambiar bandas por receta / minutos de demanda",
+        "   ESC              Salir del modo abastecimiento",
+        "",
+        " VISTAS DISPONIBLES:",
+        "   General          Resumen de todas las bandas y estadísticas",
+        "   Detalle          Información específica de la banda seleccionada",
+        "   Global           Resumen de inventarios por ingrediente",
+        "   Inventario       Inventario completo de la banda seleccionada",
+        "   Abastecimiento   Opciones de reabastecimiento masivo",
+        "   V  Flota         Todas las cocinas conectadas (ENTER entra al detalle)",
+        "   L  Linea tiempo  Ultimos minutos de cada banda (+/- cambia la ventana)",
+        "   M  Mapa calor    Bandas x ingredientes (T: llenado / minutos a agotarse)",
+        "   U  Uso de CPU    CPU, despertares y cambios de contexto de cada hilo",
+        "   G  Tendencias    Archivo de métricas (-R): semana contra semana (+/-)",
+        "",
+        " REPRODUCCION (--replay ARCHIVO):",
+        "   ESPACIO o P      Pausar/Reanudar la reproducción",
+        "   X                Velocidad x1 / x10 / x100",
+        "   < / >            Retroceder/Avanzar 10 segundos",
+        "   .                Avanzar un solo cuadro (250 ms)",
+        "",
+        " INDICADORES:",
+        "   [OK] Verde       Funcionamiento normal",
+        "   [!]  Amarillo    Advertencia/Crítico",
+        "   [X]  Rojo        Error/Agotado/Inactivo",
+        "   >    Azul        Elemento seleccionado"};
+    int num_lineas = sizeof(lineas) / sizeof(lineas[0]);
+
+    for (int i = 0; i < num_lineas; i++)
+    {
+        mvprintw(6 + i, 5, "|%-79s|", lineas[i]);
+    }
+    mvprintw(6 + num_lineas, 5, "+===============================================================================+");
 
     if (has_colors())
         attron(COLOR_PAIR(5));
-    mvprintw(43, 5, "Presiona cualquier tecla para continuar...");
+    mvprintw(8 + num_lineas, 5, "Presiona cualquier tecla para continuar...");
     if (has_colors())
         attroff(COLOR_PAIR(5));
 
     refresh();
+
+    // En modo nodelay getch() no bloquea: esperar explícitamente una tecla
+    nodelay(stdscr, FALSE);
     getch();
+    nodelay(stdscr, TRUE);
 }
 
 void limpiar_ncurses()
@@ -1696,23 +4671,81 @@ void limpiar_ncurses()
 // FUNCION PRINCIPAL
 // ================================================================
 
-int main()
+/**
+ * @brief Muestra el uso del panel de control desde la línea de comandos
+ */
+static void mostrar_uso_panel()
+{
+    printf("Uso: ./control_panel [opciones]\n\n");
+    printf("Opciones:\n");
+    printf("  -s, --cocina <NOMBRE>   Supervisar la cocina iniciada con ./burger_system -s NOMBRE\n");
+    printf("                          (repetible para supervisar varias cocinas)\n");
+    printf("  -d, --descubrir         Conectar todas las cocinas en ejecución\n");
+    printf("  -r, --replay <ARCHIVO>  Reproducir un diario grabado con ./burger_system -j ARCHIVO\n");
+    printf("                          (ESPACIO/P pausa, X velocidad 1/10/100, < > saltar 10 s, . paso)\n");
+    printf("  -h, --help              Mostrar esta ayuda\n\n");
+    printf("Sin opciones se conecta a la cocina por defecto (%s).\n", PREFIJO_MEMORIA);
+}
+
+int main(int argc, char *argv[])
 {
     printf("Iniciando Panel de Control Mejorado del Sistema de Hamburguesas...\n");
     printf("Conectando con el sistema principal...\n");
 
+    int pidio_cocinas = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--cocina") == 0) && i + 1 < argc)
+        {
+            char segmento[64];
+            snprintf(segmento, sizeof(segmento), "%s_%s", PREFIJO_MEMORIA, argv[++i]);
+            if (conectar_instancia(segmento) < 0)
+                printf("Aviso: No se pudo conectar con la cocina '%s'\n", argv[i]);
+            pidio_cocinas = 1;
+        }
+        else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--replay") == 0) && i + 1 < argc)
+        {
+            // Un diario reemplaza a las cocinas en vivo
+            if (!abrir_reproduccion(argv[++i]))
+                exit(1);
+            pidio_cocinas = 1;
+            break;
+        }
+        else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--descubrir") == 0)
+        {
+            printf("Cocinas descubiertas: %d\n", descubrir_instancias());
+            pidio_cocinas = 1;
+        }
+        else
+        {
+            mostrar_uso_panel();
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
     // Conectar con el sistema principal
-    conectar_memoria_compartida();
-    printf("Conexión establecida exitosamente\n");
+    if (!pidio_cocinas)
+        conectar_memoria_compartida();
+
+    if (num_instancias == 0)
+    {
+        printf("Error: No hay cocinas en ejecución a las que conectar.\n");
+        exit(1);
+    }
+    printf("Conexión establecida exitosamente (%d cocinas)\n", num_instancias);
 
-    // Verificar que el sistema este activo
-    if (!datos_compartidos->sistema_activo)
+    // Verificar que el sistema este activo (un diario se reproduce aunque haya terminado)
+    if (!modo_reproduccion && !datos_compartidos->sistema_activo)
     {
         printf("El sistema principal no está activo\n");
         printf("   Inicia primero: ./burger_system -n 4\n");
         exit(1);
     }
 
+    // Con varias cocinas se arranca en la vista de flota
+    if (num_instancias > 1)
+        modo_vista = 5;
+
     sleep(2);
 
     // Inicializar interfaz
@@ -1726,11 +4759,15 @@ int main()
     {
         time_t ahora = time(NULL);
 
+        // Al reproducir, redibujar también cuando cambia el cuadro
+        int cambio_cuadro = modo_reproduccion && avanzar_reproduccion();
+
         // Actualizar interfaz cada segundo o con comando
-        if (ahora - ultimo_refresh >= 1 || ch != ERR)
+        if (ahora - ultimo_refresh >= 1 || ch != ERR || cambio_cuadro)
         {
-            // Verificar si el sistema sigue activo
-            if (!datos_compartidos->sistema_activo)
+            // Con una sola cocina, terminar si el sistema se detiene; con
+            // varias, la vista de flota la muestra como INACTIVA
+            if (!modo_reproduccion && !datos_compartidos->sistema_activo && num_instancias == 1)
             {
                 break;
             }
@@ -1759,6 +4796,21 @@ int main()
                 mostrar_interfaz_general();
                 mostrar_modo_abastecimiento();
                 break;
+            case 5: // Vista de flota
+                mostrar_vista_flota();
+                break;
+            case 6: // Línea de tiempo
+                mostrar_linea_tiempo();
+                break;
+            case 7: // Mapa de calor
+                mostrar_mapa_calor();
+                break;
+            case 8: // Uso de CPU
+                mostrar_uso_cpu();
+                break;
+            case 9: // Tendencias
+                mostrar_tendencias();
+                break;
             }
 
             mostrar_comandos_disponibles();
@@ -1772,6 +4824,10 @@ int main()
             procesar_comando(ch);
             if (ch == 'q' || ch == 'Q')
                 break;
+
+            // Mostrar de inmediato el resultado de pausar, saltar o avanzar un paso
+            if (modo_reproduccion)
+                ultimo_refresh = 0;
         }
 
         usleep(50000); // 50ms de espera para no saturar CPU
@@ -1784,7 +4840,7 @@ int main()
     printf("Estadísticas finales:\n");
     // Mostrar estadísticas finales del sistema
     printf("   * Órdenes procesadas: %d\n", datos_compartidos->total_ordenes_procesadas);
-    printf("   * Órdenes en cola: %d\n", datos_compartidos->cola_espera.tamano);
+    printf("   * Órdenes en cola: %d\n", datos_compartidos->cola_espera.tamano - datos_compartidos->cola_espera.lapidas);
     printf("   * Bandas monitoreadas: %d\n", datos_compartidos->num_bandas);
     printf("   * Funciones de abastecimiento utilizadas\n");
 